@@ -0,0 +1,141 @@
+#
+#      Copyright (C) 2005-2013 Team XBMC
+#      http://xbmc.org
+#
+#  This Program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This Program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with XBMC; see the file COPYING.  If not, see
+#  <http://www.gnu.org/licenses/>.
+#
+
+# Load generator for the raw TCP JSON-RPC server.
+#
+# Opens a number of idle connections that only receive notifications and a
+# number of active connections that keep sending requests, then reports the
+# request latency percentiles of the active ones.
+#
+#   python JSONRPCLoad.py [--host 127.0.0.1] [--port 9090] [--idle 1000]
+#                         [--active 100] [--duration 30]
+#                         [--method JSONRPC.Ping]
+#
+# 1000 idle connections need a file descriptor limit above the default 1024,
+# raise it with "ulimit -n 4096" before running.
+
+import json, optparse, socket, sys, threading, time
+
+def parse_options():
+  parser = optparse.OptionParser()
+  parser.add_option("--host", default="127.0.0.1")
+  parser.add_option("--port", type="int", default=9090)
+  parser.add_option("--idle", type="int", default=1000, help="connections that only listen")
+  parser.add_option("--active", type="int", default=100, help="connections sending requests")
+  parser.add_option("--duration", type="float", default=30.0, help="seconds to send requests")
+  parser.add_option("--method", default="JSONRPC.Ping")
+  return parser.parse_args()[0]
+
+class ActiveClient(threading.Thread):
+  def __init__(self, options, stop):
+    threading.Thread.__init__(self)
+    self.daemon    = True
+    self.options   = options
+    self.stop      = stop
+    self.latencies = []
+    self.errors    = 0
+
+  def read_response(self, sock, request_id, buffer):
+    # responses are sent back to back without separators, notifications
+    # may arrive in between
+    decoder = json.JSONDecoder()
+    while True:
+      text = buffer[0].lstrip()
+      while text:
+        try:
+          obj, end = decoder.raw_decode(text)
+        except ValueError:
+          break
+        text = text[end:].lstrip()
+        if obj.get("id") == request_id:
+          buffer[0] = text
+          return obj
+      buffer[0] = text
+      data = sock.recv(65536)
+      if not data:
+        raise socket.error("connection closed")
+      buffer[0] += data.decode("utf-8")
+
+  def run(self):
+    try:
+      sock = socket.create_connection((self.options.host, self.options.port))
+    except socket.error:
+      self.errors += 1
+      return
+
+    buffer = [""]
+    request_id = 0
+    while not self.stop.is_set():
+      request_id += 1
+      request = json.dumps({ "jsonrpc": "2.0", "method": self.options.method, "id": request_id })
+      start = time.time()
+      try:
+        sock.sendall(request.encode("utf-8"))
+        response = self.read_response(sock, request_id, buffer)
+      except socket.error:
+        self.errors += 1
+        break
+      if "error" in response:
+        self.errors += 1
+      self.latencies.append(time.time() - start)
+    sock.close()
+
+def percentile(values, p):
+  if not values:
+    return 0.0
+  index = min(len(values) - 1, int(round(p / 100.0 * (len(values) - 1))))
+  return values[index]
+
+def main():
+  options = parse_options()
+
+  idle = []
+  for i in range(options.idle):
+    try:
+      idle.append(socket.create_connection((options.host, options.port)))
+    except socket.error as e:
+      print("Opened %d idle connections, then failed: %s" % (len(idle), e))
+      break
+  print("%d idle connections open" % len(idle))
+
+  stop = threading.Event()
+  clients = [ActiveClient(options, stop) for i in range(options.active)]
+  for client in clients:
+    client.start()
+
+  time.sleep(options.duration)
+  stop.set()
+  for client in clients:
+    client.join(5.0)
+
+  latencies = sorted(l for client in clients for l in client.latencies)
+  errors = sum(client.errors for client in clients)
+  print("%d requests on %d active connections in %.1f s, %.0f requests/s, %d errors" %
+        (len(latencies), options.active, options.duration, len(latencies) / options.duration, errors))
+  for p in (50, 90, 99, 99.9):
+    print("  p%-5s %8.2f ms" % (p, percentile(latencies, p) * 1000.0))
+  if latencies:
+    print("  max    %8.2f ms" % (latencies[-1] * 1000.0))
+
+  for sock in idle:
+    sock.close()
+  return 1 if errors else 0
+
+if __name__ == "__main__":
+  sys.exit(main())
@@ -61,6 +61,7 @@
 #include "GUIUserMessages.h"
 #include "filesystem/DirectoryCache.h"
 #include "filesystem/StackDirectory.h"
+#include "filesystem/MultiPathDirectory.h"
 #include "filesystem/SpecialProtocol.h"
 #include "filesystem/DllLibCurl.h"
 #include "filesystem/MythSession.h"
@@ -2268,13 +2269,16 @@ void CApplication::Render()
 
   g_Windowing.EndRender();
 
+  // glyph pages drawn this frame may be reused from now on
+  g_fontManager.NextFrame();
+
   // execute post rendering actions (finalize window closing)
   g_windowManager.AfterRender();
 
   // reset our info cache - we do this at the end of Render so that it is
   // fresh for the next process(), or after a windowclose animation (where process()
   // isn't called)
-  g_infoManager.ResetCache();
+  g_infoManager.NextFrame();
   lock.Leave();
 
   unsigned int now = XbmcThreads::SystemClockMillis();
@@ -3561,6 +3565,9 @@ void CApplication::Stop(int exitCode)
     }
 #endif
 
+    CLog::Log(LOGNOTICE, "stop multipath listings");
+    CMultiPathDirectory::StopListings();
+
     CLog::Log(LOGNOTICE, "clean cached files!");
 #ifdef HAS_FILESYSTEM_RAR
     g_RarManager.ClearCache(true);
@@ -3614,6 +3621,9 @@ void CApplication::Stop(int exitCode)
   // so we may never get to Destroy() in CXBApplicationEx::Run(), we call it here.
   Destroy();
 
+  // write out any queued log lines, everything from here on is logged directly
+  CLog::SetAsync(false);
+
   //
   Sleep(200);
 }
@@ -4209,6 +4219,7 @@ void CApplication::OnPlayBackEnded()
   CSingleLock lock(m_playStateMutex);
   CLog::Log(LOGDEBUG,"%s : play state was %d, starting %d", __FUNCTION__, m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_ENDED;
+  g_infoManager.InvalidateBools(INFO::SOURCE_PLAYER);
   if(m_bPlaybackStarting)
     return;
 
@@ -4231,6 +4242,7 @@ void CApplication::OnPlayBackStarted()
   CSingleLock lock(m_playStateMutex);
   CLog::Log(LOGDEBUG,"%s : play state was %d, starting %d", __FUNCTION__, m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_PLAYING;
+  g_infoManager.InvalidateBools(INFO::SOURCE_PLAYER);
   if(m_bPlaybackStarting)
     return;
 
@@ -4265,6 +4277,7 @@ void CApplication::OnPlayBackStopped()
   CSingleLock lock(m_playStateMutex);
   CLog::Log(LOGDEBUG,"%s : play state was %d, starting %d", __FUNCTION__, m_ePlayState, m_bPlaybackStarting);
   m_ePlayState = PLAY_STATE_STOPPED;
+  g_infoManager.InvalidateBools(INFO::SOURCE_PLAYER);
   if(m_bPlaybackStarting)
     return;
 
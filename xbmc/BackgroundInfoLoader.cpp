@@ -26,6 +26,29 @@
 
 using namespace std;
 
+class CBackgroundLoaderPreparer : public IFileItemPreparer
+{
+public:
+  CBackgroundLoaderPreparer(CBackgroundInfoLoader *loader) : m_loader(loader) { }
+
+  virtual void Prepare(const CFileItemPtr &item)
+  {
+    CSingleLock lock(m_section);
+    if (m_loader)
+      m_loader->QueueItem(item);
+  }
+
+  void Detach()
+  {
+    CSingleLock lock(m_section);
+    m_loader = NULL;
+  }
+
+private:
+  CBackgroundInfoLoader *m_loader;
+  CCriticalSection m_section;
+};
+
 CBackgroundInfoLoader::CBackgroundInfoLoader() : m_thread (NULL)
 {
   m_bStop = true;
@@ -44,53 +67,64 @@ void CBackgroundInfoLoader::Run()
 {
   try
   {
-    if (m_vecItems.size() > 0)
+    vector<CFileItemPtr> items;
+    while (true)
     {
       OnLoaderStart();
 
-      // Stage 1: All "fast" stuff we have already cached
-      for (vector<CFileItemPtr>::const_iterator iter = m_vecItems.begin(); iter != m_vecItems.end(); ++iter)
+      while (TakeItems(items))
       {
-        CFileItemPtr pItem = *iter;
-
-        // Ask the callback if we should abort
-        if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
-          break;
-
-        try
+        // Stage 1: All "fast" stuff we have already cached
+        for (vector<CFileItemPtr>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
         {
-          if (LoadItemCached(pItem.get()) && m_pObserver)
-            m_pObserver->OnItemLoaded(pItem.get());
+          CFileItemPtr pItem = *iter;
+
+          // Ask the callback if we should abort
+          if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
+            break;
+
+          try
+          {
+            if (LoadItemCached(pItem.get()) && m_pObserver)
+              m_pObserver->OnItemLoaded(pItem.get());
+          }
+          catch (...)
+          {
+            CLog::Log(LOGERROR, "CBackgroundInfoLoader::LoadItemCached - Unhandled exception for item %s", pItem->GetPath().c_str());
+          }
         }
-        catch (...)
+
+        // Stage 2: All "slow" stuff that we need to lookup
+        for (vector<CFileItemPtr>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
         {
-          CLog::Log(LOGERROR, "CBackgroundInfoLoader::LoadItemCached - Unhandled exception for item %s", pItem->GetPath().c_str());
+          CFileItemPtr pItem = *iter;
+
+          // Ask the callback if we should abort
+          if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
+            break;
+
+          try
+          {
+            if (LoadItemLookup(pItem.get()) && m_pObserver)
+              m_pObserver->OnItemLoaded(pItem.get());
+          }
+          catch (...)
+          {
+            CLog::Log(LOGERROR, "CBackgroundInfoLoader::LoadItemLookup - Unhandled exception for item %s", pItem->GetPath().c_str());
+          }
         }
       }
 
-      // Stage 2: All "slow" stuff that we need to lookup
-      for (vector<CFileItemPtr>::const_iterator iter = m_vecItems.begin(); iter != m_vecItems.end(); ++iter)
-      {
-        CFileItemPtr pItem = *iter;
+      OnLoaderFinish();
 
-        // Ask the callback if we should abort
-        if ((m_pProgressCallback && m_pProgressCallback->Abort()) || m_bStop)
-          break;
-
-        try
-        {
-          if (LoadItemLookup(pItem.get()) && m_pObserver)
-            m_pObserver->OnItemLoaded(pItem.get());
-        }
-        catch (...)
-        {
-          CLog::Log(LOGERROR, "CBackgroundInfoLoader::LoadItemLookup - Unhandled exception for item %s", pItem->GetPath().c_str());
-        }
+      // items of a lazy list may have been queued while finishing
+      CSingleLock lock(m_lock);
+      if (m_bStop || m_vecItems.empty())
+      {
+        m_bIsLoading = false;
+        break;
       }
     }
-
-    OnLoaderFinish();
-    m_bIsLoading = false;
   }
   catch (...)
   {
@@ -106,14 +140,60 @@ void CBackgroundInfoLoader::Load(CFileItemList& items)
   if (items.Size() == 0)
     return;
 
+  {
+    CSingleLock lock(m_lock);
+    m_pVecItems = &items;
+    m_bStop = false;
+    // don't start the thread before all items are queued
+    m_bIsLoading = true;
+  }
+
+  // queues every (materialized) item, the items of a lazy
+  // list are queued later on once they are materialized
+  m_preparer.reset(new CBackgroundLoaderPreparer(this));
+  items.PrepareItems("backgroundloader", m_preparer);
+
   CSingleLock lock(m_lock);
+  if (m_vecItems.empty())
+    m_bIsLoading = false;
+  else
+    StartThread();
+}
+
+void CBackgroundInfoLoader::QueueItem(const CFileItemPtr &item)
+{
+  CSingleLock lock(m_lock);
+  if (m_bStop)
+    return;
+
+  m_vecItems.push_back(item);
+  if (!m_bIsLoading)
+  {
+    m_bIsLoading = true;
+    StartThread();
+  }
+}
+
+bool CBackgroundInfoLoader::TakeItems(vector<CFileItemPtr> &items)
+{
+  items.clear();
 
-  for (int nItem=0; nItem < items.Size(); nItem++)
-    m_vecItems.push_back(items[nItem]);
+  CSingleLock lock(m_lock);
+  if (m_bStop || m_vecItems.empty())
+    return false;
+
+  items.swap(m_vecItems);
+  return true;
+}
 
-  m_pVecItems = &items;
-  m_bStop = false;
-  m_bIsLoading = true;
+void CBackgroundInfoLoader::StartThread()
+{
+  // a previous thread has already given up on the queue at this point
+  if (m_thread)
+  {
+    m_thread->StopThread();
+    delete m_thread;
+  }
 
   m_thread = new CThread(this, "BackgroundLoader");
   m_thread->Create();
@@ -130,6 +210,13 @@ void CBackgroundInfoLoader::StopAsync()
 
 void CBackgroundInfoLoader::StopThread()
 {
+  // make sure no more items of a lazy list get queued
+  if (m_preparer)
+  {
+    m_preparer->Detach();
+    m_preparer.reset();
+  }
+
   StopAsync();
 
   if (m_thread)
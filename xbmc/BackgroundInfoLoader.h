@@ -29,6 +29,7 @@
 
 class CFileItem; typedef boost::shared_ptr<CFileItem> CFileItemPtr;
 class CFileItemList;
+class CBackgroundLoaderPreparer;
 
 class IBackgroundLoaderObserver
 {
@@ -43,8 +44,16 @@ public:
   CBackgroundInfoLoader();
   virtual ~CBackgroundInfoLoader();
 
+  /*!
+   \brief Load the items of the given list in the background
+
+   For lazy lists only the items that have already been materialized are
+   loaded right away, the others are queued once they are materialized.
+   \sa CFileItemList::AddRows
+   */
   void Load(CFileItemList& items);
   bool IsLoading();
+  void QueueItem(const CFileItemPtr &item);
   virtual void Run();
   void SetObserver(IBackgroundLoaderObserver* pObserver);
   void SetProgressCallback(IProgressCallback* pCallback);
@@ -59,6 +68,9 @@ protected:
   virtual void OnLoaderStart() {};
   virtual void OnLoaderFinish() {};
 
+  bool TakeItems(std::vector<CFileItemPtr> &items);
+  void StartThread();
+
   CFileItemList *m_pVecItems;
   std::vector<CFileItemPtr> m_vecItems; // FileItemList would delete the items and we only want to keep a reference.
   CCriticalSection m_lock;
@@ -66,6 +78,7 @@ protected:
   volatile bool m_bIsLoading;
   volatile bool m_bStop;
   CThread *m_thread;
+  boost::shared_ptr<CBackgroundLoaderPreparer> m_preparer;
 
   IBackgroundLoaderObserver* m_pObserver;
   IProgressCallback* m_pProgressCallback;
@@ -1587,6 +1587,9 @@ void CFileItemList::SetFastLookup(bool fastLookup)
 {
   CSingleLock lock(m_lock);
 
+  if (fastLookup)
+    Materialize();
+
   if (fastLookup && !m_fastLookup)
   { // generate the map
     m_map.clear();
@@ -1611,7 +1614,7 @@ bool CFileItemList::Contains(const CStdString& fileName) const
   // slow method...
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
-    const CFileItemPtr pItem = m_items[i];
+    const CFileItemPtr pItem = At(i);
     if (pItem->GetPath().Equals(fileName))
       return true;
   }
@@ -1641,9 +1644,14 @@ void CFileItemList::ClearItems()
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
     CFileItemPtr item = m_items[i];
-    item->FreeMemory();
+    if (!m_rows.empty() && m_rows[i] >= 0)
+      item = m_lazyItems->GetIfMaterialized(m_rows[i]);
+    if (item)
+      item->FreeMemory();
   }
   m_items.clear();
+  m_rows.clear();
+  m_lazyItems.reset();
   m_map.clear();
 }
 
@@ -1652,6 +1660,8 @@ void CFileItemList::Add(const CFileItemPtr &pItem)
   CSingleLock lock(m_lock);
 
   m_items.push_back(pItem);
+  if (m_lazyItems)
+    m_rows.push_back(-1);
   if (m_fastLookup)
   {
     m_map.insert(MAPFILEITEMSPAIR(pItem->GetPath(), pItem));
@@ -1662,14 +1672,12 @@ void CFileItemList::AddFront(const CFileItemPtr &pItem, int itemPosition)
 {
   CSingleLock lock(m_lock);
 
-  if (itemPosition >= 0)
-  {
-    m_items.insert(m_items.begin()+itemPosition, pItem);
-  }
-  else
-  {
-    m_items.insert(m_items.begin()+(m_items.size()+itemPosition), pItem);
-  }
+  if (itemPosition < 0)
+    itemPosition += m_items.size();
+
+  m_items.insert(m_items.begin()+itemPosition, pItem);
+  if (m_lazyItems)
+    m_rows.insert(m_rows.begin()+itemPosition, -1);
   if (m_fastLookup)
   {
     m_map.insert(MAPFILEITEMSPAIR(pItem->GetPath(), pItem));
@@ -1680,11 +1688,18 @@ void CFileItemList::Remove(CFileItem* pItem)
 {
   CSingleLock lock(m_lock);
 
-  for (IVECFILEITEMS it = m_items.begin(); it != m_items.end(); ++it)
+  for (unsigned int i = 0; i < m_items.size(); i++)
   {
-    if (pItem == it->get())
+    // items of a lazy list that haven't been materialized can't be the one
+    CFileItemPtr item = m_items[i];
+    if (!m_rows.empty() && m_rows[i] >= 0)
+      item = m_lazyItems->GetIfMaterialized(m_rows[i]);
+
+    if (pItem == item.get())
     {
-      m_items.erase(it);
+      m_items.erase(m_items.begin() + i);
+      if (!m_rows.empty())
+        m_rows.erase(m_rows.begin() + i);
       if (m_fastLookup)
       {
         m_map.erase(pItem->GetPath());
@@ -1700,12 +1715,14 @@ void CFileItemList::Remove(int iItem)
 
   if (iItem >= 0 && iItem < (int)Size())
   {
-    CFileItemPtr pItem = *(m_items.begin() + iItem);
     if (m_fastLookup)
     {
+      CFileItemPtr pItem = *(m_items.begin() + iItem);
       m_map.erase(pItem->GetPath());
     }
     m_items.erase(m_items.begin() + iItem);
+    if (!m_rows.empty())
+      m_rows.erase(m_rows.begin() + iItem);
   }
 }
 
@@ -1713,6 +1730,18 @@ void CFileItemList::Append(const CFileItemList& itemlist)
 {
   CSingleLock lock(m_lock);
 
+  // share the rows of a lazy list rather than materializing them
+  if (itemlist.m_lazyItems && !m_fastLookup &&
+     (!m_lazyItems || m_lazyItems == itemlist.m_lazyItems))
+  {
+    CSingleLock lock2(itemlist.m_lock);
+    m_lazyItems = itemlist.m_lazyItems;
+    m_rows.resize(m_items.size(), -1);
+    m_items.insert(m_items.end(), itemlist.m_items.begin(), itemlist.m_items.end());
+    m_rows.insert(m_rows.end(), itemlist.m_rows.begin(), itemlist.m_rows.end());
+    return;
+  }
+
   for (int i = 0; i < itemlist.Size(); ++i)
     Add(itemlist[i]);
 }
@@ -1749,9 +1778,26 @@ bool CFileItemList::Copy(const CFileItemList& items, bool copyItems /* = true */
 
   if (copyItems)
   {
+    CSingleLock lock(items.m_lock);
+    // rows that haven't been materialized yet are copied by materializing
+    // them again from the same columns
+    LazyFileItemsPtr lazyItems;
+    if (items.m_lazyItems && !m_lazyItems && m_items.empty() && !m_fastLookup)
+    {
+      lazyItems.reset(new CLazyFileItems(*items.m_lazyItems));
+      m_lazyItems = lazyItems;
+    }
+
     // make a copy of each item
     for (int i = 0; i < items.Size(); i++)
     {
+      if (lazyItems && items.m_rows[i] >= 0 && !items.IsMaterialized(i))
+      {
+        m_items.push_back(CFileItemPtr());
+        m_rows.push_back(items.m_rows[i]);
+        continue;
+      }
+
       CFileItemPtr newItem(new CFileItem(*items[i]));
       Add(newItem);
     }
@@ -1765,7 +1811,7 @@ CFileItemPtr CFileItemList::Get(int iItem)
   CSingleLock lock(m_lock);
 
   if (iItem > -1 && iItem < (int)m_items.size())
-    return m_items[iItem];
+    return At(iItem);
 
   return CFileItemPtr();
 }
@@ -1775,7 +1821,7 @@ const CFileItemPtr CFileItemList::Get(int iItem) const
   CSingleLock lock(m_lock);
 
   if (iItem > -1 && iItem < (int)m_items.size())
-    return m_items[iItem];
+    return At(iItem);
 
   return CFileItemPtr();
 }
@@ -1795,7 +1841,7 @@ CFileItemPtr CFileItemList::Get(const CStdString& strPath)
   // slow method...
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = At(i);
     if (pItem->GetPath().Equals(strPath))
       return pItem;
   }
@@ -1818,7 +1864,7 @@ const CFileItemPtr CFileItemList::Get(const CStdString& strPath) const
   // slow method...
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    CFileItemPtr pItem = At(i);
     if (pItem->GetPath().Equals(strPath))
       return pItem;
   }
@@ -1842,17 +1888,21 @@ void CFileItemList::Reserve(int iCount)
 {
   CSingleLock lock(m_lock);
   m_items.reserve(iCount);
+  if (m_lazyItems)
+    m_rows.reserve(iCount);
 }
 
 void CFileItemList::Sort(FILEITEMLISTCOMPARISONFUNC func)
 {
   CSingleLock lock(m_lock);
+  Materialize();
   std::stable_sort(m_items.begin(), m_items.end(), func);
 }
 
 void CFileItemList::FillSortFields(FILEITEMFILLFUNC func)
 {
   CSingleLock lock(m_lock);
+  Materialize();
   std::for_each(m_items.begin(), m_items.end(), func);
 }
 
@@ -1897,7 +1947,11 @@ void CFileItemList::Sort(SortDescription sortDescription)
   for (int index = 0; index < Size(); index++)
   {
     sortItems[index] = boost::shared_ptr<SortItem>(new SortItem);
-    m_items[index]->ToSortable(*sortItems[index], fields);
+    // rows of a lazy list are sorted on their columns unless they have been
+    // materialized (and may have been changed since) or a column is missing
+    if (m_rows.empty() || m_rows[index] < 0 || IsMaterialized(index) ||
+        !m_lazyItems->GetColumns().ToSortable(m_rows[index], fields, *sortItems[index]))
+      At(index)->ToSortable(*sortItems[index], fields);
     (*sortItems[index])[FieldId] = index;
   }
 
@@ -1907,23 +1961,44 @@ void CFileItemList::Sort(SortDescription sortDescription)
   // apply the new order to the existing CFileItems
   VECFILEITEMS sortedFileItems;
   sortedFileItems.reserve(Size());
+  std::vector<int> sortedRows;
+  if (m_lazyItems)
+    sortedRows.reserve(Size());
   for (SortItems::const_iterator it = sortItems.begin(); it != sortItems.end(); it++)
   {
-    CFileItemPtr item = m_items[(int)(*it)->at(FieldId).asInteger()];
+    int index = (int)(*it)->at(FieldId).asInteger();
+    CStdStringW sortLabel((*it)->at(FieldSort).asWideString());
+    CFileItemPtr item = m_items[index];
+    if (m_lazyItems)
+    {
+      sortedRows.push_back(m_rows[index]);
+      if (m_rows[index] >= 0)
+        m_lazyItems->SetSortLabel(m_rows[index], sortLabel);
+    }
     // Set the sort label in the CFileItem
-    item->SetSortLabel(CStdStringW((*it)->at(FieldSort).asWideString()));
+    if (item)
+      item->SetSortLabel(sortLabel);
 
     sortedFileItems.push_back(item);
   }
 
   // replace the current list with the re-ordered one
   m_items.assign(sortedFileItems.begin(), sortedFileItems.end());
+  if (m_lazyItems)
+    m_rows.assign(sortedRows.begin(), sortedRows.end());
 }
 
 void CFileItemList::Randomize()
 {
   CSingleLock lock(m_lock);
-  random_shuffle(m_items.begin(), m_items.end());
+  if (!m_lazyItems)
+  {
+    random_shuffle(m_items.begin(), m_items.end());
+    return;
+  }
+
+  for (int i = (int)m_items.size() - 1; i > 0; i--)
+    Swap(i, rand() % (i + 1));
 }
 
 void CFileItemList::Archive(CArchive& ar)
@@ -1931,6 +2006,7 @@ void CFileItemList::Archive(CArchive& ar)
   CSingleLock lock(m_lock);
   if (ar.IsStoring())
   {
+    Materialize();
     CFileItem::Archive(ar);
 
     int i = 0;
@@ -1974,7 +2050,7 @@ void CFileItemList::Archive(CArchive& ar)
     CFileItemPtr pParent;
     if (!IsEmpty())
     {
-      CFileItemPtr pItem=m_items[0];
+      CFileItemPtr pItem=At(0);
       if (pItem->IsParentFolder())
         pParent.reset(new CFileItem(*pItem));
     }
@@ -2044,14 +2120,15 @@ void CFileItemList::Archive(CArchive& ar)
   }
 }
 
+class CDefaultIconPreparer : public IFileItemPreparer
+{
+public:
+  virtual void Prepare(const CFileItemPtr &item) { item->FillInDefaultIcon(); }
+};
+
 void CFileItemList::FillInDefaultIcons()
 {
-  CSingleLock lock(m_lock);
-  for (int i = 0; i < (int)m_items.size(); ++i)
-  {
-    CFileItemPtr pItem = m_items[i];
-    pItem->FillInDefaultIcon();
-  }
+  PrepareItems("defaulticons", FileItemPreparerPtr(new CDefaultIconPreparer()));
 }
 
 int CFileItemList::GetFolderCount() const
@@ -2060,8 +2137,7 @@ int CFileItemList::GetFolderCount() const
   int nFolderCount = 0;
   for (int i = 0; i < (int)m_items.size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
-    if (pItem->m_bIsFolder)
+    if (IsFolder(i))
       nFolderCount++;
   }
 
@@ -2073,7 +2149,7 @@ int CFileItemList::GetObjectCount() const
   CSingleLock lock(m_lock);
 
   int numObjects = (int)m_items.size();
-  if (numObjects && m_items[0]->IsParentFolder())
+  if (numObjects && At(0)->IsParentFolder())
     numObjects--;
 
   return numObjects;
@@ -2085,8 +2161,7 @@ int CFileItemList::GetFileCount() const
   int nFileCount = 0;
   for (int i = 0; i < (int)m_items.size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
-    if (!pItem->m_bIsFolder)
+    if (!IsFolder(i))
       nFileCount++;
   }
 
@@ -2099,7 +2174,11 @@ int CFileItemList::GetSelectedCount() const
   int count = 0;
   for (int i = 0; i < (int)m_items.size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    // items that haven't been materialized can't have been selected
+    if (!IsMaterialized(i))
+      continue;
+
+    CFileItemPtr pItem = At(i);
     if (pItem->IsSelected())
       count++;
   }
@@ -2110,6 +2189,7 @@ int CFileItemList::GetSelectedCount() const
 void CFileItemList::FilterCueItems()
 {
   CSingleLock lock(m_lock);
+  Materialize();
   // Handle .CUE sheet files...
   VECSONGS itemstoadd;
   CStdStringArray itemstodelete;
@@ -2253,6 +2333,7 @@ void CFileItemList::FilterCueItems()
 void CFileItemList::RemoveExtensions()
 {
   CSingleLock lock(m_lock);
+  Materialize();
   for (int i = 0; i < Size(); ++i)
     m_items[i]->RemoveExtension();
 }
@@ -2269,6 +2350,7 @@ void CFileItemList::Stack(bool stackFiles /* = true */)
 
   // items needs to be sorted for stuff below to work properly
   Sort(SortByLabel, SortOrderAscending);
+  Materialize();
 
   StackFolders();
 
@@ -2569,6 +2651,11 @@ bool CFileItemList::Save(int windowID)
   if (iSize <= 0)
     return false;
 
+  // lazy lists are only used for listings that are quick to get again, but
+  // archiving them would materialize every single item
+  if (IsLazy())
+    return false;
+
   CLog::Log(LOGDEBUG,"Saving fileitems [%s]", CURL::GetRedacted(GetPath()).c_str());
 
   CFile file;
@@ -3046,7 +3133,11 @@ bool CFileItem::LoadMusicTag()
 void CFileItemList::Swap(unsigned int item1, unsigned int item2)
 {
   if (item1 != item2 && item1 < m_items.size() && item2 < m_items.size())
+  {
     std::swap(m_items[item1], m_items[item2]);
+    if (!m_rows.empty())
+      std::swap(m_rows[item1], m_rows[item2]);
+  }
 }
 
 bool CFileItemList::UpdateItem(const CFileItem *item)
@@ -3056,7 +3147,13 @@ bool CFileItemList::UpdateItem(const CFileItem *item)
   CSingleLock lock(m_lock);
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
-    CFileItemPtr pItem = m_items[i];
+    // compare the path column of rows that haven't been materialized
+    // before building their item
+    if (!IsMaterialized(i) && m_lazyItems->GetColumns().HasColumn(FieldPath) &&
+        !item->GetPath().Equals(m_lazyItems->GetColumns().GetString(FieldPath, m_rows[i]).c_str()))
+      continue;
+
+    CFileItemPtr pItem = At(i);
     if (pItem->IsSamePath(item))
     {
       pItem->UpdateInfo(*item);
@@ -3095,6 +3192,121 @@ void CFileItemList::SetReplaceListing(bool replace)
   m_replaceListing = replace;
 }
 
+const VECFILEITEMS CFileItemList::GetList() const
+{
+  CSingleLock lock(m_lock);
+  if (m_rows.empty())
+    return m_items;
+
+  VECFILEITEMS items;
+  items.reserve(m_items.size());
+  for (unsigned int i = 0; i < m_items.size(); i++)
+    items.push_back(At(i));
+
+  return items;
+}
+
+void CFileItemList::AddRows(const FileItemColumnsPtr &columns)
+{
+  CSingleLock lock(m_lock);
+  if (!columns || columns->Size() == 0)
+    return;
+
+  // a list only holds the rows of a single set of columns
+  if (m_lazyItems || m_fastLookup)
+  {
+    CLazyFileItems items(columns);
+    for (unsigned int row = 0; row < columns->Size(); row++)
+      Add(items.Get(row));
+    return;
+  }
+
+  m_lazyItems.reset(new CLazyFileItems(columns));
+  m_rows.resize(m_items.size(), -1);
+  m_items.resize(m_items.size() + columns->Size());
+  for (unsigned int row = 0; row < columns->Size(); row++)
+    m_rows.push_back(row);
+}
+
+bool CFileItemList::IsLazy() const
+{
+  CSingleLock lock(m_lock);
+  return m_lazyItems != NULL;
+}
+
+bool CFileItemList::IsMaterialized(int iItem) const
+{
+  CSingleLock lock(m_lock);
+  if (iItem < 0 || iItem >= (int)m_items.size())
+    return false;
+
+  if (m_rows.empty() || m_rows[iItem] < 0)
+    return true;
+
+  return m_lazyItems->GetIfMaterialized(m_rows[iItem]) != NULL;
+}
+
+void CFileItemList::Materialize()
+{
+  CSingleLock lock(m_lock);
+  if (!m_lazyItems)
+    return;
+
+  for (unsigned int i = 0; i < m_items.size(); i++)
+  {
+    if (m_rows[i] >= 0)
+      m_items[i] = m_lazyItems->Get(m_rows[i]);
+  }
+
+  m_rows.clear();
+  m_lazyItems.reset();
+}
+
+bool CFileItemList::IsFolder(int iItem) const
+{
+  CSingleLock lock(m_lock);
+  if (iItem < 0 || iItem >= (int)m_items.size())
+    return false;
+
+  if (!IsMaterialized(iItem) && m_lazyItems->GetColumns().HasColumn(FieldFolder))
+    return m_lazyItems->GetColumns().GetBoolean(FieldFolder, m_rows[iItem]);
+
+  return At(iItem)->m_bIsFolder;
+}
+
+std::wstring CFileItemList::GetSortLabel(int iItem) const
+{
+  CSingleLock lock(m_lock);
+  if (iItem < 0 || iItem >= (int)m_items.size())
+    return L"";
+
+  if (!IsMaterialized(iItem))
+    return m_lazyItems->GetSortLabel(m_rows[iItem]);
+
+  return At(iItem)->GetSortLabel();
+}
+
+void CFileItemList::PrepareItems(const std::string &name, const FileItemPreparerPtr &preparer)
+{
+  CSingleLock lock(m_lock);
+  if (m_lazyItems)
+    m_lazyItems->AddPreparer(name, preparer);
+
+  for (unsigned int i = 0; i < m_items.size(); i++)
+  {
+    if (IsMaterialized(i))
+      preparer->Prepare(At(i));
+  }
+}
+
+CFileItemPtr CFileItemList::At(int iItem) const
+{
+  if (!m_rows.empty() && m_rows[iItem] >= 0)
+    return m_lazyItems->Get(m_rows[iItem]);
+
+  return m_items[iItem];
+}
+
 void CFileItemList::ClearSortState()
 {
   m_sortDescription.sortBy = SortByNone;
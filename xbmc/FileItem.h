@@ -32,6 +32,7 @@
 #include "utils/SortUtils.h"
 #include "utils/LabelFormatter.h"
 #include "GUIPassword.h"
+#include "FileItemColumns.h"
 #include "threads/CriticalSection.h"
 
 #include <vector>
@@ -550,7 +551,7 @@ public:
   void Remove(int iItem);
   CFileItemPtr Get(int iItem);
   const CFileItemPtr Get(int iItem) const;
-  const VECFILEITEMS GetList() const { return m_items; }
+  const VECFILEITEMS GetList() const;
   CFileItemPtr Get(const CStdString& strPath);
   const CFileItemPtr Get(const CStdString& strPath) const;
   int Size() const;
@@ -654,7 +655,35 @@ public:
   const CStdString &GetContent() const { return m_content; };
 
   void ClearSortState();
+
+  /*! \brief Append the rows of the given columns as lazily materialized items
+
+   The CFileItem of a row is only built once it is accessed (e.g. through Get()
+   or by a container rendering it), all lists the rows are appended to share
+   the same materialized item. Sorting works on the columns directly, other
+   operations that need every item materialize the whole list first.
+   \param columns rows to append
+   */
+  void AddRows(const FileItemColumnsPtr &columns);
+  bool IsLazy() const;
+  bool IsMaterialized(int iItem) const;
+  /*! \brief materialize every item of a lazy list and turn it into a regular list
+   */
+  void Materialize();
+  bool IsFolder(int iItem) const;
+  std::wstring GetSortLabel(int iItem) const;
+
+  /*! \brief Run a preparer on every item of the list
+
+   For lazy lists the preparer is run on the items that have already been
+   materialized and on the remaining ones once they are, replacing any preparer
+   of the same name that has been set before.
+   \param name name of the preparer
+   \param preparer preparer to run on the items
+   */
+  void PrepareItems(const std::string &name, const FileItemPreparerPtr &preparer);
 private:
+  CFileItemPtr At(int iItem) const;
   void Sort(FILEITEMLISTCOMPARISONFUNC func);
   void FillSortFields(FILEITEMFILLFUNC func);
   CStdString GetDiscFileCache(int windowID) const;
@@ -672,6 +701,8 @@ private:
   void StackFolders();
 
   VECFILEITEMS m_items;
+  LazyFileItemsPtr m_lazyItems;
+  std::vector<int> m_rows; ///< row of each lazy item in m_lazyItems, -1 for regular items (empty if not lazy)
   MAPFILEITEMS m_map;
   bool m_fastLookup;
   SortDescription m_sortDescription;
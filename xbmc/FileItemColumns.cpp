@@ -0,0 +1,363 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItemColumns.h"
+#include "FileItem.h"
+#include "threads/SingleLock.h"
+
+using namespace std;
+
+CFileItemColumns::CFileItemColumns(IFileItemFactory *factory)
+  : m_factory(factory),
+    m_rows(0)
+{ }
+
+CFileItemColumns::~CFileItemColumns()
+{
+  delete m_factory;
+}
+
+void CFileItemColumns::AddColumn(int key, ColumnType type)
+{
+  if (HasColumn(key))
+    return;
+
+  Column column;
+  column.type = type;
+  column.constant = false;
+  // rows added before the column get empty values
+  if (type == ColumnInteger)
+    column.integers.resize(m_rows, 0);
+  else if (type == ColumnDouble)
+    column.doubles.resize(m_rows, 0.0);
+  else
+    column.ends.resize(m_rows, 0);
+
+  m_keys.push_back(make_pair(key, m_columns.size()));
+  m_columns.push_back(column);
+}
+
+void CFileItemColumns::AddAlias(int key, int existingKey)
+{
+  for (vector<pair<int, size_t> >::const_iterator it = m_keys.begin(); it != m_keys.end(); ++it)
+  {
+    if (it->first == existingKey)
+    {
+      m_keys.push_back(make_pair(key, it->second));
+      return;
+    }
+  }
+}
+
+void CFileItemColumns::AddConstant(int key, const CVariant &value)
+{
+  if (HasColumn(key))
+    return;
+
+  Column column;
+  column.type = value.isString() ? ColumnString : (value.isDouble() ? ColumnDouble : ColumnInteger);
+  column.constant = true;
+  column.value = value;
+
+  m_keys.push_back(make_pair(key, m_columns.size()));
+  m_columns.push_back(column);
+}
+
+bool CFileItemColumns::HasColumn(int key) const
+{
+  return GetColumn(key) != NULL;
+}
+
+unsigned int CFileItemColumns::AddRow()
+{
+  for (vector<Column>::iterator column = m_columns.begin(); column != m_columns.end(); ++column)
+  {
+    if (column->constant)
+      continue;
+
+    if (column->type == ColumnInteger)
+      column->integers.push_back(0);
+    else if (column->type == ColumnDouble)
+      column->doubles.push_back(0.0);
+    else
+      column->ends.push_back((uint32_t)column->pool.size());
+  }
+
+  return m_rows++;
+}
+
+void CFileItemColumns::SetInteger(int key, int64_t value)
+{
+  Column *column = GetColumn(key);
+  if (column == NULL || column->constant || m_rows == 0)
+    return;
+
+  if (column->type == ColumnInteger)
+    column->integers.back() = value;
+  else if (column->type == ColumnDouble)
+    column->doubles.back() = (double)value;
+}
+
+void CFileItemColumns::SetDouble(int key, double value)
+{
+  Column *column = GetColumn(key);
+  if (column == NULL || column->constant || m_rows == 0)
+    return;
+
+  if (column->type == ColumnDouble)
+    column->doubles.back() = value;
+  else if (column->type == ColumnInteger)
+    column->integers.back() = (int64_t)value;
+}
+
+void CFileItemColumns::SetString(int key, const string &value)
+{
+  Column *column = GetColumn(key);
+  if (column == NULL || column->constant || m_rows == 0 || column->type != ColumnString)
+    return;
+
+  // drop a value set before for the same row
+  uint32_t start = m_rows > 1 ? column->ends[m_rows - 2] : 0;
+  column->pool.erase(start);
+  column->pool.append(value);
+  column->ends.back() = (uint32_t)column->pool.size();
+}
+
+int64_t CFileItemColumns::GetInteger(int key, unsigned int row) const
+{
+  const Column *column = GetColumn(key);
+  if (column == NULL || row >= m_rows)
+    return 0;
+
+  if (column->constant)
+    return column->value.asInteger();
+  if (column->type == ColumnInteger)
+    return column->integers[row];
+  if (column->type == ColumnDouble)
+    return (int64_t)column->doubles[row];
+  return 0;
+}
+
+double CFileItemColumns::GetDouble(int key, unsigned int row) const
+{
+  const Column *column = GetColumn(key);
+  if (column == NULL || row >= m_rows)
+    return 0.0;
+
+  if (column->constant)
+    return column->value.asDouble();
+  if (column->type == ColumnDouble)
+    return column->doubles[row];
+  if (column->type == ColumnInteger)
+    return (double)column->integers[row];
+  return 0.0;
+}
+
+string CFileItemColumns::GetString(int key, unsigned int row) const
+{
+  const Column *column = GetColumn(key);
+  if (column == NULL || row >= m_rows)
+    return "";
+
+  if (column->constant)
+    return column->value.asString();
+  if (column->type != ColumnString)
+    return "";
+
+  uint32_t start = row > 0 ? column->ends[row - 1] : 0;
+  return column->pool.substr(start, column->ends[row] - start);
+}
+
+bool CFileItemColumns::ToSortable(unsigned int row, const Fields &fields, SortItem &sortable) const
+{
+  for (Fields::const_iterator field = fields.begin(); field != fields.end(); ++field)
+  {
+    if (!ToSortable(row, *field, sortable))
+      return false;
+  }
+
+  // same as CFileItem::ToSortable(), these are needed by all sorters
+  return ToSortable(row, FieldLabel, sortable) &&
+         ToSortable(row, FieldSortSpecial, sortable) &&
+         ToSortable(row, FieldFolder, sortable);
+}
+
+CFileItemPtr CFileItemColumns::CreateItem(unsigned int row) const
+{
+  if (m_factory == NULL || row >= m_rows)
+    return CFileItemPtr();
+
+  return m_factory->CreateItem(*this, row);
+}
+
+size_t CFileItemColumns::GetMemoryUsage() const
+{
+  size_t usage = sizeof(*this) + m_keys.capacity() * sizeof(pair<int, size_t>);
+  for (vector<Column>::const_iterator column = m_columns.begin(); column != m_columns.end(); ++column)
+  {
+    usage += sizeof(Column);
+    usage += column->integers.capacity() * sizeof(int64_t);
+    usage += column->doubles.capacity() * sizeof(double);
+    usage += column->ends.capacity() * sizeof(uint32_t);
+    usage += column->pool.capacity();
+  }
+
+  return usage;
+}
+
+const CFileItemColumns::Column *CFileItemColumns::GetColumn(int key) const
+{
+  for (vector<pair<int, size_t> >::const_iterator it = m_keys.begin(); it != m_keys.end(); ++it)
+  {
+    if (it->first == key)
+      return &m_columns[it->second];
+  }
+
+  return NULL;
+}
+
+CFileItemColumns::Column *CFileItemColumns::GetColumn(int key)
+{
+  return const_cast<Column*>(static_cast<const CFileItemColumns*>(this)->GetColumn(key));
+}
+
+bool CFileItemColumns::ToSortable(unsigned int row, Field field, SortItem &sortable) const
+{
+  const Column *column = GetColumn(field);
+  if (column == NULL)
+    return false;
+
+  if (field == FieldFolder)
+    sortable[field] = GetBoolean(field, row);
+  else if (column->constant)
+    sortable[field] = column->value;
+  else if (column->type == ColumnInteger)
+    sortable[field] = column->integers[row];
+  else if (column->type == ColumnDouble)
+    sortable[field] = column->doubles[row];
+  else
+    sortable[field] = GetString(field, row);
+
+  return true;
+}
+
+CLazyFileItems::CLazyFileItems(const FileItemColumnsPtr &columns)
+  : m_columns(columns),
+    m_items(columns->Size()),
+    m_materialized(0)
+{ }
+
+CLazyFileItems::CLazyFileItems(const CLazyFileItems &items)
+  : m_columns(items.m_columns),
+    m_items(items.m_columns->Size()),
+    m_materialized(0)
+{
+  CSingleLock lock(items.m_section);
+  m_sortLabels = items.m_sortLabels;
+  m_preparers = items.m_preparers;
+}
+
+CFileItemPtr CLazyFileItems::Get(unsigned int row)
+{
+  CSingleLock lock(m_section);
+  if (row >= m_items.size())
+    return CFileItemPtr();
+
+  if (m_items[row] == NULL)
+  {
+    CFileItemPtr item = m_columns->CreateItem(row);
+    if (item == NULL)
+      return item;
+
+    if (row < m_sortLabels.size())
+    {
+      item->SetSortLabel(CStdStringW(m_sortLabels[row]));
+      m_sortLabels[row].clear();
+    }
+
+    m_items[row] = item;
+    m_materialized++;
+
+    for (vector<pair<string, FileItemPreparerPtr> >::const_iterator it = m_preparers.begin(); it != m_preparers.end(); ++it)
+      it->second->Prepare(item);
+  }
+
+  return m_items[row];
+}
+
+CFileItemPtr CLazyFileItems::GetIfMaterialized(unsigned int row) const
+{
+  CSingleLock lock(m_section);
+  if (row >= m_items.size())
+    return CFileItemPtr();
+
+  return m_items[row];
+}
+
+unsigned int CLazyFileItems::GetMaterializedCount() const
+{
+  CSingleLock lock(m_section);
+  return m_materialized;
+}
+
+void CLazyFileItems::AddPreparer(const string &name, const FileItemPreparerPtr &preparer)
+{
+  CSingleLock lock(m_section);
+  for (vector<pair<string, FileItemPreparerPtr> >::iterator it = m_preparers.begin(); it != m_preparers.end(); ++it)
+  {
+    if (it->first == name)
+    {
+      it->second = preparer;
+      return;
+    }
+  }
+
+  m_preparers.push_back(make_pair(name, preparer));
+}
+
+void CLazyFileItems::SetSortLabel(unsigned int row, const wstring &label)
+{
+  CSingleLock lock(m_section);
+  if (row >= m_items.size())
+    return;
+
+  if (m_items[row] != NULL)
+  {
+    m_items[row]->SetSortLabel(CStdStringW(label));
+    return;
+  }
+
+  if (m_sortLabels.size() < m_items.size())
+    m_sortLabels.resize(m_items.size());
+  m_sortLabels[row] = label;
+}
+
+wstring CLazyFileItems::GetSortLabel(unsigned int row) const
+{
+  CSingleLock lock(m_section);
+  if (row >= m_items.size())
+    return L"";
+
+  if (m_items[row] != NULL)
+    return m_items[row]->GetSortLabel();
+  if (row < m_sortLabels.size())
+    return m_sortLabels[row];
+  return L"";
+}
@@ -0,0 +1,189 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include "boost/shared_ptr.hpp"
+
+#include "threads/CriticalSection.h"
+#include "utils/SortUtils.h"
+#include "utils/Variant.h"
+
+class CFileItem; typedef boost::shared_ptr<CFileItem> CFileItemPtr;
+class CFileItemColumns;
+
+/*!
+ \brief Builds the CFileItem of a single row of a CFileItemColumns
+ */
+class IFileItemFactory
+{
+public:
+  virtual ~IFileItemFactory() { }
+  virtual CFileItemPtr CreateItem(const CFileItemColumns &columns, unsigned int row) const = 0;
+};
+
+/*!
+ \brief Work done on every item of a list, including the items of a lazy list
+ that are only materialized later on (e.g. label formatting)
+ \sa CFileItemList::PrepareItems
+ */
+class IFileItemPreparer
+{
+public:
+  virtual ~IFileItemPreparer() { }
+  virtual void Prepare(const CFileItemPtr &item) = 0;
+};
+typedef boost::shared_ptr<IFileItemPreparer> FileItemPreparerPtr;
+
+/*!
+ \brief Compact, column oriented storage of the rows of a huge item listing
+
+ Every column is keyed by a Field (or a private key >= FieldMax only known to
+ the factory) and holds one value per row: integers and doubles in plain
+ arrays, strings back to back in a single pool. Fields that have the same
+ value for every row (like FieldFolder) are stored once as a constant.
+
+ The columns are filled row by row through AddRow() and the setters and are
+ read-only afterwards, so they can be shared between threads and lists.
+ */
+class CFileItemColumns
+{
+public:
+  enum ColumnType
+  {
+    ColumnInteger = 0,
+    ColumnDouble,
+    ColumnString
+  };
+
+  /*!
+   \param factory Builds the items out of the rows, owned by the columns
+   */
+  CFileItemColumns(IFileItemFactory *factory);
+  ~CFileItemColumns();
+
+  void AddColumn(int key, ColumnType type);
+  /*!
+   \brief Makes key return the values of the column of an existing key
+   */
+  void AddAlias(int key, int existingKey);
+  void AddConstant(int key, const CVariant &value);
+  bool HasColumn(int key) const;
+
+  /*!
+   \brief Appends a row with empty values, the setters write to the last row
+   \return Index of the new row
+   */
+  unsigned int AddRow();
+  void SetInteger(int key, int64_t value);
+  void SetDouble(int key, double value);
+  void SetString(int key, const std::string &value);
+
+  unsigned int Size() const { return m_rows; }
+
+  int64_t GetInteger(int key, unsigned int row) const;
+  double GetDouble(int key, unsigned int row) const;
+  std::string GetString(int key, unsigned int row) const;
+  bool GetBoolean(int key, unsigned int row) const { return GetInteger(key, row) != 0; }
+
+  /*!
+   \brief Fills the given fields of a row (plus the ones every sorter needs)
+   \return False if any of the fields has no column, the item has to be materialized then
+   */
+  bool ToSortable(unsigned int row, const Fields &fields, SortItem &sortable) const;
+
+  CFileItemPtr CreateItem(unsigned int row) const;
+
+  size_t GetMemoryUsage() const;
+
+private:
+  CFileItemColumns(const CFileItemColumns&);
+  CFileItemColumns& operator=(const CFileItemColumns&);
+
+  struct Column
+  {
+    ColumnType type;
+    bool constant;
+    CVariant value;
+    std::vector<int64_t> integers;
+    std::vector<double> doubles;
+    std::vector<uint32_t> ends; ///< end of each row's string in the pool
+    std::string pool;
+  };
+
+  const Column *GetColumn(int key) const;
+  Column *GetColumn(int key);
+  bool ToSortable(unsigned int row, Field field, SortItem &sortable) const;
+
+  IFileItemFactory *m_factory;
+  std::vector<std::pair<int, size_t> > m_keys;
+  std::vector<Column> m_columns;
+  unsigned int m_rows;
+};
+typedef boost::shared_ptr<const CFileItemColumns> FileItemColumnsPtr;
+
+/*!
+ \brief The items materialized out of a CFileItemColumns
+
+ Every row is materialized at most once, so all lists sharing the rows see
+ the same CFileItem object, just like lists sharing CFileItemPtrs. Preparers
+ are run on every item as it gets materialized and the sort label of rows
+ that haven't been materialized yet is kept until they are.
+ */
+class CLazyFileItems
+{
+public:
+  CLazyFileItems(const FileItemColumnsPtr &columns);
+  /*!
+   \brief Creates a copy that shares the columns but materializes its own items
+   */
+  CLazyFileItems(const CLazyFileItems &items);
+
+  const CFileItemColumns &GetColumns() const { return *m_columns; }
+
+  CFileItemPtr Get(unsigned int row);
+  /*!
+   \return The item of the row or NULL if it hasn't been materialized yet
+   */
+  CFileItemPtr GetIfMaterialized(unsigned int row) const;
+  unsigned int GetMaterializedCount() const;
+
+  /*!
+   \brief Runs the preparer on every item materialized from now on, replacing any preparer with the same name
+   */
+  void AddPreparer(const std::string &name, const FileItemPreparerPtr &preparer);
+
+  void SetSortLabel(unsigned int row, const std::wstring &label);
+  std::wstring GetSortLabel(unsigned int row) const;
+
+private:
+  CLazyFileItems& operator=(const CLazyFileItems&);
+
+  FileItemColumnsPtr m_columns;
+  std::vector<CFileItemPtr> m_items;
+  unsigned int m_materialized;
+  std::vector<std::wstring> m_sortLabels;
+  std::vector<std::pair<std::string, FileItemPreparerPtr> > m_preparers;
+  CCriticalSection m_section;
+};
+typedef boost::shared_ptr<CLazyFileItems> LazyFileItemsPtr;
@@ -95,6 +95,8 @@ static CLinuxResourceCounter m_resourceCounter;
 #endif
 
 #define SYSHEATUPDATEINTERVAL 60000
+// all info bools are refreshed this often, in case a change of their sources went unnoticed
+#define BOOL_REFRESH_INTERVAL 1000
 
 using namespace std;
 using namespace XFILE;
@@ -125,6 +127,9 @@ CGUIInfoManager::CGUIInfoManager(void) :
   m_playerShowInfo = false;
   m_fps = 0.0f;
   m_AVInfoValid = false;
+  m_changedSources = 0;
+  m_lastFullRefresh = 0;
+  m_boolEvaluations = 0;
   ResetLibraryBools();
 }
 
@@ -151,6 +156,16 @@ bool CGUIInfoManager::OnMessage(CGUIMessage &message)
   return false;
 }
 
+void CGUIInfoManager::OnSettingsLoaded()
+{
+  InvalidateBools(SOURCE_SETTINGS);
+}
+
+void CGUIInfoManager::OnSettingValueChanged(const CSetting *setting)
+{
+  InvalidateBools(SOURCE_SETTINGS);
+}
+
 /// \brief Translates a string as given by the skin into an int that we use for more
 /// efficient retrieval of data. Can handle combined strings on the form
 /// Player.Caching + VideoPlayer.IsFullscreen (Logical and)
@@ -5229,6 +5244,83 @@ void CGUIInfoManager::ResetCache()
     (*i)->SetDirty();
 }
 
+void CGUIInfoManager::NextFrame()
+{
+  // reset any animation triggers as well
+  m_containerMoves.clear();
+
+  unsigned int sources = SOURCE_VOLATILE;
+  {
+    CSingleLock lock(m_critSources);
+    sources |= m_changedSources;
+    m_changedSources = 0;
+  }
+  unsigned int now = CTimeUtils::GetFrameTime();
+  if (now - m_lastFullRefresh >= BOOL_REFRESH_INTERVAL)
+  {
+    sources = ~0U;
+    m_lastFullRefresh = now;
+  }
+
+  // only mark those infobools dirty that depend on state that has changed
+  CSingleLock lock(m_critInfo);
+  for (vector<InfoPtr>::iterator i = m_bools.begin(); i != m_bools.end(); ++i)
+  {
+    if ((*i)->GetSources() & sources)
+      (*i)->SetDirty();
+  }
+  m_boolEvaluations = InfoBool::TakeEvaluations();
+}
+
+void CGUIInfoManager::InvalidateBools(unsigned int sources)
+{
+  // a separate lock, as this may be called while holding locks that are taken
+  // in turn while evaluating the bools under m_critInfo
+  CSingleLock lock(m_critSources);
+  m_changedSources |= sources;
+}
+
+unsigned int CGUIInfoManager::GetBoolSources(int condition1) const
+{
+  int condition = abs(condition1);
+  if (condition >= MULTI_INFO_START && condition <= MULTI_INFO_END)
+  {
+    unsigned int index = condition - MULTI_INFO_START;
+    if (index >= m_multiInfo.size())
+      return SOURCE_VOLATILE;
+
+    switch (abs(m_multiInfo[index].m_info))
+    {
+      case SKIN_BOOL:
+      case SKIN_STRING:
+      case SKIN_HAS_THEME:
+      case SYSTEM_GET_BOOL:
+        return SOURCE_SETTINGS;
+      case WINDOW_NEXT:
+      case WINDOW_PREVIOUS:
+      case WINDOW_IS_TOPMOST:
+        return SOURCE_WINDOW;
+      default:
+        // Window.IsActive and Window.IsVisible also depend on closing animations
+        return SOURCE_VOLATILE;
+    }
+  }
+
+  // playback state changes like pausing aren't reported by all players, only
+  // whether something is playing at all is tracked
+  if (condition == PLAYER_HAS_MEDIA || condition == PLAYER_HAS_AUDIO || condition == PLAYER_HAS_VIDEO)
+    return SOURCE_PLAYER;
+  if (condition >= LIBRARY_HAS_MUSIC && condition <= LIBRARY_HAS_MUSICVIDEOS)
+    return SOURCE_LIBRARY;
+  if (condition == WINDOW_IS_MEDIA)
+    return SOURCE_WINDOW;
+  if (condition == SYSTEM_ALWAYS_TRUE || condition == SYSTEM_ALWAYS_FALSE ||
+     (condition >= SYSTEM_PLATFORM_LINUX && condition <= SYSTEM_PLATFORM_LINUX_RASPBERRY_PI))
+    return SOURCE_NONE;
+
+  return SOURCE_VOLATILE;
+}
+
 // Called from tuxbox service thread to update current status
 void CGUIInfoManager::UpdateFromTuxBox()
 {
@@ -5426,6 +5518,7 @@ void CGUIInfoManager::SetLibraryBool(int condition, bool value)
     default:
       break;
   }
+  InvalidateBools(SOURCE_LIBRARY);
 }
 
 void CGUIInfoManager::ResetLibraryBools()
@@ -5435,6 +5528,7 @@ void CGUIInfoManager::ResetLibraryBools()
   m_libraryHasTVShows = -1;
   m_libraryHasMusicVideos = -1;
   m_libraryHasMovieSets = -1;
+  InvalidateBools(SOURCE_LIBRARY);
 }
 
 bool CGUIInfoManager::GetLibraryBool(int condition)
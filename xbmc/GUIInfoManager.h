@@ -35,6 +35,7 @@
 #include "interfaces/info/InfoBool.h"
 #include "interfaces/info/SkinVariable.h"
 #include "cores/IPlayer.h"
+#include "settings/lib/ISettingsHandler.h"
 
 #include <list>
 #include <map>
@@ -708,7 +709,7 @@ private:
  \ingroup strings
  \brief
  */
-class CGUIInfoManager : public IMsgTargetCallback, public Observable
+class CGUIInfoManager : public IMsgTargetCallback, public Observable, public ISettingsHandler
 {
 public:
   CGUIInfoManager(void);
@@ -717,6 +718,9 @@ public:
   void Clear();
   virtual bool OnMessage(CGUIMessage &message);
 
+  virtual void OnSettingsLoaded();
+  virtual void OnSettingValueChanged(const CSetting *setting);
+
   /*! \brief Register a boolean condition/expression
    This routine allows controls or other clients of the info manager to register
    to receive updates of particular expressions, in a particular context (currently windows).
@@ -807,10 +811,29 @@ public:
   void UpdateAVInfo();
   inline float GetFPS() const { return m_fps; };
 
-  void SetNextWindow(int windowID) { m_nextWindowID = windowID; };
-  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; };
+  void SetNextWindow(int windowID) { m_nextWindowID = windowID; InvalidateBools(INFO::SOURCE_WINDOW); };
+  void SetPreviousWindow(int windowID) { m_prevWindowID = windowID; InvalidateBools(INFO::SOURCE_WINDOW); };
 
+  /*! \brief Mark all info bools dirty, to be re-evaluated on their next use
+   */
   void ResetCache();
+  /*! \brief Start a new frame, marking dirty those info bools whose sources changed
+   \sa InvalidateBools
+   */
+  void NextFrame();
+  /*! \brief Notify the info manager that state info bools may depend on has changed
+   May be called from any thread. The affected bools are re-evaluated in the next frame.
+   \param sources the INFO::InfoSource flags of the state that changed
+   */
+  void InvalidateBools(unsigned int sources);
+  /*! \brief Get the sources the value of a condition depends on
+   \param condition the condition as returned from TranslateSingleString
+   \return the INFO::InfoSource flags, SOURCE_VOLATILE if they are unknown
+   */
+  unsigned int GetBoolSources(int condition) const;
+  /*! \brief Number of info bools evaluated in the last frame
+   */
+  unsigned int GetBoolEvaluations() const { return m_boolEvaluations; };
   bool GetItemInt(int &value, const CGUIListItem *item, int info) const;
   CStdString GetItemLabel(const CFileItem *item, int info, CStdString *fallback = NULL);
   CStdString GetItemImage(const CFileItem *item, int info, CStdString *fallback = NULL);
@@ -940,6 +963,9 @@ protected:
   int m_prevWindowID;
 
   std::vector<INFO::InfoPtr> m_bools;
+  unsigned int m_changedSources;      // sources invalidated since the last frame
+  unsigned int m_lastFullRefresh;     // frame time all bools were last marked dirty
+  unsigned int m_boolEvaluations;     // bools evaluated in the last frame
   std::vector<INFO::CSkinVariableString> m_skinVariableStrings;
 
   int m_libraryHasMusic;
@@ -952,6 +978,7 @@ protected:
   SPlayerAudioStreamInfo m_audioInfo;
 
   CCriticalSection m_critInfo;
+  CCriticalSection m_critSources;
 };
 
 /*!
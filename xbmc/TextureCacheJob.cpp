@@ -102,7 +102,11 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
     return true;
   }
 #endif
-  CBaseTexture *texture = LoadImage(image, width, height, additional_info, true);
+  // there's no point in decoding the image any larger than it is cached,
+  // jpegs can be downscaled while they are decoded
+  unsigned int load_width = width, load_height = height;
+  CPicture::GetMaxCacheSize(load_width, load_height);
+  CBaseTexture *texture = LoadImage(image, load_width, load_height, additional_info, true);
   if (texture)
   {
     if (texture->HasAlpha())
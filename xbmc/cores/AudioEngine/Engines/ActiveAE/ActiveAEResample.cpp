@@ -19,6 +19,7 @@
  */
 
 #include "ActiveAEResample.h"
+#include "cores/AudioEngine/Utils/AEKernels.h"
 #include "utils/log.h"
 
 extern "C" {
@@ -29,10 +30,49 @@ extern "C" {
 
 using namespace ActiveAE;
 
+// frames converted per pass when a packed/planar change needs scratch space
+#define CONVERT_CHUNK_FRAMES 256
+
+namespace
+{
+/* moves left aligned S32 samples to the bits the sink expects */
+void AlignSamples(int32_t *buf, int count, int shift)
+{
+  if (shift <= 0)
+    return;
+  for (int i = 0; i < count; i++)
+    buf[i] = buf[i] >> shift;
+}
+
+/* converts count samples from one packed format to another, one of them is
+ * float. S32 output is shifted right by shift bits afterwards. */
+void ConvertSamples(const uint8_t *src, AVSampleFormat srcFmt, uint8_t *dst, AVSampleFormat dstFmt, int shift, int count)
+{
+  const AEKernels &kernels = CAEKernels::Get();
+  if (srcFmt == AV_SAMPLE_FMT_FLT)
+  {
+    if (dstFmt == AV_SAMPLE_FMT_FLT)
+      memcpy(dst, src, count * sizeof(float));
+    else if (dstFmt == AV_SAMPLE_FMT_S16)
+      kernels.FloatToS16((const float*)src, (int16_t*)dst, count);
+    else
+    {
+      kernels.FloatToS32((const float*)src, (int32_t*)dst, count);
+      AlignSamples((int32_t*)dst, count, shift);
+    }
+  }
+  else if (srcFmt == AV_SAMPLE_FMT_S16)
+    kernels.S16ToFloat((const int16_t*)src, (float*)dst, count);
+  else
+    kernels.S32ToFloat((const int32_t*)src, (float*)dst, count);
+}
+}
+
 CActiveAEResample::CActiveAEResample()
 {
   m_pContext = NULL;
   m_loaded = true;
+  m_directConvert = false;
 }
 
 CActiveAEResample::~CActiveAEResample()
@@ -64,6 +104,17 @@ bool CActiveAEResample::Init(uint64_t dst_chan_layout, int dst_channels, int dst
   if (m_src_chan_layout == 0)
     m_src_chan_layout = av_get_default_channel_layout(m_src_channels);
 
+  // when only the sample format or the packing changes we convert with the
+  // AE kernels and leave swr for actual resampling and rematrixing
+  m_directConvert = m_src_rate == m_dst_rate &&
+                    m_src_channels == m_dst_channels &&
+                    m_src_chan_layout == m_dst_chan_layout &&
+                    m_src_channels <= AE_CH_MAX &&
+                    IsDirectFormat(m_src_fmt, m_src_bits) &&
+                    IsDirectFormat(m_dst_fmt, m_dst_bits) &&
+                    (av_get_packed_sample_fmt(m_src_fmt) == AV_SAMPLE_FMT_FLT ||
+                     av_get_packed_sample_fmt(m_dst_fmt) == AV_SAMPLE_FMT_FLT);
+
   m_pContext = swr_alloc_set_opts(NULL, m_dst_chan_layout, m_dst_fmt, m_dst_rate,
                                                         m_src_chan_layout, m_src_fmt, m_src_rate,
                                                         0, NULL);
@@ -112,6 +163,8 @@ bool CActiveAEResample::Init(uint64_t dst_chan_layout, int dst_channels, int dst
     // the channel is mapped by setting coef 1.0
     memset(m_rematrix, 0, sizeof(m_rematrix));
     m_dst_chan_layout = 0;
+    if ((int)remapLayout->Count() != m_src_channels)
+      m_directConvert = false;
     for (unsigned int out=0; out<remapLayout->Count(); out++)
     {
       m_dst_chan_layout += (uint64_t) (1 << out);
@@ -120,6 +173,8 @@ bool CActiveAEResample::Init(uint64_t dst_chan_layout, int dst_channels, int dst
       {
         m_rematrix[out][idx] = 1.0;
       }
+      if (idx != (int)out)
+        m_directConvert = false;
     }
 
     av_opt_set_int(m_pContext, "out_channel_count", m_dst_channels, 0);
@@ -175,11 +230,26 @@ bool CActiveAEResample::Init(uint64_t dst_chan_layout, int dst_channels, int dst
     CLog::Log(LOGERROR, "CActiveAEResample::Init - init resampler failed");
     return false;
   }
+
+  if (m_directConvert)
+    m_convertBuffer.resize(CONVERT_CHUNK_FRAMES * m_src_channels);
+
   return true;
 }
 
 int CActiveAEResample::Resample(uint8_t **dst_buffer, int dst_samples, uint8_t **src_buffer, int src_samples, double ratio)
 {
+  // swr holds no samples unless it had to resample, in that case it keeps
+  // going until its delay drained
+  if (m_directConvert && ratio == 1.0 && src_samples <= dst_samples &&
+      swr_get_delay(m_pContext, m_src_rate) == 0)
+  {
+    if (!src_buffer)
+      return 0;
+    Convert(dst_buffer, src_buffer, src_samples);
+    return src_samples;
+  }
+
   if (ratio != 1.0)
   {
     if (swr_set_compensation(m_pContext,
@@ -207,23 +277,123 @@ int CActiveAEResample::Resample(uint8_t **dst_buffer, int dst_samples, uint8_t *
   // data 8 bits to the right in order to get the correct alignment of 0 dither bits
   // if we want to use ALSA as output. For WASAPI nothing had to be done.
   // SNE24NEMSB 1 1 1 0 >> 8 = 0 1 1 1 = SNE24NE
+  // Convert() produces the same layout, so both paths agree
   if (m_dst_fmt == AV_SAMPLE_FMT_S32 || m_dst_fmt == AV_SAMPLE_FMT_S32P)
   {
-    if (m_dst_bits != 32 && (m_dst_dither_bits + m_dst_bits) != 32)
+    int shift = GetAlignShift();
+    if (shift > 0)
     {
       int planes = av_sample_fmt_is_planar(m_dst_fmt) ? m_dst_channels : 1;
       int samples = ret * m_dst_channels / planes;
       for (int i=0; i<planes; i++)
+        AlignSamples((int32_t*)dst_buffer[i], samples, shift);
+    }
+  }
+  return ret;
+}
+
+int CActiveAEResample::GetAlignShift() const
+{
+  if (m_dst_bits == 32 || (m_dst_dither_bits + m_dst_bits) == 32)
+    return 0;
+  return 32 - m_dst_bits - m_dst_dither_bits;
+}
+
+bool CActiveAEResample::IsDirectFormat(AVSampleFormat fmt, int bits)
+{
+  switch (av_get_packed_sample_fmt(fmt))
+  {
+  case AV_SAMPLE_FMT_FLT:
+  case AV_SAMPLE_FMT_S16:
+    return true;
+  case AV_SAMPLE_FMT_S32:
+    return bits == 32 || bits == 24;
+  default:
+    return false;
+  }
+}
+
+void CActiveAEResample::Convert(uint8_t **dst_buffer, uint8_t **src_buffer, int samples)
+{
+  const AEKernels &kernels = CAEKernels::Get();
+  AVSampleFormat srcFmt = av_get_packed_sample_fmt(m_src_fmt);
+  AVSampleFormat dstFmt = av_get_packed_sample_fmt(m_dst_fmt);
+  bool srcPlanar = av_sample_fmt_is_planar(m_src_fmt) != 0;
+  bool dstPlanar = av_sample_fmt_is_planar(m_dst_fmt) != 0;
+  int srcBytes = av_get_bytes_per_sample(m_src_fmt);
+  int dstBytes = av_get_bytes_per_sample(m_dst_fmt);
+  int channels = m_dst_channels;
+
+  // same as the shift after swr_convert: 24 bit with no dither bits is right aligned
+  int shift = GetAlignShift();
+
+  if (srcPlanar == dstPlanar)
+  {
+    int planes = srcPlanar ? channels : 1;
+    int count = srcPlanar ? samples : samples * channels;
+    for (int i = 0; i < planes; i++)
+      ConvertSamples(src_buffer[i], srcFmt, dst_buffer[i], dstFmt, shift, count);
+    return;
+  }
+
+  float *tmp = &m_convertBuffer[0];
+  float *planes[AE_CH_MAX];
+
+  for (int f = 0; f < samples; f += CONVERT_CHUNK_FRAMES)
+  {
+    int frames = std::min(CONVERT_CHUNK_FRAMES, samples - f);
+
+    if (srcPlanar)
+    {
+      // planar in, packed out: get float planes, interleave, convert
+      for (int c = 0; c < channels; c++)
       {
-        uint32_t* buf = (uint32_t*)dst_buffer[i];
-        for (int j=0; j<samples; j++)
+        if (srcFmt == AV_SAMPLE_FMT_FLT)
+          planes[c] = (float*)src_buffer[c] + f;
+        else
         {
-          *buf = *buf >> m_dst_dither_bits;
+          planes[c] = tmp + c * frames;
+          ConvertSamples(src_buffer[c] + f * srcBytes, srcFmt, (uint8_t*)planes[c], AV_SAMPLE_FMT_FLT, 0, frames);
         }
       }
+
+      uint8_t *dst = dst_buffer[0] + f * channels * dstBytes;
+      if (dstFmt == AV_SAMPLE_FMT_FLT)
+        kernels.Interleave(planes, (float*)dst, channels, frames);
+      else
+      {
+        kernels.Interleave(planes, tmp, channels, frames);
+        ConvertSamples((uint8_t*)tmp, AV_SAMPLE_FMT_FLT, dst, dstFmt, shift, frames * channels);
+      }
+    }
+    else
+    {
+      // packed in, planar out: convert to float, deinterleave, convert
+      const uint8_t *src = src_buffer[0] + f * channels * srcBytes;
+      const float *packed = (const float*)src;
+      if (srcFmt != AV_SAMPLE_FMT_FLT)
+      {
+        ConvertSamples(src, srcFmt, (uint8_t*)tmp, AV_SAMPLE_FMT_FLT, 0, frames * channels);
+        packed = tmp;
+      }
+
+      if (dstFmt == AV_SAMPLE_FMT_FLT)
+      {
+        for (int c = 0; c < channels; c++)
+          planes[c] = (float*)dst_buffer[c] + f;
+        kernels.Deinterleave(packed, planes, channels, frames);
+      }
+      else
+      {
+        // src is float here, so tmp is free for the deinterleaved planes
+        for (int c = 0; c < channels; c++)
+          planes[c] = tmp + c * frames;
+        kernels.Deinterleave(packed, planes, channels, frames);
+        for (int c = 0; c < channels; c++)
+          ConvertSamples((uint8_t*)planes[c], AV_SAMPLE_FMT_FLT, dst_buffer[c] + f * dstBytes, dstFmt, shift, frames);
+      }
     }
   }
-  return ret;
 }
 
 int64_t CActiveAEResample::GetDelay(int64_t base)
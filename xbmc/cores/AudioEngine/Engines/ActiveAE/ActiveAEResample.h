@@ -23,6 +23,7 @@
 #include "cores/AudioEngine/Utils/AEAudioFormat.h"
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAEBuffer.h"
 #include "cores/AudioEngine/Interfaces/AE.h"
+#include <vector>
 
 extern "C" {
 #include "libavutil/avutil.h"
@@ -51,6 +52,10 @@ public:
   int GetAVChannelIndex(enum AEChannel aechannel, uint64_t layout);
 
 protected:
+  static bool IsDirectFormat(AVSampleFormat fmt, int bits);
+  void Convert(uint8_t **dst_buffer, uint8_t **src_buffer, int samples);
+  int GetAlignShift() const;
+
   bool m_loaded;
   uint64_t m_src_chan_layout, m_dst_chan_layout;
   int m_src_rate, m_dst_rate;
@@ -60,6 +65,8 @@ protected:
   int m_src_dither_bits, m_dst_dither_bits;
   SwrContext *m_pContext;
   double m_rematrix[AE_CH_MAX][AE_CH_MAX];
+  bool m_directConvert;
+  std::vector<float> m_convertBuffer;
 };
 
 }
@@ -0,0 +1,645 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AEKernels.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+#include <math.h>
+
+#ifdef TARGET_WINDOWS
+#if _M_IX86_FP>1 && !defined(__SSE2__)
+#define __SSE2__
+#endif
+#if defined(_M_X64) && !defined(__SSE2__)
+#define __SSE2__
+#endif
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+/* implemented in AEKernelsAVX2.cpp, overrides the entries of kernels that
+ * have an AVX2 version. Returns false if built without AVX2 support. */
+extern bool AEKernelsAVX2(AEKernels &kernels);
+
+namespace
+{
+
+#define AE_S16_SCALE 32768.0f
+#define AE_S24_SCALE 8388608.0f
+#define AE_S32_SCALE 2147483648.0f
+/* largest float below 2^31, anything above overflows the conversion */
+#define AE_S32_MAX   2147483520.0f
+
+inline int32_t ClampRound(float x, const float min, const float max)
+{
+  /* written so that NaN ends up at min, like the SIMD versions */
+  x = x > min ? x : min;
+  x = x < max ? x : max;
+  return (int32_t)lrintf(x);
+}
+
+inline float SoftClamp(const float x)
+{
+  /*
+     This is a rational function to approximate a tanh-like soft clipper.
+     It is based on the pade-approximation of the tanh function with tweaked coefficients.
+     See: http://www.musicdsp.org/showone.php?id=238
+  */
+  if (x < -3.0f)
+    return -1.0f;
+  else if (x >  3.0f)
+    return 1.0f;
+  float y = x * x;
+  return x * (27.0f + y) / (27.0f + 9.0f * y);
+}
+
+/* reference implementations, also used for the tails of the SIMD versions */
+
+void FloatToS16_C(const float *src, int16_t *dst, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    dst[i] = (int16_t)ClampRound(src[i] * AE_S16_SCALE, -AE_S16_SCALE, AE_S16_SCALE - 1.0f);
+}
+
+void FloatToS24_C(const float *src, int32_t *dst, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    dst[i] = ClampRound(src[i] * AE_S24_SCALE, -AE_S24_SCALE, AE_S24_SCALE - 1.0f);
+}
+
+void FloatToS32_C(const float *src, int32_t *dst, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    dst[i] = ClampRound(src[i] * AE_S32_SCALE, -AE_S32_SCALE, AE_S32_MAX);
+}
+
+void S16ToFloat_C(const int16_t *src, float *dst, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    dst[i] = (float)src[i] * (1.0f / AE_S16_SCALE);
+}
+
+void S24ToFloat_C(const int32_t *src, float *dst, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    dst[i] = (float)((int32_t)((uint32_t)src[i] << 8) >> 8) * (1.0f / AE_S24_SCALE);
+}
+
+void S32ToFloat_C(const int32_t *src, float *dst, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    dst[i] = (float)src[i] * (1.0f / AE_S32_SCALE);
+}
+
+void Interleave_C(const float * const *src, float *dst, uint32_t channels, uint32_t frames)
+{
+  for (uint32_t f = 0; f < frames; ++f)
+    for (uint32_t c = 0; c < channels; ++c)
+      *dst++ = src[c][f];
+}
+
+void Deinterleave_C(const float *src, float * const *dst, uint32_t channels, uint32_t frames)
+{
+  for (uint32_t f = 0; f < frames; ++f)
+    for (uint32_t c = 0; c < channels; ++c)
+      dst[c][f] = *src++;
+}
+
+/* interleave/deinterleave frames [first, frames) */
+void InterleaveTail(const float * const *src, float *dst, uint32_t channels, uint32_t first, uint32_t frames)
+{
+  dst += first * channels;
+  for (uint32_t f = first; f < frames; ++f)
+    for (uint32_t c = 0; c < channels; ++c)
+      *dst++ = src[c][f];
+}
+
+void DeinterleaveTail(const float *src, float * const *dst, uint32_t channels, uint32_t first, uint32_t frames)
+{
+  src += first * channels;
+  for (uint32_t f = first; f < frames; ++f)
+    for (uint32_t c = 0; c < channels; ++c)
+      dst[c][f] = *src++;
+}
+
+void MulArray_C(float *data, const float mul, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    data[i] *= mul;
+}
+
+bool MulAddArray_C(float *data, const float *add, const float mul, uint32_t count)
+{
+  bool clip = false;
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    data[i] += add[i] * mul;
+    if (fabsf(data[i]) > 1.0f)
+      clip = true;
+  }
+  return clip;
+}
+
+void ClampArray_C(float *data, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    data[i] = SoftClamp(data[i]);
+}
+
+#ifdef __SSE2__
+inline __m128i ClampRound_SSE2(__m128 x, const __m128 min, const __m128 max)
+{
+  return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(x, min), max));
+}
+
+void FloatToS16_SSE2(const float *src, int16_t *dst, uint32_t count)
+{
+  const __m128 scale = _mm_set1_ps(AE_S16_SCALE);
+  const __m128 min   = _mm_set1_ps(-AE_S16_SCALE);
+  const __m128 max   = _mm_set1_ps(AE_S16_SCALE - 1.0f);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i lo = ClampRound_SSE2(_mm_mul_ps(_mm_loadu_ps(src + i    ), scale), min, max);
+    __m128i hi = ClampRound_SSE2(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), min, max);
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+  }
+  FloatToS16_C(src + i, dst + i, count - i);
+}
+
+void FloatToS24_SSE2(const float *src, int32_t *dst, uint32_t count)
+{
+  const __m128 scale = _mm_set1_ps(AE_S24_SCALE);
+  const __m128 min   = _mm_set1_ps(-AE_S24_SCALE);
+  const __m128 max   = _mm_set1_ps(AE_S24_SCALE - 1.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_si128((__m128i*)(dst + i), ClampRound_SSE2(_mm_mul_ps(_mm_loadu_ps(src + i), scale), min, max));
+  FloatToS24_C(src + i, dst + i, count - i);
+}
+
+void FloatToS32_SSE2(const float *src, int32_t *dst, uint32_t count)
+{
+  const __m128 scale = _mm_set1_ps(AE_S32_SCALE);
+  const __m128 min   = _mm_set1_ps(-AE_S32_SCALE);
+  const __m128 max   = _mm_set1_ps(AE_S32_MAX);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_si128((__m128i*)(dst + i), ClampRound_SSE2(_mm_mul_ps(_mm_loadu_ps(src + i), scale), min, max));
+  FloatToS32_C(src + i, dst + i, count - i);
+}
+
+void S16ToFloat_SSE2(const int16_t *src, float *dst, uint32_t count)
+{
+  const __m128 scale = _mm_set1_ps(1.0f / AE_S16_SCALE);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+    _mm_storeu_ps(dst + i    , _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+  }
+  S16ToFloat_C(src + i, dst + i, count - i);
+}
+
+void S24ToFloat_SSE2(const int32_t *src, float *dst, uint32_t count)
+{
+  const __m128 scale = _mm_set1_ps(1.0f / AE_S24_SCALE);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i in = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128((const __m128i*)(src + i)), 8), 8);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(in), scale));
+  }
+  S24ToFloat_C(src + i, dst + i, count - i);
+}
+
+void S32ToFloat_SSE2(const int32_t *src, float *dst, uint32_t count)
+{
+  const __m128 scale = _mm_set1_ps(1.0f / AE_S32_SCALE);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(src + i))), scale));
+  S32ToFloat_C(src + i, dst + i, count - i);
+}
+
+void Interleave_SSE2(const float * const *src, float *dst, uint32_t channels, uint32_t frames)
+{
+  uint32_t f = 0;
+  if (channels == 2)
+  {
+    for (; f + 4 <= frames; f += 4, dst += 8)
+    {
+      __m128 l = _mm_loadu_ps(src[0] + f);
+      __m128 r = _mm_loadu_ps(src[1] + f);
+      _mm_storeu_ps(dst    , _mm_unpacklo_ps(l, r));
+      _mm_storeu_ps(dst + 4, _mm_unpackhi_ps(l, r));
+    }
+  }
+  else if (channels == 4 || channels == 8)
+  {
+    for (; f + 4 <= frames; f += 4, dst += 4 * channels)
+    {
+      for (uint32_t c = 0; c < channels; c += 4)
+      {
+        __m128 r0 = _mm_loadu_ps(src[c    ] + f);
+        __m128 r1 = _mm_loadu_ps(src[c + 1] + f);
+        __m128 r2 = _mm_loadu_ps(src[c + 2] + f);
+        __m128 r3 = _mm_loadu_ps(src[c + 3] + f);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(dst + c                , r0);
+        _mm_storeu_ps(dst + c +     channels, r1);
+        _mm_storeu_ps(dst + c + 2 * channels, r2);
+        _mm_storeu_ps(dst + c + 3 * channels, r3);
+      }
+    }
+  }
+  else
+  {
+    Interleave_C(src, dst, channels, frames);
+    return;
+  }
+  InterleaveTail(src, dst - f * channels, channels, f, frames);
+}
+
+void Deinterleave_SSE2(const float *src, float * const *dst, uint32_t channels, uint32_t frames)
+{
+  uint32_t f = 0;
+  if (channels == 2)
+  {
+    for (; f + 4 <= frames; f += 4, src += 8)
+    {
+      __m128 a = _mm_loadu_ps(src    );
+      __m128 b = _mm_loadu_ps(src + 4);
+      _mm_storeu_ps(dst[0] + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(dst[1] + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+  }
+  else if (channels == 4 || channels == 8)
+  {
+    for (; f + 4 <= frames; f += 4, src += 4 * channels)
+    {
+      for (uint32_t c = 0; c < channels; c += 4)
+      {
+        __m128 r0 = _mm_loadu_ps(src + c               );
+        __m128 r1 = _mm_loadu_ps(src + c +     channels);
+        __m128 r2 = _mm_loadu_ps(src + c + 2 * channels);
+        __m128 r3 = _mm_loadu_ps(src + c + 3 * channels);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(dst[c    ] + f, r0);
+        _mm_storeu_ps(dst[c + 1] + f, r1);
+        _mm_storeu_ps(dst[c + 2] + f, r2);
+        _mm_storeu_ps(dst[c + 3] + f, r3);
+      }
+    }
+  }
+  else
+  {
+    Deinterleave_C(src, dst, channels, frames);
+    return;
+  }
+  DeinterleaveTail(src - f * channels, dst, channels, f, frames);
+}
+
+void MulArray_SSE2(float *data, const float mul, uint32_t count)
+{
+  const __m128 m = _mm_set1_ps(mul);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), m));
+  MulArray_C(data + i, mul, count - i);
+}
+
+bool MulAddArray_SSE2(float *data, const float *add, const float mul, uint32_t count)
+{
+  const __m128 m    = _mm_set1_ps(mul);
+  const __m128 one  = _mm_set1_ps(1.0f);
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  __m128 clip = _mm_setzero_ps();
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 r = _mm_add_ps(_mm_loadu_ps(data + i), _mm_mul_ps(_mm_loadu_ps(add + i), m));
+    clip = _mm_or_ps(clip, _mm_cmpgt_ps(_mm_andnot_ps(sign, r), one));
+    _mm_storeu_ps(data + i, r);
+  }
+  bool tail = MulAddArray_C(data + i, add + i, mul, count - i);
+  return _mm_movemask_ps(clip) != 0 || tail;
+}
+
+void ClampArray_SSE2(float *data, uint32_t count)
+{
+  const __m128 min = _mm_set1_ps(-3.0f);
+  const __m128 max = _mm_set1_ps(3.0f);
+  const __m128 c1  = _mm_set1_ps(27.0f);
+  const __m128 c9  = _mm_set1_ps(9.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    /* tanh approx clamp, exactly +-1 at +-3 */
+    __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), min), max);
+    __m128 y = _mm_mul_ps(x, x);
+    _mm_storeu_ps(data + i, _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(c1, y)),
+                                       _mm_add_ps(c1, _mm_mul_ps(c9, y))));
+  }
+  ClampArray_C(data + i, count - i);
+}
+#endif
+
+#if defined(__ARM_NEON__)
+/* round to nearest, ties away from zero */
+inline int32x4_t ClampRound_NEON(float32x4_t x, const float32x4_t min, const float32x4_t max)
+{
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  x = vminq_f32(vmaxq_f32(x, min), max);
+  uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x80000000));
+  x = vaddq_f32(x, vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(half), sign)));
+  return vcvtq_s32_f32(x);
+}
+
+void FloatToS16_NEON(const float *src, int16_t *dst, uint32_t count)
+{
+  const float32x4_t scale = vdupq_n_f32(AE_S16_SCALE);
+  const float32x4_t min   = vdupq_n_f32(-AE_S16_SCALE);
+  const float32x4_t max   = vdupq_n_f32(AE_S16_SCALE - 1.0f);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    int32x4_t lo = ClampRound_NEON(vmulq_f32(vld1q_f32(src + i    ), scale), min, max);
+    int32x4_t hi = ClampRound_NEON(vmulq_f32(vld1q_f32(src + i + 4), scale), min, max);
+    vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+  }
+  FloatToS16_C(src + i, dst + i, count - i);
+}
+
+void FloatToS24_NEON(const float *src, int32_t *dst, uint32_t count)
+{
+  const float32x4_t scale = vdupq_n_f32(AE_S24_SCALE);
+  const float32x4_t min   = vdupq_n_f32(-AE_S24_SCALE);
+  const float32x4_t max   = vdupq_n_f32(AE_S24_SCALE - 1.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_s32(dst + i, ClampRound_NEON(vmulq_f32(vld1q_f32(src + i), scale), min, max));
+  FloatToS24_C(src + i, dst + i, count - i);
+}
+
+void FloatToS32_NEON(const float *src, int32_t *dst, uint32_t count)
+{
+  const float32x4_t scale = vdupq_n_f32(AE_S32_SCALE);
+  const float32x4_t min   = vdupq_n_f32(-AE_S32_SCALE);
+  const float32x4_t max   = vdupq_n_f32(AE_S32_MAX);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_s32(dst + i, ClampRound_NEON(vmulq_f32(vld1q_f32(src + i), scale), min, max));
+  FloatToS32_C(src + i, dst + i, count - i);
+}
+
+void S16ToFloat_NEON(const int16_t *src, float *dst, uint32_t count)
+{
+  const float32x4_t scale = vdupq_n_f32(1.0f / AE_S16_SCALE);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    int16x8_t in = vld1q_s16(src + i);
+    vst1q_f32(dst + i    , vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16 (in))), scale));
+    vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(in))), scale));
+  }
+  S16ToFloat_C(src + i, dst + i, count - i);
+}
+
+void S24ToFloat_NEON(const int32_t *src, float *dst, uint32_t count)
+{
+  const float32x4_t scale = vdupq_n_f32(1.0f / AE_S24_SCALE);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    int32x4_t in = vshrq_n_s32(vshlq_n_s32(vld1q_s32(src + i), 8), 8);
+    vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(in), scale));
+  }
+  S24ToFloat_C(src + i, dst + i, count - i);
+}
+
+void S32ToFloat_NEON(const int32_t *src, float *dst, uint32_t count)
+{
+  const float32x4_t scale = vdupq_n_f32(1.0f / AE_S32_SCALE);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vld1q_s32(src + i)), scale));
+  S32ToFloat_C(src + i, dst + i, count - i);
+}
+
+void Interleave_NEON(const float * const *src, float *dst, uint32_t channels, uint32_t frames)
+{
+  if (channels != 2)
+  {
+    Interleave_C(src, dst, channels, frames);
+    return;
+  }
+
+  uint32_t f = 0;
+  for (; f + 4 <= frames; f += 4, dst += 8)
+  {
+    float32x4x2_t lr;
+    lr.val[0] = vld1q_f32(src[0] + f);
+    lr.val[1] = vld1q_f32(src[1] + f);
+    vst2q_f32(dst, lr);
+  }
+  InterleaveTail(src, dst - f * channels, channels, f, frames);
+}
+
+void Deinterleave_NEON(const float *src, float * const *dst, uint32_t channels, uint32_t frames)
+{
+  if (channels != 2)
+  {
+    Deinterleave_C(src, dst, channels, frames);
+    return;
+  }
+
+  uint32_t f = 0;
+  for (; f + 4 <= frames; f += 4, src += 8)
+  {
+    float32x4x2_t lr = vld2q_f32(src);
+    vst1q_f32(dst[0] + f, lr.val[0]);
+    vst1q_f32(dst[1] + f, lr.val[1]);
+  }
+  DeinterleaveTail(src - f * channels, dst, channels, f, frames);
+}
+
+void MulArray_NEON(float *data, const float mul, uint32_t count)
+{
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(data + i, vmulq_n_f32(vld1q_f32(data + i), mul));
+  MulArray_C(data + i, mul, count - i);
+}
+
+bool MulAddArray_NEON(float *data, const float *add, const float mul, uint32_t count)
+{
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  uint32x4_t clip = vdupq_n_u32(0);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t r = vmlaq_n_f32(vld1q_f32(data + i), vld1q_f32(add + i), mul);
+    clip = vorrq_u32(clip, vcagtq_f32(r, one));
+    vst1q_f32(data + i, r);
+  }
+  uint32x2_t c = vorr_u32(vget_low_u32(clip), vget_high_u32(clip));
+  bool tail = MulAddArray_C(data + i, add + i, mul, count - i);
+  return (vget_lane_u32(c, 0) | vget_lane_u32(c, 1)) != 0 || tail;
+}
+
+void ClampArray_NEON(float *data, uint32_t count)
+{
+  const float32x4_t min = vdupq_n_f32(-3.0f);
+  const float32x4_t max = vdupq_n_f32(3.0f);
+  const float32x4_t c1  = vdupq_n_f32(27.0f);
+  uint32_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t x = vminq_f32(vmaxq_f32(vld1q_f32(data + i), min), max);
+    float32x4_t y = vmulq_f32(x, x);
+    float32x4_t n = vmulq_f32(x, vaddq_f32(c1, y));
+    float32x4_t d = vmlaq_n_f32(c1, y, 9.0f);
+    /* reciprocal estimate refined by two newton-raphson steps */
+    float32x4_t r = vrecpeq_f32(d);
+    r = vmulq_f32(vrecpsq_f32(d, r), r);
+    r = vmulq_f32(vrecpsq_f32(d, r), r);
+    vst1q_f32(data + i, vmulq_f32(n, r));
+  }
+  ClampArray_C(data + i, count - i);
+}
+#endif
+
+class CKernelTables
+{
+public:
+  CKernelTables()
+  {
+    for (int i = 0; i < AE_KERNELS_MAX; ++i)
+      m_available[i] = false;
+
+    AEKernels &c = m_table[AE_KERNELS_C];
+    c.name         = "C";
+    c.FloatToS16   = FloatToS16_C;
+    c.FloatToS24   = FloatToS24_C;
+    c.FloatToS32   = FloatToS32_C;
+    c.S16ToFloat   = S16ToFloat_C;
+    c.S24ToFloat   = S24ToFloat_C;
+    c.S32ToFloat   = S32ToFloat_C;
+    c.Interleave   = Interleave_C;
+    c.Deinterleave = Deinterleave_C;
+    c.MulArray     = MulArray_C;
+    c.MulAddArray  = MulAddArray_C;
+    c.ClampArray   = ClampArray_C;
+    m_available[AE_KERNELS_C] = true;
+    m_best = AE_KERNELS_C;
+
+    unsigned int features = g_cpuInfo.GetCPUFeatures();
+
+#ifdef __SSE2__
+    if (features & CPU_FEATURE_SSE2)
+    {
+      AEKernels &sse2 = m_table[AE_KERNELS_SSE2];
+      sse2.name         = "SSE2";
+      sse2.FloatToS16   = FloatToS16_SSE2;
+      sse2.FloatToS24   = FloatToS24_SSE2;
+      sse2.FloatToS32   = FloatToS32_SSE2;
+      sse2.S16ToFloat   = S16ToFloat_SSE2;
+      sse2.S24ToFloat   = S24ToFloat_SSE2;
+      sse2.S32ToFloat   = S32ToFloat_SSE2;
+      sse2.Interleave   = Interleave_SSE2;
+      sse2.Deinterleave = Deinterleave_SSE2;
+      sse2.MulArray     = MulArray_SSE2;
+      sse2.MulAddArray  = MulAddArray_SSE2;
+      sse2.ClampArray   = ClampArray_SSE2;
+      m_available[AE_KERNELS_SSE2] = true;
+      m_best = AE_KERNELS_SSE2;
+
+      if (features & CPU_FEATURE_AVX2)
+      {
+        m_table[AE_KERNELS_AVX2] = sse2;
+        if (AEKernelsAVX2(m_table[AE_KERNELS_AVX2]))
+        {
+          m_available[AE_KERNELS_AVX2] = true;
+          m_best = AE_KERNELS_AVX2;
+        }
+      }
+    }
+#endif
+
+#if defined(__ARM_NEON__)
+    if (features & CPU_FEATURE_NEON)
+    {
+      AEKernels &neon = m_table[AE_KERNELS_NEON];
+      neon.name         = "NEON";
+      neon.FloatToS16   = FloatToS16_NEON;
+      neon.FloatToS24   = FloatToS24_NEON;
+      neon.FloatToS32   = FloatToS32_NEON;
+      neon.S16ToFloat   = S16ToFloat_NEON;
+      neon.S24ToFloat   = S24ToFloat_NEON;
+      neon.S32ToFloat   = S32ToFloat_NEON;
+      neon.Interleave   = Interleave_NEON;
+      neon.Deinterleave = Deinterleave_NEON;
+      neon.MulArray     = MulArray_NEON;
+      neon.MulAddArray  = MulAddArray_NEON;
+      neon.ClampArray   = ClampArray_NEON;
+      m_available[AE_KERNELS_NEON] = true;
+      m_best = AE_KERNELS_NEON;
+    }
+#endif
+
+    CLog::Log(LOGDEBUG, "CAEKernels - using %s kernels", m_table[m_best].name);
+  }
+
+  AEKernels   m_table[AE_KERNELS_MAX];
+  bool        m_available[AE_KERNELS_MAX];
+  AEKernelSet m_best;
+};
+
+const CKernelTables &Tables()
+{
+  static CKernelTables tables;
+  return tables;
+}
+
+}
+
+const AEKernels &CAEKernels::Get()
+{
+  static const AEKernels &kernels = Tables().m_table[Tables().m_best];
+  return kernels;
+}
+
+const AEKernels *CAEKernels::Get(AEKernelSet set)
+{
+  if (set < 0 || set >= AE_KERNELS_MAX || !Tables().m_available[set])
+    return NULL;
+  return &Tables().m_table[set];
+}
@@ -0,0 +1,71 @@
+#pragma once
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+
+enum AEKernelSet
+{
+  AE_KERNELS_C = 0,
+  AE_KERNELS_SSE2,
+  AE_KERNELS_AVX2,
+  AE_KERNELS_NEON,
+  AE_KERNELS_MAX
+};
+
+/*!
+ * \brief Table of sample conversion and mixing kernels.
+ *
+ * Float samples are full scale in the range [-1.0, 1.0], conversions to
+ * integer round to nearest and saturate. S24 is 24 bit in the low bits of
+ * a 32 bit word. No alignment is required for any of the buffers.
+ */
+struct AEKernels
+{
+  const char *name;
+
+  void (*FloatToS16)(const float *src, int16_t *dst, uint32_t count);
+  void (*FloatToS24)(const float *src, int32_t *dst, uint32_t count);
+  void (*FloatToS32)(const float *src, int32_t *dst, uint32_t count);
+  void (*S16ToFloat)(const int16_t *src, float *dst, uint32_t count);
+  void (*S24ToFloat)(const int32_t *src, float *dst, uint32_t count);
+  void (*S32ToFloat)(const int32_t *src, float *dst, uint32_t count);
+
+  /*! \brief planes of frames samples each to/from packed frames */
+  void (*Interleave)  (const float * const *src, float *dst, uint32_t channels, uint32_t frames);
+  void (*Deinterleave)(const float *src, float * const *dst, uint32_t channels, uint32_t frames);
+
+  /*! \brief data *= mul */
+  void (*MulArray)   (float *data, const float mul, uint32_t count);
+  /*! \brief data += add * mul, returns true if any result is outside [-1.0, 1.0] */
+  bool (*MulAddArray)(float *data, const float *add, const float mul, uint32_t count);
+  /*! \brief tanh like soft clipping into [-1.0, 1.0] */
+  void (*ClampArray) (float *data, uint32_t count);
+};
+
+class CAEKernels
+{
+public:
+  /*! \brief the fastest kernels supported by the cpu, selected from g_cpuInfo on first use */
+  static const AEKernels &Get();
+
+  /*! \brief kernels of a given instruction set, NULL if not built in or not supported by the cpu */
+  static const AEKernels *Get(AEKernelSet set);
+};
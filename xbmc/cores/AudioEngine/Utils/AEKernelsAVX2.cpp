@@ -0,0 +1,254 @@
+/*
+ *      Copyright (C) 2010-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * AVX2 versions of the ActiveAE kernels. This file is built with AVX2
+ * code generation enabled, nothing in here may run before CAEKernels made
+ * sure the cpu supports it.
+ */
+
+#include "AEKernels.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+#define AE_S16_SCALE 32768.0f
+#define AE_S24_SCALE 8388608.0f
+#define AE_S32_SCALE 2147483648.0f
+#define AE_S32_MAX   2147483520.0f
+
+namespace
+{
+
+/* the kernels this table was built from, used for tails and layouts that
+ * have no AVX2 version */
+AEKernels fallback;
+
+inline __m256i ClampRound_AVX2(__m256 x, const __m256 min, const __m256 max)
+{
+  return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(x, min), max));
+}
+
+void FloatToS16_AVX2(const float *src, int16_t *dst, uint32_t count)
+{
+  const __m256 scale = _mm256_set1_ps(AE_S16_SCALE);
+  const __m256 min   = _mm256_set1_ps(-AE_S16_SCALE);
+  const __m256 max   = _mm256_set1_ps(AE_S16_SCALE - 1.0f);
+  uint32_t i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256i lo = ClampRound_AVX2(_mm256_mul_ps(_mm256_loadu_ps(src + i    ), scale), min, max);
+    __m256i hi = ClampRound_AVX2(_mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale), min, max);
+    /* packs works per 128 bit lane, put the quadwords back in order */
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256((__m256i*)(dst + i), packed);
+  }
+  fallback.FloatToS16(src + i, dst + i, count - i);
+}
+
+void FloatToS24_AVX2(const float *src, int32_t *dst, uint32_t count)
+{
+  const __m256 scale = _mm256_set1_ps(AE_S24_SCALE);
+  const __m256 min   = _mm256_set1_ps(-AE_S24_SCALE);
+  const __m256 max   = _mm256_set1_ps(AE_S24_SCALE - 1.0f);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_si256((__m256i*)(dst + i), ClampRound_AVX2(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), min, max));
+  fallback.FloatToS24(src + i, dst + i, count - i);
+}
+
+void FloatToS32_AVX2(const float *src, int32_t *dst, uint32_t count)
+{
+  const __m256 scale = _mm256_set1_ps(AE_S32_SCALE);
+  const __m256 min   = _mm256_set1_ps(-AE_S32_SCALE);
+  const __m256 max   = _mm256_set1_ps(AE_S32_MAX);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_si256((__m256i*)(dst + i), ClampRound_AVX2(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), min, max));
+  fallback.FloatToS32(src + i, dst + i, count - i);
+}
+
+void S16ToFloat_AVX2(const int16_t *src, float *dst, uint32_t count)
+{
+  const __m256 scale = _mm256_set1_ps(1.0f / AE_S16_SCALE);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i in = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(in), scale));
+  }
+  fallback.S16ToFloat(src + i, dst + i, count - i);
+}
+
+void S24ToFloat_AVX2(const int32_t *src, float *dst, uint32_t count)
+{
+  const __m256 scale = _mm256_set1_ps(1.0f / AE_S24_SCALE);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i in = _mm256_srai_epi32(_mm256_slli_epi32(_mm256_loadu_si256((const __m256i*)(src + i)), 8), 8);
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(in), scale));
+  }
+  fallback.S24ToFloat(src + i, dst + i, count - i);
+}
+
+void S32ToFloat_AVX2(const int32_t *src, float *dst, uint32_t count)
+{
+  const __m256 scale = _mm256_set1_ps(1.0f / AE_S32_SCALE);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(src + i))), scale));
+  fallback.S32ToFloat(src + i, dst + i, count - i);
+}
+
+/* wider layouts use the 4x4 transposes of the SSE2 kernels, an 8x8 transpose
+ * in ymm registers measured slower on the store side */
+void Interleave_AVX2(const float * const *src, float *dst, uint32_t channels, uint32_t frames)
+{
+  uint32_t f = 0;
+  if (channels == 2)
+  {
+    for (; f + 8 <= frames; f += 8)
+    {
+      __m256 l  = _mm256_loadu_ps(src[0] + f);
+      __m256 r  = _mm256_loadu_ps(src[1] + f);
+      __m256 lo = _mm256_unpacklo_ps(l, r);
+      __m256 hi = _mm256_unpackhi_ps(l, r);
+      _mm256_storeu_ps(dst + 2 * f    , _mm256_permute2f128_ps(lo, hi, 0x20));
+      _mm256_storeu_ps(dst + 2 * f + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+  }
+  else
+  {
+    fallback.Interleave(src, dst, channels, frames);
+    return;
+  }
+
+  if (f < frames)
+  {
+    const float *tail[8];
+    for (uint32_t c = 0; c < channels; ++c)
+      tail[c] = src[c] + f;
+    fallback.Interleave(tail, dst + f * channels, channels, frames - f);
+  }
+}
+
+void Deinterleave_AVX2(const float *src, float * const *dst, uint32_t channels, uint32_t frames)
+{
+  uint32_t f = 0;
+  if (channels == 2)
+  {
+    for (; f + 8 <= frames; f += 8)
+    {
+      __m256 a  = _mm256_loadu_ps(src + 2 * f    );
+      __m256 b  = _mm256_loadu_ps(src + 2 * f + 8);
+      __m256 lo = _mm256_permute2f128_ps(a, b, 0x20);
+      __m256 hi = _mm256_permute2f128_ps(a, b, 0x31);
+      _mm256_storeu_ps(dst[0] + f, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm256_storeu_ps(dst[1] + f, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+  }
+  else
+  {
+    fallback.Deinterleave(src, dst, channels, frames);
+    return;
+  }
+
+  if (f < frames)
+  {
+    float *tail[8];
+    for (uint32_t c = 0; c < channels; ++c)
+      tail[c] = dst[c] + f;
+    fallback.Deinterleave(src + f * channels, tail, channels, frames - f);
+  }
+}
+
+void MulArray_AVX2(float *data, const float mul, uint32_t count)
+{
+  const __m256 m = _mm256_set1_ps(mul);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+    _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), m));
+  fallback.MulArray(data + i, mul, count - i);
+}
+
+bool MulAddArray_AVX2(float *data, const float *add, const float mul, uint32_t count)
+{
+  const __m256 m    = _mm256_set1_ps(mul);
+  const __m256 one  = _mm256_set1_ps(1.0f);
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  __m256 clip = _mm256_setzero_ps();
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 r = _mm256_add_ps(_mm256_loadu_ps(data + i), _mm256_mul_ps(_mm256_loadu_ps(add + i), m));
+    clip = _mm256_or_ps(clip, _mm256_cmp_ps(_mm256_andnot_ps(sign, r), one, _CMP_GT_OQ));
+    _mm256_storeu_ps(data + i, r);
+  }
+  bool tail = fallback.MulAddArray(data + i, add + i, mul, count - i);
+  return _mm256_movemask_ps(clip) != 0 || tail;
+}
+
+void ClampArray_AVX2(float *data, uint32_t count)
+{
+  const __m256 min = _mm256_set1_ps(-3.0f);
+  const __m256 max = _mm256_set1_ps(3.0f);
+  const __m256 c1  = _mm256_set1_ps(27.0f);
+  const __m256 c9  = _mm256_set1_ps(9.0f);
+  uint32_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(data + i), min), max);
+    __m256 y = _mm256_mul_ps(x, x);
+    _mm256_storeu_ps(data + i, _mm256_div_ps(_mm256_mul_ps(x, _mm256_add_ps(c1, y)),
+                                             _mm256_add_ps(c1, _mm256_mul_ps(c9, y))));
+  }
+  fallback.ClampArray(data + i, count - i);
+}
+
+}
+
+bool AEKernelsAVX2(AEKernels &kernels)
+{
+  fallback = kernels;
+
+  kernels.name         = "AVX2";
+  kernels.FloatToS16   = FloatToS16_AVX2;
+  kernels.FloatToS24   = FloatToS24_AVX2;
+  kernels.FloatToS32   = FloatToS32_AVX2;
+  kernels.S16ToFloat   = S16ToFloat_AVX2;
+  kernels.S24ToFloat   = S24ToFloat_AVX2;
+  kernels.S32ToFloat   = S32ToFloat_AVX2;
+  kernels.Interleave   = Interleave_AVX2;
+  kernels.Deinterleave = Deinterleave_AVX2;
+  kernels.MulArray     = MulArray_AVX2;
+  kernels.MulAddArray  = MulAddArray_AVX2;
+  kernels.ClampArray   = ClampArray_AVX2;
+  return true;
+}
+
+#else
+
+bool AEKernelsAVX2(AEKernels &kernels)
+{
+  return false;
+}
+
+#endif
@@ -0,0 +1,297 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AEKernels.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+std::vector<float> RandomSamples(unsigned int count, float range)
+{
+  std::vector<float> samples(count);
+  for (unsigned int i = 0; i < count; i++)
+    samples[i] = range * (2.0f * rand() / RAND_MAX - 1.0f);
+  return samples;
+}
+
+/* counts that exercise the vector loops and every tail length */
+const unsigned int counts[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 64, 1021 };
+const unsigned int channelCounts[] = { 1, 2, 3, 4, 6, 8 };
+
+std::vector<const AEKernels*> SimdKernels()
+{
+  std::vector<const AEKernels*> sets;
+  for (int i = AE_KERNELS_C + 1; i < AE_KERNELS_MAX; i++)
+  {
+    if (CAEKernels::Get((AEKernelSet)i))
+      sets.push_back(CAEKernels::Get((AEKernelSet)i));
+  }
+  return sets;
+}
+}
+
+TEST(TestAEKernels, Reference)
+{
+  const AEKernels *c = CAEKernels::Get(AE_KERNELS_C);
+  ASSERT_TRUE(c != NULL);
+
+  float in[] = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f };
+  int16_t s16[7];
+  c->FloatToS16(in, s16, 7);
+  EXPECT_EQ(0, s16[0]);
+  EXPECT_EQ(16384, s16[1]);
+  EXPECT_EQ(-16384, s16[2]);
+  EXPECT_EQ(32767, s16[3]);
+  EXPECT_EQ(-32768, s16[4]);
+  EXPECT_EQ(32767, s16[5]);
+  EXPECT_EQ(-32768, s16[6]);
+
+  int32_t s24[7];
+  c->FloatToS24(in, s24, 7);
+  EXPECT_EQ(4194304, s24[1]);
+  EXPECT_EQ(8388607, s24[5]);
+  EXPECT_EQ(-8388608, s24[6]);
+
+  float out[7];
+  s24[0] = 0x00800000; // -1.0 in 24 bit, garbage in the top byte is ignored
+  c->S24ToFloat(s24, out, 1);
+  EXPECT_FLOAT_EQ(-1.0f, out[0]);
+
+  float clamp[] = { 0.0f, 3.0f, -3.0f, 10.0f };
+  c->ClampArray(clamp, 4);
+  EXPECT_FLOAT_EQ(0.0f, clamp[0]);
+  EXPECT_FLOAT_EQ(1.0f, clamp[1]);
+  EXPECT_FLOAT_EQ(-1.0f, clamp[2]);
+  EXPECT_FLOAT_EQ(1.0f, clamp[3]);
+
+  float mix[]  = { 0.5f, 0.5f };
+  float add[]  = { 0.25f, 0.75f };
+  EXPECT_FALSE(c->MulAddArray(mix, add, 1.0f, 1));
+  EXPECT_TRUE(c->MulAddArray(mix + 1, add + 1, 1.0f, 1));
+}
+
+TEST(TestAEKernels, Conversions)
+{
+  const AEKernels *c = CAEKernels::Get(AE_KERNELS_C);
+  std::vector<const AEKernels*> sets = SimdKernels();
+
+  for (unsigned int s = 0; s < sets.size(); s++)
+  {
+    SCOPED_TRACE(sets[s]->name);
+    for (unsigned int n = 0; n < sizeof(counts) / sizeof(counts[0]); n++)
+    {
+      unsigned int count = counts[n];
+      std::vector<float> in = RandomSamples(count + 1, 1.5f);
+
+      std::vector<int16_t> s16a(count + 1), s16b(count + 1);
+      c->FloatToS16(&in[0], &s16a[0], count);
+      sets[s]->FloatToS16(&in[0], &s16b[0], count);
+      for (unsigned int i = 0; i < count; i++)
+        EXPECT_NEAR(s16a[i], s16b[i], 1);
+
+      std::vector<int32_t> s32a(count + 1), s32b(count + 1);
+      c->FloatToS24(&in[0], &s32a[0], count);
+      sets[s]->FloatToS24(&in[0], &s32b[0], count);
+      for (unsigned int i = 0; i < count; i++)
+        EXPECT_NEAR(s32a[i], s32b[i], 1);
+
+      c->FloatToS32(&in[0], &s32a[0], count);
+      sets[s]->FloatToS32(&in[0], &s32b[0], count);
+      for (unsigned int i = 0; i < count; i++)
+        EXPECT_NEAR((double)s32a[i], (double)s32b[i], 128.0);
+
+      std::vector<float> fa(count + 1), fb(count + 1);
+      c->S16ToFloat(&s16a[0], &fa[0], count);
+      sets[s]->S16ToFloat(&s16a[0], &fb[0], count);
+      for (unsigned int i = 0; i < count; i++)
+        EXPECT_FLOAT_EQ(fa[i], fb[i]);
+
+      c->FloatToS24(&in[0], &s32a[0], count);
+      c->S24ToFloat(&s32a[0], &fa[0], count);
+      sets[s]->S24ToFloat(&s32a[0], &fb[0], count);
+      for (unsigned int i = 0; i < count; i++)
+        EXPECT_FLOAT_EQ(fa[i], fb[i]);
+
+      c->S32ToFloat(&s32a[0], &fa[0], count);
+      sets[s]->S32ToFloat(&s32a[0], &fb[0], count);
+      for (unsigned int i = 0; i < count; i++)
+        EXPECT_FLOAT_EQ(fa[i], fb[i]);
+    }
+  }
+}
+
+TEST(TestAEKernels, Mixing)
+{
+  const AEKernels *c = CAEKernels::Get(AE_KERNELS_C);
+  std::vector<const AEKernels*> sets = SimdKernels();
+
+  for (unsigned int s = 0; s < sets.size(); s++)
+  {
+    SCOPED_TRACE(sets[s]->name);
+    for (unsigned int n = 0; n < sizeof(counts) / sizeof(counts[0]); n++)
+    {
+      unsigned int count = counts[n];
+      std::vector<float> in  = RandomSamples(count + 1, 0.5f);
+      std::vector<float> add = RandomSamples(count + 1, 0.5f);
+
+      std::vector<float> a(in), b(in);
+      c->MulArray(&a[0], 0.7f, count);
+      sets[s]->MulArray(&b[0], 0.7f, count);
+      for (unsigned int i = 0; i <= count; i++)
+        EXPECT_FLOAT_EQ(a[i], b[i]);
+
+      a = in; b = in;
+      bool clipA = c->MulAddArray(&a[0], &add[0], 0.9f, count);
+      bool clipB = sets[s]->MulAddArray(&b[0], &add[0], 0.9f, count);
+      EXPECT_EQ(clipA, clipB);
+      for (unsigned int i = 0; i <= count; i++)
+        EXPECT_FLOAT_EQ(a[i], b[i]);
+
+      // a single loud sample has to be reported wherever it is
+      if (count)
+      {
+        b = in;
+        add[count - 1] = 4.0f;
+        EXPECT_TRUE(sets[s]->MulAddArray(&b[0], &add[0], 1.0f, count));
+      }
+
+      a = RandomSamples(count + 1, 4.0f);
+      b = a;
+      c->ClampArray(&a[0], count);
+      sets[s]->ClampArray(&b[0], count);
+      for (unsigned int i = 0; i <= count; i++)
+        EXPECT_NEAR(a[i], b[i], 1e-6);
+    }
+  }
+}
+
+TEST(TestAEKernels, Interleave)
+{
+  std::vector<const AEKernels*> sets = SimdKernels();
+  sets.push_back(CAEKernels::Get(AE_KERNELS_C));
+
+  for (unsigned int s = 0; s < sets.size(); s++)
+  {
+    SCOPED_TRACE(sets[s]->name);
+    for (unsigned int ch = 0; ch < sizeof(channelCounts) / sizeof(channelCounts[0]); ch++)
+    {
+      unsigned int channels = channelCounts[ch];
+      for (unsigned int n = 0; n < sizeof(counts) / sizeof(counts[0]); n++)
+      {
+        unsigned int frames = counts[n];
+        std::vector<std::vector<float> > planes(channels);
+        std::vector<std::vector<float> > result(channels);
+        const float *src[8];
+        float *dst[8];
+        for (unsigned int c = 0; c < channels; c++)
+        {
+          planes[c] = RandomSamples(frames + 1, 1.0f);
+          result[c].resize(frames + 1, 9.0f);
+          src[c] = &planes[c][0];
+          dst[c] = &result[c][0];
+        }
+
+        std::vector<float> packed(frames * channels + 1, 9.0f);
+        sets[s]->Interleave(src, &packed[0], channels, frames);
+        for (unsigned int f = 0; f < frames; f++)
+          for (unsigned int c = 0; c < channels; c++)
+            ASSERT_EQ(planes[c][f], packed[f * channels + c]);
+        EXPECT_EQ(9.0f, packed[frames * channels]);
+
+        sets[s]->Deinterleave(&packed[0], dst, channels, frames);
+        for (unsigned int c = 0; c < channels; c++)
+        {
+          for (unsigned int f = 0; f < frames; f++)
+            ASSERT_EQ(planes[c][f], result[c][f]);
+          EXPECT_EQ(9.0f, result[c][frames]);
+        }
+      }
+    }
+  }
+}
+
+/* Throughput of every kernel and instruction set over one second of audio
+ * at 2 and 8 channels, 48 and 192 kHz. */
+TEST(TestAEKernelsBenchmark, SamplesPerSecond)
+{
+  static const unsigned int rates[] = { 48000, 192000 };
+  static const unsigned int layouts[] = { 2, 8 };
+  static const char *kernels[] = { "FloatToS16", "FloatToS32", "S16ToFloat", "Interleave",
+                                   "Deinterleave", "MulArray", "MulAddArray", "ClampArray" };
+  static const int passes = 10;
+
+  for (int set = 0; set < AE_KERNELS_MAX; set++)
+  {
+    const AEKernels *k = CAEKernels::Get((AEKernelSet)set);
+    if (!k)
+      continue;
+
+    for (unsigned int r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+      for (unsigned int l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++)
+      {
+        unsigned int channels = layouts[l];
+        unsigned int frames = rates[r];
+        unsigned int count = frames * channels;
+
+        std::vector<float> samples = RandomSamples(count, 1.0f);
+        std::vector<float> other = RandomSamples(count, 1.0f);
+        std::vector<float> planar(count);
+        std::vector<int16_t> s16(count);
+        std::vector<int32_t> s32(count);
+        const float *src[8];
+        float *dst[8];
+        for (unsigned int c = 0; c < channels; c++)
+        {
+          src[c] = &samples[c * frames];
+          dst[c] = &planar[c * frames];
+        }
+
+        for (unsigned int n = 0; n < sizeof(kernels) / sizeof(kernels[0]); n++)
+        {
+          int64_t start = CurrentHostCounter();
+          for (int p = 0; p < passes; p++)
+          {
+            switch (n)
+            {
+            case 0: k->FloatToS16(&samples[0], &s16[0], count); break;
+            case 1: k->FloatToS32(&samples[0], &s32[0], count); break;
+            case 2: k->S16ToFloat(&s16[0], &other[0], count); break;
+            case 3: k->Interleave(src, &other[0], channels, frames); break;
+            case 4: k->Deinterleave(&other[0], dst, channels, frames); break;
+            case 5: k->MulArray(&samples[0], 1.0f, count); break;
+            case 6: k->MulAddArray(&samples[0], &other[0], 0.0f, count); break;
+            case 7: k->ClampArray(&samples[0], count); break;
+            }
+          }
+          double seconds = (double)(CurrentHostCounter() - start) / (double)CurrentHostFrequency();
+
+          std::cout << k->name << " " << kernels[n] << " " << channels << "ch " << rates[r] / 1000 << "kHz"
+                    << " samples/sec: " << testing::PrintToString(passes * count / seconds) << std::endl;
+        }
+      }
+    }
+  }
+}
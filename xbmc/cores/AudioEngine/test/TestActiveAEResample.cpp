@@ -0,0 +1,99 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/AudioEngine/Engines/ActiveAE/ActiveAEResample.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <vector>
+
+using namespace ActiveAE;
+
+namespace
+{
+#define CHANNELS 2
+#define FRAMES   1000
+/* swr only takes the direct conversion when the input fits the output, more
+ * input than output space sends the same samples through swr_convert() */
+#define EXTRA    16
+
+/* converts the same float input once over the direct path and once through
+ * swr and expects the sink to get the same samples from both */
+void CompareToSwr(AVSampleFormat srcFmt, AVSampleFormat dstFmt, int dstBits, int dstDither)
+{
+  bool srcPlanar = av_sample_fmt_is_planar(srcFmt) != 0;
+  bool dstPlanar = av_sample_fmt_is_planar(dstFmt) != 0;
+
+  // below full scale, the clamps of the two conversions differ by a few steps
+  std::vector<float> samples((FRAMES + EXTRA) * CHANNELS);
+  for (unsigned int i = 0; i < samples.size(); i++)
+    samples[i] = 0.9f * (2.0f * rand() / RAND_MAX - 1.0f);
+
+  uint8_t *src[CHANNELS];
+  for (int c = 0; c < CHANNELS; c++)
+    src[c] = srcPlanar ? (uint8_t*)&samples[c * (FRAMES + EXTRA)] : (uint8_t*)&samples[0];
+
+  std::vector<int32_t> direct(FRAMES * CHANNELS), swr(FRAMES * CHANNELS);
+  uint8_t *directDst[CHANNELS], *swrDst[CHANNELS];
+  for (int c = 0; c < CHANNELS; c++)
+  {
+    directDst[c] = dstPlanar ? (uint8_t*)&direct[c * FRAMES] : (uint8_t*)&direct[0];
+    swrDst[c]    = dstPlanar ? (uint8_t*)&swr[c * FRAMES]    : (uint8_t*)&swr[0];
+  }
+
+  CActiveAEResample directResampler, swrResampler;
+  ASSERT_TRUE(directResampler.Init(0, CHANNELS, 48000, dstFmt, dstBits, dstDither,
+                                   0, CHANNELS, 48000, srcFmt, 32, 0,
+                                   false, false, NULL, AE_QUALITY_MID));
+  ASSERT_TRUE(swrResampler.Init(0, CHANNELS, 48000, dstFmt, dstBits, dstDither,
+                                0, CHANNELS, 48000, srcFmt, 32, 0,
+                                false, false, NULL, AE_QUALITY_MID));
+
+  ASSERT_EQ(FRAMES, directResampler.Resample(directDst, FRAMES, src, FRAMES, 1.0));
+  ASSERT_EQ(FRAMES, swrResampler.Resample(swrDst, FRAMES, src, FRAMES + EXTRA, 1.0));
+
+  for (unsigned int i = 0; i < direct.size(); i++)
+  {
+    ASSERT_EQ(swr[i], direct[i]) << "sample " << i;
+  }
+}
+}
+
+TEST(TestActiveAEResample, S24NE4MatchesSwr)
+{
+  // 24 bit in 32, right aligned (alsa)
+  CompareToSwr(AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_S32, 24, 0);
+  CompareToSwr(AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S32, 24, 0);
+  CompareToSwr(AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_S32P, 24, 0);
+}
+
+TEST(TestActiveAEResample, S24NE4MSBMatchesSwr)
+{
+  // 24 bit in 32 with 8 dither bits, left aligned (wasapi)
+  CompareToSwr(AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_S32, 24, 8);
+  CompareToSwr(AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S32, 24, 8);
+}
+
+TEST(TestActiveAEResample, S32MatchesSwr)
+{
+  CompareToSwr(AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_S32, 32, 0);
+  CompareToSwr(AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_S32P, 32, 0);
+}
@@ -38,6 +38,7 @@
 #include "settings/MediaSettings.h"
 #include "settings/Settings.h"
 #include "guilib/GUIFontManager.h"
+#include "guilib/GUITexture.h"
 
 #if defined(HAS_GL)
   #include "LinuxRendererGL.h"
@@ -89,12 +90,6 @@ private:
   CCriticalSection &m_owned;
 };
 
-static void requeue(std::deque<int> &trg, std::deque<int> &src)
-{
-  trg.push_back(src.front());
-  src.pop_front();
-}
-
 CXBMCRenderManager::CXBMCRenderManager()
 {
   m_pRenderer = NULL;
@@ -112,6 +107,8 @@ CXBMCRenderManager::CXBMCRenderManager()
   m_errorindex = 0;
   m_QueueSize   = 2;
   m_QueueSkip   = 0;
+  m_QueueLate   = 0;
+  m_generation  = 0;
   m_format      = RENDER_FMT_NONE;
 }
 
@@ -226,7 +223,7 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
 
   /* make sure any queued frame was fully presented */
   XbmcThreads::EndTime endtime(5000);
-  while(m_presentstep != PRESENT_IDLE)
+  while(m_presentstep != PRESENT_IDLE || !m_queued.Empty())
   {
     if(endtime.IsTimePast())
     {
@@ -266,6 +263,7 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
       m_QueueSize = m_pRenderer->GetMaxBufferSize(); /* no refs to data */
 
     m_QueueSize = std::min(m_QueueSize, (int)m_pRenderer->GetMaxBufferSize());
+    m_QueueSize = std::min(m_QueueSize, g_advancedSettings.m_videoRenderBuffers);
     m_QueueSize = std::min(m_QueueSize, NUM_BUFFERS);
     if(m_QueueSize < 2)
     {
@@ -276,12 +274,13 @@ bool CXBMCRenderManager::Configure(unsigned int width, unsigned int height, unsi
     m_pRenderer->SetBufferSize(m_QueueSize);
     m_pRenderer->Update();
 
-    m_queued.clear();
+    /* the player is in here and the render thread waits for our locks */
+    m_queued.Clear();
     m_discard.clear();
-    m_free.clear();
+    m_free.Clear();
     m_presentsource = 0;
     for (int i=1; i < m_QueueSize; i++)
-      m_free.push_back(i);
+      m_free.Push(i);
 
     m_bIsStarted = true;
     m_bReconfigured = true;
@@ -319,10 +318,16 @@ void CXBMCRenderManager::Update()
 bool CXBMCRenderManager::FrameWait(int ms)
 {
   XbmcThreads::EndTime timeout(ms);
-  CSingleLock lock(m_presentlock);
-  while(m_presentstep == PRESENT_IDLE && !timeout.IsTimePast())
-    m_presentevent.wait(lock, timeout.MillisLeft());
-  return m_presentstep != PRESENT_IDLE;
+  while(true)
+  {
+    { CSingleLock lock(m_presentlock);
+      if(m_presentstep != PRESENT_IDLE || !m_queued.Empty())
+        return true;
+    }
+    if(timeout.IsTimePast())
+      return false;
+    m_queuedEvent.WaitMSec(timeout.MillisLeft());
+  }
 }
 
 void CXBMCRenderManager::FrameMove()
@@ -333,13 +338,22 @@ void CXBMCRenderManager::FrameMove()
     if (!m_pRenderer)
       return;
 
+    DiscardStale();
+
+    /* frames queued by the player since the last present */
+    if (m_presentstep == PRESENT_IDLE && !m_queued.Empty())
+    {
+      m_presentstep = PRESENT_READY;
+      m_presentevent.notifyAll();
+    }
+
     if (m_presentstep == PRESENT_FRAME2)
     {
-      if(!m_queued.empty())
+      if(!m_queued.Empty())
       {
         double timestamp = GetPresentTime();
         SPresent& m = m_Queue[m_presentsource];
-        SPresent& q = m_Queue[m_queued.front()];
+        SPresent& q = m_Queue[m_queued.Front().source];
         if(timestamp > m.timestamp + (q.timestamp - m.timestamp) * 0.5)
         {
           m_presentstep = PRESENT_READY;
@@ -359,14 +373,17 @@ void CXBMCRenderManager::FrameMove()
     }
 
     /* release all previous */
+    bool released = !m_discard.empty();
     for(std::deque<int>::iterator it = m_discard.begin(); it != m_discard.end(); )
     {
       // TODO check for fence
       m_pRenderer->ReleaseBuffer(*it);
       m_overlays.Release(*it);
-      m_free.push_back(*it);
+      m_free.Push(*it);
       it = m_discard.erase(it);
     }
+    if (released)
+      m_freeEvent.Set();
   }
 }
 
@@ -394,7 +411,7 @@ void CXBMCRenderManager::FrameFinish()
 
     if(m_presentstep == PRESENT_IDLE)
     {
-      if(!m_queued.empty())
+      if(!m_queued.Empty())
         m_presentstep = PRESENT_READY;
     }
 
@@ -429,6 +446,7 @@ unsigned int CXBMCRenderManager::PreInit()
 
   m_QueueSize   = 2;
   m_QueueSkip   = 0;
+  m_QueueLate   = 0;
 
   return m_pRenderer->PreInit();
 }
@@ -610,6 +628,9 @@ void CXBMCRenderManager::ManageCaptures()
 void CXBMCRenderManager::RenderCapture(CRenderCapture* capture)
 {
   CSharedLock lock(m_sharedSection);
+#if defined(HAS_GL)
+  CGUITextureGL::FlushBatch();
+#endif
   if (!m_pRenderer || !m_pRenderer->RenderCapture(capture))
     capture->SetState(CAPTURESTATE_FAILED);
 }
@@ -685,26 +706,26 @@ void CXBMCRenderManager::FlipPage(volatile bool& bStop, double timestamp /* = 0L
     if(timestamp > GetPresentTime() + 5.0)
       timestamp = GetPresentTime() + 5.0;
 
-    CSingleLock lock2(m_presentlock);
-
-    if(m_free.empty())
+    if(m_free.Empty())
       return;
 
     if(source < 0)
-      source = m_free.front();
+      source = m_free.Front();
 
     SPresent& m = m_Queue[source];
     m.timestamp     = timestamp;
     m.presentfield  = sync;
     m.presentmethod = presentmethod;
-    requeue(m_queued, m_free);
 
-    /* signal to any waiters to check state */
-    if(m_presentstep == PRESENT_IDLE)
-    {
-      m_presentstep = PRESENT_READY;
-      m_presentevent.notifyAll();
-    }
+    /* there are fewer buffers than slots, so this can't fail */
+    SQueued q;
+    q.source     = m_free.Front();
+    q.generation = m_generation;
+    m_free.Pop();
+    m_queued.Push(q);
+
+    /* the render thread picks it up on its next FrameMove */
+    m_queuedEvent.Set();
   }
 }
 
@@ -754,6 +775,10 @@ void CXBMCRenderManager::RegisterRenderFeaturesCallBack(const void *ctx, RenderF
 void CXBMCRenderManager::Render(bool clear, DWORD flags, DWORD alpha)
 {
   CSharedLock lock(m_sharedSection);
+#if defined(HAS_GL)
+  // the video is drawn straight away, the gui drawn so far has to be below it
+  CGUITextureGL::FlushBatch();
+#endif
 
   SPresent& m = m_Queue[m_presentsource];
 
@@ -853,7 +878,7 @@ void CXBMCRenderManager::UpdateResolution()
 unsigned int CXBMCRenderManager::GetProcessorSize()
 {
   CSharedLock lock(m_sharedSection);
-  return std::max(4, NUM_BUFFERS);
+  return std::max(4, std::min(g_advancedSettings.m_videoRenderBuffers, NUM_BUFFERS));
 }
 
 // Supported pixel formats, can be called before configure
@@ -871,13 +896,9 @@ int CXBMCRenderManager::AddVideoPicture(DVDVideoPicture& pic)
   if (!m_pRenderer)
     return -1;
 
-  int index;
-  {
-    CSingleLock lock(m_presentlock);
-    if (m_free.empty())
-      return -1;
-    index = m_free.front();
-  }
+  if (m_free.Empty())
+    return -1;
+  int index = m_free.Front();
 
   if(m_pRenderer->AddVideoPicture(&pic, index))
     return 1;
@@ -994,12 +1015,10 @@ EINTERLACEMETHOD CXBMCRenderManager::AutoInterlaceMethodInternal(EINTERLACEMETHO
 
 int CXBMCRenderManager::WaitForBuffer(volatile bool& bStop, int timeout)
 {
-  CSingleLock lock2(m_presentlock);
-
   XbmcThreads::EndTime endtime(timeout);
-  while(m_free.empty())
+  while(m_free.Empty())
   {
-    m_presentevent.wait(lock2, std::min(50, timeout));
+    m_freeEvent.WaitMSec(std::min(50, timeout));
     if(endtime.IsTimePast() || bStop)
     {
       if (timeout != 0 && !bStop)
@@ -1009,17 +1028,18 @@ int CXBMCRenderManager::WaitForBuffer(volatile bool& bStop, int timeout)
   }
 
   // make sure overlay buffer is released, this won't happen on AddOverlay
-  m_overlays.Release(m_free.front());
+  m_overlays.Release(m_free.Front());
 
   // return buffer level
-  return m_queued.size() + m_discard.size();;
+  return std::max(0, m_QueueSize - 1 - (int)m_free.Size());
 }
 
 void CXBMCRenderManager::PrepareNextRender()
 {
   CSingleLock lock(m_presentlock);
 
-  if (m_queued.empty())
+  unsigned int count = m_queued.Size();
+  if (count == 0)
   {
     CLog::Log(LOGERROR, "CRenderManager::PrepareNextRender - asked to prepare with nothing available");
     m_presentstep = PRESENT_IDLE;
@@ -1031,19 +1051,15 @@ void CXBMCRenderManager::PrepareNextRender()
   double frametime = 1.0 / GetMaximumFPS();
 
   /* see if any future queued frames are already due */
-  std::deque<int>::reverse_iterator curr, prev;
-  int idx;
-  curr = prev = m_queued.rbegin();
-  ++prev;
-  while (prev != m_queued.rend())
+  unsigned int curr = count - 1;
+  while (curr > 0)
   {
-    if(clocktime > m_Queue[*prev].timestamp                 /* previous frame is late */
-    && clocktime > m_Queue[*curr].timestamp - frametime)    /* selected frame is close to it's display time */
+    if(clocktime > m_Queue[m_queued.Peek(curr - 1).source].timestamp          /* previous frame is late */
+    && clocktime > m_Queue[m_queued.Peek(curr).source].timestamp - frametime) /* selected frame is close to it's display time */
       break;
-    ++curr;
-    ++prev;
+    --curr;
   }
-  idx = *curr;
+  int idx = m_queued.Peek(curr).source;
 
   /* in fullscreen we will block after render, but only for MAXPRESENTDELAY */
   bool next;
@@ -1055,29 +1071,48 @@ void CXBMCRenderManager::PrepareNextRender()
   if (next)
   {
     /* skip late frames */
-    while(m_queued.front() != idx)
+    for (unsigned int i = 0; i < curr; i++)
     {
-      requeue(m_discard, m_queued);
+      m_discard.push_back(m_queued.Front().source);
+      m_queued.Pop();
       m_QueueSkip++;
     }
 
+    /* shown more than a display frame after its time */
+    if(clocktime > m_Queue[idx].timestamp + frametime)
+      m_QueueLate++;
+
     m_presentstep   = PRESENT_FLIP;
     m_discard.push_back(m_presentsource);
     m_presentsource = idx;
-    m_queued.pop_front();
+    m_queued.Pop();
     m_presentevent.notifyAll();
   }
 }
 
-void CXBMCRenderManager::DiscardBuffer()
+void CXBMCRenderManager::DiscardStale()
 {
-  CSharedLock lock(m_sharedSection);
-  CSingleLock lock2(m_presentlock);
+  CSingleLock lock(m_presentlock);
 
-  while(!m_queued.empty())
-    requeue(m_discard, m_queued);
+  /* frames queued after the discard carry a newer generation, the player
+   * may already have queued some of those */
+  long generation = AtomicAdd(&m_generation, 0);
+  while(!m_queued.Empty() && m_queued.Front().generation - generation < 0)
+  {
+    m_discard.push_back(m_queued.Front().source);
+    m_queued.Pop();
+  }
 
-  if(m_presentstep == PRESENT_READY)
-    m_presentstep   = PRESENT_IDLE;
-  m_presentevent.notifyAll();
+  if(m_presentstep == PRESENT_READY && m_queued.Empty())
+  {
+    m_presentstep = PRESENT_IDLE;
+    m_presentevent.notifyAll();
+  }
+}
+
+void CXBMCRenderManager::DiscardBuffer()
+{
+  /* called from the player, the render thread drops the frames */
+  AtomicIncrement(&m_generation);
+  m_queuedEvent.Set();
 }
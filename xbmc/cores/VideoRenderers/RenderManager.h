@@ -26,6 +26,7 @@
 #include "guilib/Geometry.h"
 #include "guilib/Resolution.h"
 #include "threads/SharedSection.h"
+#include "threads/SPSCRing.h"
 #include "threads/Thread.h"
 #include "settings/VideoSettings.h"
 #include "OverlayRenderer.h"
@@ -40,6 +41,7 @@ namespace VDPAU { class CVdpauRenderPicture; }
 struct DVDVideoPicture;
 
 #define ERRORBUFFSIZE 30
+#define RENDER_RING_SIZE 8 /* power of two above NUM_BUFFERS */
 
 class CWinRenderer;
 class CLinuxRenderer;
@@ -109,7 +111,7 @@ public:
   void AddOverlay(CDVDOverlay* o, double pts)
   {
     CSharedLock lock(m_sharedSection);
-    m_overlays.AddOverlay(o, pts, m_free.front());
+    m_overlays.AddOverlay(o, pts, m_free.Front());
   }
 
   void AddCleanup(OVERLAY::COverlay* o)
@@ -126,6 +128,9 @@ public:
   inline bool IsStarted() { return m_bIsStarted;}
   double GetDisplayLatency() { return m_displayLatency; }
   int    GetSkippedFrames()  { return m_QueueSkip; }
+  int    GetLateFrames()     { return m_QueueLate; }
+  int    GetQueueDepth()     { return m_queued.Size(); }
+  int    GetQueueSize()      { return m_QueueSize - 1; }
 
   bool Supports(ERENDERFEATURE feature);
   bool Supports(EDEINTERLACEMODE method);
@@ -170,6 +175,7 @@ public:
    * AddVideoPicture and AddOverlay. It waits for max 50 ms before it returns -1
    * in case no buffer is available. Player may call this in a loop and decides
    * by itself when it wants to drop a frame.
+   * Returns the number of buffers held by the render thread otherwise.
    * If no buffering is requested in Configure, player does not need to call this,
    * because FlipPage will block.
    */
@@ -187,6 +193,7 @@ protected:
   void PresentBlend(bool clear, DWORD flags, DWORD alpha);
 
   void PrepareNextRender();
+  void DiscardStale();
 
   EINTERLACEMETHOD AutoInterlaceMethodInternal(EINTERLACEMETHOD mInt);
 
@@ -219,6 +226,7 @@ protected:
 
   int m_QueueSize;
   int m_QueueSkip;
+  int m_QueueLate;
 
   struct SPresent
   {
@@ -227,9 +235,20 @@ protected:
     EPRESENTMETHOD presentmethod;
   } m_Queue[NUM_BUFFERS];
 
-  std::deque<int> m_free;
-  std::deque<int> m_queued;
-  std::deque<int> m_discard;
+  /* The player fills free buffers and queues them, the render thread takes
+   * queued buffers and hands them back once released. Neither side locks,
+   * each ring has one producing and one consuming thread. */
+  struct SQueued
+  {
+    int  source;
+    long generation;
+  };
+  XbmcThreads::SPSCRing<int, RENDER_RING_SIZE>     m_free;
+  XbmcThreads::SPSCRing<SQueued, RENDER_RING_SIZE> m_queued;
+  std::deque<int> m_discard;     // render thread only
+  volatile long   m_generation;  // bumped by DiscardBuffer, older queued frames are dropped
+  CEvent          m_freeEvent;
+  CEvent          m_queuedEvent;
 
   ERenderFormat   m_format;
 
@@ -22,6 +22,7 @@
 #include "DVDDemuxers/DVDDemuxUtils.h"
 #include "utils/log.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
 
@@ -35,10 +36,18 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_owne
   m_bCaching      = false;
   m_bEmptied      = true;
 
-  m_TimeBack      = DVD_NOPTS_VALUE;
-  m_TimeFront     = DVD_NOPTS_VALUE;
+  m_TimeBack.Set(DVD_NOPTS_VALUE);
+  m_TimeFront.Set(DVD_NOPTS_VALUE);
+  m_TimeFirst.Set(DVD_NOPTS_VALUE);
   m_TimeSize      = 1.0 / 4.0; /* 4 seconds */
   m_iMaxDataSize  = 0;
+
+  m_ringHead      = 0;
+  m_ringTail      = 0;
+  m_ringWaiting   = 0;
+  m_ringOpen      = 0;
+  m_ringProducers = 0;
+  m_sequence      = 0;
 }
 
 CDVDMessageQueue::~CDVDMessageQueue()
@@ -49,12 +58,18 @@ CDVDMessageQueue::~CDVDMessageQueue()
 
 void CDVDMessageQueue::Init()
 {
+  CSingleLock lock(m_section);
+  CloseRing();
+
   m_iDataSize     = 0;
   m_bAbortRequest = false;
   m_bEmptied      = true;
   m_bInitialized  = true;
-  m_TimeBack      = DVD_NOPTS_VALUE;
-  m_TimeFront     = DVD_NOPTS_VALUE;
+  m_TimeBack.Set(DVD_NOPTS_VALUE);
+  m_TimeFront.Set(DVD_NOPTS_VALUE);
+  m_TimeFirst.Set(DVD_NOPTS_VALUE);
+
+  OpenRing();
 }
 
 void CDVDMessageQueue::Flush(CDVDMsg::Message type)
@@ -71,10 +86,16 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
+    // the producer is kept out while both sides are reset
+    bool open = CloseRing();
+    FlushPackets();
     m_iDataSize = 0;
-    m_TimeBack  = DVD_NOPTS_VALUE;
-    m_TimeFront = DVD_NOPTS_VALUE;
+    m_TimeBack.Set(DVD_NOPTS_VALUE);
+    m_TimeFront.Set(DVD_NOPTS_VALUE);
+    m_TimeFirst.Set(DVD_NOPTS_VALUE);
     m_bEmptied = true;
+    if (open)
+      OpenRing();
   }
 }
 
@@ -90,6 +111,7 @@ void CDVDMessageQueue::Abort()
 void CDVDMessageQueue::End()
 {
   CSingleLock lock(m_section);
+  CloseRing();
 
   Flush();
 
@@ -101,6 +123,18 @@ void CDVDMessageQueue::End()
 
 MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 {
+  if (pMsg && priority == 0 && pMsg->IsType(CDVDMsg::DEMUXER_PACKET))
+  {
+    // announce ourselves before looking at the gate, a closing side either
+    // sees us and waits or we see the ring closed
+    AtomicIncrement(&m_ringProducers);
+    bool pushed = AtomicAdd(&m_ringOpen, 0) && PushPacket(pMsg, AtomicIncrement(&m_sequence));
+    AtomicDecrement(&m_ringProducers);
+    if (pushed)
+      return MSGQ_OK;
+    // ring is full or closed, queue it on the list
+  }
+
   CSingleLock lock(m_section);
 
   if (!m_bInitialized)
@@ -122,22 +156,10 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
       break;
     ++it;
   }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
+  m_list.insert(it, DVDMessageListItem(pMsg, priority, AtomicIncrement(&m_sequence)));
 
   if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
-  {
-    DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
-    if(packet)
-    {
-      m_iDataSize += packet->iSize;
-      if     (packet->dts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->dts;
-      else if(packet->pts != DVD_NOPTS_VALUE)
-        m_TimeFront = packet->pts;
-      if(m_TimeBack == DVD_NOPTS_VALUE)
-        m_TimeBack = m_TimeFront;
-    }
-  }
+    PacketAdded(pMsg);
 
   pMsg->Release();
 
@@ -160,7 +182,8 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  long sequence;
+  if(m_bEmptied == false && priority == 0 && m_list.empty() && !PeekPacket(sequence) && m_owner != "teletext")
   {
 #if !defined(TARGET_RASPBERRY_PI)
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
@@ -170,26 +193,21 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
 
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    bool ring = PeekPacket(sequence) && priority <= 0 && !m_bCaching;
+    bool list = !m_list.empty() && m_list.back().priority >= priority && !m_bCaching;
+
+    // messages of equal priority are returned in the order they were put
+    if(list && ring && m_list.back().priority == 0
+    && (long)((unsigned long)sequence - (unsigned long)m_list.back().sequence) < 0)
+      list = false;
+
+    if(list)
     {
       DVDMessageListItem& item(m_list.back());
       priority = item.priority;
 
       if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
-      {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
-        if(packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
-
-        if(m_bEmptied && m_iDataSize > 0)
-          m_bEmptied = false;
-      }
+        PacketRemoved(item.message);
 
       *pMsg = item.message->Acquire();
       m_list.pop_back();
@@ -197,6 +215,15 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
       ret = MSGQ_OK;
       break;
     }
+    else if(ring)
+    {
+      priority = 0;
+      *pMsg = PopPacket();
+      PacketRemoved(*pMsg);
+
+      ret = MSGQ_OK;
+      break;
+    }
     else if (!iTimeoutInMilliSeconds)
     {
       ret = MSGQ_TIMEOUT;
@@ -205,10 +232,22 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     else
     {
       m_hEvent.Reset();
+
+      // the producer only signals the event when it sees a waiter, so
+      // announce ourselves before checking the ring a last time
+      AtomicIncrement(&m_ringWaiting);
+      if (PeekPacket(sequence))
+      {
+        AtomicDecrement(&m_ringWaiting);
+        continue;
+      }
+
       lock.Leave();
 
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+      AtomicDecrement(&m_ringWaiting);
+      if (!signaled)
         return MSGQ_TIMEOUT;
 
       lock.Enter();
@@ -235,6 +274,9 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
       count++;
   }
 
+  if (type == CDVDMsg::DEMUXER_PACKET)
+    count += (unsigned)(AtomicAdd(&m_ringTail, 0) - m_ringHead);
+
   return count;
 }
 
@@ -249,28 +291,149 @@ void CDVDMessageQueue::WaitUntilEmpty()
 
 int CDVDMessageQueue::GetLevel() const
 {
-  if(m_iDataSize > m_iMaxDataSize)
+  int iDataSize = GetDataSize();
+  if(iDataSize > m_iMaxDataSize)
     return 100;
-  if(m_iDataSize == 0)
+  if(iDataSize == 0)
     return 0;
 
-  if(IsDataBased())
-    return min(100, 100 * m_iDataSize / m_iMaxDataSize);
+  double front, back;
+  GetTimes(front, back);
+  if(IsDataBased(front, back))
+    return min(100, 100 * iDataSize / m_iMaxDataSize);
 
-  return min(100, MathUtils::round_int(100.0 * m_TimeSize * (m_TimeFront - m_TimeBack) / DVD_TIME_BASE ));
+  return min(100, MathUtils::round_int(100.0 * m_TimeSize * (front - back) / DVD_TIME_BASE ));
 }
 
 int CDVDMessageQueue::GetTimeSize() const
 {
-  if(IsDataBased())
+  double front, back;
+  GetTimes(front, back);
+  if(IsDataBased(front, back))
     return 0;
   else
-    return (int)((m_TimeFront - m_TimeBack) / DVD_TIME_BASE);
+    return (int)((front - back) / DVD_TIME_BASE);
 }
 
 bool CDVDMessageQueue::IsDataBased() const
 {
-  return (m_TimeBack == DVD_NOPTS_VALUE  ||
-          m_TimeFront == DVD_NOPTS_VALUE ||
-          m_TimeFront <= m_TimeBack);
+  double front, back;
+  GetTimes(front, back);
+  return IsDataBased(front, back);
+}
+
+bool CDVDMessageQueue::IsDataBased(double front, double back)
+{
+  return (back == DVD_NOPTS_VALUE  ||
+          front == DVD_NOPTS_VALUE ||
+          front <= back);
+}
+
+void CDVDMessageQueue::GetTimes(double &front, double &back) const
+{
+  // until the consumer took a packet with a timestamp the level starts at the first one put
+  front = m_TimeFront.Get();
+  back  = m_TimeBack.Get();
+  if(back == DVD_NOPTS_VALUE)
+    back = m_TimeFirst.Get();
+}
+
+void CDVDMessageQueue::PacketAdded(CDVDMsg* pMsg)
+{
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if(packet)
+  {
+    AtomicAdd(&m_iDataSize, packet->iSize);
+
+    double front = DVD_NOPTS_VALUE;
+    if     (packet->dts != DVD_NOPTS_VALUE)
+      front = packet->dts;
+    else if(packet->pts != DVD_NOPTS_VALUE)
+      front = packet->pts;
+    if(front != DVD_NOPTS_VALUE)
+    {
+      m_TimeFront.Set(front);
+      if(m_TimeFirst.Get() == DVD_NOPTS_VALUE)
+        m_TimeFirst.Set(front);
+    }
+  }
+}
+
+void CDVDMessageQueue::PacketRemoved(CDVDMsg* pMsg)
+{
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if(packet)
+  {
+    AtomicSubtract(&m_iDataSize, packet->iSize);
+
+    if     (packet->dts != DVD_NOPTS_VALUE)
+      m_TimeBack.Set(packet->dts);
+    else if(packet->pts != DVD_NOPTS_VALUE)
+      m_TimeBack.Set(packet->pts);
+  }
+
+  if(m_bEmptied && m_iDataSize > 0)
+    m_bEmptied = false;
+}
+
+bool CDVDMessageQueue::PushPacket(CDVDMsg* pMsg, long sequence)
+{
+  long tail = m_ringTail;
+  if (tail - AtomicAdd(&m_ringHead, 0) >= MSGQ_RING_SIZE)
+    return false;
+
+  SRingItem& item = m_ring[tail & (MSGQ_RING_SIZE - 1)];
+  item.message  = pMsg;
+  item.sequence = sequence;
+
+  // account before publishing so the consumer never sees a negative size
+  PacketAdded(pMsg);
+  AtomicIncrement(&m_ringTail);
+
+  if (AtomicAdd(&m_ringWaiting, 0))
+    m_hEvent.Set(); // inform waiter for new packet
+
+  return true;
+}
+
+bool CDVDMessageQueue::PeekPacket(long &sequence)
+{
+  long head = m_ringHead;
+  if (AtomicAdd(&m_ringTail, 0) == head)
+    return false;
+
+  sequence = m_ring[head & (MSGQ_RING_SIZE - 1)].sequence;
+  return true;
+}
+
+CDVDMsg* CDVDMessageQueue::PopPacket()
+{
+  SRingItem& item = m_ring[m_ringHead & (MSGQ_RING_SIZE - 1)];
+  CDVDMsg* msg = item.message;
+  item.message = NULL;
+  AtomicIncrement(&m_ringHead);
+  return msg;
+}
+
+void CDVDMessageQueue::FlushPackets()
+{
+  long sequence;
+  while (PeekPacket(sequence))
+    PopPacket()->Release();
+}
+
+bool CDVDMessageQueue::CloseRing()
+{
+  bool open = cas(&m_ringOpen, 1, 0) == 1;
+
+  // the producer is at most one push away from leaving
+  while (AtomicAdd(&m_ringProducers, 0))
+    Sleep(0);
+
+  return open;
+}
+
+void CDVDMessageQueue::OpenRing()
+{
+  cas(&m_ringOpen, 0, 1);
 }
@@ -23,20 +23,23 @@
 #include "DVDMessage.h"
 #include <string>
 #include <list>
+#include "threads/Atomics.h"
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
 
 struct DVDMessageListItem
 {
-  DVDMessageListItem(CDVDMsg* msg, int prio)
+  DVDMessageListItem(CDVDMsg* msg, int prio, long seq = 0)
   {
     message  = msg->Acquire();
     priority = prio;
+    sequence = seq;
   }
   DVDMessageListItem()
   {
     message  = NULL;
     priority = 0;
+    sequence = 0;
   }
   DVDMessageListItem(const DVDMessageListItem& item)
   {
@@ -45,6 +48,7 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    sequence = item.sequence;
   }
  ~DVDMessageListItem()
   {
@@ -61,11 +65,13 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    sequence = item.sequence;
     return *this;
   }
 
   CDVDMsg* message;
   int      priority;
+  long     sequence;
 };
 
 enum MsgQueueReturnCode
@@ -80,6 +86,9 @@ enum MsgQueueReturnCode
 
 #define MSGQ_IS_ERROR(c)    (c < 0)
 
+// number of slots in the demux packet ring, must be a power of two
+#define MSGQ_RING_SIZE      1024
+
 class CDVDMessageQueue
 {
 public:
@@ -105,7 +114,7 @@ public:
     return Get(pMsg, iTimeoutInMilliSeconds, priority);
   }
 
-  int GetDataSize() const               { return m_iDataSize; }
+  int GetDataSize() const               { return (int)m_iDataSize; }
   int GetTimeSize() const;
   unsigned GetPacketCount(CDVDMsg::Message type);
   bool ReceivedAbortRequest()           { return m_bAbortRequest; }
@@ -124,6 +133,64 @@ public:
 
 private:
 
+  /*
+   * A timestamp with a single writer that any thread may read without a
+   * lock. The sequence is odd while the value is being changed, a reader
+   * that saw it change retries.
+   */
+  class CPublishedTime
+  {
+  public:
+    CPublishedTime() : m_seq(0), m_value(0.0) {}
+    void Set(double value)
+    {
+      AtomicIncrement(&m_seq);
+      m_value = value;
+      AtomicIncrement(&m_seq);
+    }
+    double Get() const
+    {
+      while (true)
+      {
+        long seq = AtomicAdd(&m_seq, 0);
+        double value = m_value;
+        if (!(seq & 1) && AtomicAdd(&m_seq, 0) == seq)
+          return value;
+      }
+    }
+  private:
+    mutable volatile long m_seq;
+    volatile double       m_value;
+  };
+
+  /*
+   * Demux packets with priority 0 are the bulk of the traffic between the
+   * demuxer and a decoder. They come from a single producer and go through
+   * a single producer / single consumer ring without taking a lock.
+   * Ordering against messages on m_list is kept by a sequence number
+   * stamped on every message. The consumer side of the ring is owned by
+   * whoever holds m_section.
+   *
+   * The producer only pushes while m_ringOpen is set and announces itself
+   * in m_ringProducers. Init(), Flush() and End() close the ring under
+   * m_section and wait for the producer to leave it, they are the only
+   * ones needing exclusive access to both sides.
+   *
+   * The levels are single writer atomics published before the ring index:
+   * m_TimeFront and m_TimeFirst belong to the producer, m_TimeBack to the
+   * consumer, m_iDataSize is changed with atomic adds from both.
+   */
+  bool PushPacket(CDVDMsg* pMsg, long sequence);
+  bool PeekPacket(long &sequence);
+  CDVDMsg* PopPacket();
+  void FlushPackets();
+  bool CloseRing();
+  void OpenRing();
+  void PacketAdded(CDVDMsg* pMsg);
+  void PacketRemoved(CDVDMsg* pMsg);
+  void GetTimes(double &front, double &back) const;
+  static bool IsDataBased(double front, double back);
+
   CEvent m_hEvent;
   mutable CCriticalSection m_section;
 
@@ -131,9 +198,10 @@ private:
   bool m_bInitialized;
   bool m_bCaching;
 
-  int m_iDataSize;
-  double m_TimeFront;
-  double m_TimeBack;
+  volatile long m_iDataSize;
+  CPublishedTime m_TimeFront;  // last packet put
+  CPublishedTime m_TimeFirst;  // first packet put since the last flush
+  CPublishedTime m_TimeBack;   // last packet taken
   double m_TimeSize;
 
   int m_iMaxDataSize;
@@ -142,5 +210,18 @@ private:
 
   typedef std::list<DVDMessageListItem> SList;
   SList m_list;
+
+  struct SRingItem
+  {
+    CDVDMsg* message;
+    long     sequence;
+  };
+  SRingItem     m_ring[MSGQ_RING_SIZE];
+  volatile long m_ringHead;      // next slot to read, advanced by the consumer
+  volatile long m_ringTail;      // next slot to write, advanced by the producer
+  volatile long m_ringWaiting;   // consumer is blocked on m_hEvent
+  volatile long m_ringOpen;      // the producer may push
+  volatile long m_ringProducers; // producer is inside the ring
+  volatile long m_sequence;
 };
 
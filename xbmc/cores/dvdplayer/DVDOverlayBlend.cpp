@@ -0,0 +1,305 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDOverlayBlend.h"
+#include "utils/CPUInfo.h"
+#include "utils/log.h"
+
+#ifdef TARGET_WINDOWS
+#if _M_IX86_FP>1 && !defined(__SSE2__)
+#define __SSE2__
+#endif
+#if defined(_M_X64) && !defined(__SSE2__)
+#define __SSE2__
+#endif
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+/* implemented in DVDOverlayBlendAVX2.cpp, overrides the entries of kernels
+ * that have an AVX2 version. Returns false if built without AVX2 support. */
+extern bool OverlayBlendAVX2(OverlayBlendKernels &kernels);
+
+namespace
+{
+
+/* reference implementations, also used for the tails of the SIMD versions */
+
+void BlendMask_C(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    unsigned int k = mask[i] * opacity / 255;
+    dst[i] = (k * value + (255 - k) * dst[i]) / 255;
+  }
+}
+
+void BlendMaskChroma_C(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    unsigned int k = mask[i] * opacity / 255;
+    dst[i >> 1] = (k * value + (255 - k) * dst[i >> 1]) / 255;
+  }
+}
+
+void BlendAlpha_C(uint8_t *dst, const uint8_t *value, const uint8_t *alpha, unsigned int count)
+{
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    if (alpha[i] == 0)
+      continue;
+    unsigned int s = alpha[i] + 1;
+    dst[i] = (dst[i] * (256 - s) + value[i] * s) >> 8;
+  }
+}
+
+#ifdef __SSE2__
+
+/* x / 255 for x up to 65534, the products here stay below 65281 */
+inline __m128i Div255_SSE2(__m128i x)
+{
+  return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+/* blends 8 16 bit lanes of dst with the ones of mask */
+inline __m128i Blend_SSE2(__m128i d, __m128i m, __m128i opacity, __m128i value)
+{
+  __m128i k = Div255_SSE2(_mm_mullo_epi16(m, opacity));
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(k, value),
+                            _mm_mullo_epi16(_mm_sub_epi16(_mm_set1_epi16(255), k), d));
+  return Div255_SSE2(t);
+}
+
+void BlendMask_SSE2(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i o    = _mm_set1_epi16(opacity);
+  const __m128i v    = _mm_set1_epi16(value);
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m128i m  = _mm_loadu_si128((const __m128i*)(mask + i));
+    __m128i d  = _mm_loadu_si128((const __m128i*)(dst + i));
+    __m128i lo = Blend_SSE2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(m, zero), o, v);
+    __m128i hi = Blend_SSE2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(m, zero), o, v);
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+  }
+  BlendMask_C(dst + i, mask + i, opacity, value, count - i);
+}
+
+void BlendMaskChroma_SSE2(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count)
+{
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i low  = _mm_set1_epi16(0xff);
+  const __m128i o    = _mm_set1_epi16(opacity);
+  const __m128i v    = _mm_set1_epi16(value);
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m128i m = _mm_loadu_si128((const __m128i*)(mask + i));
+    __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(dst + i / 2)), zero);
+    d = Blend_SSE2(d, _mm_and_si128(m, low), o, v);
+    d = Blend_SSE2(d, _mm_srli_epi16(m, 8), o, v);
+    _mm_storel_epi64((__m128i*)(dst + i / 2), _mm_packus_epi16(d, d));
+  }
+  BlendMaskChroma_C(dst + i / 2, mask + i, opacity, value, count - i);
+}
+
+inline __m128i BlendAlpha_SSE2(__m128i d, __m128i v, __m128i a)
+{
+  __m128i t = _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), a)),
+                            _mm_mullo_epi16(v, _mm_add_epi16(a, _mm_set1_epi16(1))));
+  return _mm_srli_epi16(t, 8);
+}
+
+void BlendAlpha_SSE2(uint8_t *dst, const uint8_t *value, const uint8_t *alpha, unsigned int count)
+{
+  const __m128i zero = _mm_setzero_si128();
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m128i a  = _mm_loadu_si128((const __m128i*)(alpha + i));
+    __m128i v  = _mm_loadu_si128((const __m128i*)(value + i));
+    __m128i d  = _mm_loadu_si128((const __m128i*)(dst + i));
+    __m128i lo = BlendAlpha_SSE2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(v, zero), _mm_unpacklo_epi8(a, zero));
+    __m128i hi = BlendAlpha_SSE2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(v, zero), _mm_unpackhi_epi8(a, zero));
+    /* transparent pixels keep the picture */
+    __m128i keep = _mm_cmpeq_epi8(a, zero);
+    __m128i r = _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, _mm_packus_epi16(lo, hi)));
+    _mm_storeu_si128((__m128i*)(dst + i), r);
+  }
+  BlendAlpha_C(dst + i, value + i, alpha + i, count - i);
+}
+
+#endif
+
+#if defined(__ARM_NEON__)
+
+/* x / 255 narrowed to 8 bit, exact for x up to 65534 */
+inline uint8x8_t Div255_NEON(uint16x8_t x)
+{
+  return vshrn_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+inline uint8x8_t Blend_NEON(uint8x8_t d, uint8x8_t m, uint8x8_t opacity, uint8x8_t value)
+{
+  uint8x8_t k = Div255_NEON(vmull_u8(m, opacity));
+  return Div255_NEON(vmlal_u8(vmull_u8(k, value), vsub_u8(vdup_n_u8(255), k), d));
+}
+
+void BlendMask_NEON(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count)
+{
+  const uint8x8_t o = vdup_n_u8(opacity);
+  const uint8x8_t v = vdup_n_u8(value);
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    uint8x16_t m = vld1q_u8(mask + i);
+    uint8x16_t d = vld1q_u8(dst + i);
+    uint8x8_t lo = Blend_NEON(vget_low_u8(d),  vget_low_u8(m),  o, v);
+    uint8x8_t hi = Blend_NEON(vget_high_u8(d), vget_high_u8(m), o, v);
+    vst1q_u8(dst + i, vcombine_u8(lo, hi));
+  }
+  BlendMask_C(dst + i, mask + i, opacity, value, count - i);
+}
+
+void BlendMaskChroma_NEON(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count)
+{
+  const uint8x8_t o = vdup_n_u8(opacity);
+  const uint8x8_t v = vdup_n_u8(value);
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    uint8x8x2_t m = vld2_u8(mask + i);
+    uint8x8_t d = vld1_u8(dst + i / 2);
+    d = Blend_NEON(d, m.val[0], o, v);
+    d = Blend_NEON(d, m.val[1], o, v);
+    vst1_u8(dst + i / 2, d);
+  }
+  BlendMaskChroma_C(dst + i / 2, mask + i, opacity, value, count - i);
+}
+
+inline uint8x8_t BlendAlpha_NEON(uint8x8_t d, uint8x8_t v, uint8x8_t a)
+{
+  /* value * (alpha + 1) without leaving 8 bit for the factor */
+  uint16x8_t t = vaddw_u8(vmull_u8(v, a), v);
+  t = vmlal_u8(t, d, vsub_u8(vdup_n_u8(255), a));
+  return vbsl_u8(vceq_u8(a, vdup_n_u8(0)), d, vshrn_n_u16(t, 8));
+}
+
+void BlendAlpha_NEON(uint8_t *dst, const uint8_t *value, const uint8_t *alpha, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 8 <= count; i += 8)
+    vst1_u8(dst + i, BlendAlpha_NEON(vld1_u8(dst + i), vld1_u8(value + i), vld1_u8(alpha + i)));
+  BlendAlpha_C(dst + i, value + i, alpha + i, count - i);
+}
+
+#endif
+
+class CBlendTables
+{
+public:
+  CBlendTables()
+  {
+    for (int i = 0; i < OVERLAY_BLEND_MAX; ++i)
+      m_available[i] = false;
+
+    OverlayBlendKernels &c = m_table[OVERLAY_BLEND_C];
+    c.name            = "C";
+    c.BlendMask       = BlendMask_C;
+    c.BlendMaskChroma = BlendMaskChroma_C;
+    c.BlendAlpha      = BlendAlpha_C;
+    m_available[OVERLAY_BLEND_C] = true;
+    m_best = OVERLAY_BLEND_C;
+
+    unsigned int features = g_cpuInfo.GetCPUFeatures();
+
+#ifdef __SSE2__
+    if (features & CPU_FEATURE_SSE2)
+    {
+      OverlayBlendKernels &sse2 = m_table[OVERLAY_BLEND_SSE2];
+      sse2.name            = "SSE2";
+      sse2.BlendMask       = BlendMask_SSE2;
+      sse2.BlendMaskChroma = BlendMaskChroma_SSE2;
+      sse2.BlendAlpha      = BlendAlpha_SSE2;
+      m_available[OVERLAY_BLEND_SSE2] = true;
+      m_best = OVERLAY_BLEND_SSE2;
+
+      if (features & CPU_FEATURE_AVX2)
+      {
+        m_table[OVERLAY_BLEND_AVX2] = sse2;
+        if (OverlayBlendAVX2(m_table[OVERLAY_BLEND_AVX2]))
+        {
+          m_available[OVERLAY_BLEND_AVX2] = true;
+          m_best = OVERLAY_BLEND_AVX2;
+        }
+      }
+    }
+#endif
+
+#if defined(__ARM_NEON__)
+    if (features & CPU_FEATURE_NEON)
+    {
+      OverlayBlendKernels &neon = m_table[OVERLAY_BLEND_NEON];
+      neon.name            = "NEON";
+      neon.BlendMask       = BlendMask_NEON;
+      neon.BlendMaskChroma = BlendMaskChroma_NEON;
+      neon.BlendAlpha      = BlendAlpha_NEON;
+      m_available[OVERLAY_BLEND_NEON] = true;
+      m_best = OVERLAY_BLEND_NEON;
+    }
+#endif
+
+    CLog::Log(LOGDEBUG, "CDVDOverlayBlend - using %s kernels", m_table[m_best].name);
+  }
+
+  OverlayBlendKernels m_table[OVERLAY_BLEND_MAX];
+  bool                m_available[OVERLAY_BLEND_MAX];
+  OverlayBlendSet     m_best;
+};
+
+const CBlendTables &Tables()
+{
+  static CBlendTables tables;
+  return tables;
+}
+
+}
+
+const OverlayBlendKernels &CDVDOverlayBlend::Get()
+{
+  static const OverlayBlendKernels &kernels = Tables().m_table[Tables().m_best];
+  return kernels;
+}
+
+const OverlayBlendKernels *CDVDOverlayBlend::Get(OverlayBlendSet set)
+{
+  if (set < 0 || set >= OVERLAY_BLEND_MAX || !Tables().m_available[set])
+    return NULL;
+  return &Tables().m_table[set];
+}
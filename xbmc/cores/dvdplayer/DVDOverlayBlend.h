@@ -0,0 +1,59 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+
+enum OverlayBlendSet
+{
+  OVERLAY_BLEND_C = 0,
+  OVERLAY_BLEND_SSE2,
+  OVERLAY_BLEND_AVX2,
+  OVERLAY_BLEND_NEON,
+  OVERLAY_BLEND_MAX
+};
+
+/*!
+ * \brief Table of kernels blending one line of an overlay into a YUV plane.
+ *
+ * All sets give exactly the same result as the C reference. No alignment is
+ * required for any of the buffers.
+ */
+struct OverlayBlendKernels
+{
+  const char *name;
+
+  /*! \brief dst = (dst * (255 - k) + value * k) / 255 with k = mask * opacity / 255, as for libass images */
+  void (*BlendMask)      (uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count);
+  /*! \brief BlendMask onto a subsampled plane, dst[i] is blended with mask[2i] and then with mask[2i+1], count is in mask pixels */
+  void (*BlendMaskChroma)(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count);
+  /*! \brief dst = (dst * (255 - alpha) + value * (alpha + 1)) >> 8 where alpha isn't 0, as for palette images */
+  void (*BlendAlpha)     (uint8_t *dst, const uint8_t *value, const uint8_t *alpha, unsigned int count);
+};
+
+class CDVDOverlayBlend
+{
+public:
+  /*! \brief the fastest kernels supported by the cpu, selected from g_cpuInfo on first use */
+  static const OverlayBlendKernels &Get();
+
+  /*! \brief kernels of a given instruction set, NULL if not built in or not supported by the cpu */
+  static const OverlayBlendKernels *Get(OverlayBlendSet set);
+};
@@ -0,0 +1,129 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * AVX2 versions of the overlay blend kernels. This file is built with AVX2
+ * code generation enabled, nothing in here may run before CDVDOverlayBlend
+ * made sure the cpu supports it.
+ */
+
+#include "DVDOverlayBlend.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace
+{
+
+/* the kernels this table was built from, used for the tails */
+OverlayBlendKernels fallback;
+
+inline __m256i Div255_AVX2(__m256i x)
+{
+  return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+inline __m256i Blend_AVX2(__m256i d, __m256i m, __m256i opacity, __m256i value)
+{
+  __m256i k = Div255_AVX2(_mm256_mullo_epi16(m, opacity));
+  __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(k, value),
+                               _mm256_mullo_epi16(_mm256_sub_epi16(_mm256_set1_epi16(255), k), d));
+  return Div255_AVX2(t);
+}
+
+/* 16 bit lanes back to 16 bytes in order */
+inline __m128i Pack_AVX2(__m256i x)
+{
+  return _mm_packus_epi16(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+}
+
+inline __m256i Load16_AVX2(const uint8_t *p)
+{
+  return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)p));
+}
+
+void BlendMask_AVX2(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count)
+{
+  const __m256i o = _mm256_set1_epi16(opacity);
+  const __m256i v = _mm256_set1_epi16(value);
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m256i r = Blend_AVX2(Load16_AVX2(dst + i), Load16_AVX2(mask + i), o, v);
+    _mm_storeu_si128((__m128i*)(dst + i), Pack_AVX2(r));
+  }
+  fallback.BlendMask(dst + i, mask + i, opacity, value, count - i);
+}
+
+void BlendMaskChroma_AVX2(uint8_t *dst, const uint8_t *mask, uint8_t opacity, uint8_t value, unsigned int count)
+{
+  const __m256i low = _mm256_set1_epi16(0xff);
+  const __m256i o   = _mm256_set1_epi16(opacity);
+  const __m256i v   = _mm256_set1_epi16(value);
+  unsigned int i = 0;
+  for (; i + 32 <= count; i += 32)
+  {
+    __m256i m = _mm256_loadu_si256((const __m256i*)(mask + i));
+    __m256i d = Load16_AVX2(dst + i / 2);
+    d = Blend_AVX2(d, _mm256_and_si256(m, low), o, v);
+    d = Blend_AVX2(d, _mm256_srli_epi16(m, 8), o, v);
+    _mm_storeu_si128((__m128i*)(dst + i / 2), Pack_AVX2(d));
+  }
+  fallback.BlendMaskChroma(dst + i / 2, mask + i, opacity, value, count - i);
+}
+
+void BlendAlpha_AVX2(uint8_t *dst, const uint8_t *value, const uint8_t *alpha, unsigned int count)
+{
+  unsigned int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m128i a8 = _mm_loadu_si128((const __m128i*)(alpha + i));
+    __m128i d8 = _mm_loadu_si128((const __m128i*)(dst + i));
+    __m256i a  = _mm256_cvtepu8_epi16(a8);
+    __m256i t  = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(d8), _mm256_sub_epi16(_mm256_set1_epi16(255), a)),
+                                  _mm256_mullo_epi16(Load16_AVX2(value + i), _mm256_add_epi16(a, _mm256_set1_epi16(1))));
+    /* transparent pixels keep the picture */
+    __m128i keep = _mm_cmpeq_epi8(a8, _mm_setzero_si128());
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_blendv_epi8(Pack_AVX2(_mm256_srli_epi16(t, 8)), d8, keep));
+  }
+  fallback.BlendAlpha(dst + i, value + i, alpha + i, count - i);
+}
+
+}
+
+bool OverlayBlendAVX2(OverlayBlendKernels &kernels)
+{
+  fallback = kernels;
+
+  kernels.name            = "AVX2";
+  kernels.BlendMask       = BlendMask_AVX2;
+  kernels.BlendMaskChroma = BlendMaskChroma_AVX2;
+  kernels.BlendAlpha      = BlendAlpha_AVX2;
+  return true;
+}
+
+#else
+
+bool OverlayBlendAVX2(OverlayBlendKernels &kernels)
+{
+  return false;
+}
+
+#endif
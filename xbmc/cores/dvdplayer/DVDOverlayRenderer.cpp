@@ -20,12 +20,15 @@
 
 #include "utils/log.h"
 #include "DVDOverlayRenderer.h"
+#include "DVDOverlayBlend.h"
 #include "DVDCodecs/Overlay/DVDOverlaySpu.h"
 #include "DVDCodecs/Overlay/DVDOverlayText.h"
 #include "DVDCodecs/Overlay/DVDOverlayImage.h"
 #include "DVDCodecs/Overlay/DVDOverlaySSA.h"
 #include "cores/VideoRenderers/OverlayRendererUtil.h"
 
+#include <vector>
+
 #define CLAMP(a, min, max) ((a) > (max) ? (max) : ( (a) < (min) ? (min) : a ))
 
 
@@ -74,6 +77,7 @@ void CDVDOverlayRenderer::Render(DVDPictureRenderer* pPicture, CDVDOverlaySSA* p
   ASS_Image* img = pOverlay->m_libass->RenderImage(width, height, pts);
 
   int depth = OVERLAY::GetStereoscopicDepth();
+  const OverlayBlendKernels &blend = CDVDOverlayBlend::Get();
 
   while(img)
   {
@@ -98,6 +102,8 @@ void CDVDOverlayRenderer::Render(DVDPictureRenderer* pPicture, CDVDOverlaySSA* p
 
     int y = std::max(0,std::min(img->dst_y, pPicture->height-img->h));
     int x = std::max(0,std::min(img->dst_x + depth, pPicture->width-img->w));
+    int w = std::min(img->w, pPicture->width - x);
+    uint8_t opacity = 255 - alpha;
 
     for(int i=0; i<img->h; i++)
     {
@@ -111,22 +117,10 @@ void CDVDOverlayRenderer::Render(DVDPictureRenderer* pPicture, CDVDOverlaySSA* p
       target[1] = pPicture->data[1] + pPicture->stride[1]*((i + y)>>1) + (x>>1);
       target[2] = pPicture->data[2] + pPicture->stride[2]*((i + y)>>1) + (x>>1);
 
-      for(int j=0; j<img->w; j++)
-      {
-        if(x + j >= pPicture->width)
-          break;
-
-        unsigned char index, opacity, k;
-        index = line[j];
-
-        //Blend the image with the underlying picture
-        opacity = 255 - alpha;
-        k = (unsigned char)index * opacity / 255;
-
-        target[0][j]    = (k*luma + (255-k)*target[0][j])/255;
-        target[1][j>>1] = (k*u    + (255-k)*target[1][j>>1])/255;
-        target[2][j>>1] = (k*v    + (255-k)*target[2][j>>1])/255;
-      }
+      //Blend the image with the underlying picture
+      blend.BlendMask      (target[0], line, opacity, luma, w);
+      blend.BlendMaskChroma(target[1], line, opacity, u,    w);
+      blend.BlendMaskChroma(target[2], line, opacity, v,    w);
     }
     img = img->next;
   }
@@ -156,10 +150,21 @@ void CDVDOverlayRenderer::Render(DVDPictureRenderer* pPicture, CDVDOverlayImage*
   // we try o fit it in if it's outside the image
   int y = std::max(0,std::min(pOverlay->y, pPicture->height-pOverlay->height));
   int x = std::max(0,std::min(pOverlay->x, pPicture->width-pOverlay->width));
+  int w = std::min(pOverlay->width, pPicture->width - x);
+  int invalid = 0;
+
+  // the palette is looked up a line at a time, then blended as a whole
+  const OverlayBlendKernels &blend = CDVDOverlayBlend::Get();
+  std::vector<uint8_t> values[3];
+  std::vector<uint8_t> alpha[2];
+  for(int i=0;i<3;i++)
+    values[i].resize(std::max(w, 1));
+  for(int i=0;i<2;i++)
+    alpha[i].resize(std::max(w, 1));
 
   for(int i=0;i<pOverlay->height;i++)
   {
-    if(y + i >= pPicture->height)
+    if(y + i >= pPicture->height || w <= 0)
       break;
 
     uint8_t* line = pOverlay->data + pOverlay->linesize*i;
@@ -169,33 +174,43 @@ void CDVDOverlayRenderer::Render(DVDPictureRenderer* pPicture, CDVDOverlayImage*
     target[1] = pPicture->data[1] + pPicture->stride[1]*((i + y)>>1) + (x>>1);
     target[2] = pPicture->data[2] + pPicture->stride[2]*((i + y)>>1) + (x>>1);
 
-    for(int j=0;j<pOverlay->width;j++)
+    for(int j=0;j<w;j++)
     {
-      if(x + j >= pPicture->width)
-        break;
-
       unsigned char index = line[j];
-      if(index > pOverlay->palette_colors)
+      if(index >= pOverlay->palette_colors)
       {
-        CLog::Log(LOGWARNING, "%s - out of range color index %u", __FUNCTION__, index);
+        invalid++;
+        alpha[0][j] = 0;
         continue;
       }
+      values[0][j] = palette[0][index];
+      alpha[0][j]  = palette[3][index];
+    }
+    blend.BlendAlpha(target[0], &values[0][0], &alpha[0][0], w);
 
-      if(palette[3][index] == 0)
-        continue;
-
-      int s_blend = palette[3][index] + 1;
-      int t_blend = 256 - s_blend;
+    // chroma is taken from the even pixels of the even lines
+    if(i & 1)
+      continue;
 
-      target[0][j] = (target[0][j] * t_blend + palette[0][index] * s_blend) >> 8;
-      if(!(1&(i|j)))
+    for(int j=0;j<w;j+=2)
+    {
+      unsigned char index = line[j];
+      if(index >= pOverlay->palette_colors)
       {
-        target[1][j>>1] = (target[1][j>>1] * t_blend + palette[1][index] * s_blend) >> 8;
-        target[2][j>>1] = (target[2][j>>1] * t_blend + palette[2][index] * s_blend) >> 8;
+        alpha[1][j>>1] = 0;
+        continue;
       }
+      values[1][j>>1] = palette[1][index];
+      values[2][j>>1] = palette[2][index];
+      alpha[1][j>>1]  = palette[3][index];
     }
-
+    blend.BlendAlpha(target[1], &values[1][0], &alpha[1][0], (w + 1) >> 1);
+    blend.BlendAlpha(target[2], &values[2][0], &alpha[1][0], (w + 1) >> 1);
   }
+
+  if(invalid)
+    CLog::Log(LOGWARNING, "%s - %d pixels with out of range color index", __FUNCTION__, invalid);
+
   for(int i=0;i<4;i++)
     free(palette[i]);
 }
@@ -1435,6 +1435,8 @@ std::string CDVDPlayerVideo::GetPlayerInfo()
   s << ", Mb/s:" << fixed << setprecision(2) << (double)GetVideoBitrate() / (1024.0*1024.0);
   s << ", drop:" << m_iDroppedFrames;
   s << ", skip:" << g_renderManager.GetSkippedFrames();
+  s << ", late:" << g_renderManager.GetLateFrames();
+  s << ", rq:"   << g_renderManager.GetQueueDepth() << "/" << g_renderManager.GetQueueSize();
 
   int pc = m_pullupCorrection.GetPatternLength();
   if (pc > 0)
@@ -0,0 +1,271 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DVDMessageQueue.h"
+#include "DVDClock.h"
+#include "DVDDemuxers/DVDDemuxUtils.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace
+{
+struct TracePacket
+{
+  int    size;
+  double dts;
+};
+
+/* A packet trace shaped like the video stream of a 25fps H.264 broadcast:
+ * a 12 frame IBBP GOP at roughly 8 Mbit/s. */
+std::vector<TracePacket> CreateTrace(unsigned int packets)
+{
+  static const int gop[] = { 150000, 12000, 12000, 40000, 12000, 12000,
+                             40000,  12000, 12000, 40000, 12000, 12000 };
+  std::vector<TracePacket> trace(packets);
+  for (unsigned int i = 0; i < packets; i++)
+  {
+    trace[i].size = gop[i % (sizeof(gop) / sizeof(gop[0]))];
+    trace[i].dts  = i * DVD_TIME_BASE / 25.0;
+  }
+  return trace;
+}
+
+CDVDMsg* CreatePacket(int size, double dts, int index)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(0);
+  packet->iSize     = size;
+  packet->dts       = dts;
+  packet->iStreamId = index;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+int PacketIndex(CDVDMsg* msg)
+{
+  if (!msg->IsType(CDVDMsg::DEMUXER_PACKET))
+    return -1;
+  return ((CDVDMsgDemuxerPacket*)msg)->GetPacket()->iStreamId;
+}
+
+/* Decoder side of the replay, pulls messages until it has seen every
+ * packet and checks they arrive in the order they were put. */
+class CReplayConsumer : public CThread
+{
+public:
+  CReplayConsumer(CDVDMessageQueue &queue, int packets) :
+    CThread("ReplayConsumer"),
+    m_queue(queue),
+    m_packets(packets),
+    m_received(0),
+    m_outOfOrder(0)
+  {
+  }
+
+  void Process()
+  {
+    while (m_received < m_packets)
+    {
+      CDVDMsg* msg;
+      if (m_queue.Get(&msg, 1000) != MSGQ_OK)
+        break;
+      int index = PacketIndex(msg);
+      if (index >= 0)
+      {
+        if (index != m_received)
+          m_outOfOrder++;
+        m_received++;
+      }
+      msg->Release();
+    }
+  }
+
+  CDVDMessageQueue &m_queue;
+  int m_packets;
+  int m_received;
+  int m_outOfOrder;
+};
+
+void ReplayTrace(unsigned int packets, unsigned int controlInterval)
+{
+  std::vector<TracePacket> trace = CreateTrace(packets);
+  CDVDMessageQueue queue("replay");
+  queue.Init();
+
+  CReplayConsumer consumer(queue, packets);
+  consumer.Create();
+
+  int64_t start = CurrentHostCounter();
+  for (unsigned int i = 0; i < packets; i++)
+  {
+    queue.Put(CreatePacket(trace[i].size, trace[i].dts, i));
+    if (controlInterval && i % controlInterval == 0)
+      queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  }
+  consumer.StopThread(true);
+  int64_t elapsed = CurrentHostCounter() - start;
+
+  EXPECT_EQ((int)packets, consumer.m_received);
+  EXPECT_EQ(0, consumer.m_outOfOrder);
+  EXPECT_EQ(0, queue.GetDataSize());
+
+  double seconds = (double)elapsed / (double)CurrentHostFrequency();
+  std::cout << "Packets: " << testing::PrintToString(packets) << std::endl;
+  std::cout << "  Control every: " << testing::PrintToString(controlInterval) << std::endl;
+  std::cout << "  Packets/sec: " << testing::PrintToString(packets / seconds) << std::endl;
+  std::cout << "  Time per packet (ns): " << testing::PrintToString(seconds * 1000000000.0 / packets) << std::endl;
+  queue.End();
+}
+}
+
+class TestDVDMessageQueue : public testing::Test
+{
+protected:
+  TestDVDMessageQueue() : m_queue("test")
+  {
+    m_queue.Init();
+  }
+  ~TestDVDMessageQueue()
+  {
+    m_queue.End();
+  }
+
+  CDVDMessageQueue m_queue;
+};
+
+TEST_F(TestDVDMessageQueue, PacketAccounting)
+{
+  m_queue.Put(CreatePacket(100, DVD_TIME_BASE, 0));
+  m_queue.Put(CreatePacket(200, 2 * DVD_TIME_BASE, 1));
+  m_queue.Put(CreatePacket(300, 3 * DVD_TIME_BASE, 2));
+  EXPECT_EQ(600, m_queue.GetDataSize());
+  EXPECT_EQ(2, m_queue.GetTimeSize());
+  EXPECT_EQ(3U, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  CDVDMsg* msg;
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+  EXPECT_EQ(0, PacketIndex(msg));
+  msg->Release();
+  EXPECT_EQ(500, m_queue.GetDataSize());
+  EXPECT_EQ(2U, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  m_queue.Flush();
+  EXPECT_EQ(0, m_queue.GetDataSize());
+  EXPECT_EQ(0U, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+  EXPECT_EQ(MSGQ_TIMEOUT, m_queue.Get(&msg, 0));
+}
+
+TEST_F(TestDVDMessageQueue, ControlMessagesKeepOrder)
+{
+  m_queue.Put(CreatePacket(100, DVD_NOPTS_VALUE, 0));
+  m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_RESYNC));
+  m_queue.Put(CreatePacket(100, DVD_NOPTS_VALUE, 1));
+  m_queue.Put(new CDVDMsg(CDVDMsg::GENERAL_FLUSH), 1);
+
+  CDVDMsg* msg;
+  int priority = 0;
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_FLUSH));
+  EXPECT_EQ(1, priority);
+  msg->Release();
+
+  priority = 0;
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0, priority));
+  EXPECT_EQ(0, PacketIndex(msg));
+  msg->Release();
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0, priority));
+  EXPECT_TRUE(msg->IsType(CDVDMsg::GENERAL_RESYNC));
+  msg->Release();
+  ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0, priority));
+  EXPECT_EQ(1, PacketIndex(msg));
+  msg->Release();
+
+  priority = 1;
+  m_queue.Put(CreatePacket(100, DVD_NOPTS_VALUE, 2));
+  EXPECT_EQ(MSGQ_TIMEOUT, m_queue.Get(&msg, 0, priority));
+}
+
+TEST_F(TestDVDMessageQueue, RingOverflow)
+{
+  const int packets = MSGQ_RING_SIZE * 3;
+  for (int i = 0; i < packets; i++)
+    m_queue.Put(CreatePacket(10, DVD_NOPTS_VALUE, i));
+  EXPECT_EQ(packets * 10, m_queue.GetDataSize());
+  EXPECT_EQ((unsigned)packets, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+
+  for (int i = 0; i < packets; i++)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+    EXPECT_EQ(i, PacketIndex(msg));
+    msg->Release();
+  }
+  EXPECT_EQ(0, m_queue.GetDataSize());
+}
+
+TEST_F(TestDVDMessageQueue, TimeLevel)
+{
+  m_queue.SetMaxDataSize(1000000);
+  m_queue.SetMaxTimeSize(4.0);
+
+  // the level starts at the first timestamp put
+  m_queue.Put(CreatePacket(10, DVD_NOPTS_VALUE, 0));
+  EXPECT_TRUE(m_queue.IsDataBased());
+  for (int i = 1; i <= 2; i++)
+    m_queue.Put(CreatePacket(10, i * DVD_TIME_BASE, i));
+  EXPECT_FALSE(m_queue.IsDataBased());
+  EXPECT_EQ(1, m_queue.GetTimeSize());
+  EXPECT_EQ(25, m_queue.GetLevel());
+
+  // then at the last one taken
+  for (int i = 0; i < 3; i++)
+  {
+    CDVDMsg* msg;
+    ASSERT_EQ(MSGQ_OK, m_queue.Get(&msg, 0));
+    msg->Release();
+  }
+  EXPECT_TRUE(m_queue.IsDataBased());
+  m_queue.Put(CreatePacket(10, 4 * DVD_TIME_BASE, 3));
+  EXPECT_EQ(2, m_queue.GetTimeSize());
+
+  // a flush resets the times and the ring takes packets again
+  m_queue.Flush();
+  EXPECT_EQ(0, m_queue.GetDataSize());
+  EXPECT_TRUE(m_queue.IsDataBased());
+  m_queue.Put(CreatePacket(10, 10 * DVD_TIME_BASE, 4));
+  m_queue.Put(CreatePacket(10, 12 * DVD_TIME_BASE, 5));
+  EXPECT_EQ(2, m_queue.GetTimeSize());
+  EXPECT_EQ(2u, m_queue.GetPacketCount(CDVDMsg::DEMUXER_PACKET));
+}
+
+/* Replays the packet trace from a producer to a decoder thread, with and
+ * without control messages mixed into the stream. */
+TEST(TestDVDMessageQueueBenchmark, Replay100k)
+{
+  ReplayTrace(100000, 0);
+}
+
+TEST(TestDVDMessageQueueBenchmark, Replay100kWithControl)
+{
+  ReplayTrace(100000, 50);
+}
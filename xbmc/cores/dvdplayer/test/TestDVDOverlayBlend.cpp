@@ -0,0 +1,175 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "cores/dvdplayer/DVDOverlayBlend.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+std::vector<uint8_t> RandomBytes(unsigned int count)
+{
+  std::vector<uint8_t> bytes(count);
+  for (unsigned int i = 0; i < count; i++)
+    bytes[i] = rand() & 0xff;
+  return bytes;
+}
+
+/* counts that exercise the vector loops and every tail length */
+const unsigned int counts[] = { 0, 1, 2, 3, 15, 16, 17, 31, 32, 33, 47, 64, 1021 };
+
+std::vector<const OverlayBlendKernels*> SimdKernels()
+{
+  std::vector<const OverlayBlendKernels*> sets;
+  for (int i = OVERLAY_BLEND_C + 1; i < OVERLAY_BLEND_MAX; i++)
+  {
+    if (CDVDOverlayBlend::Get((OverlayBlendSet)i))
+      sets.push_back(CDVDOverlayBlend::Get((OverlayBlendSet)i));
+  }
+  return sets;
+}
+}
+
+TEST(TestDVDOverlayBlend, Reference)
+{
+  const OverlayBlendKernels *c = CDVDOverlayBlend::Get(OVERLAY_BLEND_C);
+  ASSERT_TRUE(c != NULL);
+
+  uint8_t mask[] = { 0, 255, 255, 128 };
+  uint8_t dst[]  = { 100, 100, 100, 100 };
+  c->BlendMask(dst, mask, 255, 200, 4);
+  EXPECT_EQ(100, dst[0]);
+  EXPECT_EQ(200, dst[1]);
+  EXPECT_EQ(200, dst[2]);
+  EXPECT_EQ((128 * 200 + 127 * 100) / 255, dst[3]);
+
+  // every pixel of a pair blends into the same chroma sample
+  uint8_t chroma[] = { 100, 100 };
+  c->BlendMaskChroma(chroma, mask, 255, 200, 4);
+  EXPECT_EQ(200, chroma[0]);
+  EXPECT_EQ((128 * 200 + 127 * 200) / 255, chroma[1]);
+
+  uint8_t value[] = { 200, 200, 200 };
+  uint8_t alpha[] = { 0, 255, 127 };
+  uint8_t image[] = { 100, 100, 100 };
+  c->BlendAlpha(image, value, alpha, 3);
+  EXPECT_EQ(100, image[0]);
+  EXPECT_EQ(200, image[1]);
+  EXPECT_EQ((100 * 128 + 200 * 128) >> 8, image[2]);
+}
+
+TEST(TestDVDOverlayBlend, Kernels)
+{
+  const OverlayBlendKernels *c = CDVDOverlayBlend::Get(OVERLAY_BLEND_C);
+  std::vector<const OverlayBlendKernels*> sets = SimdKernels();
+
+  for (unsigned int s = 0; s < sets.size(); s++)
+  {
+    SCOPED_TRACE(sets[s]->name);
+    for (unsigned int n = 0; n < sizeof(counts) / sizeof(counts[0]); n++)
+    {
+      unsigned int count = counts[n];
+      std::vector<uint8_t> picture = RandomBytes(count + 1);
+      std::vector<uint8_t> mask    = RandomBytes(count + 1);
+      std::vector<uint8_t> value   = RandomBytes(count + 1);
+      std::vector<uint8_t> alpha   = RandomBytes(count + 1);
+      for (unsigned int i = 0; i < count; i += 3)
+        alpha[i] = 0;
+
+      std::vector<uint8_t> a(picture), b(picture);
+      c->BlendMask(&a[0], &mask[0], 200, 17, count);
+      sets[s]->BlendMask(&b[0], &mask[0], 200, 17, count);
+      for (unsigned int i = 0; i <= count; i++)
+        ASSERT_EQ(a[i], b[i]);
+
+      a = picture; b = picture;
+      c->BlendMaskChroma(&a[0], &mask[0], 255, 240, count);
+      sets[s]->BlendMaskChroma(&b[0], &mask[0], 255, 240, count);
+      for (unsigned int i = 0; i <= count; i++)
+        ASSERT_EQ(a[i], b[i]);
+
+      a = picture; b = picture;
+      c->BlendAlpha(&a[0], &value[0], &alpha[0], count);
+      sets[s]->BlendAlpha(&b[0], &value[0], &alpha[0], count);
+      for (unsigned int i = 0; i <= count; i++)
+        ASSERT_EQ(a[i], b[i]);
+    }
+  }
+}
+
+/* Replays a karaoke like libass frame, four lines of glyphs each drawn as
+ * fill, outline and shadow image, onto a 1080p and a 2160p YV12 surface. */
+TEST(TestDVDOverlayBlendBenchmark, FramesPerSecond)
+{
+  static const int sizes[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+  static const int passes = 50;
+
+  for (int set = 0; set < OVERLAY_BLEND_MAX; set++)
+  {
+    const OverlayBlendKernels *k = CDVDOverlayBlend::Get((OverlayBlendSet)set);
+    if (!k)
+      continue;
+
+    for (unsigned int n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++)
+    {
+      int width  = sizes[n][0];
+      int height = sizes[n][1];
+      int glyphW = width / 40;
+      int glyphH = height / 15;
+
+      std::vector<uint8_t> planes[3];
+      planes[0] = RandomBytes(width * height);
+      planes[1] = RandomBytes(width * height / 4);
+      planes[2] = RandomBytes(width * height / 4);
+      std::vector<uint8_t> glyph = RandomBytes(glyphW * glyphH);
+
+      int64_t start = CurrentHostCounter();
+      for (int p = 0; p < passes; p++)
+      {
+        for (int line = 0; line < 4; line++)
+        {
+          int y0 = height - (4 - line) * glyphH * 5 / 4;
+          for (int layer = 0; layer < 3; layer++)
+          {
+            for (int x0 = width / 10; x0 + glyphW < width * 9 / 10; x0 += glyphW)
+            {
+              for (int i = 0; i < glyphH; i++)
+              {
+                int y = y0 + i;
+                const uint8_t *mask = &glyph[i * glyphW];
+                k->BlendMask      (&planes[0][y * width + x0], mask, 255 - layer * 40, 235, glyphW);
+                k->BlendMaskChroma(&planes[1][(y >> 1) * (width >> 1) + (x0 >> 1)], mask, 255 - layer * 40, 90, glyphW);
+                k->BlendMaskChroma(&planes[2][(y >> 1) * (width >> 1) + (x0 >> 1)], mask, 255 - layer * 40, 160, glyphW);
+              }
+            }
+          }
+        }
+      }
+      double seconds = (double)(CurrentHostCounter() - start) / (double)CurrentHostFrequency();
+
+      std::cout << k->name << " " << width << "x" << height
+                << " frames/sec: " << testing::PrintToString(passes / seconds) << std::endl;
+    }
+  }
+}
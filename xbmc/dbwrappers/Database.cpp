@@ -234,6 +234,25 @@ bool CDatabase::ExecuteQuery(const CStdString &strQuery)
   return bReturn;
 }
 
+int CDatabase::ExecuteBatch(const std::string &strQuery, dbiplus::bind_source &rows)
+{
+  int iReturn = -1;
+
+  try
+  {
+    if (NULL == m_pDB.get()) return iReturn;
+    if (NULL == m_pDS.get()) return iReturn;
+    iReturn = m_pDS->exec_batch(strQuery, rows);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s - failed to execute query '%s'",
+        __FUNCTION__, strQuery.c_str());
+  }
+
+  return iReturn;
+}
+
 bool CDatabase::ResultQuery(const CStdString &strQuery)
 {
   bool bReturn = false;
@@ -669,7 +688,7 @@ void CDatabase::RollbackTransaction()
 
 bool CDatabase::InTransaction()
 {
-  if (NULL != m_pDB.get()) return false;
+  if (NULL == m_pDB.get()) return false;
   return m_pDB->in_transaction();
 }
 
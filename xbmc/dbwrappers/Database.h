@@ -25,6 +25,7 @@
 namespace dbiplus {
   class Database;
   class Dataset;
+  class bind_source;
 }
 
 #include <memory>
@@ -110,6 +111,15 @@ public:
    */
   bool ExecuteQuery(const CStdString &strQuery);
 
+  /*!
+   * @brief Execute an INSERT or REPLACE query for every row of a batch, within a
+   *        single transaction unless one is running already.
+   * @param strQuery The query, with '?' placeholders in its VALUES clause.
+   * @param rows Supplies the values of the rows.
+   * @return The number of rows written or -1 if the query failed.
+   */
+  int ExecuteBatch(const std::string &strQuery, dbiplus::bind_source &rows);
+
   /*!
    * @brief Execute a query that returns a result.
    * @remarks Call m_pDS->close(); to clean up the dataset when done.
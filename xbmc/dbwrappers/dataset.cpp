@@ -39,7 +39,7 @@ using namespace std;
 namespace dbiplus {
 //************* Database implementation ***************
 
-Database::Database() {
+Database::Database() : bind_cache(DB_STATEMENT_CACHE_SIZE) {
   active = false;	// No connection yet
   error = "";//S_NO_CONNECTION;
   host = "";
@@ -81,6 +81,60 @@ string Database::prepare(const char *format, ...)
   return result;
 }
 
+string Database::bind(const string &sql, const BindList &params)
+{
+  vector<string> *parts = bind_cache.find(sql);
+  vector<string> split;
+  if (parts == NULL)
+  {
+    // split the statement at every placeholder not within a string literal
+    bool literal = false;
+    size_t start = 0;
+    for (size_t pos = 0; pos < sql.size(); pos++)
+    {
+      if (sql[pos] == '\'')
+        literal = !literal;
+      else if (sql[pos] == '?' && !literal)
+      {
+        split.push_back(sql.substr(start, pos - start));
+        start = pos + 1;
+      }
+    }
+    split.push_back(sql.substr(start));
+
+    vector<string> evicted;
+    bind_cache.insert(sql, split, evicted);
+    parts = &split;
+  }
+
+  if (parts->size() != params.size() + 1)
+    throw DbErrors("Wrong number of bound parameters\nQuery: %s", sql.c_str());
+
+  string result = parts->at(0);
+  for (size_t i = 0; i < params.size(); i++)
+  {
+    const field_value &value = params[i];
+    if (value.get_isNull())
+      result += "NULL";
+    else if (value.get_fType() == ft_String)
+      result += prepare("'%s'", value.get_asString().c_str());
+    else if (value.get_fType() == ft_Boolean)
+      result += value.get_asBool() ? "1" : "0";
+    else if (value.get_fType() == ft_Float || value.get_fType() == ft_Double)
+    {
+      // get_asString() only keeps 6 decimals
+      char number[32];
+      sprintf(number, "%.17g", value.get_asDouble());
+      result += number;
+    }
+    else
+      result += value.get_asString();
+    result += parts->at(i + 1);
+  }
+
+  return result;
+}
+
 //************* Dataset implementation ***************
 
 Dataset::Dataset() {
@@ -215,6 +269,63 @@ bool Dataset::seek(int pos) {
 }
 
 
+bool Dataset::query(const std::string &sql, const BindList &params) {
+  return query(db->bind(sql, params).c_str());
+}
+
+int Dataset::exec(const std::string &sql, const BindList &params) {
+  return exec(db->bind(sql, params));
+}
+
+int Dataset::exec_batch(const std::string &sql, bind_source &rows) {
+  // the VALUES tuple is repeated for every row of a multi row statement
+  size_t values = sql.rfind("VALUES");
+  size_t start = values == string::npos ? string::npos : sql.find('(', values);
+  size_t end = sql.rfind(')');
+  if (start == string::npos || end == string::npos || end < start)
+    throw DbErrors("Batch statements need a VALUES tuple\nQuery: %s", sql.c_str());
+
+  const string head = sql.substr(0, start);
+  const string tuple = sql.substr(start, end - start + 1);
+
+  bool own_transaction = !db->in_transaction();
+  if (own_transaction)
+    db->start_transaction();
+
+  int count = 0;
+  try
+  {
+    BindList params;
+    string statement;
+    while (rows.next(params))
+    {
+      statement += statement.empty() ? head : ", ";
+      statement += db->bind(tuple, params);
+      params.clear();
+      count++;
+
+      if (statement.size() >= DB_BATCH_MAX_SIZE)
+      {
+        exec(statement);
+        statement.clear();
+      }
+    }
+
+    if (!statement.empty())
+      exec(statement);
+  }
+  catch (...)
+  {
+    if (own_transaction)
+      db->rollback_transaction();
+    throw;
+  }
+
+  if (own_transaction)
+    db->commit_transaction();
+  return count;
+}
+
 void Dataset::refresh() {
   int row = frecno;
   if ((row != 0) && active) {
@@ -34,6 +34,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
 #include "qry_dat.h"
 #include <stdarg.h>
 
@@ -60,6 +61,81 @@ class Dataset;		// forward declaration of class Dataset
 #define DB_UNEXPECTED		7	// This shouldn't ever happen
 #define DB_UNEXPECTED_RESULT   -1       //For integer functions
 
+#define DB_STATEMENT_CACHE_SIZE 64      //Prepared statements kept per connection
+#define DB_BATCH_MAX_SIZE      524288   //Length at which multi row statements are split
+
+/* Values bound to the '?' placeholders of a prepared statement, in order */
+typedef std::vector<field_value> BindList;
+
+/******************* Class bind_source definition *****************
+
+   supplies the rows of a batch one at a time, so the caller doesn't
+   have to copy them into a list first
+
+******************************************************************/
+class bind_source {
+public:
+  virtual ~bind_source() {}
+/* fills the empty params with the values of the next row, returns false
+   when there are no rows left */
+  virtual bool next(BindList &params) = 0;
+};
+
+/******************* Class lru_cache definition *******************
+
+   keeps the most recently used prepared statements of a connection,
+   keyed by their sql
+
+******************************************************************/
+template<class T>
+class lru_cache {
+public:
+  lru_cache(size_t max_size) : max_size(max_size), hits(0), misses(0) {}
+
+/* returns the cached value for key and marks it as most recently used */
+  T *find(const std::string &key) {
+    typename index_map::iterator it = index.find(key);
+    if (it == index.end()) {
+      misses++;
+      return NULL;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return &it->second->second;
+  }
+/* adds a value, returns true if the least recently used value had to be
+   dropped to make room for it and passes it back in evicted */
+  bool insert(const std::string &key, const T &value, T &evicted) {
+    entries.push_front(std::make_pair(key, value));
+    index[key] = entries.begin();
+    if (entries.size() <= max_size)
+      return false;
+    return pop(evicted);
+  }
+/* removes the least recently used value */
+  bool pop(T &value) {
+    if (entries.empty())
+      return false;
+    value = entries.back().second;
+    index.erase(entries.back().first);
+    entries.pop_back();
+    return true;
+  }
+  size_t size() const { return entries.size(); }
+
+  unsigned int get_hits() const { return hits; }
+  unsigned int get_misses() const { return misses; }
+
+private:
+  typedef std::list<std::pair<std::string, T> > entry_list;
+  typedef std::map<std::string, typename entry_list::iterator> index_map;
+
+  entry_list entries;
+  index_map index;
+  size_t max_size;
+  unsigned int hits, misses;
+};
+
 /******************* Class Database definition ********************
 
    represents  connection with database server;
@@ -165,8 +241,19 @@ public:
    */
   virtual std::string vprepare(const char *format, va_list args) = 0;
 
+  /*! \brief Substitute the values of params for the '?' placeholders in sql.
+   Used for backends without native prepared statements, the placeholder
+   positions of every statement are cached.
+   \param sql - SQL statement with '?' placeholders outside of string literals
+   \param params - values to substitute, strings are escaped and quoted.
+   \return escaped and formatted string.
+   */
+  virtual std::string bind(const std::string &sql, const BindList &params);
+
   virtual bool in_transaction() {return false;};
 
+protected:
+  lru_cache<std::vector<std::string> > bind_cache;
 };
 
 
@@ -310,6 +397,17 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const char *sql) = 0;
+/* prepared statements: sql uses '?' placeholders for the values in params.
+   Backends cache the prepared statement per connection so repeated queries
+   are only parsed once */
+  virtual bool query(const std::string &sql, const BindList &params);
+  virtual int  exec(const std::string &sql, const BindList &params);
+/* batches: executes the INSERT or REPLACE statement sql, which has '?'
+   placeholders in its single VALUES tuple, for every row of rows within one
+   transaction (unless one is already running). Backends either reuse a
+   prepared statement or send multi row statements. Returns the number of
+   rows written */
+  virtual int  exec_batch(const std::string &sql, bind_source &rows);
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
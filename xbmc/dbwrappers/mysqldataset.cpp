@@ -1315,10 +1315,12 @@ MYSQL* MysqlDataset::handle(){
 void MysqlDataset::make_query(StringList &_sql) {
   string query;
   int result = 0;
+  bool own_transaction = false;
   if (db == NULL) throw DbErrors("No Database Connection");
   try
   {
-    if (autocommit) db->start_transaction();
+    own_transaction = autocommit && !db->in_transaction();
+    if (own_transaction) db->start_transaction();
 
     for (list<string>::iterator i =_sql.begin(); i!=_sql.end(); i++)
     {
@@ -1330,7 +1332,7 @@ void MysqlDataset::make_query(StringList &_sql) {
       }
     } // end of for
 
-    if (db->in_transaction() && autocommit) db->commit_transaction();
+    if (own_transaction) db->commit_transaction();
 
     active = true;
     ds_state = dsSelect;
@@ -1339,7 +1341,7 @@ void MysqlDataset::make_query(StringList &_sql) {
   } // end of try
   catch(...)
   {
-    if (db->in_transaction()) db->rollback_transaction();
+    if (own_transaction) db->rollback_transaction();
     throw;
   }
 
@@ -150,6 +150,9 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+/* prepared statements are bound by Dataset through Database::bind() */
+  using Dataset::exec;
+  using Dataset::query;
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -88,7 +88,7 @@ static int busy_callback(void*, int busyCount)
 
 //************* SqliteDatabase implementation ***************
 
-SqliteDatabase::SqliteDatabase() {
+SqliteDatabase::SqliteDatabase() : statements(DB_STATEMENT_CACHE_SIZE) {
 
   active = false;  
   _in_transaction = false;    // for transaction
@@ -193,6 +193,8 @@ int SqliteDatabase::setErr(int err_code, const char * qry){
     break;
   case SQLITE_MISMATCH:  error = "Data type mismatch";
     break;
+  case SQLITE_RANGE: error = "Bind parameter out of range";
+    break;
   default : error = "Undefined SQLite error";
   }
   error += "\nQuery: ";
@@ -259,6 +261,8 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  // the connection can't be closed while statements are left
+  clear_statements();
   sqlite3_close(conn);
   active = false;
 }
@@ -414,6 +418,30 @@ void SqliteDatabase::rollback_transaction() {
 }
 
 
+sqlite3_stmt *SqliteDatabase::get_statement(const string &sql)
+{
+  sqlite3_stmt **cached = statements.find(sql);
+  if (cached != NULL)
+    return *cached;
+
+  sqlite3_stmt *stmt = NULL;
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+    return NULL;
+
+  sqlite3_stmt *evicted = NULL;
+  if (statements.insert(sql, stmt, evicted))
+    sqlite3_finalize(evicted);
+
+  return stmt;
+}
+
+void SqliteDatabase::clear_statements()
+{
+  sqlite3_stmt *stmt = NULL;
+  while (statements.pop(stmt))
+    sqlite3_finalize(stmt);
+}
+
 // methods for formatting
 // ---------------------------------------------
 string SqliteDatabase::vprepare(const char *format, va_list args)
@@ -486,10 +514,11 @@ sqlite3* SqliteDataset::handle(){
 void SqliteDataset::make_query(StringList &_sql) {
   string query;
   if (db == NULL) throw DbErrors("No Database Connection");
+  bool own_transaction = autocommit && !db->in_transaction();
 
  try {
 
-  if (autocommit) db->start_transaction();
+  if (own_transaction) db->start_transaction();
 
 
   for (list<string>::iterator i =_sql.begin(); i!=_sql.end(); i++) {
@@ -502,7 +531,7 @@ void SqliteDataset::make_query(StringList &_sql) {
   } // end of for
 
 
-  if (db->in_transaction() && autocommit) db->commit_transaction();
+  if (own_transaction) db->commit_transaction();
 
   active = true;
   ds_state = dsSelect;    
@@ -511,7 +540,7 @@ void SqliteDataset::make_query(StringList &_sql) {
 
  } // end of try
  catch(...) {
-  if (db->in_transaction()) db->rollback_transaction();
+  if (own_transaction) db->rollback_transaction();
   throw;
  }
 
@@ -652,6 +681,122 @@ bool SqliteDataset::query(const char *query) {
   if (db->setErr(sqlite3_prepare_v2(handle(),query,-1,&stmt, NULL),query) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
 
+  fetch_rows(stmt);
+
+  if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
+  {
+    active = true;
+    ds_state = dsSelect;
+    this->first();
+    return true;
+  }
+  else
+  {
+    throw DbErrors(db->getErrorMsg());
+  }  
+}
+
+bool SqliteDataset::query(const string &q){
+  return query(q.c_str());
+}
+
+bool SqliteDataset::query(const string &sql, const BindList &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+
+  close();
+
+  SqliteDatabase *database = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = database->get_statement(sql);
+  if (stmt == NULL)
+    throw DbErrors(db->getErrorMsg());
+
+  if (db->setErr(bind_params(stmt, params), sql.c_str()) != SQLITE_OK)
+  {
+    sqlite3_clear_bindings(stmt);
+    throw DbErrors(db->getErrorMsg());
+  }
+
+  fetch_rows(stmt);
+
+  // cached statements are only reset, the connection finalizes them
+  int res = sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (db->setErr(res, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
+}
+
+int SqliteDataset::exec(const string &sql, const BindList &params) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  SqliteDatabase *database = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = database->get_statement(sql);
+  if (stmt == NULL)
+    throw DbErrors(db->getErrorMsg());
+
+  int res = bind_params(stmt, params);
+  if (res == SQLITE_OK)
+  {
+    while ((res = sqlite3_step(stmt)) == SQLITE_ROW) ;
+    // the error of a failed step is reported by reset
+    res = sqlite3_reset(stmt);
+  }
+  sqlite3_clear_bindings(stmt);
+
+  if (db->setErr(res, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return res;
+}
+
+int SqliteDataset::exec_batch(const string &sql, bind_source &rows) {
+  if (!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  SqliteDatabase *database = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = database->get_statement(sql);
+  if (stmt == NULL)
+    throw DbErrors(db->getErrorMsg());
+
+  // every row reuses the prepared statement, but only a transaction
+  // saves the sync to disk after every row
+  bool own_transaction = !db->in_transaction();
+  if (own_transaction)
+    db->start_transaction();
+
+  int count = 0;
+  int res = SQLITE_OK;
+  BindList params;
+  while (res == SQLITE_OK && rows.next(params))
+  {
+    res = bind_params(stmt, params);
+    if (res == SQLITE_OK)
+    {
+      while ((res = sqlite3_step(stmt)) == SQLITE_ROW) ;
+      res = sqlite3_reset(stmt);
+    }
+    sqlite3_clear_bindings(stmt);
+    params.clear();
+    count++;
+  }
+
+  if (db->setErr(res, sql.c_str()) != SQLITE_OK)
+  {
+    if (own_transaction)
+      db->rollback_transaction();
+    throw DbErrors(db->getErrorMsg());
+  }
+
+  if (own_transaction)
+    db->commit_transaction();
+  return count;
+}
+
+void SqliteDataset::fetch_rows(sqlite3_stmt *stmt) {
   // column headers
   const unsigned int numColumns = sqlite3_column_count(stmt);
   result.record_header.resize(numColumns);
@@ -689,21 +834,44 @@ bool SqliteDataset::query(const char *query) {
     }
     result.records.push_back(res);
   }
-  if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
+}
+
+int SqliteDataset::bind_params(sqlite3_stmt *stmt, const BindList &params) {
+  if ((int)params.size() != sqlite3_bind_parameter_count(stmt))
+    return SQLITE_RANGE;
+
+  int res = SQLITE_OK;
+  for (unsigned int i = 0; i < params.size() && res == SQLITE_OK; i++)
   {
-    active = true;
-    ds_state = dsSelect;
-    this->first();
-    return true;
+    const field_value &value = params[i];
+    const int index = i + 1;
+    if (value.get_isNull())
+    {
+      res = sqlite3_bind_null(stmt, index);
+      continue;
+    }
+
+    switch (value.get_fType())
+    {
+    case ft_String:
+    case ft_Char:
+    {
+      std::string str = value.get_asString();
+      res = sqlite3_bind_text(stmt, index, str.c_str(), str.size(), SQLITE_TRANSIENT);
+      break;
+    }
+    case ft_Float:
+    case ft_Double:
+    case ft_LongDouble:
+      res = sqlite3_bind_double(stmt, index, value.get_asDouble());
+      break;
+    default:
+      res = sqlite3_bind_int64(stmt, index, value.get_asInt64());
+      break;
+    }
   }
-  else
-  {
-    throw DbErrors(db->getErrorMsg());
-  }  
-}
 
-bool SqliteDataset::query(const string &q){
-  return query(q.c_str());
+  return res;
 }
 
 void SqliteDataset::open(const string &sql) {
@@ -45,6 +45,8 @@ protected:
   sqlite3 *conn;
   bool _in_transaction;
   int last_err;
+/* prepared statements of this connection */
+  lru_cache<sqlite3_stmt*> statements;
 
 public:
 /* default constructor */
@@ -97,6 +99,12 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* returns the prepared statement for sql, preparing it if it isn't cached.
+   The statement stays owned by the connection */
+  sqlite3_stmt *get_statement(const std::string &sql);
+/* finalizes all cached statements */
+  void clear_statements();
+
 };
 
 
@@ -128,6 +136,11 @@ protected:
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
 
+/* reads all rows of a stepped statement into the result set */
+  void fetch_rows(sqlite3_stmt *stmt);
+/* binds params to the placeholders of a prepared statement */
+  int bind_params(sqlite3_stmt *stmt, const BindList &params);
+
 public:
 /* constructor */
   SqliteDataset();
@@ -150,6 +163,10 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+/* prepared statements, see Dataset */
+  virtual bool query(const std::string &sql, const BindList &params);
+  virtual int  exec(const std::string &sql, const BindList &params);
+  virtual int  exec_batch(const std::string &sql, bind_source &rows);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
@@ -0,0 +1,287 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+#include "filesystem/File.h"
+#include "utils/TimeUtils.h"
+#include "utils/URIUtils.h"
+
+#include "test/TestUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+using namespace dbiplus;
+
+class TestSqliteDataset : public testing::Test
+{
+protected:
+  TestSqliteDataset()
+  {
+    m_file = XBMC_CREATETEMPFILE(".db");
+    CStdString path = XBMC_TEMPFILEPATH(m_file);
+    m_db.setHostName(URIUtils::GetDirectory(path).c_str());
+    m_db.setDatabase(URIUtils::GetFileName(path).c_str());
+    m_db.connect(true);
+
+    m_ds.reset(m_db.CreateDataset());
+    m_ds->exec("CREATE TABLE path (idPath integer primary key, strPath text, strHash text, rating double)");
+    m_ds->exec("CREATE UNIQUE INDEX ix_path ON path ( strPath(255) )");
+  }
+
+  ~TestSqliteDataset()
+  {
+    m_ds.reset();
+    m_db.disconnect();
+    XBMC_DELETETEMPFILE(m_file);
+  }
+
+  XFILE::CFile *m_file;
+  SqliteDatabase m_db;
+  std::auto_ptr<Dataset> m_ds;
+};
+
+/* numbered paths, generated while the batch reads them */
+class CPathRows : public bind_source
+{
+public:
+  CPathRows(const char *prefix, int rows, int duplicate = -1) :
+    m_prefix(prefix), m_rows(rows), m_row(0), m_duplicate(duplicate) {}
+
+  virtual bool next(BindList &params)
+  {
+    if (m_row >= m_rows)
+      return false;
+
+    // a duplicate path makes the batch fail on the unique index
+    int number = m_row == m_duplicate ? 0 : m_row;
+    char path[64];
+    sprintf(path, "%s %i/", m_prefix, number);
+    params.push_back(path);
+    params.push_back((double)m_row);
+    m_row++;
+    return true;
+  }
+
+private:
+  const char *m_prefix;
+  int m_rows;
+  int m_row;
+  int m_duplicate;
+};
+
+TEST(TestLruCache, Evict)
+{
+  lru_cache<int> cache(2);
+  int evicted = 0;
+  EXPECT_FALSE(cache.insert("a", 1, evicted));
+  EXPECT_FALSE(cache.insert("b", 2, evicted));
+
+  // "a" becomes the most recently used, so "b" is dropped next
+  ASSERT_TRUE(cache.find("a") != NULL);
+  EXPECT_TRUE(cache.insert("c", 3, evicted));
+  EXPECT_EQ(2, evicted);
+  EXPECT_TRUE(cache.find("b") == NULL);
+  EXPECT_EQ(1, *cache.find("a"));
+  EXPECT_EQ(3, *cache.find("c"));
+  EXPECT_EQ(3U, cache.get_hits());
+  EXPECT_EQ(1U, cache.get_misses());
+
+  EXPECT_TRUE(cache.pop(evicted));
+  EXPECT_EQ(1, evicted);
+  EXPECT_EQ(1U, cache.size());
+}
+
+TEST_F(TestSqliteDataset, PreparedStatements)
+{
+  BindList params;
+  params.push_back("smb://server/it's/");
+  params.push_back(field_value());
+  params.back().set_isNull();
+  params.push_back(7.25);
+  EXPECT_EQ(SQLITE_OK, m_ds->exec("INSERT INTO path (idPath, strPath, strHash, rating) VALUES (NULL, ?, ?, ?)", params));
+  int64_t idPath = m_ds->lastinsertid();
+
+  params.clear();
+  params.push_back("smb://server/it's/");
+  for (int i = 0; i < 3; i++)
+  {
+    // the second and third query run on the cached statement
+    ASSERT_TRUE(m_ds->query("SELECT * FROM path WHERE strPath=?", params));
+    ASSERT_EQ(1, m_ds->num_rows());
+    EXPECT_EQ(idPath, m_ds->fv("idPath").get_asInt64());
+    EXPECT_TRUE(m_ds->fv("strHash").get_isNull());
+    EXPECT_DOUBLE_EQ(7.25, m_ds->fv("rating").get_asDouble());
+    m_ds->close();
+  }
+
+  params.clear();
+  params.push_back("smb://server/missing/");
+  ASSERT_TRUE(m_ds->query("SELECT * FROM path WHERE strPath=?", params));
+  EXPECT_EQ(0, m_ds->num_rows());
+  m_ds->close();
+
+  // constraint violations are reported like for unprepared statements
+  params.clear();
+  params.push_back("smb://server/it's/");
+  EXPECT_THROW(m_ds->exec("INSERT INTO path (idPath, strPath) VALUES (NULL, ?)", params), DbErrors);
+
+  // wrong number of parameters
+  EXPECT_THROW(m_ds->query("SELECT * FROM path WHERE strPath=? AND idPath=?", params), DbErrors);
+}
+
+TEST_F(TestSqliteDataset, Bind)
+{
+  BindList params;
+  params.push_back("it's");
+  params.push_back(5);
+  params.push_back(true);
+  EXPECT_STREQ("SELECT * FROM path WHERE strPath='it''s' AND strHash='?' AND idPath=5 AND rating=1",
+               m_db.bind("SELECT * FROM path WHERE strPath=? AND strHash='?' AND idPath=? AND rating=?", params).c_str());
+
+  params.pop_back();
+  EXPECT_THROW(m_db.bind("SELECT * FROM path WHERE strPath=? AND strHash='?' AND idPath=? AND rating=?", params), DbErrors);
+}
+
+TEST_F(TestSqliteDataset, Batch)
+{
+  CPathRows rows("smb://server/batch", 100);
+  EXPECT_EQ(100, m_ds->exec_batch("INSERT INTO path (idPath, strPath, rating) VALUES (NULL, ?, ?)", rows));
+  EXPECT_FALSE(m_db.in_transaction());
+
+  ASSERT_TRUE(m_ds->query("SELECT * FROM path WHERE strPath='smb://server/batch 99/'"));
+  ASSERT_EQ(1, m_ds->num_rows());
+  EXPECT_DOUBLE_EQ(99.0, m_ds->fv("rating").get_asDouble());
+  m_ds->close();
+
+  // a failing row rolls back the whole batch
+  CPathRows failing("smb://server/failing", 100, 50);
+  EXPECT_THROW(m_ds->exec_batch("INSERT INTO path (idPath, strPath, rating) VALUES (NULL, ?, ?)", failing), DbErrors);
+  EXPECT_FALSE(m_db.in_transaction());
+  ASSERT_TRUE(m_ds->query("SELECT * FROM path WHERE strPath LIKE 'smb://server/failing%'"));
+  EXPECT_EQ(0, m_ds->num_rows());
+  m_ds->close();
+
+  // a batch within a transaction doesn't end it
+  m_db.start_transaction();
+  CPathRows rolledBack("smb://server/rolled back", 10);
+  EXPECT_EQ(10, m_ds->exec_batch("INSERT INTO path (idPath, strPath, rating) VALUES (NULL, ?, ?)", rolledBack));
+  EXPECT_TRUE(m_db.in_transaction());
+  m_db.rollback_transaction();
+  ASSERT_TRUE(m_ds->query("SELECT * FROM path WHERE strPath LIKE 'smb://server/rolled back%'"));
+  EXPECT_EQ(0, m_ds->num_rows());
+  m_ds->close();
+}
+
+TEST_F(TestSqliteDataset, MultiRowBatch)
+{
+  // the multi row statements other backends get, split in several statements
+  CPathRows rows("smb://server/a rather long path to make the statements grow beyond their size limit", 20000);
+  EXPECT_EQ(20000, m_ds->Dataset::exec_batch("REPLACE INTO path (idPath, strPath, rating) VALUES (NULL, ?, ?);", rows));
+
+  ASSERT_TRUE(m_ds->query("SELECT COUNT(*) AS paths, SUM(rating) AS ratings FROM path"));
+  EXPECT_EQ(20000, m_ds->fv("paths").get_asInt());
+  EXPECT_DOUBLE_EQ(19999.0 * 20000.0 / 2.0, m_ds->fv("ratings").get_asDouble());
+  m_ds->close();
+
+  CPathRows none("smb://server/none", 0);
+  EXPECT_EQ(0, m_ds->Dataset::exec_batch("REPLACE INTO path (idPath, strPath, rating) VALUES (NULL, ?, ?)", none));
+  EXPECT_THROW(m_ds->Dataset::exec_batch("DELETE FROM path", none), DbErrors);
+}
+
+TEST_F(TestSqliteDataset, BatchBenchmark)
+{
+  // roughly the changed tags of a full guide refresh of a few channels
+  const int rows = 20000;
+  int64_t start, queued, batched, multiRow;
+
+  // queued inserts are formatted one by one and parsed by sqlite one by one
+  start = CurrentHostCounter();
+  m_ds->insert();
+  for (int i = 0; i < rows; i++)
+    m_ds->add_insert_sql(m_db.prepare("REPLACE INTO path (idPath, strPath, rating) VALUES (NULL, 'smb://server/queued %i/', %i)", i, i));
+  m_ds->post();
+  m_ds->clear_insert_sql();
+  queued = CurrentHostCounter() - start;
+
+  CPathRows batchRows("smb://server/batched", rows);
+  start = CurrentHostCounter();
+  m_ds->exec_batch("REPLACE INTO path (idPath, strPath, rating) VALUES (NULL, ?, ?)", batchRows);
+  batched = CurrentHostCounter() - start;
+
+  CPathRows multiRows("smb://server/multi row", rows);
+  start = CurrentHostCounter();
+  m_ds->Dataset::exec_batch("REPLACE INTO path (idPath, strPath, rating) VALUES (NULL, ?, ?)", multiRows);
+  multiRow = CurrentHostCounter() - start;
+
+  std::cout << "Rows: " << testing::PrintToString(rows) << std::endl;
+  std::cout << "  Queued (rows/s): " << testing::PrintToString((double)rows * CurrentHostFrequency() / queued) << std::endl;
+  std::cout << "  Prepared batch (rows/s): " << testing::PrintToString((double)rows * CurrentHostFrequency() / batched) << std::endl;
+  std::cout << "  Multi row batch (rows/s): " << testing::PrintToString((double)rows * CurrentHostFrequency() / multiRow) << std::endl;
+}
+
+/* synthetic: a lookup/insert loop on a bare path table, modelled after the
+ * path lookups of a scan. It doesn't run the CVideoDatabase or CMusicDatabase
+ * queries, so it only compares formatted against prepared statements and says
+ * nothing about how much a real scan gains */
+TEST_F(TestSqliteDataset, Benchmark)
+{
+  const int paths = 5000;
+  const int lookups = 4;
+  int64_t start, formatted, prepared;
+
+  // every path is looked up a few times and added once, first with
+  // formatted sql which sqlite has to parse every time
+  m_db.start_transaction();
+  start = CurrentHostCounter();
+  for (int i = 0; i < paths; i++)
+  {
+    std::string path = m_db.prepare("smb://server/movies/formatted %i/", i);
+    for (int j = 0; j < lookups; j++)
+    {
+      m_ds->query(m_db.prepare("SELECT idPath FROM path WHERE strPath='%s'", path.c_str()).c_str());
+      m_ds->close();
+    }
+    m_ds->exec(m_db.prepare("INSERT INTO path (idPath, strPath) VALUES (NULL, '%s')", path.c_str()));
+  }
+  formatted = CurrentHostCounter() - start;
+  m_db.commit_transaction();
+
+  m_db.start_transaction();
+  start = CurrentHostCounter();
+  for (int i = 0; i < paths; i++)
+  {
+    BindList params;
+    params.push_back(m_db.prepare("smb://server/movies/prepared %i/", i).c_str());
+    for (int j = 0; j < lookups; j++)
+    {
+      m_ds->query("SELECT idPath FROM path WHERE strPath=?", params);
+      m_ds->close();
+    }
+    m_ds->exec("INSERT INTO path (idPath, strPath) VALUES (NULL, ?)", params);
+  }
+  prepared = CurrentHostCounter() - start;
+  m_db.commit_transaction();
+
+  std::cout << "Paths (synthetic): " << testing::PrintToString(paths) << std::endl;
+  std::cout << "  Formatted (ms): " << testing::PrintToString((double)formatted * 1000.0 / CurrentHostFrequency()) << std::endl;
+  std::cout << "  Prepared (ms): " << testing::PrintToString((double)prepared * 1000.0 / CurrentHostFrequency()) << std::endl;
+}
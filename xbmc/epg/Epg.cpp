@@ -99,6 +99,7 @@ CEpg &CEpg::operator =(const CEpg &right)
   {
     CEpgInfoTagPtr EITPtr (new CEpgInfoTag(*it->second));
     m_tags.insert(make_pair(it->first, EITPtr));
+    m_index.Add(*EITPtr);
   }
 
   return *this;
@@ -158,6 +159,7 @@ void CEpg::Clear(void)
 {
   CSingleLock lock(m_critSection);
   m_tags.clear();
+  m_index.Clear();
 }
 
 void CEpg::Cleanup(void)
@@ -178,6 +180,7 @@ void CEpg::Cleanup(const CDateTime &Time)
         m_nowActiveStart.SetValid(false);
 
       it->second->ClearTimer();
+      m_index.Remove(*it->second);
       m_tags.erase(it++);
     }
   }
@@ -200,8 +203,11 @@ bool CEpg::InfoTagNow(CEpgInfoTag &tag, bool bUpdateIfNeeded /* = true */)
   {
     CEpgInfoTagPtr lastActiveTag;
 
+    /* tags that ended more than 5 minutes ago can't match, skip them */
+    CDateTime firstStart = CDateTime::GetUTCDateTime() - CDateTimeSpan(0, 0, 5, m_index.MaxDuration());
+
     /* one of the first items will always match if the list is sorted */
-    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.lower_bound(firstStart); it != m_tags.end(); it++)
     {
       if (it->second->IsActive())
       {
@@ -241,7 +247,8 @@ bool CEpg::InfoTagNext(CEpgInfoTag &tag)
   else if (Size() > 0)
   {
     /* return the first event that is in the future */
-    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+    CSingleLock lock(m_critSection);
+    for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.upper_bound(CDateTime::GetUTCDateTime()); it != m_tags.end(); it++)
     {
       if (it->second->InTheFuture())
       {
@@ -288,9 +295,9 @@ CEpgInfoTagPtr CEpg::GetTag(const CDateTime &StartTime) const
 CEpgInfoTagPtr CEpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &endTime) const
 {
   CSingleLock lock(m_critSection);
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.lower_bound(beginTime); it != m_tags.end() && it->first <= endTime; it++)
   {
-    if (it->second->StartAsUTC() >= beginTime && it->second->EndAsUTC() <= endTime)
+    if (it->second->EndAsUTC() <= endTime)
       return it->second;
   }
 
@@ -301,9 +308,11 @@ CEpgInfoTagPtr CEpg::GetTagBetween(const CDateTime &beginTime, const CDateTime &
 CEpgInfoTagPtr CEpg::GetTagAround(const CDateTime &time) const
 {
   CSingleLock lock(m_critSection);
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+  /* no tag that started before this one can last until the given time */
+  CDateTime firstStart = time - CDateTimeSpan(0, 0, 0, m_index.MaxDuration());
+  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.lower_bound(firstStart); it != m_tags.end() && it->first < time; it++)
   {
-    if ((it->second->StartAsUTC() < time) && (it->second->EndAsUTC() > time))
+    if (it->second->EndAsUTC() > time)
       return it->second;
   }
 
@@ -317,7 +326,10 @@ void CEpg::AddEntry(const CEpgInfoTag &tag)
   CSingleLock lock(m_critSection);
   map<CDateTime, CEpgInfoTagPtr>::iterator itr = m_tags.find(tag.StartAsUTC());
   if (itr != m_tags.end())
+  {
     newTag = itr->second;
+    m_index.Remove(*newTag);
+  }
   else
   {
     newTag = CEpgInfoTagPtr(new CEpgInfoTag(this, m_pvrChannel, m_strName, m_pvrChannel ? m_pvrChannel->IconPath() : StringUtils::EmptyString));
@@ -330,6 +342,7 @@ void CEpg::AddEntry(const CEpgInfoTag &tag)
     newTag->SetPVRChannel(m_pvrChannel);
     newTag->m_epg          = this;
     newTag->m_bChanged     = false;
+    m_index.Add(*newTag);
   }
 }
 
@@ -342,6 +355,7 @@ bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false *
   if (it != m_tags.end())
   {
     infoTag = it->second;
+    m_index.Remove(*infoTag);
   }
   else
   {
@@ -355,6 +369,7 @@ bool CEpg::UpdateEntry(const CEpgInfoTag &tag, bool bUpdateDatabase /* = false *
   infoTag->Update(tag, bNewTag);
   infoTag->m_epg          = this;
   infoTag->m_pvrChannel   = m_pvrChannel;
+  m_index.Add(*infoTag);
 
   if (bUpdateDatabase)
     m_changedTags.insert(make_pair(infoTag->UniqueBroadcastID(), infoTag));
@@ -522,7 +537,40 @@ int CEpg::Get(CFileItemList &results, const EpgSearchFilter &filter) const
 
   CSingleLock lock(m_critSection);
 
-  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = m_tags.begin(); it != m_tags.end(); it++)
+  /* the index only knows what the tags contain, while tags of locked channels
+     are matched by what they show */
+  CEpgSearchIndex::Postings candidates;
+  if ((!m_pvrChannel || !g_PVRManager.IsParentalLocked(*m_pvrChannel)) &&
+      m_index.GetCandidates(filter, candidates))
+  {
+    for (CEpgSearchIndex::Postings::const_iterator it = candidates.begin(); it != candidates.end(); it++)
+    {
+      /* the index only knows the start times in whole seconds */
+      CDateTime start((time_t)*it);
+      CDateTime end = start + CDateTimeSpan(0, 0, 0, 1);
+      for (map<CDateTime, CEpgInfoTagPtr>::const_iterator tag = m_tags.lower_bound(start); tag != m_tags.end() && tag->first < end; tag++)
+      {
+        if (filter.FilterEntry(*tag->second))
+          results.Add(CFileItemPtr(new CFileItem(*tag->second)));
+      }
+    }
+
+    return results.Size() - iInitialSize;
+  }
+
+  /* only look at the tags around the requested time frame */
+  map<CDateTime, CEpgInfoTagPtr>::const_iterator first = m_tags.begin();
+  map<CDateTime, CEpgInfoTagPtr>::const_iterator last = m_tags.end();
+  if (filter.m_startDateTime.IsValid() && filter.m_endDateTime.IsValid())
+  {
+    if (filter.m_startDateTime > filter.m_endDateTime)
+      return 0;
+
+    first = m_tags.lower_bound(filter.m_startDateTime.GetAsUTCDateTime() - CDateTimeSpan(1, 0, 0, 0));
+    last = m_tags.upper_bound(filter.m_endDateTime.GetAsUTCDateTime() + CDateTimeSpan(1, 0, 0, 0));
+  }
+
+  for (map<CDateTime, CEpgInfoTagPtr>::const_iterator it = first; it != last; it++)
   {
     if (filter.FilterEntry(*it->second))
       results.Add(CFileItemPtr(new CFileItem(*it->second)));
@@ -547,6 +595,7 @@ bool CEpg::Persist(void)
     return false;
   }
 
+  std::map<int, CEpgInfoTagPtr> deletedTags, changedTags;
   {
     CSingleLock lock(m_critSection);
     if (m_iEpgID <= 0 || m_bChanged)
@@ -556,23 +605,29 @@ bool CEpg::Persist(void)
         m_iEpgID = iId;
     }
 
-    for (std::map<int, CEpgInfoTagPtr>::iterator it = m_deletedTags.begin(); it != m_deletedTags.end(); it++)
-      database->Delete(*it->second);
-
-    for (std::map<int, CEpgInfoTagPtr>::iterator it = m_changedTags.begin(); it != m_changedTags.end(); it++)
-      it->second->Persist(false);
-
     if (m_bUpdateLastScanTime)
       database->PersistLastEpgScanTime(m_iEpgID, true);
 
-    m_deletedTags.clear();
-    m_changedTags.clear();
+    /* take the changes, so this table isn't locked while they are being written */
+    deletedTags.swap(m_deletedTags);
+    changedTags.swap(m_changedTags);
     m_bChanged            = false;
     m_bTagsChanged        = false;
     m_bUpdateLastScanTime = false;
   }
 
-  return database->CommitInsertQueries();
+  bool bTransaction = !database->InTransaction();
+  if (bTransaction)
+    database->BeginTransaction();
+
+  bool bReturn = database->Delete(deletedTags);
+  bReturn &= database->Persist(changedTags);
+  bReturn &= database->CommitInsertQueries();
+
+  if (bTransaction)
+    bReturn &= database->CommitTransaction();
+
+  return bReturn;
 }
 
 CDateTime CEpg::GetFirstDate(void) const
@@ -626,6 +681,7 @@ bool CEpg::FixOverlappingEvents(bool bUpdateDb /* = false */)
         m_nowActiveStart.SetValid(false);
 
       it->second->ClearTimer();
+      m_index.Remove(*it->second);
       m_tags.erase(it++);
     }
     else if (previousTag->EndAsUTC() > currentTag->StartAsUTC())
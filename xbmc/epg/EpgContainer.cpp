@@ -244,6 +244,11 @@ bool CEpgContainer::PersistAll(void)
   m_critSection.lock();
   std::map<unsigned int, CEpg*> copy = m_epgs;
   m_critSection.unlock();
+
+  /* write all tables in a single transaction */
+  bool bTransaction = m_database.IsOpen() && !m_database.InTransaction();
+  if (bTransaction)
+    m_database.BeginTransaction();
   
   for (map<unsigned int, CEpg *>::iterator it = copy.begin(); it != copy.end() && !m_bStop; it++)
   {
@@ -254,6 +259,9 @@ bool CEpgContainer::PersistAll(void)
     }
   }
 
+  if (bTransaction)
+    bReturn &= m_database.CommitTransaction();
+
   return bReturn;
 }
 
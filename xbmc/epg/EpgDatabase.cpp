@@ -32,6 +32,77 @@ using namespace std;
 using namespace dbiplus;
 using namespace EPG;
 
+#define EPG_DELETE_BATCH_SIZE 500
+
+namespace EPG
+{
+  /* streams the changed tags of a table into a batch, either the ones that were
+     persisted before or the new ones, as their queries differ */
+  class CEpgTagRows : public bind_source
+  {
+  public:
+    CEpgTagRows(const map<int, CEpgInfoTagPtr> &tags, bool bPersisted) :
+      m_it(tags.begin()),
+      m_end(tags.end()),
+      m_bPersisted(bPersisted) {}
+
+    virtual bool next(BindList &params)
+    {
+      for (; m_it != m_end; m_it++)
+      {
+        const CEpgInfoTag &tag = *m_it->second;
+        if (!tag.Changed() || (tag.BroadcastId() >= 0) != m_bPersisted)
+          continue;
+
+        if (tag.EpgID() <= 0)
+        {
+          CLog::Log(LOGERROR, "%s - tag '%s' does not have a valid table", __FUNCTION__, tag.Title(true).c_str());
+          continue;
+        }
+
+        time_t iStartTime, iEndTime, iFirstAired;
+        tag.StartAsUTC().GetAsTime(iStartTime);
+        tag.EndAsUTC().GetAsTime(iEndTime);
+        tag.FirstAiredAsUTC().GetAsTime(iFirstAired);
+
+        /* Only store the genre string when needed */
+        CStdString strGenre = (tag.GenreType() == EPG_GENRE_USE_STRING) ? StringUtils::Join(tag.Genre(), g_advancedSettings.m_videoItemSeparator) : "";
+
+        params.push_back(tag.EpgID());
+        params.push_back((int64_t)iStartTime);
+        params.push_back((int64_t)iEndTime);
+        params.push_back(tag.Title(true).c_str());
+        params.push_back(tag.PlotOutline(true).c_str());
+        params.push_back(tag.Plot(true).c_str());
+        params.push_back(tag.GenreType());
+        params.push_back(tag.GenreSubType());
+        params.push_back(strGenre.c_str());
+        params.push_back((int64_t)iFirstAired);
+        params.push_back(tag.ParentalRating());
+        params.push_back(tag.StarRating());
+        params.push_back(tag.Notify() ? 1 : 0);
+        params.push_back(tag.SeriesNum());
+        params.push_back(tag.EpisodeNum());
+        params.push_back(tag.EpisodePart());
+        params.push_back(tag.EpisodeName().c_str());
+        params.push_back(tag.UniqueBroadcastID());
+        if (m_bPersisted)
+          params.push_back(tag.BroadcastId());
+
+        m_it++;
+        return true;
+      }
+
+      return false;
+    }
+
+  private:
+    map<int, CEpgInfoTagPtr>::const_iterator m_it;
+    map<int, CEpgInfoTagPtr>::const_iterator m_end;
+    bool m_bPersisted;
+  };
+}
+
 bool CEpgDatabase::Open(void)
 {
   return CDatabase::Open(g_advancedSettings.m_databaseEpg);
@@ -147,6 +218,30 @@ bool CEpgDatabase::Delete(const CEpgInfoTag &tag)
   return DeleteValues("epgtags", filter);
 }
 
+bool CEpgDatabase::Delete(const map<int, CEpgInfoTagPtr> &tags)
+{
+  bool bReturn(true);
+  vector<string> ids;
+
+  for (map<int, CEpgInfoTagPtr>::const_iterator it = tags.begin(); it != tags.end(); it++)
+  {
+    /* tag without a database ID was not persisted */
+    if (it->second->BroadcastId() > 0)
+      ids.push_back(StringUtils::Format("%i", it->second->BroadcastId()));
+
+    map<int, CEpgInfoTagPtr>::const_iterator next = it;
+    if (!ids.empty() && (ids.size() == EPG_DELETE_BATCH_SIZE || ++next == tags.end()))
+    {
+      Filter filter;
+      filter.AppendWhere("idBroadcast IN (" + StringUtils::Join(ids, ",") + ")");
+      bReturn &= DeleteValues("epgtags", filter);
+      ids.clear();
+    }
+  }
+
+  return bReturn;
+}
+
 int CEpgDatabase::Get(CEpgContainer &container)
 {
   int iReturn(-1);
@@ -364,6 +459,25 @@ int CEpgDatabase::Persist(const CEpgInfoTag &tag, bool bSingleUpdate /* = true *
   return iReturn;
 }
 
+bool CEpgDatabase::Persist(const map<int, CEpgInfoTagPtr> &tags)
+{
+  CEpgTagRows newTags(tags, false);
+  int iNewRows = ExecuteBatch("REPLACE INTO epgtags (idEpg, iStartTime, "
+      "iEndTime, sTitle, sPlotOutline, sPlot, iGenreType, iGenreSubType, sGenre, "
+      "iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
+      "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", newTags);
+
+  CEpgTagRows persistedTags(tags, true);
+  int iPersistedRows = ExecuteBatch("REPLACE INTO epgtags (idEpg, iStartTime, "
+      "iEndTime, sTitle, sPlotOutline, sPlot, iGenreType, iGenreSubType, sGenre, "
+      "iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
+      "iEpisodeId, iEpisodePart, sEpisodeName, iBroadcastUid, idBroadcast) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", persistedTags);
+
+  return iNewRows >= 0 && iPersistedRows >= 0;
+}
+
 int CEpgDatabase::GetLastEPGId(void)
 {
   CStdString strQuery = PrepareSQL("SELECT MAX(idEpg) FROM epg");
@@ -21,12 +21,12 @@
 
 #include "dbwrappers/Database.h"
 #include "XBDateTime.h"
+#include "EpgInfoTag.h"
 #include <map>
 
 namespace EPG
 {
   class CEpg;
-  class CEpgInfoTag;
   class CEpgContainer;
 
   /** The EPG database */
@@ -91,6 +91,13 @@ namespace EPG
      */
     virtual bool Delete(const CEpgInfoTag &tag);
 
+    /*!
+     * @brief Remove tags from the database at once.
+     * @param tags The tags to remove, mapped by their unique broadcast ID.
+     * @return True if the tags were removed successfully, false otherwise.
+     */
+    bool Delete(const std::map<int, CEpgInfoTagPtr> &tags);
+
     /*!
      * @brief Get all EPG tables from the database. Does not get the EPG tables' entries.
      * @param container The container to fill.
@@ -139,6 +146,16 @@ namespace EPG
      */
     virtual int Persist(const CEpgInfoTag &tag, bool bSingleUpdate = true);
 
+    /*!
+     * @brief Persist the changed tags of a table in a single batch.
+     *
+     * The rows are read from the tags while they are written, so the map must not be
+     * changed meanwhile. New tags don't get their database ID, like queued tags.
+     * @param tags The tags to persist, mapped by their unique broadcast ID.
+     * @return True if the tags were persisted successfully, false otherwise.
+     */
+    bool Persist(const std::map<int, CEpgInfoTagPtr> &tags);
+
     /*!
      * @return Last EPG id in the database
      */
@@ -0,0 +1,265 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+
+#include "EpgSearchIndex.h"
+#include "EpgInfoTag.h"
+#include "EpgSearchFilter.h"
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+#include "utils/TextSearch.h"
+#include "../addons/include/xbmc_epg_types.h"
+
+using namespace std;
+using namespace EPG;
+
+static inline bool IsWordCharacter(unsigned char c)
+{
+  // bytes of multi-byte utf-8 characters are treated as letters
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+static void Narrow(CEpgSearchIndex::Postings &candidates, const CEpgSearchIndex::Postings &postings, bool &bNarrowed)
+{
+  if (!bNarrowed)
+  {
+    candidates = postings;
+    bNarrowed = true;
+    return;
+  }
+
+  CEpgSearchIndex::Postings intersection;
+  set_intersection(candidates.begin(), candidates.end(), postings.begin(), postings.end(), back_inserter(intersection));
+  candidates.swap(intersection);
+}
+
+CEpgSearchIndex::CEpgSearchIndex(void) :
+    m_iMaxDuration(0)
+{
+}
+
+void CEpgSearchIndex::Add(const CEpgInfoTag &tag)
+{
+  uint32_t iStart = GetStart(tag);
+
+  vector<string> words;
+  GetWords(tag, words);
+  for (vector<string>::const_iterator it = words.begin(); it != words.end(); it++)
+    Insert(m_words[*it], iStart);
+
+  Insert(m_genres[tag.GenreType()], iStart);
+
+  {
+    CSingleLock lock(tag.m_critSection);
+    if (tag.m_strTitle.empty())
+      Insert(m_untitled, iStart);
+  }
+
+  m_iMaxDuration = max(m_iMaxDuration, tag.GetDuration());
+}
+
+void CEpgSearchIndex::Remove(const CEpgInfoTag &tag)
+{
+  uint32_t iStart = GetStart(tag);
+
+  vector<string> words;
+  GetWords(tag, words);
+  for (vector<string>::const_iterator it = words.begin(); it != words.end(); it++)
+  {
+    map<string, Postings>::iterator word = m_words.find(*it);
+    if (word == m_words.end())
+      continue;
+
+    Erase(word->second, iStart);
+    if (word->second.empty())
+      m_words.erase(word);
+  }
+
+  map<int, Postings>::iterator genre = m_genres.find(tag.GenreType());
+  if (genre != m_genres.end())
+  {
+    Erase(genre->second, iStart);
+    if (genre->second.empty())
+      m_genres.erase(genre);
+  }
+
+  Erase(m_untitled, iStart);
+}
+
+void CEpgSearchIndex::Clear(void)
+{
+  m_words.clear();
+  m_genres.clear();
+  m_untitled.clear();
+  m_iMaxDuration = 0;
+}
+
+bool CEpgSearchIndex::GetCandidates(const EpgSearchFilter &filter, Postings &candidates) const
+{
+  bool bNarrowed(false);
+  candidates.clear();
+
+  if (filter.m_iGenreType != EPG_SEARCH_UNSET)
+  {
+    Postings genres;
+    for (map<int, Postings>::const_iterator it = m_genres.begin(); it != m_genres.end(); it++)
+    {
+      bool bIsUnknownGenre(it->first > EPG_EVENT_CONTENTMASK_USERDEFINED ||
+          it->first < EPG_EVENT_CONTENTMASK_MOVIEDRAMA);
+      if (it->first == filter.m_iGenreType || (filter.m_bIncludeUnknownGenres && bIsUnknownGenre))
+        genres.insert(genres.end(), it->second.begin(), it->second.end());
+    }
+    sort(genres.begin(), genres.end());
+    Narrow(candidates, genres, bNarrowed);
+  }
+
+  if (!filter.m_strSearchTerm.empty())
+  {
+    CTextSearch search(filter.m_strSearchTerm, filter.m_bIsCaseSensitive, SEARCH_DEFAULT_OR);
+    if (!search.IsValid())
+    {
+      // nothing matches a search without any terms
+      candidates.clear();
+      return true;
+    }
+
+    /* every term that has to be found narrows down the candidates */
+    const vector<CStdString> &andTerms = search.GetAndTerms();
+    for (vector<CStdString>::const_iterator it = andTerms.begin(); it != andTerms.end(); it++)
+    {
+      Postings term;
+      if (GetTermCandidates(*it, term))
+        Narrow(candidates, term, bNarrowed);
+    }
+
+    /* and so do all terms of which at least one has to be found together */
+    const vector<CStdString> &orTerms = search.GetOrTerms();
+    if (!orTerms.empty())
+    {
+      Postings terms;
+      bool bAllTags(false);
+      for (vector<CStdString>::const_iterator it = orTerms.begin(); !bAllTags && it != orTerms.end(); it++)
+      {
+        Postings term;
+        if (GetTermCandidates(*it, term))
+          terms.insert(terms.end(), term.begin(), term.end());
+        else
+          bAllTags = true;
+      }
+
+      if (!bAllTags)
+      {
+        sort(terms.begin(), terms.end());
+        terms.erase(unique(terms.begin(), terms.end()), terms.end());
+        Narrow(candidates, terms, bNarrowed);
+      }
+    }
+  }
+
+  return bNarrowed;
+}
+
+void CEpgSearchIndex::GetWords(const string &strText, vector<string> &words)
+{
+  string strLower(strText);
+  StringUtils::ToLower(strLower);
+
+  size_t iStart(0);
+  while (iStart < strLower.size())
+  {
+    while (iStart < strLower.size() && !IsWordCharacter(strLower[iStart]))
+      iStart++;
+
+    size_t iEnd(iStart);
+    while (iEnd < strLower.size() && IsWordCharacter(strLower[iEnd]))
+      iEnd++;
+
+    if (iEnd > iStart)
+      words.push_back(strLower.substr(iStart, iEnd - iStart));
+    iStart = iEnd;
+  }
+
+  sort(words.begin(), words.end());
+  words.erase(unique(words.begin(), words.end()), words.end());
+}
+
+void CEpgSearchIndex::Insert(Postings &postings, uint32_t iStart)
+{
+  Postings::iterator it = lower_bound(postings.begin(), postings.end(), iStart);
+  if (it == postings.end() || *it != iStart)
+    postings.insert(it, iStart);
+}
+
+void CEpgSearchIndex::Erase(Postings &postings, uint32_t iStart)
+{
+  Postings::iterator it = lower_bound(postings.begin(), postings.end(), iStart);
+  if (it != postings.end() && *it == iStart)
+    postings.erase(it);
+}
+
+uint32_t CEpgSearchIndex::GetStart(const CEpgInfoTag &tag)
+{
+  time_t iStart;
+  tag.StartAsUTC().GetAsTime(iStart);
+  return (uint32_t)iStart;
+}
+
+void CEpgSearchIndex::GetWords(const CEpgInfoTag &tag, vector<string> &words)
+{
+  // index what the tag contains, not what it shows
+  string strText;
+  {
+    CSingleLock lock(tag.m_critSection);
+    strText = tag.m_strTitle + " " + tag.m_strPlotOutline;
+  }
+
+  GetWords(strText, words);
+}
+
+bool CEpgSearchIndex::GetTermCandidates(const string &strTerm, Postings &candidates) const
+{
+  /* a term can span multiple words, but each part of it between two separators
+     has to be found within a single word of the tag. look up the longest part. */
+  vector<string> parts;
+  GetWords(strTerm, parts);
+  if (parts.empty())
+    return false;
+
+  const string *part = &parts[0];
+  for (vector<string>::const_iterator it = parts.begin(); it != parts.end(); it++)
+  {
+    if (it->size() > part->size())
+      part = &(*it);
+  }
+
+  for (map<string, Postings>::const_iterator it = m_words.begin(); it != m_words.end(); it++)
+  {
+    if (it->first.find(*part) != string::npos)
+      candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+  }
+
+  // tags without a title show a localised one instead
+  candidates.insert(candidates.end(), m_untitled.begin(), m_untitled.end());
+
+  sort(candidates.begin(), candidates.end());
+  candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+  return true;
+}
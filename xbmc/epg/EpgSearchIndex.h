@@ -0,0 +1,105 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace EPG
+{
+  class CEpgInfoTag;
+  struct EpgSearchFilter;
+
+  /** Index of the tags of a single CEpg, to narrow down searches */
+
+  class CEpgSearchIndex
+  {
+  public:
+    /*!
+     * @brief Tags are identified by their start time in seconds since the epoch (UTC).
+     */
+    typedef std::vector<uint32_t> Postings;
+
+    CEpgSearchIndex(void);
+
+    /*!
+     * @brief Add a tag to the index.
+     * @param tag The tag to add.
+     */
+    void Add(const CEpgInfoTag &tag);
+
+    /*!
+     * @brief Remove a tag from the index. It has to have the same contents as when it was added.
+     * @param tag The tag to remove.
+     */
+    void Remove(const CEpgInfoTag &tag);
+
+    /*!
+     * @brief Remove all tags from the index.
+     */
+    void Clear(void);
+
+    /*!
+     * @brief The longest duration of any tag added since the last Clear().
+     * @return The duration in seconds.
+     */
+    int MaxDuration(void) const { return m_iMaxDuration; }
+
+    /*!
+     * @brief Get the tags that could match the search term and genre of a filter.
+     *
+     * Every tag that matches is returned, but not every tag returned matches: the
+     * filter still has to be applied to them. The search term is matched against the
+     * words of the title and plot outline, a term has to be part of a single word.
+     * @param filter The filter to get the candidates for.
+     * @param candidates The start times of the candidates, sorted.
+     * @return False if the filter can't be narrowed down and all tags have to be checked.
+     */
+    bool GetCandidates(const EpgSearchFilter &filter, Postings &candidates) const;
+
+    /*!
+     * @brief Split a text into lower case words.
+     * @param strText The text to split.
+     * @param words The words found, without duplicates.
+     */
+    static void GetWords(const std::string &strText, std::vector<std::string> &words);
+
+  private:
+    static void Insert(Postings &postings, uint32_t iStart);
+    static void Erase(Postings &postings, uint32_t iStart);
+    static uint32_t GetStart(const CEpgInfoTag &tag);
+    static void GetWords(const CEpgInfoTag &tag, std::vector<std::string> &words);
+
+    /*!
+     * @brief Get the tags containing a search term.
+     * @param strTerm The term.
+     * @param candidates The tags that could contain the term.
+     * @return False if the term can't be looked up in the index.
+     */
+    bool GetTermCandidates(const std::string &strTerm, Postings &candidates) const;
+
+    std::map<std::string, Postings> m_words;    /*!< the tags containing each word */
+    std::map<int, Postings>         m_genres;   /*!< the tags of each genre type */
+    Postings                        m_untitled; /*!< the tags without a title, which get a localised title */
+    int                             m_iMaxDuration;
+  };
+}
@@ -0,0 +1,206 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "epg/Epg.h"
+#include "epg/EpgSearchIndex.h"
+#include "utils/StdString.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+
+using namespace EPG;
+
+static const char *Words[] = { "news", "weather", "football", "the", "big", "match", "highlights", "documentary",
+                               "wildlife", "ocean", "cooking", "show", "late", "night", "movie", "drama", "kids" };
+
+static CDateTime GetStart(int iChannel, int iEvent)
+{
+  // start a bit in the past, so there is a tag that is currently active
+  static CDateTime first = CDateTime(time(NULL)) - CDateTimeSpan(0, 1, 0, 0);
+  return first + CDateTimeSpan(0, 0, iEvent * 15, iChannel);
+}
+
+static void AddTags(CEpg &epg, int iChannel, int iEvents, std::vector<CEpgInfoTag> *tags = NULL)
+{
+  for (int iEvent = 0; iEvent < iEvents; iEvent++)
+  {
+    CEpgInfoTag tag;
+    tag.SetUniqueBroadcastID(iChannel * iEvents + iEvent + 1);
+    tag.SetStartFromUTC(GetStart(iChannel, iEvent));
+    tag.SetEndFromUTC(GetStart(iChannel, iEvent + 1));
+    tag.SetTitle(CStdString(Words[iEvent % 17]) + " " + Words[(iEvent / 17 + iChannel) % 17]);
+    tag.SetPlotOutline(CStdString(Words[(iEvent * 7 + iChannel) % 17]) + ", " + Words[(iEvent * 3) % 17]);
+    tag.SetGenre(((iEvent + iChannel) % 11) << 4, 0, NULL);
+    epg.UpdateEntry(tag);
+
+    if (tags)
+      tags->push_back(tag);
+  }
+}
+
+static EpgSearchFilter GetFilter(const CStdString &strSearchTerm, int iGenreType = EPG_SEARCH_UNSET)
+{
+  EpgSearchFilter filter;
+  filter.Reset();
+  filter.m_startDateTime = CDateTime::GetCurrentDateTime() - CDateTimeSpan(7, 0, 0, 0);
+  filter.m_endDateTime = CDateTime::GetCurrentDateTime() + CDateTimeSpan(30, 0, 0, 0);
+  filter.m_strSearchTerm = strSearchTerm;
+  filter.m_iGenreType = iGenreType;
+  return filter;
+}
+
+static int GetBruteForce(const CEpg &epg, const EpgSearchFilter &filter)
+{
+  CFileItemList all;
+  epg.Get(all);
+
+  int iMatches = 0;
+  for (int i = 0; i < all.Size(); i++)
+  {
+    if (filter.FilterEntry(*all[i]->GetEPGInfoTag()))
+      iMatches++;
+  }
+
+  return iMatches;
+}
+
+TEST(TestEpgSearchIndex, GetWords)
+{
+  std::vector<std::string> words;
+  CEpgSearchIndex::GetWords("The Big Match: the highlights (2013)", words);
+
+  ASSERT_EQ(5U, words.size());
+  EXPECT_STREQ("2013", words[0].c_str());
+  EXPECT_STREQ("big", words[1].c_str());
+  EXPECT_STREQ("highlights", words[2].c_str());
+  EXPECT_STREQ("match", words[3].c_str());
+  EXPECT_STREQ("the", words[4].c_str());
+}
+
+TEST(TestEpgSearchIndex, SameResultsAsScan)
+{
+  CEpg epg(1, "test");
+  AddTags(epg, 0, 200);
+
+  const char *terms[] = { "match", "MATCH", "atc", "big match", "\"big match\"", "news +night", "ocean -cooking",
+                          "late,", "nothing", "" };
+  for (unsigned int i = 0; i < sizeof(terms) / sizeof(terms[0]); i++)
+  {
+    EpgSearchFilter filter = GetFilter(terms[i]);
+    CFileItemList results;
+    epg.Get(results, filter);
+    EXPECT_EQ(GetBruteForce(epg, filter), results.Size()) << "search term '" << terms[i] << "'";
+
+    filter.m_iGenreType = EPG_EVENT_CONTENTMASK_SPORTS;
+    results.Clear();
+    epg.Get(results, filter);
+    EXPECT_EQ(GetBruteForce(epg, filter), results.Size()) << "search term '" << terms[i] << "' and genre";
+  }
+}
+
+TEST(TestEpgSearchIndex, IncrementalUpdate)
+{
+  CEpg epg(1, "test");
+  AddTags(epg, 0, 20);
+
+  CFileItemList results;
+  epg.Get(results, GetFilter("zebra"));
+  EXPECT_EQ(0, results.Size());
+
+  CEpgInfoTag tag(*epg.GetTag(GetStart(0, 5)));
+  tag.SetTitle("Zebra Crossing");
+  epg.UpdateEntry(tag);
+
+  results.Clear();
+  epg.Get(results, GetFilter("zebra"));
+  ASSERT_EQ(1, results.Size());
+  EXPECT_EQ(tag.StartAsUTC(), results[0]->GetEPGInfoTag()->StartAsUTC());
+
+  epg.Cleanup(GetStart(0, 6) + CDateTimeSpan(0, 0, 1, 0));
+  results.Clear();
+  epg.Get(results, GetFilter("zebra"));
+  EXPECT_EQ(0, results.Size());
+}
+
+TEST(TestEpgSearchIndex, TimeLookups)
+{
+  CEpg epg(1, "test");
+  AddTags(epg, 0, 20);
+
+  CEpgInfoTagPtr tag = epg.GetTagAround(GetStart(0, 10) + CDateTimeSpan(0, 0, 1, 0));
+  ASSERT_TRUE(tag != NULL);
+  EXPECT_EQ(GetStart(0, 10), tag->StartAsUTC());
+
+  tag = epg.GetTagBetween(GetStart(0, 3) - CDateTimeSpan(0, 0, 1, 0), GetStart(0, 5));
+  ASSERT_TRUE(tag != NULL);
+  EXPECT_EQ(GetStart(0, 3), tag->StartAsUTC());
+
+  EXPECT_TRUE(epg.GetTagAround(GetStart(0, 20) + CDateTimeSpan(0, 0, 1, 0)) == NULL);
+
+  CEpgInfoTag now;
+  ASSERT_TRUE(epg.InfoTagNow(now));
+  EXPECT_EQ(GetStart(0, 4), now.StartAsUTC());
+}
+
+TEST(TestEpgSearchIndex, Benchmark)
+{
+  // a guide of 400 channels with 1250 events each
+  const int iChannels = 400;
+  const int iEvents = 1250;
+
+  std::vector<CEpg*> epgs;
+  std::vector<CEpgInfoTag> tags;
+  tags.reserve(iChannels * iEvents);
+  for (int iChannel = 0; iChannel < iChannels; iChannel++)
+  {
+    CEpg *epg = new CEpg(iChannel + 1, "test");
+    AddTags(*epg, iChannel, iEvents, &tags);
+    epgs.push_back(epg);
+  }
+
+  EpgSearchFilter filter = GetFilter("highlights");
+  filter.m_iGenreType = EPG_EVENT_CONTENTMASK_SPORTS;
+
+  int64_t iStart = CurrentHostCounter();
+  int iScanned = 0;
+  for (std::vector<CEpgInfoTag>::const_iterator it = tags.begin(); it != tags.end(); it++)
+  {
+    if (filter.FilterEntry(*it))
+      iScanned++;
+  }
+  int64_t iScanTime = CurrentHostCounter() - iStart;
+
+  iStart = CurrentHostCounter();
+  CFileItemList results;
+  for (std::vector<CEpg*>::const_iterator it = epgs.begin(); it != epgs.end(); it++)
+    (*it)->Get(results, filter);
+  int64_t iIndexTime = CurrentHostCounter() - iStart;
+
+  EXPECT_EQ(iScanned, results.Size());
+  std::cout << "Scanning " << testing::PrintToString(iChannels * iEvents) << " tags took "
+            << testing::PrintToString(iScanTime * 1000 / CurrentHostFrequency()) << " ms, "
+            << "the index took " << testing::PrintToString(iIndexTime * 1000 / CurrentHostFrequency()) << " ms"
+            << std::endl;
+
+  for (std::vector<CEpg*>::iterator it = epgs.begin(); it != epgs.end(); it++)
+    delete *it;
+}
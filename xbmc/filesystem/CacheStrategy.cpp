@@ -43,6 +43,16 @@ CCacheStrategy::~CCacheStrategy()
 {
 }
 
+int CCacheStrategy::GetWriteBuffer(char **pBuffer, size_t *iSize)
+{
+  return CACHE_RC_ERROR;
+}
+
+int CCacheStrategy::CommitWrite(size_t iSize)
+{
+  return CACHE_RC_ERROR;
+}
+
 void CCacheStrategy::EndOfInput() {
   m_bEndOfInput = true;
 }
@@ -318,6 +328,16 @@ int64_t CSimpleDoubleCache::WaitForData(unsigned int iMinAvail, unsigned int iMi
   return m_pCache->WaitForData(iMinAvail, iMillis);
 }
 
+int CSimpleDoubleCache::GetWriteBuffer(char **pBuffer, size_t *iSize)
+{
+  return m_pCache->GetWriteBuffer(pBuffer, iSize);
+}
+
+int CSimpleDoubleCache::CommitWrite(size_t iSize)
+{
+  return m_pCache->CommitWrite(iSize);
+}
+
 int64_t CSimpleDoubleCache::Seek(int64_t iFilePosition)
 {
   return m_pCache->Seek(iFilePosition);
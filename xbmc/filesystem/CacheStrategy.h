@@ -50,6 +50,24 @@ public:
   virtual int ReadFromCache(char *pBuffer, size_t iMaxSize) = 0;
   virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis) = 0;
 
+  /*!
+   \brief Get contiguous free space in the cache, so the source can be read straight into it.
+   Saves copying through a staging buffer and WriteToCache(). Data written into the space must
+   be committed with CommitWrite() before any other write, seek or reset of the cache; an unused
+   space may simply be abandoned.
+   \param pBuffer set to the start of the free space.
+   \param iSize in: the maximum amount of space wanted, out: the size of the free space.
+   \return CACHE_RC_OK, CACHE_RC_WOULD_BLOCK if the cache is full, CACHE_RC_ERROR if not supported.
+   */
+  virtual int GetWriteBuffer(char **pBuffer, size_t *iSize);
+
+  /*!
+   \brief Mark data written into the space returned by GetWriteBuffer() as cached.
+   \param iSize the amount of data written, at most the size returned by GetWriteBuffer().
+   \return the amount of data added to the cache, or CACHE_RC_ERROR.
+   */
+  virtual int CommitWrite(size_t iSize);
+
   virtual int64_t Seek(int64_t iFilePosition) = 0;
   virtual void Reset(int64_t iSourcePosition, bool clearAnyway=true) = 0;
 
@@ -114,6 +132,8 @@ public:
   virtual int WriteToCache(const char *pBuffer, size_t iSize) ;
   virtual int ReadFromCache(char *pBuffer, size_t iMaxSize) ;
   virtual int64_t WaitForData(unsigned int iMinAvail, unsigned int iMillis) ;
+  virtual int GetWriteBuffer(char **pBuffer, size_t *iSize);
+  virtual int CommitWrite(size_t iSize);
 
   virtual int64_t Seek(int64_t iFilePosition);
   virtual void Reset(int64_t iSourcePosition, bool clearAnyway=true);
@@ -24,6 +24,14 @@
 #include "threads/SingleLock.h"
 #include "utils/TimeUtils.h"
 #include "CircularCache.h"
+#ifdef TARGET_POSIX
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdlib.h>
+#endif
+#if defined(TARGET_LINUX)
+#include <sys/syscall.h>
+#endif
 
 using namespace XFILE;
 
@@ -35,6 +43,7 @@ CCircularCache::CCircularCache(size_t front, size_t back)
  , m_buf(NULL)
  , m_size(front + back)
  , m_size_back(back)
+ , m_mirrored(false)
 #ifdef TARGET_WINDOWS
  , m_handle(INVALID_HANDLE_VALUE)
 #endif
@@ -99,22 +108,12 @@ int CCircularCache::WriteToCache(const char *buf, size_t len)
 {
   CSingleLock lock(m_sync);
 
-  // where are we in the buffer
+  // limit by max forward size and wrap point
   size_t pos   = m_end % m_size;
-  size_t back  = (size_t)(m_cur - m_beg);
-  size_t front = (size_t)(m_end - m_cur);
-
-  size_t limit = m_size - std::min(back, m_size_back) - front;
-  size_t wrap  = m_size - pos;
-
-  // limit by max forward size
+  size_t limit = WriteLimit();
   if(len > limit)
     len = limit;
 
-  // limit to wrap point
-  if(len > wrap)
-    len = wrap;
-
   if(len == 0)
     return 0;
 
@@ -131,10 +130,68 @@ int CCircularCache::WriteToCache(const char *buf, size_t len)
   return len;
 }
 
+/**
+ * Hands out the free space at m_end % m_size, up to as
+ * much of it as WriteToCache would write in one go, so the
+ * caller can fill it without an intermediate buffer.
+ *
+ * The history that is going to be overwritten is dropped
+ * immediately, as the caller writes without holding our lock.
+ */
+int CCircularCache::GetWriteBuffer(char **buf, size_t *len)
+{
+  CSingleLock lock(m_sync);
+
+  size_t pos   = m_end % m_size;
+  size_t limit = std::min(WriteLimit(), *len);
+  if(limit == 0)
+    return CACHE_RC_WOULD_BLOCK;
+
+  if(m_end + (int64_t)limit - m_beg > (int64_t)m_size)
+    m_beg = m_end + limit - m_size;
+
+  *buf = (char *)m_buf + pos;
+  *len = limit;
+  return CACHE_RC_OK;
+}
+
+int CCircularCache::CommitWrite(size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  m_end += len;
+
+  // drop history that was overwritten
+  if(m_end - m_beg > (int64_t)m_size)
+    m_beg = m_end - m_size;
+
+  m_written.Set();
+
+  return len;
+}
+
+/**
+ * Returns how much can be written at m_end % m_size in
+ * one go, keeping the back buffer and unread data intact
+ * and stopping at the wrap point of the buffer, unless the
+ * buffer is mirrored.
+ */
+size_t CCircularCache::WriteLimit()
+{
+  size_t pos   = m_end % m_size;
+  size_t back  = (size_t)(m_cur - m_beg);
+  size_t front = (size_t)(m_end - m_cur);
+
+  size_t limit = m_size - std::min(back, m_size_back) - front;
+  size_t wrap  = m_mirrored ? m_size : m_size - pos;
+
+  return std::min(limit, wrap);
+}
+
 /**
  * Reads data from cache. Will only read up till
- * the buffer wrap point. So multiple calls
- * may be needed to empty the whole cache
+ * the buffer wrap point (unless the buffer is mirrored).
+ * So multiple calls may be needed to empty the whole cache
  */
 int CCircularCache::ReadFromCache(char *buf, size_t len)
 {
@@ -142,7 +199,7 @@ int CCircularCache::ReadFromCache(char *buf, size_t len)
 
   size_t pos   = m_cur % m_size;
   size_t front = (size_t)(m_end - m_cur);
-  size_t avail = std::min(m_size - pos, front);
+  size_t avail = std::min(m_mirrored ? m_size : m_size - pos, front);
 
   if(avail == 0)
   {
@@ -246,3 +303,144 @@ CCacheStrategy *CCircularCache::CreateNew()
   return new CCircularCache(m_size - m_size_back, m_size_back);
 }
 
+
+CMappedCircularCache::CMappedCircularCache(size_t front, size_t back)
+ : CCircularCache(front, back)
+#ifdef TARGET_WINDOWS
+ , m_mapping(NULL)
+#endif
+{
+}
+
+CMappedCircularCache::~CMappedCircularCache()
+{
+  Close();
+}
+
+int CMappedCircularCache::Open()
+{
+  if (!MapRing())
+  {
+    CLog::Log(LOGWARNING, "%s - unable to map ring buffer, using memory buffer", __FUNCTION__);
+    return CCircularCache::Open();
+  }
+  m_beg = 0;
+  m_end = 0;
+  m_cur = 0;
+  return CACHE_RC_OK;
+}
+
+void CMappedCircularCache::Close()
+{
+  if (!m_mirrored)
+  {
+    CCircularCache::Close();
+    return;
+  }
+
+#ifdef TARGET_WINDOWS
+  UnmapViewOfFile(m_buf);
+  UnmapViewOfFile(m_buf + m_size);
+  CloseHandle(m_mapping);
+  m_mapping = NULL;
+#else
+  munmap(m_buf, m_size * 2);
+#endif
+  m_buf = NULL;
+  m_mirrored = false;
+}
+
+/**
+ * Maps a ring file of m_size bytes (rounded up to the
+ * mapping granularity) twice into consecutive memory.
+ */
+bool CMappedCircularCache::MapRing()
+{
+#ifdef TARGET_WINDOWS
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  size_t size = (m_size + info.dwAllocationGranularity - 1) / info.dwAllocationGranularity * info.dwAllocationGranularity;
+
+  // ring file backed by the paging file
+  m_mapping = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, size, NULL);
+  if (m_mapping == NULL)
+    return false;
+
+  // find a free range of twice the size, and map both views into it. Another
+  // thread may grab the range in between, so retry a few times.
+  for (int attempt = 0; attempt < 10; attempt++)
+  {
+    uint8_t *base = (uint8_t*)VirtualAlloc(NULL, size * 2, MEM_RESERVE, PAGE_NOACCESS);
+    if (base == NULL)
+      break;
+    VirtualFree(base, 0, MEM_RELEASE);
+
+    uint8_t *first = (uint8_t*)MapViewOfFileEx(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, base);
+    uint8_t *second = first ? (uint8_t*)MapViewOfFileEx(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, base + size) : NULL;
+    if (first && second)
+    {
+      m_buf = base;
+      m_size = size;
+      m_mirrored = true;
+      return true;
+    }
+    if (first)
+      UnmapViewOfFile(first);
+  }
+  CloseHandle(m_mapping);
+  m_mapping = NULL;
+  return false;
+#else
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t size = (m_size + page - 1) / page * page;
+
+  // the ring has to stay in memory, a file on disk would defeat the cache. Without
+  // an anonymous memory file or shared memory the caller uses the heap ring instead.
+  int fd = -1;
+#if defined(TARGET_LINUX) && defined(SYS_memfd_create)
+  fd = syscall(SYS_memfd_create, "xbmc-cache", 0);
+#endif
+  if (fd < 0)
+  {
+    // the ring file is unlinked straight away, it only lives as long as the mapping
+    char path[] = "/dev/shm/xbmc-cache-XXXXXX";
+    fd = mkstemp(path);
+    if (fd < 0)
+      return false;
+    unlink(path);
+  }
+
+  if (ftruncate(fd, size) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  // reserve twice the size, then map the file over both halves
+  uint8_t *base = (uint8_t*)mmap(NULL, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+  {
+    close(fd);
+    return false;
+  }
+
+  if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+      mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+  {
+    munmap(base, size * 2);
+    close(fd);
+    return false;
+  }
+  close(fd);
+
+  m_buf = base;
+  m_size = size;
+  m_mirrored = true;
+  return true;
+#endif
+}
+
+CCacheStrategy *CMappedCircularCache::CreateNew()
+{
+  return new CMappedCircularCache(m_size - m_size_back, m_size_back);
+}
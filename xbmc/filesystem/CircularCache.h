@@ -39,6 +39,8 @@ public:
     virtual int WriteToCache(const char *buf, size_t len) ;
     virtual int ReadFromCache(char *buf, size_t len) ;
     virtual int64_t WaitForData(unsigned int minimum, unsigned int iMillis) ;
+    virtual int GetWriteBuffer(char **buf, size_t *len);
+    virtual int CommitWrite(size_t len);
 
     virtual int64_t Seek(int64_t pos) ;
     virtual void Reset(int64_t pos, bool clearAnyway=true) ;
@@ -49,12 +51,15 @@ public:
 
     virtual CCacheStrategy *CreateNew();
 protected:
+    size_t            WriteLimit();
+
     int64_t           m_beg;       /**< index in file (not buffer) of beginning of valid data */
     int64_t           m_end;       /**< index in file (not buffer) of end of valid data */
     int64_t           m_cur;       /**< current reading index in file */
     uint8_t          *m_buf;       /**< buffer holding data */
     size_t            m_size;      /**< size of data buffer used (m_buf) */
     size_t            m_size_back; /**< guaranteed size of back buffer (actual size can be smaller, or larger if front buffer doesn't need it) */
+    bool              m_mirrored;  /**< buffer is mapped twice back to back, so data never needs to be split at the wrap point */
     CCriticalSection  m_sync;
     CEvent            m_written;
 #ifdef TARGET_WINDOWS
@@ -62,5 +67,29 @@ protected:
 #endif
 };
 
+/**
+ * Circular cache backed by a memory mapped ring file. The file is mapped twice,
+ * back to back, so that every read and write into the ring is contiguous, and
+ * the source can always be read straight into the cache (see GetWriteBuffer()).
+ * The ring file lives in memory (an anonymous memory file or /dev/shm), it
+ * falls back to a plain CCircularCache buffer if the mapping can't be set up.
+ */
+class CMappedCircularCache : public CCircularCache
+{
+public:
+    CMappedCircularCache(size_t front, size_t back);
+    virtual ~CMappedCircularCache();
+
+    virtual int Open();
+    virtual void Close();
+
+    virtual CCacheStrategy *CreateNew();
+protected:
+    bool              MapRing();
+#ifdef TARGET_WINDOWS
+    HANDLE            m_mapping;
+#endif
+};
+
 } // namespace XFILE
 #endif
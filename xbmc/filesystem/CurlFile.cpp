@@ -231,6 +231,7 @@ CCurlFile::CReadState::CReadState()
   m_cancelled = false;
   m_bFirstLoop = true;
   m_sendRange = true;
+  m_rangeEnd = 0;
   m_readBuffer = 0;
   m_isPaused = false;
   m_curlHeaderList = NULL;
@@ -292,6 +293,15 @@ void CCurlFile::CReadState::SetResume(void)
    * request header. If we don't the server may provide different content causing seeking to fail.
    * This only affects HTTP-like items, for FTP it's a null operation.
    */
+  if (m_rangeEnd > 0)
+  {
+    CStdString range;
+    range.Format("%"PRId64"-%"PRId64, m_filePos, m_rangeEnd - 1);
+    g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RANGE, range.c_str());
+    g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RESUME_FROM_LARGE, (int64_t)0);
+    return;
+  }
+
   if (m_sendRange && m_filePos == 0)
     g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RANGE, "0-");
   else
@@ -325,8 +335,9 @@ long CCurlFile::CReadState::Connect(unsigned int size)
     return -1;
   }
 
+  // the length of a bounded request is the one of the range
   double length;
-  if (CURLE_OK == g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length))
+  if (m_rangeEnd == 0 && CURLE_OK == g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length))
   {
     if (length < 0)
       length = 0.0;
@@ -381,6 +392,7 @@ CCurlFile::CCurlFile()
   m_inError = false;
   m_multisession  = true;
   m_seekable = true;
+  m_idle = false;
   m_useOldHttpVersion = false;
   m_connecttimeout = 0;
   m_lowspeedtime = 0;
@@ -415,6 +427,7 @@ void CCurlFile::Close()
       Write(NULL, 0);
 
   m_state->Disconnect();
+  m_state->m_rangeEnd = 0;
   delete m_oldState;
   m_oldState = NULL;
 
@@ -425,6 +438,7 @@ void CCurlFile::Close()
   m_opened = false;
   m_forWrite = false;
   m_inError = false;
+  m_idle = false;
 }
 
 void CCurlFile::SetCommonOptions(CReadState* state)
@@ -895,6 +909,22 @@ void CCurlFile::Reset()
   m_state->m_cancelled = false;
 }
 
+void CCurlFile::Idle()
+{
+  if (!m_opened || m_idle)
+    return;
+
+  int64_t size = m_state->m_fileSize;
+  int64_t pos  = m_state->m_filePos;
+  m_state->Disconnect();
+  m_state->m_fileSize = size;
+  m_state->m_filePos  = pos;
+
+  delete m_oldState;
+  m_oldState = NULL;
+  m_idle = true;
+}
+
 bool CCurlFile::Open(const CURL& url)
 {
   m_opened = true;
@@ -971,6 +1001,40 @@ bool CCurlFile::Open(const CURL& url)
   return true;
 }
 
+bool CCurlFile::OpenRange(const CURL& url, int64_t start, int64_t end)
+{
+  if (!m_opened)
+  {
+    m_opened = true;
+    m_seekable = true;
+
+    CURL url2(url);
+    ParseAndCorrectUrl(url2);
+    g_curlInterface.easy_aquire(url2.GetProtocol(), url2.GetHostName(), &m_state->m_easyHandle, &m_state->m_multiHandle );
+  }
+  else
+    m_state->Disconnect();
+
+  SetCommonOptions(m_state);
+  SetRequestHeaders(m_state);
+
+  m_state->m_filePos = start;
+  m_state->m_rangeEnd = end;
+  m_state->m_sendRange = true;
+
+  // anything but partial content means the server ignored the range
+  m_httpresponse = m_state->Connect(m_bufferSize);
+  if (m_httpresponse != 206)
+  {
+    CLog::Log(LOGDEBUG, "CCurlFile::OpenRange - Failed to get range %"PRId64"-%"PRId64" of %s, response %ld",
+              start, end, CURL::GetRedacted(m_url).c_str(), m_httpresponse);
+    return false;
+  }
+
+  SetCorrectHeaders(m_state);
+  return true;
+}
+
 bool CCurlFile::OpenForWrite(const CURL& url, bool bOverWrite)
 {
   if(m_opened)
@@ -1159,10 +1223,11 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   // We can't seek beyond EOF
   if (m_state->m_fileSize && nextPos > m_state->m_fileSize) return -1;
 
-  if(m_state->Seek(nextPos))
+  // an idle state has nothing buffered and no transfer to reuse
+  if(!m_idle && m_state->Seek(nextPos))
     return nextPos;
 
-  if (m_multisession)
+  if (m_multisession && !m_idle)
   {
     if (!m_oldState)
     {
@@ -1190,6 +1255,7 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   }
   else
     m_state->Disconnect();
+  m_idle = false;
 
   // re-setup common curl options
   SetCommonOptions(m_state);
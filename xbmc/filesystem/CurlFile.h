@@ -68,6 +68,25 @@ namespace XFILE
       bool ReadData(CStdString& strHTML);
       bool Download(const CStdString& strURL, const CStdString& strFileName, LPDWORD pdwSize = NULL);
       bool IsInternet();
+
+      /*!
+       \brief Requests the bytes from start up to end of a file
+       Unlike a seek the request is bounded, so once it has been read completely
+       the connection is kept alive and the next range is fetched over it.
+       May be called again on the opened file for the next range.
+       \return false if the server didn't return the range
+       */
+      bool OpenRange(const CURL& url, int64_t start, int64_t end);
+      /*!
+       \brief Whether ranges of the opened file may be fetched over other connections
+       */
+      bool CanOpenRange() const                                  { return m_seekable && m_multisession; }
+      /*!
+       \brief Drops the running transfer of the opened file but keeps its length
+       The connection is made again by the next Seek(), which has to come before any Read().
+       */
+      void Idle();
+
       void Cancel();
       void Reset();
       void SetUserAgent(CStdString sUserAgent)                   { m_userAgent = sUserAgent; }
@@ -121,6 +140,7 @@ namespace XFILE
           bool            m_bFirstLoop;
           bool            m_isPaused;
           bool            m_sendRange;
+          int64_t         m_rangeEnd;         // end of a bounded request, 0 to read to the end of the file
 
           char*           m_readBuffer;
 
@@ -187,6 +207,7 @@ namespace XFILE
       bool            m_useOldHttpVersion;
       bool            m_seekable;
       bool            m_multisession;
+      bool            m_idle;
       bool            m_skipshout;
       bool            m_postdataset;
 
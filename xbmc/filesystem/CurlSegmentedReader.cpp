@@ -0,0 +1,332 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "CurlSegmentedReader.h"
+#include "CurlFile.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/log.h"
+
+#include <string.h>
+
+using namespace XFILE;
+
+#define SEGMENT_READ_SIZE (64*1024)
+
+namespace XFILE
+{
+  /*!
+   \brief One connection of a CCurlSegmentedReader
+   Fetches whatever segment the reader hands out next, over the same curl
+   session as the one before.
+   */
+  class CSegmentWorker : public CThread
+  {
+  public:
+    CSegmentWorker(CCurlSegmentedReader &reader, unsigned int index)
+      : CThread("CurlSegment")
+      , m_reader(reader)
+      , m_index(index)
+    {
+    }
+
+  protected:
+    virtual void Process()
+    {
+      while (!m_bStop)
+      {
+        CCurlSegmentedReader::Segment *segment = m_reader.Take(m_index);
+        if (!segment)
+        {
+          AbortableWait(m_reader.m_work, 100);
+          continue;
+        }
+
+        unsigned int start = XbmcThreads::SystemClockMillis();
+        unsigned int size = segment->data.size();
+        bool success = m_file.OpenRange(m_reader.m_url, segment->start + segment->filled, segment->end);
+        while (success && segment->filled < size)
+        {
+          // only this worker moves filled while it owns the segment
+          int read = m_file.Read(&segment->data[segment->filled], std::min<unsigned int>(size - segment->filled, SEGMENT_READ_SIZE));
+          if (read <= 0)
+            success = false;
+          else if (!m_reader.Filled(segment, read))
+            break;
+        }
+        m_reader.Finished(segment, success && segment->filled == size, XbmcThreads::SystemClockMillis() - start);
+      }
+      m_file.Close();
+    }
+
+  private:
+    CCurlSegmentedReader &m_reader;
+    unsigned int m_index;
+    CCurlFile m_file;
+  };
+}
+
+CCurlSegmentedReader::CCurlSegmentedReader(unsigned int maxConnections, unsigned int segmentSize)
+{
+  m_length = 0;
+  m_position = 0;
+  m_maxConnections = std::max(maxConnections, 1U);
+  m_segmentSize = segmentSize;
+  m_connections = std::min(m_maxConnections, 2U);
+  m_cancelled = false;
+  m_windowBytes = 0;
+  m_windowMillis = 0;
+  m_windowCount = 0;
+  m_lastRate = 0;
+}
+
+CCurlSegmentedReader::~CCurlSegmentedReader()
+{
+  Close();
+}
+
+bool CCurlSegmentedReader::Open(const CURL &url, int64_t length, int64_t position)
+{
+  Close();
+
+  if (length <= 0)
+    return false;
+
+  CSingleLock lock(m_section);
+  m_url = url;
+  m_length = length;
+  m_position = position;
+  m_cancelled = false;
+  m_connections = std::min(m_maxConnections, 2U);
+  m_windowBytes = 0;
+  m_windowMillis = 0;
+  m_windowCount = 0;
+  m_lastRate = 0;
+  m_data.Reset();
+  Schedule();
+
+  CLog::Log(LOGDEBUG, "CCurlSegmentedReader::Open - reading %s over up to %u connections", m_url.GetRedacted().c_str(), m_maxConnections);
+  return true;
+}
+
+void CCurlSegmentedReader::Close()
+{
+  Cancel();
+
+  // the workers may still be inside a transfer, so they are stopped without the lock held
+  std::vector<CSegmentWorker*> workers;
+  {
+    CSingleLock lock(m_section);
+    workers.swap(m_workers);
+  }
+  for (std::vector<CSegmentWorker*>::iterator it = workers.begin(); it != workers.end(); ++it)
+    (*it)->StopThread(false);
+  for (std::vector<CSegmentWorker*>::iterator it = workers.begin(); it != workers.end(); ++it)
+  {
+    (*it)->StopThread(true);
+    delete *it;
+  }
+
+  CSingleLock lock(m_section);
+  for (std::deque<Segment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+    delete *it;
+  m_segments.clear();
+}
+
+void CCurlSegmentedReader::Cancel()
+{
+  CSingleLock lock(m_section);
+  m_cancelled = true;
+  m_data.Set();
+  m_work.Set();
+}
+
+int CCurlSegmentedReader::Read(char *buffer, size_t size)
+{
+  CSingleLock lock(m_section);
+  while (!m_cancelled)
+  {
+    if (m_position >= m_length)
+      return 0;
+
+    Schedule();
+
+    // after Schedule() the front segment holds the read position
+    Segment *segment = m_segments.front();
+    unsigned int offset = (unsigned int)(m_position - segment->start);
+    if (offset < segment->filled)
+    {
+      size_t amount = std::min<size_t>(size, segment->filled - offset);
+      memcpy(buffer, &segment->data[offset], amount);
+      m_position += amount;
+      return (int)amount;
+    }
+
+    if (segment->failed)
+    {
+      CLog::Log(LOGERROR, "CCurlSegmentedReader::Read - failed to fetch %"PRId64"-%"PRId64" of %s",
+                segment->start, segment->end, m_url.GetRedacted().c_str());
+      return -1;
+    }
+
+    m_data.Reset();
+    CSingleExit exit(m_section);
+    m_data.WaitMSec(100);
+  }
+  return -1;
+}
+
+int64_t CCurlSegmentedReader::Seek(int64_t position)
+{
+  CSingleLock lock(m_section);
+  if (position < 0 || position > m_length)
+    return -1;
+
+  // segments that are still ahead of the new position are kept
+  m_position = position;
+  if (m_position < m_length)
+    Schedule();
+  return m_position;
+}
+
+CCurlSegmentedReader::Segment *CCurlSegmentedReader::Take(unsigned int index)
+{
+  CSingleLock lock(m_section);
+  if (m_cancelled || index >= m_connections)
+    return NULL;
+
+  for (std::deque<Segment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+  {
+    Segment *segment = *it;
+    if (!segment->worker && !segment->failed && segment->filled < segment->data.size())
+    {
+      segment->worker = m_workers[index];
+      return segment;
+    }
+  }
+  return NULL;
+}
+
+bool CCurlSegmentedReader::Filled(Segment *segment, unsigned int amount)
+{
+  CSingleLock lock(m_section);
+  segment->filled += amount;
+  m_data.Set();
+  return !segment->dropped && !m_cancelled;
+}
+
+void CCurlSegmentedReader::Finished(Segment *segment, bool success, unsigned int millis)
+{
+  CSingleLock lock(m_section);
+  segment->worker = NULL;
+  if (segment->dropped)
+  {
+    delete segment;
+    return;
+  }
+
+  if (success)
+    Adapt(segment->data.size(), millis);
+  else if (!m_cancelled && ++segment->retries > (unsigned int)g_advancedSettings.m_curlretries)
+    segment->failed = true;
+
+  m_data.Set();
+  m_work.Set();
+}
+
+void CCurlSegmentedReader::Schedule()
+{
+  int64_t first = m_position - m_position % m_segmentSize;
+
+  // keep the segments following on the one of the read position, drop the others
+  std::deque<Segment*> kept;
+  int64_t next = first;
+  for (std::deque<Segment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it)
+  {
+    if ((*it)->start == next)
+    {
+      kept.push_back(*it);
+      next = (*it)->end;
+    }
+    else
+      Drop(*it);
+  }
+  m_segments.swap(kept);
+
+  // one segment more than connections, so a connection finishing early has something to fetch
+  while (m_segments.size() < m_connections + 1 && next < m_length)
+  {
+    Segment *segment = new Segment;
+    segment->start = next;
+    segment->end = std::min(next + m_segmentSize, m_length);
+    segment->data.resize((size_t)(segment->end - segment->start));
+    segment->filled = 0;
+    segment->retries = 0;
+    segment->worker = NULL;
+    segment->failed = false;
+    segment->dropped = false;
+    m_segments.push_back(segment);
+    next = segment->end;
+  }
+
+  while (m_workers.size() < m_connections)
+  {
+    CSegmentWorker *worker = new CSegmentWorker(*this, m_workers.size());
+    m_workers.push_back(worker);
+    worker->Create();
+  }
+  m_work.Set();
+}
+
+void CCurlSegmentedReader::Drop(Segment *segment)
+{
+  // a segment in transfer is deleted by its worker once it notices
+  if (segment->worker)
+    segment->dropped = true;
+  else
+    delete segment;
+}
+
+void CCurlSegmentedReader::Adapt(unsigned int bytes, unsigned int millis)
+{
+  m_windowBytes += bytes;
+  m_windowMillis += std::max(millis, 1U);
+  if (++m_windowCount < m_connections * 2)
+    return;
+
+  // the connections run side by side, so together they manage the average rate of one times their count
+  unsigned int rate = (unsigned int)(1000 * m_windowBytes / m_windowMillis * m_connections);
+  unsigned int connections = m_connections;
+  if (rate > m_lastRate + m_lastRate / 10 && m_connections < m_maxConnections)
+    m_connections++;
+  else if (rate < m_lastRate - m_lastRate / 10 && m_connections > 1)
+    m_connections--;
+
+  if (connections != m_connections)
+    CLog::Log(LOGDEBUG, "CCurlSegmentedReader::Adapt - %u kB/s over %u connections, now using %u",
+              rate / 1024, connections, m_connections);
+
+  m_lastRate = rate;
+  m_windowBytes = 0;
+  m_windowMillis = 0;
+  m_windowCount = 0;
+}
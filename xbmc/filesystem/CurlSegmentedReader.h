@@ -0,0 +1,132 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "URL.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <deque>
+#include <vector>
+#include <stdint.h>
+
+namespace XFILE
+{
+  class CSegmentWorker;
+
+  /*!
+   \brief Reads a HTTP file over several connections at once
+
+   The file is split into segments that are fetched ahead of the read position
+   with bounded range requests, every connection keeping its curl session alive
+   from one segment to the next. On links with a high latency a single
+   connection is limited by its TCP window, several of them are not.
+
+   The number of connections starts at two and grows as long as that raises the
+   overall throughput, it shrinks again if the throughput drops. Segments that
+   were fetched ahead survive a seek into them, so seeking forward within the
+   window doesn't restart any transfer.
+   */
+  class CCurlSegmentedReader
+  {
+  public:
+    /*!
+     \param maxConnections Most parallel requests
+     \param segmentSize Bytes requested at once, also the unit of read ahead
+     */
+    CCurlSegmentedReader(unsigned int maxConnections, unsigned int segmentSize = 1024 * 1024);
+    ~CCurlSegmentedReader();
+
+    /*!
+     \brief Starts fetching a file
+     \param url The file, the server has to support range requests
+     \param length Length of the file
+     \param position Where to start reading
+     */
+    bool Open(const CURL &url, int64_t length, int64_t position = 0);
+    void Close();
+
+    /*!
+     \brief Waits for the data at the read position
+     \return The amount read, 0 at the end of the file, -1 if the data couldn't be fetched
+     */
+    int Read(char *buffer, size_t size);
+    int64_t Seek(int64_t position);
+    int64_t GetPosition() const { return m_position; }
+
+    /*!
+     \brief Aborts a waiting Read(), used when stopping the reading thread
+     */
+    void Cancel();
+
+    /*!
+     \brief Connections currently used
+     */
+    unsigned int GetConnections() const { return m_connections; }
+    /*!
+     \brief Estimated throughput of all connections together in bytes per second
+     */
+    unsigned int GetRate() const { return m_lastRate; }
+
+  private:
+    friend class CSegmentWorker;
+
+    struct Segment
+    {
+      int64_t start;
+      int64_t end;
+      std::vector<char> data;
+      unsigned int filled;      ///< bytes fetched from start on
+      unsigned int retries;
+      CSegmentWorker *worker;   ///< the connection fetching it, NULL if none
+      bool failed;
+      bool dropped;             ///< no longer wanted, deleted by its worker
+    };
+
+    // called by the workers
+    Segment *Take(unsigned int index);
+    bool Filled(Segment *segment, unsigned int amount);
+    void Finished(Segment *segment, bool success, unsigned int millis);
+
+    void Schedule();
+    void Drop(Segment *segment);
+    void Adapt(unsigned int bytes, unsigned int millis);
+
+    CURL m_url;
+    int64_t m_length;
+    int64_t m_position;
+    unsigned int m_maxConnections;
+    unsigned int m_segmentSize;
+    unsigned int m_connections;
+    bool m_cancelled;
+
+    // throughput of the segments finished since the last change of connections
+    uint64_t m_windowBytes;
+    uint64_t m_windowMillis;
+    unsigned int m_windowCount;
+    unsigned int m_lastRate;
+
+    std::deque<Segment*> m_segments;
+    std::vector<CSegmentWorker*> m_workers;
+    CCriticalSection m_section;
+    CEvent m_work;
+    CEvent m_data;
+  };
+}
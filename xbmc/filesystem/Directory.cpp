@@ -151,6 +151,10 @@ bool CDirectory::GetDirectory(const CURL& url, CFileItemList &items, const CHint
     // check our cache for this path
     if (g_directoryCache.GetDirectory(realURL.Get(), items, (hints.flags & DIR_FLAG_READ_CACHE) == DIR_FLAG_READ_CACHE))
       items.SetURL(url);
+    // interactive listings of network sources may come from disk, and are revalidated in the background
+    else if (g_application.IsCurrentThread() && allowThreads && !(hints.flags & DIR_FLAG_BYPASS_CACHE) &&
+             g_directoryCache.GetPersistentDirectory(realURL.Get(), items))
+      items.SetURL(url);
     else
     {
       // need to clear the cache (in case the directory fetch fails)
@@ -232,9 +236,9 @@ bool CDirectory::GetDirectory(const CURL& url, CFileItemList &items, const CHint
         }
       }
     }
-    // filter hidden files
+    // filter hidden files (lazy lists come out of the library which doesn't hold any)
     // TODO: we shouldn't be checking the gui setting here, callers should use getHidden instead
-    if (!CSettings::Get().GetBool("filelists.showhidden") && !(hints.flags & DIR_FLAG_GET_HIDDEN))
+    if (!CSettings::Get().GetBool("filelists.showhidden") && !(hints.flags & DIR_FLAG_GET_HIDDEN) && !items.IsLazy())
     {
       for (int i = 0; i < items.Size(); ++i)
       {
@@ -85,6 +85,14 @@ bool CDirectoryCache::GetDirectory(const CStdString& strPath, CFileItemList &ite
   return false;
 }
 
+bool CDirectoryCache::GetPersistentDirectory(const CStdString& strPath, CFileItemList &items)
+{
+  CStdString storedPath = strPath;
+  URIUtils::RemoveSlashAtEnd(storedPath);
+
+  return m_persistent.GetDirectory(storedPath, items);
+}
+
 void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
 {
   if (cacheType == DIR_CACHE_NEVER)
@@ -101,6 +109,20 @@ void CDirectoryCache::SetDirectory(const CStdString& strPath, const CFileItemLis
   // IDEALLY, any further processing on the item would actually create a new item
   // instead of altering it, but we can't really enforce that in an easy way, so
   // this is the best solution for now.
+  SetMemoryDirectory(strPath, items, cacheType);
+
+  CStdString storedPath = strPath;
+  URIUtils::RemoveSlashAtEnd(storedPath);
+
+  // and keep a copy on disk for the next time we start
+  m_persistent.SetDirectory(storedPath, items, cacheType);
+}
+
+void CDirectoryCache::SetMemoryDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
+{
+  if (cacheType == DIR_CACHE_NEVER)
+    return; // nothing to do
+
   CSingleLock lock (m_cs);
 
   CStdString storedPath = strPath;
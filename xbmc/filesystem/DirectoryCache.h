@@ -21,6 +21,7 @@
 
 #include "IDirectory.h"
 #include "Directory.h"
+#include "PersistentDirectoryCache.h"
 #include "threads/CriticalSection.h"
 
 #include <map>
@@ -50,7 +51,19 @@ namespace XFILE
     CDirectoryCache(void);
     virtual ~CDirectoryCache(void);
     bool GetDirectory(const CStdString& strPath, CFileItemList &items, bool retrieveAll = false);
+    /*!
+     \brief Retrieve a listing from the on-disk tier of the cache
+     Used for interactive listings of network sources not yet fetched this session.
+     The listing may be out of date, and is revalidated in the background.
+     \sa CPersistentDirectoryCache
+     */
+    bool GetPersistentDirectory(const CStdString& strPath, CFileItemList &items);
     void SetDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType);
+    /*!
+     \brief Put a listing into the memory cache only.
+     Used for stored listings whose revalidation found them unchanged, they're already on disk.
+     */
+    void SetMemoryDirectory(const CStdString& strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType);
     void ClearDirectory(const CStdString& strPath);
     void ClearFile(const CStdString& strFile);
     void ClearSubPaths(const CStdString& strPath);
@@ -72,6 +85,8 @@ namespace XFILE
 
     CCriticalSection m_cs;
 
+    CPersistentDirectoryCache m_persistent;
+
     unsigned int m_accessCounter;
 
 #ifdef _DEBUG
@@ -26,6 +26,8 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "CurlFile.h"
+#include "CurlSegmentedReader.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -85,6 +87,7 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
    m_seekPos = 0;
    m_readPos = 0;
    m_writePos = 0;
+   m_segmented = NULL;
    if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
    else
@@ -96,7 +99,10 @@ CFileCache::CFileCache(bool useDoubleCache) : CThread("FileCache")
        front = front / 2;
        back = back / 2;
      }
-     m_pCache = new CCircularCache(front, back);
+     if (g_advancedSettings.m_cacheMemBufferMapped)
+       m_pCache = new CMappedCircularCache(front, back);
+     else
+       m_pCache = new CCircularCache(front, back);
    }
    if (useDoubleCache)
    {
@@ -115,6 +121,7 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("Fil
   m_writePos = 0;
   m_nSeekResult = 0;
   m_chunkSize = 0;
+  m_segmented = NULL;
 }
 
 CFileCache::~CFileCache()
@@ -179,6 +186,21 @@ bool CFileCache::Open(const CURL& url)
   m_seekPossible = m_source.IoControl(IOCTRL_SEEK_POSSIBLE, NULL);
   m_chunkSize = CFile::GetChunkSize(m_source.GetChunkSize(), READ_CACHE_CHUNK_SIZE);
 
+  // large http files are fetched with parallel range requests, the source only serves as reference
+  CCurlFile *curl = dynamic_cast<CCurlFile*>(m_source.GetImplemenation());
+  if (g_advancedSettings.m_curlConnections > 1 && m_seekPossible > 0 && curl && curl->CanOpenRange()
+  &&  m_source.GetLength() > 4 * 1024 * 1024)
+  {
+    m_segmented = new CCurlSegmentedReader(g_advancedSettings.m_curlConnections);
+    if (!m_segmented->Open(url, m_source.GetLength()))
+    {
+      delete m_segmented;
+      m_segmented = NULL;
+    }
+    else
+      curl->Idle(); // reconnected by the seek if we have to fall back to it
+  }
+
   m_readPos = 0;
   m_writePos = 0;
   m_writeRate = 1024 * 1024;
@@ -223,7 +245,10 @@ void CFileCache::Process()
       bool sourceSeekFailed = false;
       if (!cacheReachEOF)
       {
-        m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
+        if (m_segmented)
+          m_nSeekResult = m_segmented->Seek(cacheMaxPos);
+        else
+          m_nSeekResult = m_source.Seek(cacheMaxPos, SEEK_SET);
         if (m_nSeekResult != cacheMaxPos)
         {
           CLog::Log(LOGERROR,"CFileCache::Process - Error %d seeking. Seek returned %"PRId64, (int)GetLastError(), m_nSeekResult);
@@ -264,9 +289,47 @@ void CFileCache::Process()
       }
     }
 
+    // read straight into the cache if the strategy allows it, saving a copy
+    char *direct = NULL;
+    size_t directSize = m_chunkSize;
+    int directRc = CACHE_RC_ERROR;
+    if (!cacheReachEOF)
+      directRc = m_pCache->GetWriteBuffer(&direct, &directSize);
+    if (directRc == CACHE_RC_WOULD_BLOCK)
+    {
+      m_cacheFull = true;
+      average.Pause();
+      m_pCache->m_space.WaitMSec(5);
+      average.Resume();
+      continue;
+    }
+
     int iRead = 0;
     if (!cacheReachEOF)
-      iRead = m_source.Read(buffer.get(), m_chunkSize);
+    {
+      char *target = directRc == CACHE_RC_OK ? direct : buffer.get();
+      size_t size = directRc == CACHE_RC_OK ? directSize : m_chunkSize;
+      if (m_segmented)
+      {
+        iRead = m_segmented->Read(target, size);
+        if (iRead < 0 && !m_bStop)
+        {
+          // a range couldn't be fetched, carry on over the single connection
+          int64_t pos = m_segmented->GetPosition();
+          CLog::Log(LOGWARNING, "CFileCache::Process - segmented read failed, continuing at %"PRId64" over one connection", pos);
+          CCurlSegmentedReader *segmented = m_segmented;
+          {
+            CSingleLock lock(m_segmentedSection);
+            m_segmented = NULL;
+          }
+          delete segmented;
+          if (m_source.Seek(pos, SEEK_SET) == pos)
+            iRead = m_source.Read(target, size);
+        }
+      }
+      else
+        iRead = m_source.Read(target, size);
+    }
     if (iRead == 0)
     {
       CLog::Log(LOGINFO, "CFileCache::Process - Hit eof.");
@@ -285,6 +348,20 @@ void CFileCache::Process()
       m_bStop = true;
 
     int iTotalWrite=0;
+    if (directRc == CACHE_RC_OK && iRead > 0)
+    {
+      if (m_pCache->CommitWrite(iRead) < 0)
+      {
+        CLog::Log(LOGERROR,"CFileCache::Process - error writing to cache");
+        m_bStop = true;
+      }
+      else
+      {
+        m_cacheFull = false;
+        iTotalWrite = iRead;
+      }
+    }
+
     while (!m_bStop && (iTotalWrite < iRead))
     {
       int iWrite = 0;
@@ -454,6 +531,9 @@ void CFileCache::Close()
   if (m_pCache)
     m_pCache->Close();
 
+  delete m_segmented;
+  m_segmented = NULL;
+
   m_source.Close();
 }
 
@@ -472,6 +552,12 @@ void CFileCache::StopThread(bool bWait /*= true*/)
   m_bStop = true;
   //Process could be waiting for seekEvent
   m_seekEvent.Set();
+  //or for a segment
+  {
+    CSingleLock lock(m_segmentedSection);
+    if (m_segmented)
+      m_segmented->Cancel();
+  }
   CThread::StopThread(bWait);
 }
 
@@ -27,6 +27,7 @@
 
 namespace XFILE
 {
+  class CCurlSegmentedReader;
 
   class CFileCache : public IFile, public CThread
   {
@@ -66,6 +67,8 @@ namespace XFILE
     bool      m_bDeleteCache;
     int        m_seekPossible;
     CFile      m_source;
+    CCurlSegmentedReader *m_segmented; // fetches http sources over several connections, NULL if not
+    CCriticalSection m_segmentedSection; // guards m_segmented against StopThread() while Process() drops it
     CStdString    m_sourcePath;
     CEvent      m_seekEvent;
     CEvent      m_seekEnded;
@@ -19,17 +19,23 @@
  */
 
 #include "threads/SystemClock.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
 #include "MultiPathDirectory.h"
 #include "Directory.h"
 #include "Util.h"
 #include "URL.h"
 #include "guilib/GUIWindowManager.h"
+#include "GUIUserMessages.h"
 #include "dialogs/GUIDialogProgress.h"
 #include "FileItem.h"
 #include "utils/StringUtils.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
 #include "utils/URIUtils.h"
+#include "settings/AdvancedSettings.h"
+
+#include <map>
 
 using namespace std;
 using namespace XFILE;
@@ -41,7 +47,125 @@ using namespace XFILE;
 // multipath:// style url.
 //
 
+namespace
+{
+/* listings of sources that answered after their multipath listing gave up are
+ * dropped when nobody came back for them within this time */
+#define LATE_LISTING_EXPIRY 60000
+
+/* The listing of a single source. It's shared between the thread listing it and
+ * every multipath listing waiting for it, so it outlives a listing that gave up. */
+struct SSourceListing
+{
+  SSourceListing(const CStdString &strPath, const CStdString &strMask, int iFlags)
+  : path(strPath), mask(strMask), flags(iFlags), success(false), done(true), finished(0)
+  {
+  }
+
+  CStdString           path;
+  CStdString           mask;
+  int                  flags;
+  CFileItemList        items;    ///< only read once done is set
+  bool                 success;
+  CEvent               done;
+  unsigned int         finished; ///< when the source answered
+  std::set<CStdString> waiting;  ///< multipaths that were shown without this source
+};
+
+typedef boost::shared_ptr<SSourceListing> SourceListingPtr;
+
+class CSourceListingThread;
+
+/* sources being listed and sources that answered late, by path, the listing
+ * threads and whether they may still start, all guarded by g_sourceSection */
+CCriticalSection                       g_sourceSection;
+std::map<CStdString, SourceListingPtr> g_sources;
+std::vector<CSourceListingThread*>     g_threads;
+bool                                   g_stopping = false;
+
+class CSourceListingThread : public CThread
+{
+public:
+  CSourceListingThread(const MultiPathSourceListerPtr &lister, const SourceListingPtr &source)
+  : CThread("MultiPathSource"), m_lister(lister), m_source(source)
+  {
+  }
+
+protected:
+  virtual void Process()
+  {
+    bool success = m_lister->GetDirectory(m_source->path, m_source->items, m_source->mask, m_source->flags);
+    if (!success)
+      CLog::Log(LOGERROR,"Error Getting Directory (%s)", m_source->path.c_str());
+
+    std::set<CStdString> waiting;
+    {
+      CSingleLock lock(g_sourceSection);
+      m_source->success  = success;
+      m_source->finished = XbmcThreads::SystemClockMillis();
+      // the windows are going away when we are stopped
+      if (!g_stopping)
+        waiting.swap(m_source->waiting);
+      m_source->done.Set();
+    }
+
+    // the refresh takes the listing, a failure included, so an offline
+    // source isn't listed over and over again
+    for (std::set<CStdString>::const_iterator it = waiting.begin(); it != waiting.end(); ++it)
+    {
+      CLog::Log(LOGDEBUG, "%s - %s answered late, refreshing %s", __FUNCTION__,
+                CURL::GetRedacted(m_source->path).c_str(), CURL::GetRedacted(*it).c_str());
+      CGUIMessage message(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_PATH);
+      message.SetStringParam(*it);
+      g_windowManager.SendThreadMessage(message);
+    }
+  }
+
+private:
+  MultiPathSourceListerPtr m_lister;
+  SourceListingPtr         m_source;
+};
+
+/* needs g_sourceSection */
+void ExpireSources()
+{
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  for (std::map<CStdString, SourceListingPtr>::iterator it = g_sources.begin(); it != g_sources.end(); )
+  {
+    if (it->second->done.WaitMSec(0) && now - it->second->finished > LATE_LISTING_EXPIRY)
+      g_sources.erase(it++);
+    else
+      ++it;
+  }
+}
+
+/* needs g_sourceSection, the threads are deleted once they are done */
+void ReapThreads()
+{
+  for (std::vector<CSourceListingThread*>::iterator it = g_threads.begin(); it != g_threads.end(); )
+  {
+    if (!(*it)->IsRunning())
+    {
+      delete *it;
+      it = g_threads.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+}
+
+bool CMultiPathSourceLister::GetDirectory(const CStdString &strPath, CFileItemList &items, const CStdString &strMask, int flags)
+{
+  return CDirectory::GetDirectory(strPath, items, strMask, flags);
+}
+
 CMultiPathDirectory::CMultiPathDirectory()
+: m_lister(new CMultiPathSourceLister)
+{}
+
+CMultiPathDirectory::CMultiPathDirectory(const MultiPathSourceListerPtr &lister)
+: m_lister(lister)
 {}
 
 CMultiPathDirectory::~CMultiPathDirectory()
@@ -55,12 +179,60 @@ bool CMultiPathDirectory::GetDirectory(const CURL& url, CFileItemList &items)
   if (!GetPaths(url, vecPaths))
     return false;
 
+  // start a listing for every source that isn't being listed already
+  vector<SourceListingPtr> sources;
+  {
+    CSingleLock lock(g_sourceSection);
+    if (g_stopping)
+      return false;
+
+    ExpireSources();
+    ReapThreads();
+    for (unsigned int i = 0; i < vecPaths.size(); ++i)
+    {
+      map<CStdString, SourceListingPtr>::iterator it = g_sources.find(vecPaths[i]);
+      if (it != g_sources.end() && it->second->mask == m_strFileMask && it->second->flags == m_flags)
+      {
+        sources.push_back(it->second);
+        continue;
+      }
+
+      CLog::Log(LOGDEBUG,"Getting Directory (%s)", vecPaths[i].c_str());
+      SourceListingPtr source(new SSourceListing(vecPaths[i], m_strFileMask, m_flags));
+      g_sources[vecPaths[i]] = source;
+      sources.push_back(source);
+      CSourceListingThread *thread = new CSourceListingThread(m_lister, source);
+      g_threads.push_back(thread);
+      thread->Create();
+    }
+  }
+
   XbmcThreads::EndTime progressTime(3000); // 3 seconds before showing progress bar
+  // only a window listing gives up on slow sources, it is refreshed once they
+  // answered. Everyone else, the scanners foremost, needs the complete listing
+  // and waits as long as the sources' own timeouts let them.
+  XbmcThreads::EndTime timeout;
+  if (m_flags & DIR_FLAG_ALLOW_PROMPT)
+    timeout.Set(g_advancedSettings.m_multiPathTimeout);
+  else
+    timeout.SetInfinite();
   CGUIDialogProgress* dlgProgress = NULL;
 
-  unsigned int iFailures = 0;
-  for (unsigned int i = 0; i < vecPaths.size(); ++i)
+  for (unsigned int i = 0; i < sources.size(); )
   {
+    if (sources[i]->done.WaitMSec(std::min(timeout.MillisLeft(), 100u)))
+    {
+      ++i;
+      if (dlgProgress)
+      {
+        dlgProgress->SetProgressAdvance();
+        dlgProgress->Progress();
+      }
+      continue;
+    }
+    if (timeout.IsTimePast())
+      break;
+
     // show the progress dialog if we have passed our time limit
     if (progressTime.IsTimePast() && !dlgProgress)
     {
@@ -73,39 +245,53 @@ bool CMultiPathDirectory::GetDirectory(const CURL& url, CFileItemList &items)
         dlgProgress->SetLine(2, "");
         dlgProgress->StartModal();
         dlgProgress->ShowProgressBar(true);
-        dlgProgress->SetProgressMax((int)vecPaths.size()*2);
-        dlgProgress->Progress();
+        dlgProgress->SetProgressMax((int)sources.size());
+        for (unsigned int j = 0; j < i; ++j)
+          dlgProgress->SetProgressAdvance();
       }
     }
     if (dlgProgress)
     {
-      CURL url(vecPaths[i]);
+      CURL url(sources[i]->path);
       dlgProgress->SetLine(1, url.GetWithoutUserDetails());
-      dlgProgress->SetProgressAdvance();
       dlgProgress->Progress();
     }
+  }
 
-    CFileItemList tempItems;
-    CLog::Log(LOGDEBUG,"Getting Directory (%s)", vecPaths[i].c_str());
-    if (CDirectory::GetDirectory(vecPaths[i], tempItems, m_strFileMask, m_flags))
-      items.Append(tempItems);
-    else
-    {
-      CLog::Log(LOGERROR,"Error Getting Directory (%s)", vecPaths[i].c_str());
-      iFailures++;
-    }
+  if (dlgProgress)
+    dlgProgress->Close();
 
-    if (dlgProgress)
+  unsigned int iFailures = 0;
+  {
+    CSingleLock lock(g_sourceSection);
+    for (unsigned int i = 0; i < sources.size(); ++i)
     {
-      dlgProgress->SetProgressAdvance();
-      dlgProgress->Progress();
+      const SourceListingPtr &source = sources[i];
+      if (!source->done.WaitMSec(0))
+      {
+        CLog::Log(LOGWARNING, "%s - %s didn't answer in time, listing without it", __FUNCTION__, CURL::GetRedacted(source->path).c_str());
+        source->waiting.insert(url.Get());
+        continue;
+      }
+
+      // this listing takes the source, the next one lists it again
+      map<CStdString, SourceListingPtr>::iterator it = g_sources.find(source->path);
+      if (it != g_sources.end() && it->second == source)
+        g_sources.erase(it);
+
+      if (!source->success)
+      {
+        iFailures++;
+        continue;
+      }
+
+      // the items may be shared with another listing and MergeItems changes them
+      for (int j = 0; j < source->items.Size(); ++j)
+        items.Add(CFileItemPtr(new CFileItem(*source->items[j])));
     }
   }
 
-  if (dlgProgress)
-    dlgProgress->Close();
-
-  if (iFailures == vecPaths.size())
+  if (iFailures == sources.size())
     return false;
 
   // merge like-named folders into a sub multipath:// style url
@@ -114,6 +300,24 @@ bool CMultiPathDirectory::GetDirectory(const CURL& url, CFileItemList &items)
   return true;
 }
 
+void CMultiPathDirectory::StopListings()
+{
+  std::vector<CSourceListingThread*> threads;
+  {
+    CSingleLock lock(g_sourceSection);
+    g_stopping = true;
+    threads.swap(g_threads);
+    g_sources.clear();
+  }
+
+  // the sources may still be answering, so they are waited for without the lock held
+  for (std::vector<CSourceListingThread*>::iterator it = threads.begin(); it != threads.end(); ++it)
+  {
+    (*it)->StopThread();
+    delete *it;
+  }
+}
+
 bool CMultiPathDirectory::Exists(const CURL& url)
 {
   CLog::Log(LOGDEBUG,"Testing Existence (%s)", url.GetRedacted().c_str());
@@ -20,16 +20,41 @@
  */
 
 #include <set>
+#include <boost/shared_ptr.hpp>
 #include "IDirectory.h"
 #include "utils/StdString.h"
 
 namespace XFILE
 {
+/*!
+ \brief Lists one source of a multipath, the tests replace it to inject latency
+ */
+class CMultiPathSourceLister
+{
+public:
+  virtual ~CMultiPathSourceLister() {}
+  virtual bool GetDirectory(const CStdString &strPath, CFileItemList &items, const CStdString &strMask, int flags);
+};
+
+typedef boost::shared_ptr<CMultiPathSourceLister> MultiPathSourceListerPtr;
+
+/*!
+ \brief Combines the listings of several sources
+
+ The sources are listed in parallel, each on its own thread. For listings that
+ allow prompting, i.e. those of a window, sources that don't answer within
+ advancedsettings' multipathtimeout are left behind and the listing returns
+ what arrived. Other listings wait for every source. A source that answers
+ later keeps its listing around and asks the windows showing the multipath to
+ refresh, the refresh then picks it up instead of listing the source again.
+ The listing threads are joined by StopListings() on shutdown.
+ */
 class CMultiPathDirectory :
       public IDirectory
 {
 public:
   CMultiPathDirectory(void);
+  CMultiPathDirectory(const MultiPathSourceListerPtr &lister);
   virtual ~CMultiPathDirectory(void);
   virtual bool GetDirectory(const CURL& url, CFileItemList &items);
   virtual bool Exists(const CURL& url);
@@ -43,9 +68,17 @@ public:
   static CStdString ConstructMultiPath(const std::vector<CStdString> &vecPaths);
   static CStdString ConstructMultiPath(const std::set<CStdString> &setPaths);
 
+  /*!
+   \brief Waits for the sources still being listed, called on shutdown
+   No listing is started afterwards and late answers don't refresh the windows anymore.
+   */
+  static void StopListings();
+
 private:
   void MergeItems(CFileItemList &items);
   static void AddToMultiPath(CStdString& strMultiPath, const CStdString& strPath);
   CStdString ConstructMultiPath(const CFileItemList& items, const std::vector<int> &stack);
+
+  MultiPathSourceListerPtr m_lister;
 };
 }
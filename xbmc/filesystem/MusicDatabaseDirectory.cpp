@@ -55,8 +55,11 @@ bool CMusicDatabaseDirectory::GetDirectory(const CURL& url, CFileItemList &items
   bool bResult = pNode->GetChilds(items);
   for (int i=0;i<items.Size();++i)
   {
+    if (!items.IsFolder(i))
+      continue;
+
     CFileItemPtr item = items[i];
-    if (item->m_bIsFolder && !item->HasIcon() && !item->HasArt("thumb"))
+    if (!item->HasIcon() && !item->HasArt("thumb"))
     {
       CStdString strImage = GetIcon(item->GetPath());
       if (!strImage.empty() && g_TextureManager.HasTexture(strImage))
@@ -0,0 +1,404 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PersistentDirectoryCache.h"
+#include "DirectoryCache.h"
+#include "DirectoryFactory.h"
+#include "File.h"
+#include "SpecialProtocol.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "guilib/GUIWindowManager.h"
+#include "GUIUserMessages.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "utils/Archive.h"
+#include "utils/Crc32.h"
+#include "utils/JobManager.h"
+#include "utils/log.h"
+#include "utils/md5.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include <memory>
+#include <string.h>
+
+using namespace std;
+using namespace XFILE;
+
+#define DIRCACHE_FOLDER  "special://temp/dircache/"
+#define DIRCACHE_VERSION 1
+
+class CPersistentDirectoryCache::CStoreJob : public CJob
+{
+public:
+  CStoreJob(CPersistentDirectoryCache *cache, const CStdString &strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
+  : m_cache(cache), m_path(strPath), m_cacheType(cacheType)
+  {
+    m_items.Copy(items);
+  }
+
+  virtual const char *GetType() const { return "dircachestore"; }
+
+  virtual bool DoWork()
+  {
+    return m_cache->Write(m_path, m_items, m_cacheType);
+  }
+
+private:
+  CPersistentDirectoryCache *m_cache;
+  CStdString     m_path;
+  CFileItemList  m_items;
+  DIR_CACHE_TYPE m_cacheType;
+};
+
+class CPersistentDirectoryCache::CRevalidateJob : public CJob
+{
+public:
+  CRevalidateJob(CPersistentDirectoryCache *cache, const CStdString &strPath, const CFileItemList &items, int64_t mtime, const CStdString &hash, DIR_CACHE_TYPE cacheType)
+  : m_cache(cache), m_path(strPath), m_mtime(mtime), m_hash(hash), m_cacheType(cacheType)
+  {
+    m_items.Copy(items);
+  }
+
+  virtual const char *GetType() const { return "dircacherevalidate"; }
+
+  virtual bool DoWork()
+  {
+    // a stat of the directory is all we need if the source gives us a modification time
+    int64_t mtime = m_cache->m_source->GetModificationTime(m_path);
+    if (mtime != 0 && mtime == m_mtime)
+    {
+      // the stored listing is current, later lookups come from memory
+      g_directoryCache.SetMemoryDirectory(m_path, m_items, m_cacheType);
+      return true;
+    }
+
+    CFileItemList items;
+    items.SetPath(m_path);
+    if (!m_cache->m_source->GetDirectory(m_path, items))
+      return false;
+
+    // hand the fresh listing to the memory cache and update our copy on disk
+    g_directoryCache.SetMemoryDirectory(m_path, items, m_cacheType);
+    m_cache->SetDirectory(m_path, items, m_cacheType);
+
+    if (GetHash(items) != m_hash)
+    {
+      CLog::Log(LOGDEBUG, "%s - stored listing of %s is out of date", __FUNCTION__, CURL::GetRedacted(m_path).c_str());
+      CGUIMessage message(GUI_MSG_NOTIFY_ALL, 0, 0, GUI_MSG_UPDATE_PATH);
+      message.SetStringParam(m_path);
+      g_windowManager.SendThreadMessage(message);
+    }
+    return true;
+  }
+
+  const CStdString &GetPath() const { return m_path; }
+
+private:
+  CPersistentDirectoryCache *m_cache;
+  CStdString     m_path;
+  CFileItemList  m_items;
+  int64_t        m_mtime;
+  CStdString     m_hash;
+  DIR_CACHE_TYPE m_cacheType;
+};
+
+int64_t CPersistentDirectorySource::GetModificationTime(const CStdString &strPath)
+{
+  struct __stat64 buffer;
+  if (CFile::Stat(strPath, &buffer) == 0)
+    return (int64_t)buffer.st_mtime;
+  return 0;
+}
+
+bool CPersistentDirectorySource::GetDirectory(const CStdString &strPath, CFileItemList &items)
+{
+  // list the source directly, the directory cache would hand us our own listing
+  CURL url(strPath);
+  auto_ptr<IDirectory> directory(CDirectoryFactory::Create(url));
+  if (!directory.get())
+    return false;
+
+  return directory->GetDirectory(url, items);
+}
+
+CPersistentDirectoryCache::CPersistentDirectoryCache()
+: m_source(new CPersistentDirectorySource)
+{
+  m_indexLoaded = false;
+  m_totalSize = 0;
+  m_accessCounter = 0;
+}
+
+CPersistentDirectoryCache::CPersistentDirectoryCache(const PersistentDirectorySourcePtr &source)
+: m_source(source)
+{
+  m_indexLoaded = false;
+  m_totalSize = 0;
+  m_accessCounter = 0;
+}
+
+CPersistentDirectoryCache::~CPersistentDirectoryCache()
+{
+}
+
+bool CPersistentDirectoryCache::IsCached(const CStdString &strPath) const
+{
+  if (g_advancedSettings.m_dirCacheDiskSize == 0)
+    return false;
+
+  return URIUtils::IsSmb(strPath) || URIUtils::IsNfs(strPath) ||
+         URIUtils::IsAfp(strPath) || URIUtils::IsUPnP(strPath);
+}
+
+bool CPersistentDirectoryCache::GetDirectory(const CStdString &strPath, CFileItemList &items)
+{
+  if (!IsCached(strPath))
+    return false;
+
+  CSingleLock lock(m_section);
+
+  // once we've listed the source this session, we behave like the memory cache
+  if (m_fresh.find(strPath) != m_fresh.end())
+    return false;
+
+  LoadIndex();
+  CStdString cacheFile = GetCacheFile(strPath);
+  Index::iterator i = m_index.find(cacheFile);
+  if (i == m_index.end())
+    return false;
+  i->second.m_lastAccess = m_accessCounter++;
+  lock.Leave();
+
+  int64_t mtime;
+  CStdString hash;
+  DIR_CACHE_TYPE cacheType;
+  if (!Read(cacheFile, strPath, mtime, hash, cacheType, &items))
+    return false;
+
+  lock.Enter();
+  if (m_pending.insert(strPath).second)
+    CJobManager::GetInstance().AddJob(new CRevalidateJob(this, strPath, items, mtime, hash, cacheType), this, CJob::PRIORITY_LOW);
+  return true;
+}
+
+void CPersistentDirectoryCache::SetDirectory(const CStdString &strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
+{
+  if (!IsCached(strPath))
+    return;
+
+  CSingleLock lock(m_section);
+  m_fresh.insert(strPath);
+  CJobManager::GetInstance().AddJob(new CStoreJob(this, strPath, items, cacheType), this, CJob::PRIORITY_LOW);
+}
+
+void CPersistentDirectoryCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  // stores have nothing to report
+  if (strcmp(job->GetType(), "dircacherevalidate") != 0)
+    return;
+
+  CRevalidateJob *revalidate = static_cast<CRevalidateJob*>(job);
+
+  CSingleLock lock(m_section);
+  m_pending.erase(revalidate->GetPath());
+  if (success)
+    m_fresh.insert(revalidate->GetPath());
+}
+
+CStdString CPersistentDirectoryCache::GetCacheFile(const CStdString &strPath)
+{
+  Crc32 crc;
+  crc.ComputeFromLowerCase(strPath);
+  return StringUtils::Format(DIRCACHE_FOLDER "%08x.dc", (unsigned __int32)crc);
+}
+
+CStdString CPersistentDirectoryCache::GetHash(const CFileItemList &items)
+{
+  // hash the filenames, sizes and dates, as the video scanner does
+  XBMC::XBMC_MD5 md5state;
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    const CFileItemPtr item = items[i];
+    md5state.append(item->GetPath());
+    md5state.append((unsigned char *)&item->m_dwSize, sizeof(item->m_dwSize));
+    FILETIME time = item->m_dateTime;
+    md5state.append((unsigned char *)&time, sizeof(FILETIME));
+  }
+  CStdString hash;
+  md5state.getDigest(hash);
+  return hash;
+}
+
+bool CPersistentDirectoryCache::Read(const CStdString &strCacheFile, const CStdString &strPath, int64_t &mtime, CStdString &hash, DIR_CACHE_TYPE &cacheType, CFileItemList *items)
+{
+  CFile file;
+  if (!file.Open(strCacheFile))
+    return false;
+
+  CArchive ar(&file, CArchive::load);
+  int version;
+  ar >> version;
+  if (version != DIRCACHE_VERSION)
+    return false;
+
+  // make sure this is our directory, and not a crc collision
+  CStdString path;
+  ar >> path;
+  if (!path.Equals(strPath))
+    return false;
+
+  int type;
+  long long int time;
+  ar >> type;
+  ar >> time;
+  ar >> hash;
+  cacheType = (DIR_CACHE_TYPE)type;
+  mtime = time;
+
+  if (items)
+  {
+    ar >> *items;
+    items->SetPath(strPath);
+  }
+  return true;
+}
+
+bool CPersistentDirectoryCache::Write(const CStdString &strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType)
+{
+  CStdString cacheFile = GetCacheFile(strPath);
+  int64_t mtime = m_source->GetModificationTime(strPath);
+  CStdString hash = GetHash(items);
+
+  {
+    CSingleLock lock(m_section);
+    LoadIndex();
+  }
+
+  // nothing to do if the stored copy is identical
+  int64_t storedMtime;
+  CStdString storedHash;
+  DIR_CACHE_TYPE storedCacheType;
+  if (Read(cacheFile, strPath, storedMtime, storedHash, storedCacheType, NULL) &&
+      storedMtime == mtime && storedHash == hash && storedCacheType == cacheType)
+    return true;
+
+  // write to a temporary file first, so readers never see a partial listing
+  CSingleLock writeLock(m_writeSection);
+  CStdString tempFile = cacheFile + ".tmp";
+  uint64_t size = 0;
+  {
+    CFile file;
+    if (!file.OpenForWrite(tempFile, true))
+      return false;
+
+    CArchive ar(&file, CArchive::store);
+    ar << (int)DIRCACHE_VERSION;
+    ar << strPath;
+    ar << (int)cacheType;
+    ar << (long long int)mtime;
+    ar << hash;
+    ar << const_cast<CFileItemList&>(items);
+    ar.Close();
+    size = file.GetLength();
+    file.Close();
+  }
+
+  CSingleLock lock(m_section);
+  if (!CFile::Rename(tempFile, cacheFile))
+  {
+    CFile::Delete(cacheFile);
+    if (!CFile::Rename(tempFile, cacheFile))
+    {
+      CLog::Log(LOGERROR, "%s - unable to store listing of %s", __FUNCTION__, CURL::GetRedacted(strPath).c_str());
+      CFile::Delete(tempFile);
+      return false;
+    }
+  }
+
+  CEntry &entry = m_index[cacheFile];
+  m_totalSize -= entry.m_size;
+  entry.m_size = size;
+  entry.m_lastAccess = m_accessCounter++;
+  m_totalSize += size;
+
+  CheckIfFull();
+  return true;
+}
+
+void CPersistentDirectoryCache::LoadIndex()
+{
+  if (m_indexLoaded)
+    return;
+  m_indexLoaded = true;
+
+  CDirectory::Create(DIRCACHE_FOLDER);
+
+  // list the cache folder directly, bypassing CDirectory and thus the directory cache itself
+  CURL url(CSpecialProtocol::TranslatePath(DIRCACHE_FOLDER));
+  auto_ptr<IDirectory> directory(CDirectoryFactory::Create(url));
+  CFileItemList items;
+  if (!directory.get() || !directory->GetDirectory(url, items))
+    return;
+
+  // oldest listings are the first to go
+  items.Sort(SortByDate, SortOrderAscending);
+  for (int i = 0; i < items.Size(); ++i)
+  {
+    const CFileItemPtr item = items[i];
+    if (item->m_bIsFolder)
+      continue;
+
+    CStdString cacheFile = DIRCACHE_FOLDER + URIUtils::GetFileName(item->GetPath());
+    if (!URIUtils::HasExtension(cacheFile, ".dc"))
+    {
+      // leftover from an interrupted write
+      CFile::Delete(cacheFile);
+      continue;
+    }
+
+    CEntry &entry = m_index[cacheFile];
+    entry.m_size = item->m_dwSize;
+    entry.m_lastAccess = m_accessCounter++;
+    m_totalSize += entry.m_size;
+  }
+  CLog::Log(LOGDEBUG, "%s - %u stored listings, %"PRIu64" bytes", __FUNCTION__, (unsigned int)m_index.size(), m_totalSize);
+
+  CheckIfFull();
+}
+
+void CPersistentDirectoryCache::CheckIfFull()
+{
+  uint64_t maxSize = g_advancedSettings.m_dirCacheDiskSize;
+
+  while (m_totalSize > maxSize && !m_index.empty())
+  {
+    Index::iterator lastAccessed = m_index.begin();
+    for (Index::iterator i = m_index.begin(); i != m_index.end(); ++i)
+    {
+      if (i->second.m_lastAccess < lastAccessed->second.m_lastAccess)
+        lastAccessed = i;
+    }
+    CFile::Delete(lastAccessed->first);
+    m_totalSize -= lastAccessed->second.m_size;
+    m_index.erase(lastAccessed);
+  }
+}
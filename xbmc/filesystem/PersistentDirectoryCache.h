@@ -0,0 +1,140 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "IDirectory.h"
+#include "threads/CriticalSection.h"
+#include "utils/Job.h"
+#include "utils/StdString.h"
+
+#include <map>
+#include <set>
+#include <boost/shared_ptr.hpp>
+
+class CFileItemList;
+
+namespace XFILE
+{
+  /*!
+   \brief Stats and lists the directories of stored listings, the tests replace it to fake a source
+   */
+  class CPersistentDirectorySource
+  {
+  public:
+    virtual ~CPersistentDirectorySource() {}
+    /*! \return the modification time of the directory, 0 if the source doesn't give one. */
+    virtual int64_t GetModificationTime(const CStdString &strPath);
+    virtual bool GetDirectory(const CStdString &strPath, CFileItemList &items);
+  };
+
+  typedef boost::shared_ptr<CPersistentDirectorySource> PersistentDirectorySourcePtr;
+
+  /*!
+   \brief Persistent, size bounded on-disk tier of the directory cache.
+
+   Listings of network sources (smb, nfs, afp and upnp) handed to the directory cache are written
+   in the background to special://temp/dircache/, one CArchive file per directory, together with
+   the modification time of the directory and a hash of its contents.  On the first interactive
+   listing of such a directory after startup, the stored listing is returned immediately and is
+   revalidated in the background: a cheap stat of the directory is enough if its modification time
+   is unchanged, otherwise the directory is listed again, and the GUI is asked to refresh the path
+   if the listing changed.
+
+   The tier is disabled unless a byte budget is set with <network><dircachesize> in
+   advancedsettings.xml.  The least recently used listings are removed when the budget is exceeded.
+
+   \sa CDirectoryCache
+   */
+  class CPersistentDirectoryCache : public IJobCallback
+  {
+  public:
+    CPersistentDirectoryCache();
+    CPersistentDirectoryCache(const PersistentDirectorySourcePtr &source);
+    virtual ~CPersistentDirectoryCache();
+
+    /*!
+     \brief Whether listings of the given path are kept on disk.
+     \param strPath the directory, as used as key by CDirectoryCache.
+     \return true if the tier is enabled and the path is on a network source.
+     */
+    bool IsCached(const CStdString &strPath) const;
+
+    /*!
+     \brief Retrieve a stored listing and schedule its revalidation.
+     Only listings that have not been fetched from the source during this session are returned.
+     \param strPath the directory, as used as key by CDirectoryCache.
+     \param items the list to fill with the stored items.
+     \return true if a stored listing was found, false otherwise.
+     */
+    bool GetDirectory(const CStdString &strPath, CFileItemList &items);
+
+    /*!
+     \brief Store a listing that has just been fetched from its source.
+     The listing is written to disk in the background.
+     \param strPath the directory, as used as key by CDirectoryCache.
+     \param items the listing to store.
+     \param cacheType the cache type of the directory.
+     */
+    void SetDirectory(const CStdString &strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType);
+
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+  private:
+    class CEntry
+    {
+    public:
+      CEntry() : m_size(0), m_lastAccess(0) {};
+      uint64_t     m_size;
+      unsigned int m_lastAccess;
+    };
+
+    class CStoreJob;
+    class CRevalidateJob;
+    friend class CStoreJob;
+    friend class CRevalidateJob;
+
+    static CStdString GetCacheFile(const CStdString &strPath);
+    static CStdString GetHash(const CFileItemList &items);
+
+    /*! \brief Read the header of a stored listing, and optionally the listing itself. */
+    static bool Read(const CStdString &strCacheFile, const CStdString &strPath, int64_t &mtime, CStdString &hash, DIR_CACHE_TYPE &cacheType, CFileItemList *items);
+
+    /*! \brief Write a listing to disk, skipping the write if the stored copy is identical. Called on a job worker. */
+    bool Write(const CStdString &strPath, const CFileItemList &items, DIR_CACHE_TYPE cacheType);
+
+    /*! \brief Scan the cache folder for stored listings. Must be called with m_section held. */
+    void LoadIndex();
+
+    /*! \brief Remove the least recently used listings until we're within budget. Must be called with m_section held. */
+    void CheckIfFull();
+
+    typedef std::map<CStdString, CEntry> Index; ///< keyed by cache file
+    PersistentDirectorySourcePtr m_source;
+    Index              m_index;
+    bool               m_indexLoaded;
+    uint64_t           m_totalSize;
+    unsigned int       m_accessCounter;
+    std::set<CStdString> m_fresh;      ///< paths whose listing has been fetched from the source this session
+    std::set<CStdString> m_pending;    ///< paths with a revalidation in progress
+
+    CCriticalSection   m_section;
+    CCriticalSection   m_writeSection;   ///< serializes writes to the cache folder
+  };
+}
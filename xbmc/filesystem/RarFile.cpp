@@ -33,6 +33,8 @@
 #include "UnrarXLib/rar.hpp"
 #include "utils/StringUtils.h"
 
+#include <algorithm>
+
 #ifndef TARGET_POSIX
 #include <process.h>
 #endif
@@ -130,6 +132,8 @@ CRarFile::CRarFile()
   m_bUseFile = false;
   m_bOpen = false;
   m_bSeekable = true;
+  m_bStored = false;
+  m_iPart = -1;
 }
 
 CRarFile::~CRarFile()
@@ -143,6 +147,8 @@ CRarFile::~CRarFile()
     m_File.Close();
     g_RarManager.ClearCachedFile(m_strRarPath,m_strPathInRar);
   }
+  else if (m_bStored)
+    m_File.Close();
   else
   {
     CleanUp();
@@ -158,23 +164,34 @@ CRarFile::~CRarFile()
 bool CRarFile::Open(const CURL& url)
 {
   InitFromUrl(url);
-  CFileItemList items;
-  g_RarManager.GetFilesInRar(items,m_strRarPath,false);
-  int i;
-  for (i=0;i<items.Size();++i)
-  {
-    if (items[i]->GetLabel() == m_strPathInRar)
-      break;
-  }
+  int64_t iSize;
+  int iMethod;
 
-  if (i<items.Size())
+  if (g_RarManager.GetFileEntry(m_strRarPath, m_strPathInRar, iSize, iMethod))
   {
-    if (items[i]->m_idepth == 0x30) // stored
+    if (iMethod == 0x30) // stored
     {
+      // unencrypted stored files are read straight from the volumes, so they
+      // start right away and seek without the unpacker
+      if (!g_RarManager.GetStoredFile(m_strRarPath, m_strPathInRar, m_parts) ||
+          m_parts.back().m_iStart + m_parts.back().m_iSize != iSize)
+        m_parts.clear();
+
+      if (!m_parts.empty())
+      {
+        m_bStored = true;
+        m_bUseFile = false;
+        m_iFileSize = iSize;
+        m_iFilePosition = 0;
+        m_iPart = -1;
+        m_bOpen = true;
+        return true;
+      }
+
       if (!OpenInArchive())
         return false;
 
-      m_iFileSize = items[i]->m_dwSize;
+      m_iFileSize = iSize;
       m_bOpen = true;
 
       // perform 'noidx' check
@@ -204,7 +221,7 @@ bool CRarFile::Open(const CURL& url)
 
       if (!g_RarManager.CacheRarredFile(strPathInCache, m_strRarPath, m_strPathInRar,
                                         EXFILE_AUTODELETE | m_bFileOptions, m_strCacheDir,
-                                        items[i]->m_dwSize))
+                                        iSize))
       {
         CLog::Log(LOGERROR,"filerar::open failed to cache file %s",m_strPathInRar.c_str());
         return false;
@@ -278,6 +295,9 @@ unsigned int CRarFile::Read(void *lpBuf, int64_t uiBufSize)
   if (m_bUseFile)
     return m_File.Read(lpBuf,uiBufSize);
 
+  if (m_bStored)
+    return ReadStored((uint8_t*)lpBuf, uiBufSize);
+
   if (m_iFilePosition >= GetLength()) // we are done
     return 0;
 
@@ -374,6 +394,14 @@ void CRarFile::Close()
     g_RarManager.ClearCachedFile(m_strRarPath,m_strPathInRar);
     m_bOpen = false;
   }
+  else if (m_bStored)
+  {
+    m_File.Close();
+    m_parts.clear();
+    m_iPart = -1;
+    m_bStored = false;
+    m_bOpen = false;
+  }
   else
   {
     CleanUp();
@@ -399,6 +427,30 @@ int64_t CRarFile::Seek(int64_t iFilePosition, int iWhence)
   if (m_bUseFile)
     return m_File.Seek(iFilePosition,iWhence);
 
+  if (m_bStored)
+  {
+    switch (iWhence)
+    {
+      case SEEK_CUR:
+        iFilePosition += m_iFilePosition;
+        break;
+      case SEEK_END:
+        iFilePosition += m_iFileSize;
+        break;
+      case SEEK_SET:
+        break;
+      default:
+        return -1;
+    }
+
+    if (iFilePosition < 0 || iFilePosition > m_iFileSize)
+      return -1;
+
+    // the volume is switched on the next read
+    m_iFilePosition = iFilePosition;
+    return m_iFilePosition;
+  }
+
   if( !m_pExtract->GetDataIO().hBufferEmpty->WaitMSec(SEEKTIMOUT) )
   {
     CLog::Log(LOGERROR, "%s - Timeout waiting for buffer to empty", __FUNCTION__);
@@ -538,6 +590,64 @@ void CRarFile::Flush()
     m_File.Flush();
 }
 
+unsigned int CRarFile::ReadStored(uint8_t* pBuf, int64_t uiBufSize)
+{
+  int64_t iRead = 0;
+  while (uiBufSize > 0 && m_iFilePosition < m_iFileSize)
+  {
+    if (!OpenStoredPart(m_iFilePosition))
+      break;
+
+    const CRarStoredPart& part = m_parts[m_iPart];
+    int64_t iOffset = part.m_iOffset + m_iFilePosition - part.m_iStart;
+    if (m_File.GetPosition() != iOffset && m_File.Seek(iOffset, SEEK_SET) != iOffset)
+      break;
+
+    int64_t iWant = std::min(uiBufSize, part.m_iStart + part.m_iSize - m_iFilePosition);
+    unsigned int iGot = m_File.Read(pBuf, iWant);
+    if (iGot == 0)
+      break;
+
+    pBuf += iGot;
+    uiBufSize -= iGot;
+    iRead += iGot;
+    m_iFilePosition += iGot;
+  }
+  return (unsigned int)iRead;
+}
+
+bool CRarFile::OpenStoredPart(int64_t iPosition)
+{
+  if (m_iPart >= 0 && iPosition >= m_parts[m_iPart].m_iStart &&
+      iPosition < m_parts[m_iPart].m_iStart + m_parts[m_iPart].m_iSize)
+    return true;
+
+  // the parts are in file order, find the last one starting at or before the position
+  int iPart = 0;
+  int iLast = (int)m_parts.size() - 1;
+  while (iPart < iLast)
+  {
+    int iMiddle = (iPart + iLast + 1) / 2;
+    if (m_parts[iMiddle].m_iStart <= iPosition)
+      iPart = iMiddle;
+    else
+      iLast = iMiddle - 1;
+  }
+
+  if (m_iPart < 0 || m_parts[m_iPart].m_strVolume != m_parts[iPart].m_strVolume)
+  {
+    m_File.Close();
+    if (!m_File.Open(m_parts[iPart].m_strVolume))
+    {
+      CLog::Log(LOGERROR, "filerar::OpenStoredPart failed to open volume %s", m_parts[iPart].m_strVolume.c_str());
+      m_iPart = -1;
+      return false;
+    }
+  }
+  m_iPart = iPart;
+  return true;
+}
+
 void CRarFile::InitFromUrl(const CURL& url)
 {
   m_strCacheDir = g_advancedSettings.m_cachePath;//url.GetDomain();
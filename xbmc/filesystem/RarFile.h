@@ -26,6 +26,7 @@
 
 #include "File.h"
 #include "IFile.h"
+#include "RarManager.h"
 #include "threads/Thread.h"
 #include "threads/Event.h"
 
@@ -90,6 +91,8 @@ namespace XFILE
     void InitFromUrl(const CURL& url);
     bool OpenInArchive();
     void CleanUp();
+    unsigned int ReadStored(uint8_t* pBuf, int64_t uiBufSize);
+    bool OpenStoredPart(int64_t iPosition);
 
     int64_t m_iFilePosition;
     int64_t m_iFileSize;
@@ -97,7 +100,10 @@ namespace XFILE
     bool m_bUseFile;
     bool m_bOpen;
     bool m_bSeekable;
-    CFile m_File; // for packed source
+    bool m_bStored; // read in place from the volumes
+    CFile m_File; // for packed source, or the current volume of a stored file
+    std::vector<CRarStoredPart> m_parts;
+    int m_iPart;
 #ifdef HAS_FILESYSTEM_RAR
     Archive* m_pArc;
     CommandData* m_pCmd;
@@ -30,6 +30,9 @@
 #include "FileItem.h"
 #include "utils/log.h"
 #include "filesystem/File.h"
+#ifdef HAS_FILESYSTEM_RAR
+#include "UnrarXLib/rar.hpp"
+#endif
 
 #include "dialogs/GUIDialogYesNo.h"
 #include "guilib/GUIWindowManager.h"
@@ -232,20 +235,9 @@ bool CRarManager::GetFilesInRar(CFileItemList& vecpItems, const CStdString& strR
 #ifdef HAS_FILESYSTEM_RAR
   CSingleLock lock(m_CritSection);
 
-  ArchiveList_struct* pFileList = NULL;
-  map<CStdString,pair<ArchiveList_struct*,vector<CFileInfo> > >::iterator it = m_ExFiles.find(strRarPath);
-  if (it == m_ExFiles.end())
-  {
-    if( urarlib_list((char*) strRarPath.c_str(), &pFileList, NULL) )
-      m_ExFiles.insert(make_pair(strRarPath,make_pair(pFileList,vector<CFileInfo>())));
-    else
-    {
-      if( pFileList ) urarlib_freelist(pFileList);
-      return false;
-    }
-  }
-  else
-    pFileList = it->second.first;
+  ArchiveList_struct* pFileList = CacheArchiveList(strRarPath);
+  if (!pFileList)
+    return false;
 
   CFileItemPtr pFileItem;
   vector<std::string> vec;
@@ -259,18 +251,7 @@ bool CRarManager::GetFilesInRar(CFileItemList& vecpItems, const CStdString& strR
     strCompare += '/';
   for( pIterator = pFileList; pIterator  ; pIterator ? pIterator = pIterator->next : NULL)
   {
-    CStdString strDirDelimiter = (pIterator->item.HostOS==3 ? "/":"\\"); // win32 or unix paths?
-    CStdString strName;
-
-    /* convert to utf8 */
-    if( pIterator->item.NameW && wcslen(pIterator->item.NameW) > 0)
-      g_charsetConverter.wToUTF8(pIterator->item.NameW, strName);
-    else
-      g_charsetConverter.unknownToUTF8(pIterator->item.Name, strName);
-
-    /* replace back slashes into forward slashes */
-    /* this could get us into troubles, file could two different files, one with / and one with \ */
-    StringUtils::Replace(strName, '\\', '/');
+    CStdString strName = GetEntryName(pIterator->item);
 
     if (bMask)
     {
@@ -283,8 +264,7 @@ bool CRarManager::GetFilesInRar(CFileItemList& vecpItems, const CStdString& strR
         continue;
     }
 
-    unsigned int iMask = (pIterator->item.HostOS==3 ? 0x0040000:16); // win32 or unix attribs?
-    if (((pIterator->item.FileAttr & iMask) == iMask) || (vec.size() > iDepth+1 && bMask)) // we have a directory
+    if (IsDirectory(pIterator->item) || (vec.size() > iDepth+1 && bMask)) // we have a directory
     {
       if (!bMask) continue;
       if (vec.size() == iDepth)
@@ -327,6 +307,172 @@ bool CRarManager::GetFilesInRar(CFileItemList& vecpItems, const CStdString& strR
 #endif
 }
 
+ArchiveList_struct* CRarManager::CacheArchiveList(const CStdString& strRarPath)
+{
+#ifdef HAS_FILESYSTEM_RAR
+  CSingleLock lock(m_CritSection);
+
+  map<CStdString,pair<ArchiveList_struct*,vector<CFileInfo> > >::iterator it = m_ExFiles.find(strRarPath);
+  if (it != m_ExFiles.end())
+    return it->second.first;
+
+  ArchiveList_struct* pFileList = NULL;
+  if( !urarlib_list((char*) strRarPath.c_str(), &pFileList, NULL) )
+  {
+    if( pFileList ) urarlib_freelist(pFileList);
+    return NULL;
+  }
+  m_ExFiles.insert(make_pair(strRarPath,make_pair(pFileList,vector<CFileInfo>())));
+
+  // index the files, so opening one doesn't need to walk the whole list
+  map<CStdString, RAR20_archive_entry*>& index = m_Index[strRarPath];
+  for (ArchiveList_struct* pIterator = pFileList; pIterator; pIterator = pIterator->next)
+  {
+    if (!IsDirectory(pIterator->item))
+      index.insert(make_pair(GetEntryName(pIterator->item), &pIterator->item));
+  }
+  return pFileList;
+#else
+  return NULL;
+#endif
+}
+
+CStdString CRarManager::GetEntryName(const RAR20_archive_entry& item)
+{
+  CStdString strName;
+
+  /* convert to utf8 */
+  if( item.NameW && wcslen(item.NameW) > 0)
+    g_charsetConverter.wToUTF8(item.NameW, strName);
+  else
+    g_charsetConverter.unknownToUTF8(item.Name, strName);
+
+  /* replace back slashes into forward slashes */
+  /* this could get us into troubles, file could two different files, one with / and one with \ */
+  StringUtils::Replace(strName, '\\', '/');
+  return strName;
+}
+
+bool CRarManager::IsDirectory(const RAR20_archive_entry& item)
+{
+  unsigned int iMask = (item.HostOS==3 ? 0x0040000:16); // win32 or unix attribs?
+  return (item.FileAttr & iMask) == iMask;
+}
+
+bool CRarManager::GetFileEntry(const CStdString& strRarPath, const CStdString& strPathInRar, int64_t& iSize, int& iMethod)
+{
+#ifdef HAS_FILESYSTEM_RAR
+  CSingleLock lock(m_CritSection);
+  if (!CacheArchiveList(strRarPath))
+    return false;
+
+  map<CStdString, RAR20_archive_entry*>& index = m_Index[strRarPath];
+  map<CStdString, RAR20_archive_entry*>::const_iterator it = index.find(strPathInRar);
+  if (it == index.end())
+    return false;
+
+  iSize = it->second->UnpSize;
+  iMethod = it->second->Method;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool CRarManager::GetStoredFile(const CStdString& strRarPath, const CStdString& strPathInRar, vector<CRarStoredPart>& parts)
+{
+#ifdef HAS_FILESYSTEM_RAR
+  CSingleLock lock(m_CritSection);
+  pair<CStdString, CStdString> key(strRarPath, strPathInRar);
+  map<pair<CStdString, CStdString>, vector<CRarStoredPart> >::const_iterator it = m_StoredFiles.find(key);
+  if (it != m_StoredFiles.end())
+  {
+    parts = it->second;
+    return !parts.empty();
+  }
+
+  // an empty list remembers files that have to go through the unpacker
+  vector<CRarStoredPart>& found = m_StoredFiles[key];
+  try
+  {
+    CommandData cmd;
+    strcpy(cmd.Command, "X");
+    cmd.AddArcName(const_cast<char*>(strRarPath.c_str()),NULL);
+    cmd.ParseDone();
+
+    Archive arc(&cmd);
+    if (!arc.WOpen(strRarPath.c_str(),NULL) || !arc.IsArchive(true))
+      return false;
+
+    int64_t iStart = 0;
+    while (true)
+    {
+      bool bFound = false;
+      while (arc.ReadHeader() > 0)
+      {
+        if (arc.GetHeaderType() == FILE_HEAD)
+        {
+          CStdString strFileName;
+          if (wcslen(arc.NewLhd.FileNameW) > 0)
+            g_charsetConverter.wToUTF8(arc.NewLhd.FileNameW, strFileName);
+          else
+            g_charsetConverter.unknownToUTF8(arc.NewLhd.FileName, strFileName);
+          StringUtils::Replace(strFileName, '\\', '/');
+
+          if (strFileName == strPathInRar)
+          {
+            bFound = true;
+            break;
+          }
+        }
+        arc.SeekToNext();
+      }
+
+      // encrypted data has to be decrypted by the unpacker
+      if (!bFound || arc.NewLhd.Method != 0x30 || (arc.NewLhd.Flags & LHD_PASSWORD))
+      {
+        found.clear();
+        return false;
+      }
+
+      CRarStoredPart part;
+      part.m_strVolume = arc.FileName;
+      part.m_iSize = arc.NewLhd.FullPackSize;
+      part.m_iOffset = arc.NextBlockPos - part.m_iSize;
+      part.m_iStart = iStart;
+      found.push_back(part);
+      iStart += part.m_iSize;
+
+      if (!(arc.NewLhd.Flags & LHD_SPLIT_AFTER))
+        break;
+
+      // the file continues at the start of the next volume
+      char NextName[NM];
+      strcpy(NextName, arc.FileName);
+      NextVolumeName(NextName, (arc.NewMhd.Flags & MHD_NEWNUMBERING)==0 || arc.OldFormat);
+      arc.Close();
+      if (!arc.WOpen(NextName,NULL) || !arc.IsArchive(true))
+      {
+        CLog::Log(LOGERROR, "%s - missing volume %s", __FUNCTION__, NextName);
+        found.clear();
+        return false;
+      }
+    }
+  }
+  catch (int rarErrCode)
+  {
+    CLog::Log(LOGERROR, "%s - UnrarXLib error code %d while mapping %s", __FUNCTION__, rarErrCode, strPathInRar.c_str());
+    found.clear();
+    return false;
+  }
+
+  parts = found;
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool CRarManager::ListArchive(const CStdString& strRarPath, ArchiveList_struct* &pArchiveList)
 {
 #ifdef HAS_FILESYSTEM_RAR
@@ -368,19 +514,13 @@ bool CRarManager::IsFileInRar(bool& bResult, const CStdString& strRarPath, const
 {
 #ifdef HAS_FILESYSTEM_RAR
   bResult = false;
-  CFileItemList ItemList;
+  CSingleLock lock(m_CritSection);
 
-  if (!GetFilesInRar(ItemList,strRarPath,false))
+  if (!CacheArchiveList(strRarPath))
     return false;
 
-  int it;
-  for (it=0;it<ItemList.Size();++it)
-  {
-    if (strPathInRar.compare(ItemList[it]->GetPath()) == 0)
-      break;
-  }
-  if (it != ItemList.Size())
-    bResult = true;
+  map<CStdString, RAR20_archive_entry*>& index = m_Index[strRarPath];
+  bResult = index.find(strPathInRar) != index.end();
 
   return true;
 #else
@@ -406,6 +546,8 @@ void CRarManager::ClearCache(bool force)
   }
 
   m_ExFiles.clear();
+  m_Index.clear();
+  m_StoredFiles.clear();
 #endif
 }
 
@@ -25,6 +25,7 @@
 #include "utils/StdString.h"
 #include "threads/CriticalSection.h"
 #include <map>
+#include <vector>
 #include "UnrarXLib/UnrarX.hpp"
 #include "utils/Stopwatch.h"
 
@@ -62,6 +63,16 @@ public:
   int m_iIsSeekable;
 };
 
+/* the part of a stored file that lies in one volume of the archive */
+class CRarStoredPart
+{
+public:
+  CStdString m_strVolume;
+  int64_t m_iOffset; // start of the data in the volume
+  int64_t m_iStart;  // position of the part in the file
+  int64_t m_iSize;
+};
+
 class CRarManager
 {
 public:
@@ -76,13 +87,28 @@ public:
                      bool bMask=true, const CStdString& strPathInRar="");
   CFileInfo* GetFileInRar(const CStdString& strRarPath, const CStdString& strPathInRar);
   bool IsFileInRar(bool& bResult, const CStdString& strRarPath, const CStdString& strPathInRar);
+  /*!
+   \brief Looks up a file of the archive in the index built when it was listed
+   \param iMethod The compression method, 0x30 for stored files
+   */
+  bool GetFileEntry(const CStdString& strRarPath, const CStdString& strPathInRar, int64_t& iSize, int& iMethod);
+  /*!
+   \brief Where the data of a stored, unencrypted file lies in the volumes
+   Such files can be read in place instead of through the unpacker.
+   */
+  bool GetStoredFile(const CStdString& strRarPath, const CStdString& strPathInRar, std::vector<CRarStoredPart>& parts);
   void ClearCache(bool force=false);
   void ClearCachedFile(const CStdString& strRarPath, const CStdString& strPathInRar);
   void ExtractArchive(const CStdString& strArchive, const CStdString& strPath);
 protected:
 
   bool ListArchive(const CStdString& strRarPath, ArchiveList_struct* &pArchiveList);
+  ArchiveList_struct* CacheArchiveList(const CStdString& strRarPath);
+  static CStdString GetEntryName(const RAR20_archive_entry& item);
+  static bool IsDirectory(const RAR20_archive_entry& item);
   std::map<CStdString, std::pair<ArchiveList_struct*,std::vector<CFileInfo> > > m_ExFiles;
+  std::map<CStdString, std::map<CStdString, RAR20_archive_entry*> > m_Index; // files of each archive by path
+  std::map<std::pair<CStdString, CStdString>, std::vector<CRarStoredPart> > m_StoredFiles;
   CCriticalSection m_CritSection;
 
   int64_t CheckFreeSpace(const CStdString& strDrive);
@@ -26,6 +26,7 @@
 #include "utils/log.h"
 #include "utils/EndianSwap.h"
 #include "utils/URIUtils.h"
+#include "threads/SingleLock.h"
 #include "SpecialProtocol.h"
 
 
@@ -59,19 +60,18 @@ bool CZipManager::GetZipList(const CURL& url, vector<SZipEntry>& items)
     return false;
   }
 
-  map<CStdString,vector<SZipEntry> >::iterator it = mZipMap.find(strFile);
+  CSingleLock lock(m_critSection);
+  map<CStdString,SZipIndex>::iterator it = mZipMap.find(strFile);
   if (it != mZipMap.end()) // already listed, just return it if not changed, else release and reread
   {
-    map<CStdString,int64_t>::iterator it2=mZipDate.find(strFile);
-    CLog::Log(LOGDEBUG,"statdata: %"PRId64" new: %"PRIu64, it2->second, (uint64_t)m_StatData.st_mtime);
+    CLog::Log(LOGDEBUG,"statdata: %"PRId64" new: %"PRIu64, it->second.date, (uint64_t)m_StatData.st_mtime);
 
-      if (m_StatData.st_mtime == it2->second)
+      if (m_StatData.st_mtime == it->second.date)
       {
-        items = it->second;
+        items = it->second.items;
         return true;
       }
       mZipMap.erase(it);
-      mZipDate.erase(it2);
   }
 
   CFile mFile;
@@ -89,8 +89,6 @@ bool CZipManager::GetZipList(const CURL& url, vector<SZipEntry>& items)
     mFile.Close();
     return false;
   }
-  // push date for update detection
-  mZipDate.insert(make_pair(strFile,m_StatData.st_mtime));
 
 
   // Look for end of central directory record
@@ -160,53 +158,57 @@ bool CZipManager::GetZipList(const CURL& url, vector<SZipEntry>& items)
   mFile.Read(&cdirOffset,4);
   cdirOffset = Endian_SwapLE32(cdirOffset);
 
-  // Go to the start of central directory
-  mFile.Seek(cdirOffset,SEEK_SET);
+  // The directory has to lie within the file, don't trust the sizes before allocating
+  if (cdirSize == 0 || (int64_t)cdirOffset + cdirSize > fileSize)
+  {
+    CLog::Log(LOGDEBUG,"ZipManager: broken file %s!",strFile.c_str());
+    mFile.Close();
+    return false;
+  }
 
-  char temp[CHDR_SIZE];
-  while (mFile.GetPosition() < cdirOffset + cdirSize)
+  // Read the whole central directory at once and parse it in memory
+  vector<char> cdir(cdirSize);
+  if (mFile.Seek(cdirOffset,SEEK_SET) != (int64_t)cdirOffset ||
+      mFile.Read(&cdir[0],cdirSize) != cdirSize)
+  {
+    CLog::Log(LOGDEBUG,"ZipManager: broken file %s!",strFile.c_str());
+    mFile.Close();
+    return false;
+  }
+  mFile.Close();
+
+  SZipIndex index;
+  // push date for update detection
+  index.date = m_StatData.st_mtime;
+
+  unsigned int pos = 0;
+  while (pos < cdirSize)
   {
     SZipEntry ze;
-    mFile.Read(temp,CHDR_SIZE);
-    readCHeader(temp, ze);
-    if (ze.header != ZIP_CENTRAL_HEADER)
+    if (pos + CHDR_SIZE <= cdirSize)
+      readCHeader(&cdir[pos], ze);
+    if (ze.header != ZIP_CENTRAL_HEADER || pos + CHDR_SIZE + ze.flength > cdirSize)
     {
       CLog::Log(LOGDEBUG,"ZipManager: broken file %s!",strFile.c_str());
-      mFile.Close();
       return false;
     }
 
     // Get the filename just after the central file header
-    CStdString strName;
-    mFile.Read(strName.GetBuffer(ze.flength), ze.flength);
-    strName.ReleaseBuffer();
+    CStdString strName(&cdir[pos + CHDR_SIZE], ze.flength);
     g_charsetConverter.unknownToUTF8(strName);
     ZeroMemory(ze.name, 255);
     strncpy(ze.name, strName.c_str(), strName.size()>254 ? 254 : strName.size());
 
     // Jump after central file header extra field and file comment
-    mFile.Seek(ze.eclength + ze.clength,SEEK_CUR);
+    pos += CHDR_SIZE + ze.flength + ze.eclength + ze.clength;
 
-    items.push_back(ze);
+    // the first entry of a name wins, as with a scan of the list
+    index.names.insert(make_pair(CStdString(ze.name), index.items.size()));
+    index.items.push_back(ze);
   }
 
-  /* go through list and figure out file header lengths */
-  for(vector<SZipEntry>::iterator it = items.begin(); it != items.end(); ++it)
-  {
-    SZipEntry& ze = *it;
-    // Go to the local file header to get the extra field length
-    // !! local header extra field length != central file header extra field length !!
-    mFile.Seek(ze.lhdrOffset+28,SEEK_SET);
-    mFile.Read(&(ze.elength),2);
-    ze.elength = Endian_SwapLE16(ze.elength);
-
-    // Compressed data offset = local header offset + size of local header + filename length + local file header extra field length
-    ze.offset = ze.lhdrOffset + LHDR_SIZE + ze.flength + ze.elength;
-
-  }
-
-  mZipMap.insert(make_pair(strFile,items));
-  mFile.Close();
+  items = index.items;
+  mZipMap.insert(make_pair(strFile,index));
   return true;
 }
 
@@ -214,27 +216,54 @@ bool CZipManager::GetZipEntry(const CURL& url, SZipEntry& item)
 {
   CStdString strFile = url.GetHostName();
 
-  map<CStdString,vector<SZipEntry> >::iterator it = mZipMap.find(strFile);
-  vector<SZipEntry> items;
+  CSingleLock lock(m_critSection);
+  map<CStdString,SZipIndex>::iterator it = mZipMap.find(strFile);
   if (it == mZipMap.end()) // we need to list the zip
   {
-    GetZipList(url,items);
+    vector<SZipEntry> items;
+    if (!GetZipList(url,items))
+      return false;
+    it = mZipMap.find(strFile);
+    if (it == mZipMap.end())
+      return false;
   }
-  else
+
+  map<CStdString,size_t>::const_iterator name = it->second.names.find(url.GetFileName());
+  if (name == it->second.names.end())
+    return false;
+
+  // the local header is only read for entries that actually get opened
+  SZipEntry& ze = it->second.items[name->second];
+  if (ze.offset == 0 && !ReadLocalHeader(strFile, ze))
+    return false;
+
+  item = ze;
+  return true;
+}
+
+bool CZipManager::ReadLocalHeader(const CStdString& strFile, SZipEntry& item)
+{
+  CFile mFile;
+  if (!mFile.Open(strFile))
   {
-    items = it->second;
+    CLog::Log(LOGDEBUG,"ZipManager: unable to open file %s!",strFile.c_str());
+    return false;
   }
 
-  CStdString strFileName = url.GetFileName();
-  for (vector<SZipEntry>::iterator it2=items.begin();it2 != items.end();++it2)
+  // Go to the local file header to get the extra field length
+  // !! local header extra field length != central file header extra field length !!
+  unsigned short elength;
+  if (mFile.Seek(item.lhdrOffset+28,SEEK_SET) != (int64_t)item.lhdrOffset+28 ||
+      mFile.Read(&elength,2) != 2)
   {
-    if (CStdString(it2->name) == strFileName)
-    {
-      memcpy(&item,&(*it2),sizeof(SZipEntry));
-      return true;
-    }
+    CLog::Log(LOGDEBUG,"ZipManager: broken file %s!",strFile.c_str());
+    return false;
   }
-  return false;
+  item.elength = Endian_SwapLE16(elength);
+
+  // Compressed data offset = local header offset + size of local header + filename length + local file header extra field length
+  item.offset = item.lhdrOffset + LHDR_SIZE + item.flength + item.elength;
+  return true;
 }
 
 bool CZipManager::ExtractArchive(const CStdString& strArchive, const CStdString& strPath)
@@ -302,13 +331,6 @@ void CZipManager::readCHeader(const char* buffer, SZipEntry& info)
 void CZipManager::release(const CStdString& strPath)
 {
   CURL url(strPath);
-  map<CStdString,vector<SZipEntry> >::iterator it= mZipMap.find(url.GetHostName());
-  if (it != mZipMap.end())
-  {
-    map<CStdString,int64_t>::iterator it2=mZipDate.find(url.GetHostName());
-    mZipMap.erase(it);
-    mZipDate.erase(it2);
-  }
+  CSingleLock lock(m_critSection);
+  mZipMap.erase(url.GetHostName());
 }
-
-
@@ -30,6 +30,7 @@
 #define ECDREC_SIZE 22
 
 #include  "utils/StdString.h"
+#include "threads/CriticalSection.h"
 
 #include <memory.h>
 #include <vector>
@@ -52,7 +53,7 @@ struct SZipEntry {
   unsigned short eclength; // extra field length (central file header)
   unsigned short clength; // file comment length (central file header)
   unsigned int lhdrOffset; // Relative offset of local header
-  int64_t offset;         // offset in file to compressed data
+  int64_t offset;         // offset in file to compressed data, only known after GetZipEntry()
   char name[255];
 
   SZipEntry()
@@ -110,8 +111,18 @@ public:
   static void readHeader(const char* buffer, SZipEntry& info);
   static void readCHeader(const char* buffer, SZipEntry& info);
 private:
-  std::map<CStdString,std::vector<SZipEntry> > mZipMap;
-  std::map<CStdString,int64_t> mZipDate;
+  /* the central directory of an archive, indexed by entry name */
+  struct SZipIndex
+  {
+    std::vector<SZipEntry> items;
+    std::map<CStdString,size_t> names;
+    int64_t date;
+  };
+
+  bool ReadLocalHeader(const CStdString& strFile, SZipEntry& item);
+
+  std::map<CStdString,SZipIndex> mZipMap;
+  CCriticalSection m_critSection;
 };
 
 extern CZipManager g_ZipManager;
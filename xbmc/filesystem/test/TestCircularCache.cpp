@@ -0,0 +1,141 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/CircularCache.h"
+
+#include "gtest/gtest.h"
+
+using namespace XFILE;
+
+namespace
+{
+/* Stream "size" bytes of a known pattern through the cache, in chunks of
+ * "chunk" bytes, either through WriteToCache or by writing straight into
+ * the space handed out by GetWriteBuffer, and check what is read back. */
+void StreamThroughCache(CCircularCache &cache, size_t size, size_t chunk, bool direct)
+{
+  std::vector<char> data(chunk);
+  size_t written = 0;
+  size_t read = 0;
+
+  while (read < size)
+  {
+    size_t wanted = std::min(chunk, size - written);
+    if (wanted > 0)
+    {
+      if (direct)
+      {
+        char *buffer;
+        size_t length = wanted;
+        if (cache.GetWriteBuffer(&buffer, &length) == CACHE_RC_OK)
+        {
+          ASSERT_LE(length, wanted);
+          for (size_t i = 0; i < length; i++)
+            buffer[i] = (char)((written + i) % 251);
+          ASSERT_EQ((int)length, cache.CommitWrite(length));
+          written += length;
+        }
+      }
+      else
+      {
+        for (size_t i = 0; i < wanted; i++)
+          data[i] = (char)((written + i) % 251);
+        int length = cache.WriteToCache(&data[0], wanted);
+        ASSERT_GE(length, 0);
+        written += length;
+      }
+    }
+
+    int length = cache.ReadFromCache(&data[0], chunk);
+    if (length == CACHE_RC_WOULD_BLOCK)
+      continue;
+    ASSERT_GT(length, 0);
+    for (int i = 0; i < length; i++)
+      ASSERT_EQ((char)((read + i) % 251), data[i]);
+    read += length;
+  }
+  EXPECT_EQ((int64_t)size, cache.CachedDataEndPos());
+}
+}
+
+TEST(TestCircularCache, WriteToCache)
+{
+  CCircularCache cache(64 * 1024, 16 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  StreamThroughCache(cache, 1024 * 1024, 10000, false);
+  cache.Close();
+}
+
+TEST(TestCircularCache, GetWriteBuffer)
+{
+  CCircularCache cache(64 * 1024, 16 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  StreamThroughCache(cache, 1024 * 1024, 10000, true);
+  cache.Close();
+}
+
+TEST(TestCircularCache, KeepsBackBuffer)
+{
+  CCircularCache cache(64 * 1024, 16 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  StreamThroughCache(cache, 1024 * 1024, 10000, true);
+
+  // the last 16k read are still available to seek back to
+  EXPECT_TRUE(cache.IsCachedPosition(1024 * 1024 - 16 * 1024));
+  EXPECT_EQ(1024 * 1024 - 16 * 1024, cache.Seek(1024 * 1024 - 16 * 1024));
+  cache.Close();
+}
+
+TEST(TestCircularCache, MappedWriteToCache)
+{
+  CMappedCircularCache cache(64 * 1024, 16 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  StreamThroughCache(cache, 1024 * 1024, 10000, false);
+  cache.Close();
+}
+
+TEST(TestCircularCache, MappedGetWriteBuffer)
+{
+  CMappedCircularCache cache(64 * 1024, 16 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+  StreamThroughCache(cache, 1024 * 1024, 10000, true);
+  cache.Close();
+}
+
+TEST(TestCircularCache, MappedContiguousAtWrap)
+{
+  CMappedCircularCache cache(64 * 1024, 16 * 1024);
+  ASSERT_EQ(CACHE_RC_OK, cache.Open());
+
+  // fill and drain most of the ring, so that the next write crosses the wrap point
+  StreamThroughCache(cache, 70 * 1024, 10 * 1024, true);
+
+  char *buffer;
+  size_t length = 32 * 1024;
+  ASSERT_EQ(CACHE_RC_OK, cache.GetWriteBuffer(&buffer, &length));
+  EXPECT_EQ((size_t)32 * 1024, length);
+  memset(buffer, 'x', length);
+  EXPECT_EQ((int)length, cache.CommitWrite(length));
+
+  std::vector<char> data(32 * 1024);
+  EXPECT_EQ(32 * 1024, cache.ReadFromCache(&data[0], data.size()));
+  EXPECT_EQ(std::string(32 * 1024, 'x'), std::string(data.begin(), data.end()));
+  cache.Close();
+}
@@ -0,0 +1,217 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/MultiPathDirectory.h"
+#include "FileItem.h"
+#include "URL.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "utils/URIUtils.h"
+
+#ifdef TARGET_POSIX
+#include "../linux/XTimeUtils.h"
+#endif
+
+#include "gtest/gtest.h"
+
+#include <map>
+
+namespace
+{
+/* stands in for the sources, every path answers with one file after its latency */
+class CSlowLister : public XFILE::CMultiPathSourceLister
+{
+public:
+  void SetLatency(const CStdString &strPath, unsigned int latency, bool success = true)
+  {
+    CSingleLock lock(m_section);
+    m_latency[strPath] = latency;
+    m_success[strPath] = success;
+  }
+
+  int Calls(const CStdString &strPath)
+  {
+    CSingleLock lock(m_section);
+    return m_calls[strPath];
+  }
+
+  virtual bool GetDirectory(const CStdString &strPath, CFileItemList &items, const CStdString &strMask, int flags)
+  {
+    unsigned int latency;
+    bool success;
+    {
+      CSingleLock lock(m_section);
+      m_calls[strPath]++;
+      latency = m_latency[strPath];
+      success = m_success.find(strPath) == m_success.end() || m_success[strPath];
+    }
+    Sleep(latency);
+    if (!success)
+      return false;
+
+    CFileItemPtr item(new CFileItem(URIUtils::AddFileToFolder(strPath, "movie.mkv"), false));
+    items.Add(item);
+    return true;
+  }
+
+private:
+  CCriticalSection                   m_section;
+  std::map<CStdString, unsigned int> m_latency;
+  std::map<CStdString, bool>         m_success;
+  std::map<CStdString, int>          m_calls;
+};
+
+class TemporaryTimeout
+{
+public:
+  TemporaryTimeout(int timeout) : m_OldValue(g_advancedSettings.m_multiPathTimeout)
+  {
+    g_advancedSettings.m_multiPathTimeout = timeout;
+  }
+
+  ~TemporaryTimeout()
+  {
+    g_advancedSettings.m_multiPathTimeout = m_OldValue;
+  }
+
+private:
+  int m_OldValue;
+};
+
+CStdString MultiPath(const char *first, const char *second, const char *third = NULL, const char *fourth = NULL)
+{
+  std::vector<CStdString> paths;
+  paths.push_back(first);
+  paths.push_back(second);
+  if (third)
+    paths.push_back(third);
+  if (fourth)
+    paths.push_back(fourth);
+  return XFILE::CMultiPathDirectory::ConstructMultiPath(paths);
+}
+}
+
+TEST(TestMultiPathDirectory, Parallel)
+{
+  TemporaryTimeout timeout(5000);
+  boost::shared_ptr<CSlowLister> lister(new CSlowLister);
+  const char *sources[] = { "nfs://nas1/movies/", "nfs://nas2/movies/",
+                            "smb://nas3/movies/", "smb://nas4/movies/" };
+  for (int i = 0; i < 4; i++)
+    lister->SetLatency(sources[i], 300);
+
+  XFILE::CMultiPathDirectory dir(lister);
+  CFileItemList items;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  EXPECT_TRUE(dir.GetDirectory(CURL(MultiPath(sources[0], sources[1], sources[2], sources[3])), items));
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+  // one latency, not the sum of them
+  EXPECT_LT(elapsed, 900u);
+  ASSERT_EQ(4, items.Size());
+  for (int i = 0; i < 4; i++)
+  {
+    EXPECT_STREQ(URIUtils::AddFileToFolder(sources[i], "movie.mkv").c_str(), items[i]->GetPath().c_str());
+    EXPECT_EQ(1, lister->Calls(sources[i]));
+  }
+}
+
+TEST(TestMultiPathDirectory, Deadline)
+{
+  TemporaryTimeout timeout(200);
+  boost::shared_ptr<CSlowLister> lister(new CSlowLister);
+  const char *fast = "nfs://fast/tv/";
+  const char *slow = "smb://offline/tv/";
+  lister->SetLatency(fast, 0);
+  lister->SetLatency(slow, 1000);
+
+  // a window listing
+  XFILE::CMultiPathDirectory dir(lister);
+  dir.SetFlags(XFILE::DIR_FLAG_ALLOW_PROMPT);
+  CStdString path = MultiPath(fast, slow);
+  CFileItemList items;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  EXPECT_TRUE(dir.GetDirectory(CURL(path), items));
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+  // the listing doesn't wait for the slow source
+  EXPECT_LT(elapsed, 800u);
+  ASSERT_EQ(1, items.Size());
+  EXPECT_STREQ(URIUtils::AddFileToFolder(fast, "movie.mkv").c_str(), items[0]->GetPath().c_str());
+
+  // once it answered the refresh picks up its listing without asking it again
+  Sleep(1200);
+  items.Clear();
+  EXPECT_TRUE(dir.GetDirectory(CURL(path), items));
+  EXPECT_EQ(2, items.Size());
+  EXPECT_EQ(2, lister->Calls(fast));
+  EXPECT_EQ(1, lister->Calls(slow));
+
+  // the late listing is used once only
+  items.Clear();
+  lister->SetLatency(slow, 0);
+  EXPECT_TRUE(dir.GetDirectory(CURL(path), items));
+  EXPECT_EQ(2, items.Size());
+  EXPECT_EQ(2, lister->Calls(slow));
+}
+
+TEST(TestMultiPathDirectory, BackgroundWaits)
+{
+  TemporaryTimeout timeout(200);
+  boost::shared_ptr<CSlowLister> lister(new CSlowLister);
+  const char *fast = "nfs://awake/tv/";
+  const char *slow = "smb://spinningup/tv/";
+  lister->SetLatency(fast, 0);
+  lister->SetLatency(slow, 600);
+
+  // a scanner listing gets every source, however late
+  XFILE::CMultiPathDirectory dir(lister);
+  CFileItemList items;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  EXPECT_TRUE(dir.GetDirectory(CURL(MultiPath(fast, slow)), items));
+  unsigned int elapsed = XbmcThreads::SystemClockMillis() - start;
+
+  EXPECT_GE(elapsed, 500u);
+  EXPECT_EQ(2, items.Size());
+  EXPECT_EQ(1, lister->Calls(slow));
+}
+
+TEST(TestMultiPathDirectory, Failures)
+{
+  TemporaryTimeout timeout(5000);
+  boost::shared_ptr<CSlowLister> lister(new CSlowLister);
+  const char *good = "nfs://good/music/";
+  const char *bad  = "nfs://bad/music/";
+  const char *worse = "nfs://worse/music/";
+  lister->SetLatency(good, 50);
+  lister->SetLatency(bad, 50, false);
+  lister->SetLatency(worse, 50, false);
+
+  XFILE::CMultiPathDirectory dir(lister);
+  CFileItemList items;
+  EXPECT_TRUE(dir.GetDirectory(CURL(MultiPath(good, bad)), items));
+  EXPECT_EQ(1, items.Size());
+
+  // only fails if every source failed
+  items.Clear();
+  EXPECT_FALSE(dir.GetDirectory(CURL(MultiPath(bad, worse)), items));
+  EXPECT_EQ(0, items.Size());
+}
@@ -0,0 +1,223 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/PersistentDirectoryCache.h"
+#include "filesystem/Directory.h"
+#include "filesystem/DirectoryCache.h"
+#include "filesystem/File.h"
+#include "FileItem.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
+#include "utils/URIUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+#define TEST_PATH "smb://server/movies"
+#define TIMEOUT   5000
+
+namespace
+{
+/* stands in for the network source, answering with as many files as it's told */
+class CFakeSource : public XFILE::CPersistentDirectorySource
+{
+public:
+  CFakeSource() : m_mtime(1000), m_files(2), m_listings(0) {}
+
+  void Change(int64_t mtime, int files)
+  {
+    CSingleLock lock(m_section);
+    m_mtime = mtime;
+    m_files = files;
+  }
+
+  int Listings()
+  {
+    CSingleLock lock(m_section);
+    return m_listings;
+  }
+
+  virtual int64_t GetModificationTime(const CStdString &strPath)
+  {
+    CSingleLock lock(m_section);
+    return m_mtime;
+  }
+
+  virtual bool GetDirectory(const CStdString &strPath, CFileItemList &items)
+  {
+    CSingleLock lock(m_section);
+    m_listings++;
+    List(strPath, m_files, items);
+    return true;
+  }
+
+  static void List(const CStdString &strPath, int files, CFileItemList &items)
+  {
+    for (int i = 0; i < files; i++)
+    {
+      CFileItemPtr item(new CFileItem(URIUtils::AddFileToFolder(strPath, StringUtils::Format("movie %i.mkv", i)), false));
+      item->m_dwSize = 1000 + i;
+      items.Add(item);
+    }
+  }
+
+private:
+  CCriticalSection m_section;
+  int64_t          m_mtime;
+  int              m_files;
+  int              m_listings;
+};
+
+/* lets the tests wait for the background jobs of the cache */
+class CTestCache : public XFILE::CPersistentDirectoryCache
+{
+public:
+  CTestCache(const XFILE::PersistentDirectorySourcePtr &source) : CPersistentDirectoryCache(source) {}
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    CPersistentDirectoryCache::OnJobComplete(jobID, success, job);
+    if (strcmp(job->GetType(), "dircachestore") == 0)
+      m_stored.Set();
+    else
+      m_revalidated.Set();
+  }
+
+  CEvent m_stored;
+  CEvent m_revalidated;
+};
+
+void ClearStoredListings()
+{
+  CFileItemList items;
+  XFILE::CDirectory::GetDirectory("special://temp/dircache/", items, "", XFILE::DIR_FLAG_BYPASS_CACHE);
+  for (int i = 0; i < items.Size(); i++)
+    XFILE::CFile::Delete(items[i]->GetPath());
+}
+}
+
+class TestPersistentDirectoryCache : public testing::Test
+{
+protected:
+  TestPersistentDirectoryCache() :
+    m_oldSize(g_advancedSettings.m_dirCacheDiskSize),
+    m_source(new CFakeSource)
+  {
+    g_advancedSettings.m_dirCacheDiskSize = 1024 * 1024;
+    ClearStoredListings();
+  }
+
+  ~TestPersistentDirectoryCache()
+  {
+    g_directoryCache.ClearDirectory(TEST_PATH);
+    ClearStoredListings();
+    g_advancedSettings.m_dirCacheDiskSize = m_oldSize;
+  }
+
+  /* stores the current listing of the source, as a previous session would have */
+  void Store()
+  {
+    CTestCache cache(m_source);
+    CFileItemList items;
+    CFakeSource::List(TEST_PATH, 2, items);
+    cache.SetDirectory(TEST_PATH, items, XFILE::DIR_CACHE_ALWAYS);
+    ASSERT_TRUE(cache.m_stored.WaitMSec(TIMEOUT));
+  }
+
+  unsigned int m_oldSize;
+  boost::shared_ptr<CFakeSource> m_source;
+};
+
+TEST_F(TestPersistentDirectoryCache, RoundTrip)
+{
+  Store();
+
+  CTestCache cache(m_source);
+  CFileItemList items;
+  ASSERT_TRUE(cache.GetDirectory(TEST_PATH, items));
+  ASSERT_EQ(2, items.Size());
+  EXPECT_STREQ(TEST_PATH, items.GetPath().c_str());
+  EXPECT_STREQ(TEST_PATH "/movie 0.mkv", items[0]->GetPath().c_str());
+  EXPECT_STREQ(TEST_PATH "/movie 1.mkv", items[1]->GetPath().c_str());
+  EXPECT_EQ(1001, items[1]->m_dwSize);
+  ASSERT_TRUE(cache.m_revalidated.WaitMSec(TIMEOUT));
+
+  // once revalidated, the listing is no longer served from disk
+  CFileItemList again;
+  EXPECT_FALSE(cache.GetDirectory(TEST_PATH, again));
+
+  // other paths and a disabled tier have nothing stored
+  CTestCache other(m_source);
+  EXPECT_FALSE(other.GetDirectory("smb://server/music", items));
+  g_advancedSettings.m_dirCacheDiskSize = 0;
+  EXPECT_FALSE(other.GetDirectory(TEST_PATH, items));
+}
+
+TEST_F(TestPersistentDirectoryCache, Modified)
+{
+  Store();
+  m_source->Change(2000, 3);
+
+  // the stored listing is returned at first and replaced in the background
+  CTestCache cache(m_source);
+  CFileItemList items;
+  ASSERT_TRUE(cache.GetDirectory(TEST_PATH, items));
+  EXPECT_EQ(2, items.Size());
+  ASSERT_TRUE(cache.m_revalidated.WaitMSec(TIMEOUT));
+  ASSERT_TRUE(cache.m_stored.WaitMSec(TIMEOUT));
+  EXPECT_EQ(1, m_source->Listings());
+
+  CTestCache next(m_source);
+  CFileItemList stored;
+  ASSERT_TRUE(next.GetDirectory(TEST_PATH, stored));
+  EXPECT_EQ(3, stored.Size());
+  ASSERT_TRUE(next.m_revalidated.WaitMSec(TIMEOUT));
+}
+
+TEST_F(TestPersistentDirectoryCache, OverBudget)
+{
+  // a budget smaller than a single listing drops it right after it's written
+  g_advancedSettings.m_dirCacheDiskSize = 1;
+  Store();
+
+  CTestCache cache(m_source);
+  CFileItemList items;
+  EXPECT_FALSE(cache.GetDirectory(TEST_PATH, items));
+}
+
+TEST_F(TestPersistentDirectoryCache, RevalidatedInMemory)
+{
+  Store();
+
+  CTestCache cache(m_source);
+  CFileItemList items;
+  ASSERT_TRUE(cache.GetDirectory(TEST_PATH, items));
+  ASSERT_TRUE(cache.m_revalidated.WaitMSec(TIMEOUT));
+
+  // an unchanged modification time is enough, the source isn't listed and
+  // the stored listing is handed to the memory cache
+  EXPECT_EQ(0, m_source->Listings());
+  CFileItemList cached;
+  ASSERT_TRUE(g_directoryCache.GetDirectory(TEST_PATH, cached));
+  EXPECT_EQ(2, cached.Size());
+}
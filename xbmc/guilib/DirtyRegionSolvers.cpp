@@ -21,6 +21,8 @@
 #include "DirtyRegionSolvers.h"
 #include "GraphicContext.h"
 #include <stdio.h>
+#include <math.h>
+#include <algorithm>
 
 void CUnionDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
 {
@@ -81,3 +83,128 @@ void CGreedyDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegion
       output.push_back(currentRegion);
   }
 }
+
+// beyond this many rectangles merging them pairwise takes longer than redrawing
+#define TILE_MAX_MERGE 64
+
+CTileDirtyRegionSolver::CTileDirtyRegionSolver(float tileSize, unsigned int maxRegions)
+{
+  m_tileSize   = tileSize > 1.0f ? tileSize : 1.0f;
+  m_maxRegions = maxRegions > 0 ? maxRegions : 1;
+}
+
+void CTileDirtyRegionSolver::Solve(const CDirtyRegionList &input, CDirtyRegionList &output)
+{
+  Solve(input, g_graphicsContext.GetViewWindow(), output);
+}
+
+void CTileDirtyRegionSolver::Solve(const CDirtyRegionList &input, const CRect &viewport, CDirtyRegionList &output)
+{
+  if (viewport.IsEmpty())
+    return;
+
+  int cols = (int)ceilf(viewport.Width() / m_tileSize);
+  int rows = (int)ceilf(viewport.Height() / m_tileSize);
+  m_tiles.assign(cols * rows, false);
+
+  bool dirty = false;
+  for (unsigned int i = 0; i < input.size(); i++)
+  {
+    CRect region = input[i];
+    region.Intersect(viewport);
+    if (region.IsEmpty())
+      continue;
+
+    int col1 = (int)((region.x1 - viewport.x1) / m_tileSize);
+    int col2 = std::min((int)ceilf((region.x2 - viewport.x1) / m_tileSize), cols);
+    int row1 = (int)((region.y1 - viewport.y1) / m_tileSize);
+    int row2 = std::min((int)ceilf((region.y2 - viewport.y1) / m_tileSize), rows);
+    for (int row = row1; row < row2; row++)
+    {
+      for (int col = col1; col < col2; col++)
+        m_tiles[row * cols + col] = true;
+    }
+    dirty = true;
+  }
+  if (!dirty)
+    return;
+
+  // runs of the previous row, each the bottom of a rectangle that may be extended
+  std::vector<Run> previous, current;
+  CDirtyRegionList regions;
+  for (int row = 0; row < rows; row++)
+  {
+    current.clear();
+    for (int col = 0; col < cols;)
+    {
+      if (!m_tiles[row * cols + col])
+      {
+        col++;
+        continue;
+      }
+      Run run;
+      run.col1 = col;
+      while (col < cols && m_tiles[row * cols + col])
+        col++;
+      run.col2 = col;
+
+      float y2 = std::min(viewport.y1 + (row + 1) * m_tileSize, viewport.y2);
+      run.region = regions.size();
+      for (unsigned int i = 0; i < previous.size(); i++)
+      {
+        if (previous[i].col1 == run.col1 && previous[i].col2 == run.col2)
+        {
+          run.region = previous[i].region;
+          regions[run.region].y2 = y2;
+          break;
+        }
+      }
+      if (run.region == regions.size())
+        regions.push_back(CDirtyRegion(viewport.x1 + run.col1 * m_tileSize, viewport.y1 + row * m_tileSize,
+                                       std::min(viewport.x1 + run.col2 * m_tileSize, viewport.x2), y2));
+      current.push_back(run);
+    }
+    previous.swap(current);
+  }
+
+  Merge(regions);
+  output.insert(output.end(), regions.begin(), regions.end());
+}
+
+void CTileDirtyRegionSolver::Merge(CDirtyRegionList &regions) const
+{
+  if (regions.size() <= m_maxRegions)
+    return;
+
+  if (regions.size() > TILE_MAX_MERGE)
+  {
+    CDirtyRegion unifiedRegion;
+    for (unsigned int i = 0; i < regions.size(); i++)
+      unifiedRegion.Union(regions[i]);
+    regions.assign(1, unifiedRegion);
+    return;
+  }
+
+  while (regions.size() > m_maxRegions)
+  {
+    unsigned int first = 0, second = 1;
+    float leastCost = 0.0f;
+    for (unsigned int i = 0; i < regions.size(); i++)
+    {
+      for (unsigned int j = i + 1; j < regions.size(); j++)
+      {
+        CRect merged = regions[i];
+        merged.Union(regions[j]);
+        float cost = merged.Area() - regions[i].Area() - regions[j].Area();
+        if ((i == 0 && j == 1) || cost < leastCost)
+        {
+          first = i;
+          second = j;
+          leastCost = cost;
+        }
+      }
+    }
+    regions[first].Union(regions[second]);
+    regions.erase(regions.begin() + second);
+  }
+}
@@ -48,3 +48,32 @@ private:
   float m_costNewRegion;
   float m_costPerArea;
 };
+
+/*!
+ \brief Snaps the dirty regions to a grid of screen tiles
+
+ Every tile touched by a dirty region is marked. Runs of marked tiles on a
+ row become a rectangle, which grows downwards as long as the rows below have
+ the same run. If that leaves more rectangles than rendering passes wanted,
+ the two whose union adds the least area are merged until it fits.
+ */
+class CTileDirtyRegionSolver : public IDirtyRegionSolver
+{
+public:
+  CTileDirtyRegionSolver(float tileSize = 64.0f, unsigned int maxRegions = 4);
+  virtual void Solve(const CDirtyRegionList &input, CDirtyRegionList &output);
+  void Solve(const CDirtyRegionList &input, const CRect &viewport, CDirtyRegionList &output);
+private:
+  struct Run
+  {
+    int col1;
+    int col2;             ///< one past the last tile
+    unsigned int region;  ///< rectangle the run belongs to
+  };
+
+  void Merge(CDirtyRegionList &regions) const;
+
+  float m_tileSize;
+  unsigned int m_maxRegions;
+  std::vector<bool> m_tiles;
+};
@@ -40,6 +40,10 @@ void CDirtyRegionTracker::SelectAlgorithm()
 
   switch (g_advancedSettings.m_guiAlgorithmDirtyRegions)
   {
+    case DIRTYREGION_SOLVER_TILES:
+      CLog::Log(LOGDEBUG, "guilib: Tiles as algorithm for solving rendering passes");
+      m_solver = new CTileDirtyRegionSolver();
+      break;
     case DIRTYREGION_SOLVER_FILL_VIEWPORT_ON_CHANGE:
       CLog::Log(LOGDEBUG, "guilib: Fill viewport on change for solving rendering passes");
       m_solver = new CFillViewportOnChangeRegionSolver();
@@ -62,11 +62,13 @@ CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, fl
   m_autoScrollDelayTime = 0;
   m_autoScrollIsReversed = false;
   m_lastRenderTime = 0;
+  m_lazyItems = NULL;
 }
 
 CGUIBaseContainer::~CGUIBaseContainer(void)
 {
   delete m_listProvider;
+  delete m_lazyItems;
 }
 
 void CGUIBaseContainer::DoProcess(unsigned int currentTime, CDirtyRegionList &dirtyregions)
@@ -128,7 +130,7 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
     bool focused = (current == GetOffset() + GetCursor());
     if (itemNo >= 0)
     {
-      CGUIListItemPtr item = m_items[itemNo];
+      CGUIListItemPtr item = GetItemAt(itemNo);
       // render our item
       if (m_orientation == VERTICAL)
         ProcessItem(origin.x, pos, item, focused, currentTime, dirtyregions);
@@ -235,7 +237,7 @@ void CGUIBaseContainer::Render()
       bool focused = (current == GetOffset() + GetCursor());
       if (itemNo >= 0)
       {
-        CGUIListItemPtr item = m_items[itemNo];
+        CGUIListItemPtr item = GetItemAt(itemNo);
         // render our item
         if (focused)
         {
@@ -406,8 +408,17 @@ bool CGUIBaseContainer::OnMessage(CGUIMessage& message)
       { // bind our items
         Reset();
         CFileItemList *items = (CFileItemList *)message.GetPointer();
-        for (int i = 0; i < items->Size(); i++)
-          m_items.push_back(items->Get(i));
+        if (items->IsLazy())
+        { // share the rows, items are materialized once they are rendered
+          m_lazyItems = new CFileItemList;
+          m_lazyItems->Append(*items);
+          m_items.resize(items->Size());
+        }
+        else
+        {
+          for (int i = 0; i < items->Size(); i++)
+            m_items.push_back(items->Get(i));
+        }
         UpdateLayout(true); // true to refresh all items
         UpdateScrollByLetter();
         SelectItem(message.GetParam1());
@@ -443,7 +454,10 @@ bool CGUIBaseContainer::OnMessage(CGUIMessage& message)
     else if (message.GetMessage() == GUI_MSG_REFRESH_LIST)
     { // update our list contents
       for (unsigned int i = 0; i < m_items.size(); ++i)
-        m_items[i]->SetInvalid();
+      {
+        if (m_items[i])
+          m_items[i]->SetInvalid();
+      }
     }
     else if (message.GetMessage() == GUI_MSG_MOVE_OFFSET)
     {
@@ -560,7 +574,7 @@ void CGUIBaseContainer::OnJumpLetter(char letter, bool skip /*=false*/)
   unsigned int i      = (offset + ((skip) ? 1 : 0)) % m_items.size();
   do
   {
-    CGUIListItemPtr item = m_items[i];
+    CGUIListItemPtr item = GetItemAt(i);
     if (0 == strnicmp(SortUtils::RemoveArticles(item->GetLabel()).c_str(), m_match.c_str(), m_match.size()))
     {
       SelectItem(i);
@@ -647,12 +661,12 @@ CGUIListItemPtr CGUIBaseContainer::GetListItem(int offset, unsigned int flag) co
   {
     item %= ((int)m_items.size());
     if (item < 0) item += m_items.size();
-    return m_items[item];
+    return GetItemAt(item);
   }
   else
   {
     if (item >= 0 && item < (int)m_items.size())
-      return m_items[item];
+      return GetItemAt(item);
   }
   return CGUIListItemPtr();
 }
@@ -740,7 +754,7 @@ bool CGUIBaseContainer::OnClick(int actionID)
     { // "select" action
       int selected = GetSelectedItem();
       if (selected >= 0 && selected < (int)m_items.size())
-        m_listProvider->OnClick(m_items[selected]);
+        m_listProvider->OnClick(GetItemAt(selected));
       return true;
     }
     // grab the currently focused subitem (if applicable)
@@ -759,7 +773,7 @@ CStdString CGUIBaseContainer::GetDescription() const
   int item = GetSelectedItem();
   if (item >= 0 && item < (int)m_items.size())
   {
-    CGUIListItemPtr pItem = m_items[item];
+    CGUIListItemPtr pItem = GetItemAt(item);
     if (pItem->m_bIsFolder)
       strLabel = StringUtils::Format("[%s]", pItem->GetLabel().c_str());
     else
@@ -829,7 +843,10 @@ void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
   if (updateAllItems)
   { // free memory of items
     for (iItems it = m_items.begin(); it != m_items.end(); ++it)
-      (*it)->FreeMemory();
+    {
+      if (*it)
+        (*it)->FreeMemory();
+    }
   }
   // and recalculate the layout
   CalculateLayout();
@@ -938,11 +955,14 @@ void CGUIBaseContainer::UpdateScrollByLetter()
   CStdString currentMatch;
   for (unsigned int i = 0; i < m_items.size(); i++)
   {
-    CGUIListItemPtr item = m_items[i];
     // The letter offset jumping is only for ASCII characters at present, and
     // our checks are all done in uppercase
     CStdString nextLetter;
-    std::wstring character = item->GetSortLabel().substr(0, 1);
+    std::wstring character;
+    if (m_items[i])
+      character = m_items[i]->GetSortLabel().substr(0, 1);
+    else if (m_lazyItems)
+      character = m_lazyItems->GetSortLabel(i).substr(0, 1);
     StringUtils::ToUpper(character);
     g_charsetConverter.wToUTF8(character, nextLetter);
     if (currentMatch != nextLetter)
@@ -1060,6 +1080,8 @@ void CGUIBaseContainer::Reset()
 {
   m_wasReset = true;
   m_items.clear();
+  delete m_lazyItems;
+  m_lazyItems = NULL;
   m_lastItem.reset();
   ResetAutoScrolling();
 }
@@ -1104,19 +1126,33 @@ void CGUIBaseContainer::SetRenderOffset(const CPoint &offset)
   m_renderOffset = offset;
 }
 
+CGUIListItemPtr CGUIBaseContainer::GetItemAt(unsigned int index)
+{
+  if (!m_items[index] && m_lazyItems)
+    m_items[index] = m_lazyItems->Get(index);
+  return m_items[index];
+}
+
+CGUIListItemPtr CGUIBaseContainer::GetItemAt(unsigned int index) const
+{
+  if (!m_items[index] && m_lazyItems)
+    return m_lazyItems->Get(index);
+  return m_items[index];
+}
+
 void CGUIBaseContainer::FreeMemory(int keepStart, int keepEnd)
 {
   if (keepStart < keepEnd)
   { // remove before keepStart and after keepEnd
     for (int i = 0; i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      if (m_items[i]) m_items[i]->FreeMemory();
     for (int i = std::max(keepEnd + 1, 0); i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      if (m_items[i]) m_items[i]->FreeMemory();
   }
   else
   { // wrapping
     for (int i = std::max(keepEnd + 1, 0); i < keepStart && i < (int)m_items.size(); ++i)
-      m_items[i]->FreeMemory();
+      if (m_items[i]) m_items[i]->FreeMemory();
   }
 }
 
@@ -1136,6 +1172,7 @@ void CGUIBaseContainer::DumpTextureUse()
   for (unsigned int i = 0; i < m_items.size(); ++i)
   {
     CGUIListItemPtr item = m_items[i];
+    if (!item) continue;
     if (item->GetFocusedLayout()) item->GetFocusedLayout()->DumpTextureUse();
     if (item->GetLayout()) item->GetLayout()->DumpTextureUse();
   }
@@ -1224,7 +1261,8 @@ CStdString CGUIBaseContainer::GetLabel(int info) const
   case CONTAINER_NUM_ITEMS:
     {
       unsigned int numItems = GetNumItems();
-      if (numItems && m_items[0]->IsFileItem() && (boost::static_pointer_cast<CFileItem>(m_items[0]))->IsParentFolder())
+      CGUIListItemPtr first = numItems ? GetItemAt(0) : CGUIListItemPtr();
+      if (first && first->IsFileItem() && (boost::static_pointer_cast<CFileItem>(first))->IsParentFolder())
         label = StringUtils::Format("%u", numItems-1);
       else
         label = StringUtils::Format("%u", numItems);
@@ -35,6 +35,7 @@
  */
 
 class IListProvider;
+class CFileItemList;
 
 class CGUIBaseContainer : public IGUIContainer
 {
@@ -119,6 +120,11 @@ protected:
   virtual int GetCursorFromPoint(const CPoint &point, CPoint *itemPoint = NULL) const { return -1; };
   virtual void Reset();
   virtual unsigned int GetNumItems() const { return m_items.size(); };
+  /*! \brief Get an item, materializing it if it's part of a lazily bound list
+   \sa CFileItemList::AddRows
+   */
+  CGUIListItemPtr GetItemAt(unsigned int index);
+  CGUIListItemPtr GetItemAt(unsigned int index) const;
   virtual int GetCurrentPage() const;
   bool InsideLayout(const CGUIListItemLayout *layout, const CPoint &point) const;
   virtual void OnFocus();
@@ -141,6 +147,7 @@ protected:
 
   std::vector< CGUIListItemPtr > m_items;
   typedef std::vector<CGUIListItemPtr> ::iterator iItems;
+  CFileItemList *m_lazyItems; ///< rows of a lazy list, items are only added to m_items as they are needed
   CGUIListItemPtr m_lastItem;
 
   int m_pageControl;
@@ -457,6 +457,18 @@ CRect CGUIControl::CalcRenderRegion() const
   return CRect(tl.x, tl.y, br.x, br.y);
 }
 
+bool CGUIControl::CanCull() const
+{
+  return m_hasProcessed && !m_renderRegion.IsEmpty() && !DrivesRendering();
+}
+
+bool CGUIControl::DrivesRendering() const
+{
+  return ControlType == GUICONTROL_VIDEO ||
+         ControlType == GUICONTROL_VISUALISATION ||
+         ControlType == GUICONTROL_RENDERADDON;
+}
+
 void CGUIControl::SetNavigationActions(const ActionMap &actions)
 {
   m_actions = actions;
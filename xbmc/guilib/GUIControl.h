@@ -178,6 +178,17 @@ public:
    Called during process to update m_renderRegion
    */
   virtual CRect CalcRenderRegion() const;
+  /*! \brief whether the whole render region is covered with opaque pixels
+   Controls rendered before this one that lie within its render region are hidden.
+   */
+  virtual bool IsOpaque() const { return false; };
+  /*! \brief whether rendering may be skipped when the control is hidden or outside the area being redrawn
+   Controls that drive video or addon rendering are always rendered, as are groups holding them.
+   */
+  bool CanCull() const;
+  /*! \brief whether the control, or any control it holds, drives video, visualisation or addon rendering
+   */
+  virtual bool DrivesRendering() const;
 
   /*! \brief Set actions to perform on navigation
    \param actions ActionMap of actions
@@ -20,9 +20,17 @@
 
 #include "GUIControlGroup.h"
 #include "GUIControlProfiler.h"
+#include "GraphicContext.h"
+#include "IDirtyRegionSolver.h"
+#include "settings/AdvancedSettings.h"
 
 using namespace std;
 
+static inline bool Contains(const CRect &outer, const CRect &inner)
+{
+  return outer.x1 <= inner.x1 && outer.y1 <= inner.y1 && outer.x2 >= inner.x2 && outer.y2 >= inner.y2;
+}
+
 CGUIControlGroup::CGUIControlGroup()
 {
   m_defaultControl = 0;
@@ -119,12 +127,15 @@ void CGUIControlGroup::Render()
   CPoint pos(GetPosition());
   g_graphicsContext.SetOrigin(pos.x, pos.y);
   CGUIControl *focusedControl = NULL;
-  for (iControls it = m_children.begin(); it != m_children.end(); ++it)
+  bool cull = g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_TILES;
+  if (cull)
+    CullChildren(g_graphicsContext.GetScissors());
+  for (unsigned int i = 0; i < m_children.size(); i++)
   {
-    CGUIControl *control = *it;
+    CGUIControl *control = m_children[i];
     if (m_renderFocusedLast && control->HasFocus())
       focusedControl = control;
-    else
+    else if (!cull || !m_culledChildren[i])
       control->DoRender();
   }
   if (focusedControl)
@@ -133,6 +144,62 @@ void CGUIControlGroup::Render()
   g_graphicsContext.RestoreOrigin();
 }
 
+bool CGUIControlGroup::IsOpaque() const
+{
+  if (!IsVisible() || m_renderRegion.IsEmpty())
+    return false;
+
+  for (ciControls it = m_children.begin(); it != m_children.end(); ++it)
+  {
+    const CGUIControl *control = *it;
+    if (control->IsOpaque() && Contains(control->GetRenderRegion(), m_renderRegion))
+      return true;
+  }
+  return false;
+}
+
+bool CGUIControlGroup::DrivesRendering() const
+{
+  for (ciControls it = m_children.begin(); it != m_children.end(); ++it)
+  {
+    if ((*it)->DrivesRendering())
+      return true;
+  }
+  return false;
+}
+
+void CGUIControlGroup::CullChildren(const CRect &redrawn)
+{
+  // walk the children back to front, collecting the regions hidden by opaque
+  // ones. A focused control rendered last is left alone.
+  m_culledChildren.assign(m_children.size(), false);
+  vector<CRect> opaque;
+  for (int i = (int)m_children.size() - 1; i >= 0; i--)
+  {
+    CGUIControl *control = m_children[i];
+    if (!control->IsVisible() || (m_renderFocusedLast && control->HasFocus()))
+      continue;
+
+    if (control->CanCull())
+    {
+      const CRect &region = control->GetRenderRegion();
+      bool hidden = CRect(region).Intersect(redrawn).IsEmpty();
+      for (vector<CRect>::const_iterator it = opaque.begin(); !hidden && it != opaque.end(); ++it)
+        hidden = Contains(*it, region);
+
+      if (hidden)
+      {
+        m_culledChildren[i] = true;
+        GUIPROFILER_CULLED(control);
+        continue;
+      }
+    }
+
+    if (control->IsOpaque())
+      opaque.push_back(control->GetRenderRegion());
+  }
+}
+
 bool CGUIControlGroup::OnAction(const CAction &action)
 {
   ASSERT(false);  // unimplemented
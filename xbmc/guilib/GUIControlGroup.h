@@ -82,6 +82,10 @@ public:
   virtual void SaveStates(std::vector<CControlState> &states);
 
   virtual bool IsGroup() const { return true; };
+  /*! \brief a group is opaque if one of its children covers all of it
+   */
+  virtual bool IsOpaque() const;
+  virtual bool DrivesRendering() const;
 
 #ifdef _DEBUG
   virtual void DumpTextureUse();
@@ -96,6 +100,14 @@ protected:
    */
   bool IsValidControl(const CGUIControl *control) const;
 
+  /*!
+   \brief Find the children that don't have to be rendered
+   Children are skipped if they lie outside the area being redrawn or are
+   hidden behind opaque children rendered after them.
+   \param redrawn the area being redrawn, in screen coordinates
+   */
+  void CullChildren(const CRect &redrawn);
+
   // sub controls
   std::vector<CGUIControl *> m_children;
   typedef std::vector<CGUIControl *>::iterator iControls;
@@ -114,5 +126,6 @@ protected:
   bool m_defaultAlways;
   int m_focusedControl;
   bool m_renderFocusedLast;
+  std::vector<bool> m_culledChildren;
 };
 
@@ -26,7 +26,7 @@
 bool CGUIControlProfiler::m_bIsRunning = false;
 
 CGUIControlProfilerItem::CGUIControlProfilerItem(CGUIControlProfiler *pProfiler, CGUIControlProfilerItem *pParent, CGUIControl *pControl)
-: m_pProfiler(pProfiler), m_pParent(pParent), m_pControl(pControl), m_visTime(0), m_renderTime(0), m_i64VisStart(0), m_i64RenderStart(0)
+: m_pProfiler(pProfiler), m_pParent(pParent), m_pControl(pControl), m_visTime(0), m_renderTime(0), m_culled(0), m_i64VisStart(0), m_i64RenderStart(0)
 {
   if (m_pControl)
   {
@@ -54,6 +54,7 @@ void CGUIControlProfilerItem::Reset(CGUIControlProfiler *pProfiler)
 
   m_visTime = 0;
   m_renderTime = 0;
+  m_culled = 0;
   const unsigned int dwSize = m_vecChildren.size();
   for (unsigned int i=0; i<dwSize; ++i)
     delete m_vecChildren[i];
@@ -202,6 +203,15 @@ void CGUIControlProfilerItem::SaveToXML(TiXmlElement *parent)
     elem->LinkEndChild(text);
   }
 
+  if (m_culled)
+  {
+    TiXmlElement *elem = new TiXmlElement("culled");
+    xmlControl->LinkEndChild(elem);
+    CStdString val = StringUtils::Format("%u", m_culled);
+    TiXmlText *text = new TiXmlText(val.c_str());
+    elem->LinkEndChild(text);
+  }
+
   if (m_vecChildren.size())
   {
     TiXmlElement *xmlChilds = new TiXmlElement("children");
@@ -237,7 +247,7 @@ CGUIControlProfilerItem *CGUIControlProfilerItem::FindOrAddControl(CGUIControl *
 }
 
 CGUIControlProfiler::CGUIControlProfiler(void)
-: m_ItemHead(NULL, NULL, NULL), m_pLastItem(NULL), m_iMaxFrameCount(200), m_iFrameCount(0)
+: m_ItemHead(NULL, NULL, NULL), m_pLastItem(NULL), m_iMaxFrameCount(200), m_iFrameCount(0), m_screenArea(0), m_redrawnArea(0)
 // m_bIsRunning(false), no isRunning because it is static
 {
   m_fPerfScale = 100000.0f / CurrentHostFrequency();
@@ -257,6 +267,8 @@ bool CGUIControlProfiler::IsRunning(void)
 void CGUIControlProfiler::Start(void)
 {
   m_iFrameCount = 0;
+  m_screenArea = 0;
+  m_redrawnArea = 0;
   m_bIsRunning = true;
   m_pLastItem = NULL;
   m_ItemHead.Reset(this);
@@ -286,6 +298,18 @@ void CGUIControlProfiler::EndRender(CGUIControl *pControl)
   item->EndRender();
 }
 
+void CGUIControlProfiler::Culled(CGUIControl *pControl)
+{
+  CGUIControlProfilerItem *item = FindOrAddControl(pControl);
+  item->m_culled++;
+}
+
+void CGUIControlProfiler::AddRedrawnArea(float screenArea, float redrawnArea)
+{
+  m_screenArea += screenArea;
+  m_redrawnArea += redrawnArea;
+}
+
 CGUIControlProfilerItem *CGUIControlProfiler::FindOrAddControl(CGUIControl *pControl)
 {
   if (m_pLastItem)
@@ -346,6 +370,12 @@ bool CGUIControlProfiler::SaveResults(void)
   CStdString str = StringUtils::Format("%d", m_iFrameCount);
   root->SetAttribute("framecount", str.c_str());
   root->SetAttribute("timeunit", "ms");
+  if (m_screenArea > 0)
+  {
+    // share of the screen that didn't have to be filled thanks to dirty regions
+    str = StringUtils::Format("%.0f", 100.0 * (1.0 - m_redrawnArea / m_screenArea));
+    root->SetAttribute("fillsaved", str.c_str());
+  }
   doc.LinkEndChild(root);
 
   m_ItemHead.SaveToXML(root);
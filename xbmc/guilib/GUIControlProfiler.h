@@ -39,6 +39,7 @@ public:
   CGUIControl::GUICONTROLTYPES m_ControlType;
   unsigned int m_visTime;
   unsigned int m_renderTime;
+  unsigned int m_culled;
   int64_t m_i64VisStart;
   int64_t m_i64RenderStart;
 
@@ -69,6 +70,10 @@ public:
   void EndVisibility(CGUIControl *pControl);
   void BeginRender(CGUIControl *pControl);
   void EndRender(CGUIControl *pControl);
+  /*! \brief Count a control that wasn't rendered as it was hidden or outside the redrawn area */
+  void Culled(CGUIControl *pControl);
+  /*! \brief Add the area redrawn in a frame, to report how much of the screen didn't have to be filled */
+  void AddRedrawnArea(float screenArea, float redrawnArea);
   int GetMaxFrameCount(void) const { return m_iMaxFrameCount; };
   void SetMaxFrameCount(int iMaxFrameCount) { m_iMaxFrameCount = iMaxFrameCount; };
   void SetOutputFile(const CStdString &strOutputFile) { m_strOutputFile = strOutputFile; };
@@ -91,11 +96,15 @@ private:
   CStdString m_strOutputFile;
   int m_iMaxFrameCount;
   int m_iFrameCount;
+  double m_screenArea;
+  double m_redrawnArea;
 };
 
 #define GUIPROFILER_VISIBILITY_BEGIN(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().BeginVisibility(x); }
 #define GUIPROFILER_VISIBILITY_END(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndVisibility(x); }
 #define GUIPROFILER_RENDER_BEGIN(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().BeginRender(x); }
 #define GUIPROFILER_RENDER_END(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().EndRender(x); }
+#define GUIPROFILER_CULLED(x) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().Culled(x); }
+#define GUIPROFILER_REDRAWN(screen, redrawn) { if (CGUIControlProfiler::IsRunning()) CGUIControlProfiler::Instance().AddRedrawnArea(screen, redrawn); }
 
 #endif
@@ -0,0 +1,264 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIFontAtlas.h"
+#include "utils/log.h"
+
+#include <string.h>
+
+using namespace std;
+
+CGUIFontAtlas::CGUIFontAtlas(unsigned int width, unsigned int height, unsigned int maxPages)
+  : m_width(width),
+    m_height(height),
+    m_maxPages(maxPages),
+    m_frame(0)
+{
+  memset(&m_stats, 0, sizeof(m_stats));
+  memset(&m_lastFrame, 0, sizeof(m_lastFrame));
+  memset(&m_total, 0, sizeof(m_total));
+}
+
+bool CGUIFontAtlas::Allocate(const void *owner, unsigned int width, unsigned int lineHeight, Slot &slot)
+{
+  if (width > m_width || lineHeight > m_height || lineHeight == 0)
+    return false;
+
+  Shelf *shelf = NULL;
+  for (vector<Shelf>::reverse_iterator it = m_shelves.rbegin(); it != m_shelves.rend(); ++it)
+  {
+    if (it->owner == owner && it->height >= lineHeight && it->used + width <= m_width)
+    {
+      shelf = &*it;
+      break;
+    }
+  }
+
+  if (shelf == NULL)
+  {
+    // take over the shelf of an unloaded font, if it doesn't waste too much room
+    for (vector<Shelf>::iterator it = m_shelves.begin(); it != m_shelves.end(); ++it)
+    {
+      if (it->owner == NULL && it->height >= lineHeight && it->height <= lineHeight + lineHeight / 4)
+      {
+        it->owner = owner;
+        it->used = 0;
+        ClearRows(it->page, it->y, it->height);
+        shelf = &*it;
+        break;
+      }
+    }
+  }
+
+  if (shelf == NULL)
+  {
+    AddShelf(owner, lineHeight);
+    shelf = &m_shelves.back();
+  }
+
+  slot.page = shelf->page;
+  slot.generation = m_pages[shelf->page].generation;
+  slot.x = shelf->used;
+  slot.y = shelf->y;
+  shelf->used += width;
+
+  return true;
+}
+
+void CGUIFontAtlas::Release(const void *owner)
+{
+  for (vector<Shelf>::iterator it = m_shelves.begin(); it != m_shelves.end(); ++it)
+  {
+    if (it->owner == owner)
+    {
+      it->owner = NULL;
+      it->used = 0;
+    }
+  }
+}
+
+void CGUIFontAtlas::Reset()
+{
+  for (unsigned int page = 0; page < m_pages.size(); page++)
+    ClearPage(page);
+}
+
+void CGUIFontAtlas::Write(const Slot &slot, const unsigned char *pixels, unsigned int pitch, unsigned int width, unsigned int height)
+{
+  if (!IsValid(slot.page, slot.generation) || slot.x >= m_width || slot.y >= m_height)
+    return;
+
+  // stay inside the page, glyphs are expected to fit their shelf but there is no harm in making sure
+  if (width > m_width - slot.x)
+    width = m_width - slot.x;
+  if (height > m_height - slot.y)
+    height = m_height - slot.y;
+
+  Page &page = m_pages[slot.page];
+  unsigned char *target = &page.pixels[slot.y * m_width + slot.x];
+  for (unsigned int y = 0; y < height; y++)
+  {
+    memcpy(target, pixels, width);
+    pixels += pitch;
+    target += m_width;
+  }
+
+  MarkDirty(slot.page, slot.y, height);
+}
+
+void CGUIFontAtlas::NextFrame()
+{
+  // pages added beyond the limit while a frame used all others are given up
+  // now that nothing queued refers to them. The glyphs still needed are
+  // cached again, packed into the remaining pages.
+  unsigned int used = 0;
+  for (unsigned int page = 0; page < m_pages.size(); page++)
+  {
+    if (m_pages[page].nextShelf > 0)
+      used++;
+  }
+  for (; used > m_maxPages; used--)
+  {
+    unsigned int oldest = m_pages.size();
+    for (unsigned int i = 0; i < m_pages.size(); i++)
+    {
+      if (m_pages[i].nextShelf > 0 && (oldest == m_pages.size() || m_pages[i].lastUsed < m_pages[oldest].lastUsed))
+        oldest = i;
+    }
+    ClearPage(oldest);
+    m_stats.evictions++;
+  }
+
+  m_total.hits += m_stats.hits;
+  m_total.misses += m_stats.misses;
+  m_total.evictions += m_stats.evictions;
+  m_total.vertices += m_stats.vertices;
+  m_lastFrame = m_stats;
+  memset(&m_stats, 0, sizeof(m_stats));
+  m_frame++;
+}
+
+bool CGUIFontAtlas::TakeDirtyRows(unsigned int page, unsigned int &firstRow, unsigned int &lastRow)
+{
+  if (page >= m_pages.size() || m_pages[page].dirtyLast == 0)
+    return false;
+
+  firstRow = m_pages[page].dirtyFirst;
+  lastRow = m_pages[page].dirtyLast;
+  m_pages[page].dirtyFirst = m_pages[page].dirtyLast = 0;
+  return true;
+}
+
+CGUIFontAtlas::Stats CGUIFontAtlas::GetTotalStats() const
+{
+  Stats total = m_total;
+  total.hits += m_stats.hits;
+  total.misses += m_stats.misses;
+  total.evictions += m_stats.evictions;
+  total.vertices += m_stats.vertices;
+  return total;
+}
+
+void CGUIFontAtlas::AddShelf(const void *owner, unsigned int height)
+{
+  unsigned int page = 0;
+  while (page < m_pages.size() && m_pages[page].nextShelf + height > m_height)
+    page++;
+
+  if (page == m_pages.size() && m_pages.size() >= m_maxPages)
+  {
+    // reuse the page that wasn't drawn for the longest time
+    unsigned int oldest = m_pages.size();
+    for (unsigned int i = 0; i < m_pages.size(); i++)
+    {
+      if (m_pages[i].lastUsed != m_frame && (oldest == m_pages.size() || m_pages[i].lastUsed < m_pages[oldest].lastUsed))
+        oldest = i;
+    }
+
+    if (oldest < m_pages.size())
+    {
+      ClearPage(oldest);
+      m_stats.evictions++;
+      page = oldest;
+    }
+    else
+      CLog::Log(LOGDEBUG, "%s - all %u glyph pages are in use, adding another one", __FUNCTION__, (unsigned int)m_pages.size());
+  }
+
+  if (page == m_pages.size())
+  {
+    Page added;
+    added.generation = 0;
+    added.lastUsed = m_frame;
+    added.nextShelf = 0;
+    added.dirtyFirst = 0;
+    added.dirtyLast = m_height;
+    m_pages.push_back(added);
+    m_pages.back().pixels.resize(m_width * m_height, 0);
+  }
+
+  Shelf shelf;
+  shelf.owner = owner;
+  shelf.page = page;
+  shelf.y = m_pages[page].nextShelf;
+  shelf.height = height;
+  shelf.used = 0;
+  m_shelves.push_back(shelf);
+  m_pages[page].nextShelf += height;
+}
+
+void CGUIFontAtlas::ClearPage(unsigned int page)
+{
+  Page &cleared = m_pages[page];
+  cleared.generation++;
+  cleared.nextShelf = 0;
+  ClearRows(page, 0, m_height);
+
+  for (vector<Shelf>::iterator it = m_shelves.begin(); it != m_shelves.end();)
+  {
+    if (it->page == page)
+      it = m_shelves.erase(it);
+    else
+      ++it;
+  }
+}
+
+void CGUIFontAtlas::ClearRows(unsigned int page, unsigned int y, unsigned int height)
+{
+  memset(&m_pages[page].pixels[y * m_width], 0, height * m_width);
+  MarkDirty(page, y, height);
+}
+
+void CGUIFontAtlas::MarkDirty(unsigned int page, unsigned int y, unsigned int height)
+{
+  Page &changed = m_pages[page];
+  if (changed.dirtyLast == 0)
+  {
+    changed.dirtyFirst = y;
+    changed.dirtyLast = y + height;
+  }
+  else
+  {
+    if (y < changed.dirtyFirst)
+      changed.dirtyFirst = y;
+    if (y + height > changed.dirtyLast)
+      changed.dirtyLast = y + height;
+  }
+}
@@ -0,0 +1,167 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+#include <stdint.h>
+
+/*!
+ \ingroup textures
+ \brief Glyph cache shared by all fonts
+
+ The rendered glyphs of all fonts live in a few equally sized 8 bit alpha
+ pages. Every font (a face at a size and border) gets its own shelves, rows
+ as high as its lines, and fills them from left to right. Shelves of fonts
+ that are unloaded are handed to the next font that fits.
+
+ Once the maximum number of pages is reached, the least recently used page is
+ cleared and reused. Glyphs remember the generation of their page so the
+ fonts notice when they have to render them again. Pages used during the
+ current frame are never evicted, as there may still be text queued for
+ drawing that uses them. If a frame needs more pages than allowed, the extra
+ ones are cleared again once it is done.
+
+ The pages are kept in memory only, the renderers upload the rows that
+ changed to their textures before drawing. Neither the atlas nor the page
+ textures are locked, they may only be used from the render thread.
+ */
+class CGUIFontAtlas
+{
+public:
+  struct Slot
+  {
+    unsigned int page;
+    unsigned int generation;
+    unsigned int x;
+    unsigned int y;
+  };
+
+  struct Stats
+  {
+    uint64_t hits;       ///< glyphs found in the cache
+    uint64_t misses;     ///< glyphs that had to be rendered
+    uint64_t evictions;  ///< pages cleared to make room
+    uint64_t vertices;   ///< text vertices drawn
+  };
+
+  /*!
+   \param width Width of every page
+   \param height Height of every page
+   \param maxPages Pages allocated before the least recently used one is reused
+   */
+  CGUIFontAtlas(unsigned int width, unsigned int height, unsigned int maxPages);
+
+  /*!
+   \brief Reserves room for a glyph
+   \param owner The font the glyph belongs to
+   \param width Width of the glyph, including any spacing to the next one
+   \param lineHeight Height of the font's lines, all its glyphs have to fit into it
+   \param slot Where to put the glyph
+   \return False if the glyph can't fit into a page at all
+   */
+  bool Allocate(const void *owner, unsigned int width, unsigned int lineHeight, Slot &slot);
+  /*!
+   \brief Hands the shelves of an unloaded font back
+   */
+  void Release(const void *owner);
+  /*!
+   \brief Clears all pages, invalidating every cached glyph
+   */
+  void Reset();
+
+  /*!
+   \brief Copies a rendered glyph into its slot
+   */
+  void Write(const Slot &slot, const unsigned char *pixels, unsigned int pitch, unsigned int width, unsigned int height);
+
+  bool IsValid(unsigned int page, unsigned int generation) const
+  {
+    return page < m_pages.size() && m_pages[page].generation == generation;
+  }
+  /*!
+   \brief Marks a page as used by the current frame
+   */
+  void Touch(unsigned int page)
+  {
+    if (page < m_pages.size())
+      m_pages[page].lastUsed = m_frame;
+  }
+  void NextFrame();
+
+  unsigned int GetWidth() const { return m_width; }
+  unsigned int GetHeight() const { return m_height; }
+  unsigned int GetPageCount() const { return m_pages.size(); }
+  unsigned int GetGeneration(unsigned int page) const { return m_pages[page].generation; }
+  const unsigned char *GetPixels(unsigned int page) const { return &m_pages[page].pixels[0]; }
+
+  /*!
+   \brief Returns the rows of a page that changed since the last call
+   \return False if nothing changed
+   */
+  bool TakeDirtyRows(unsigned int page, unsigned int &firstRow, unsigned int &lastRow);
+
+  void AddHit() { m_stats.hits++; }
+  void AddMiss() { m_stats.misses++; }
+  void AddVertices(unsigned int count) { m_stats.vertices += count; }
+  /*!
+   \brief Counters of the last complete frame
+   */
+  const Stats &GetFrameStats() const { return m_lastFrame; }
+  /*!
+   \brief Counters since the atlas was created
+   */
+  Stats GetTotalStats() const;
+
+private:
+  struct Page
+  {
+    std::vector<unsigned char> pixels;
+    unsigned int generation;
+    unsigned int lastUsed;   ///< frame the page was last drawn in
+    unsigned int nextShelf;  ///< first row not used by any shelf
+    unsigned int dirtyFirst;
+    unsigned int dirtyLast;  ///< one past the last changed row, 0 if nothing changed
+  };
+
+  struct Shelf
+  {
+    const void *owner;
+    unsigned int page;
+    unsigned int y;
+    unsigned int height;
+    unsigned int used;
+  };
+
+  void AddShelf(const void *owner, unsigned int height);
+  void ClearPage(unsigned int page);
+  void ClearRows(unsigned int page, unsigned int y, unsigned int height);
+  void MarkDirty(unsigned int page, unsigned int y, unsigned int height);
+
+  unsigned int m_width;
+  unsigned int m_height;
+  unsigned int m_maxPages;
+  unsigned int m_frame;
+  std::vector<Page> m_pages;
+  std::vector<Shelf> m_shelves;
+
+  Stats m_stats;
+  Stats m_lastFrame;
+  Stats m_total;
+};
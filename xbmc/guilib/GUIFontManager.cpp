@@ -23,6 +23,7 @@
 #include "GUIWindowManager.h"
 #include "addons/Skin.h"
 #include "GUIFontTTF.h"
+#include "GUIFontAtlas.h"
 #include "GUIFont.h"
 #include "utils/XMLUtils.h"
 #include "GUIControlFactory.h"
@@ -40,14 +41,19 @@
 
 using namespace std;
 
+#define GLYPH_PAGE_SIZE 1024  // width and height of the glyph cache pages
+#define GLYPH_PAGES     8     // pages allocated before old ones are reused
+
 GUIFontManager::GUIFontManager(void)
 {
   m_canReload = true;
+  m_glyphAtlas = NULL;
 }
 
 GUIFontManager::~GUIFontManager(void)
 {
   Clear();
+  delete m_glyphAtlas;
 }
 
 void GUIFontManager::RescaleFontSizeAndAspect(float *size, float *aspect, const RESOLUTION_INFO &sourceRes, bool preserveAspect)
@@ -335,6 +341,27 @@ void GUIFontManager::Clear()
   m_vecFonts.clear();
   m_vecFontFiles.clear();
   m_vecFontInfo.clear();
+
+  // start over with empty pages, the next fonts probably have other sizes
+  if (m_glyphAtlas)
+    m_glyphAtlas->Reset();
+  CGUIFontTTF::FreePageTextures();
+}
+
+CGUIFontAtlas& GUIFontManager::GetGlyphAtlas()
+{
+  if (!m_glyphAtlas)
+  {
+    unsigned int size = std::min<unsigned int>(GLYPH_PAGE_SIZE, g_Windowing.GetMaxTextureSize());
+    m_glyphAtlas = new CGUIFontAtlas(size, size, GLYPH_PAGES);
+  }
+  return *m_glyphAtlas;
+}
+
+void GUIFontManager::NextFrame()
+{
+  if (m_glyphAtlas)
+    m_glyphAtlas->NextFrame();
 }
 
 void GUIFontManager::LoadFonts(const std::string& fontSet)
@@ -35,6 +35,7 @@
 // Forward
 class CGUIFont;
 class CGUIFontTTFBase;
+class CGUIFontAtlas;
 class CXBMCTinyXML;
 class TiXmlNode;
 class CSetting;
@@ -76,6 +77,13 @@ public:
   void Clear();
   void FreeFontFile(CGUIFontTTFBase *pFont);
 
+  /*! \brief the glyph cache shared by all fonts
+   */
+  CGUIFontAtlas& GetGlyphAtlas();
+  /*! \brief marks the end of a rendered frame for the glyph cache
+   */
+  void NextFrame();
+
   static void SettingOptionsFontsFiller(const CSetting *setting, std::vector< std::pair<std::string, std::string> > &list, std::string &current, void *data);
 
 protected:
@@ -90,6 +98,7 @@ protected:
   std::vector<OrigFontInfo> m_vecFontInfo;
   RESOLUTION_INFO m_skinResolution;
   bool m_canReload;
+  CGUIFontAtlas* m_glyphAtlas;
 };
 
 /*!
@@ -21,7 +21,7 @@
 #include "GUIFont.h"
 #include "GUIFontTTF.h"
 #include "GUIFontManager.h"
-#include "Texture.h"
+#include "GUIFontAtlas.h"
 #include "GraphicContext.h"
 #include "filesystem/SpecialProtocol.h"
 #include "utils/MathUtils.h"
@@ -46,7 +46,6 @@
 using namespace std;
 
 
-#define CHARS_PER_TEXTURE_LINE 20 // number of characters to cache per texture line
 #define CHAR_CHUNK    64      // 64 chars allocated at a time (1024 bytes)
 
 int CGUIFontTTFBase::justification_word_weight = 6;   // weight of word spacing over letter spacing when justifying.
@@ -133,12 +132,11 @@ XBMC_GLOBAL_REF(CFreeTypeLibrary, g_freeTypeLibrary); // our freetype library
 
 CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
 {
-  m_texture = NULL;
+  m_atlas = NULL;
   m_char = NULL;
   m_maxChars = 0;
   m_nestedBeginCount = 0;
 
-  m_bTextureLoaded = false;
   m_vertex_size   = 4*1024;
   m_vertex        = (SVertex*)malloc(m_vertex_size * sizeof(SVertex));
 
@@ -150,13 +148,10 @@ CGUIFontTTFBase::CGUIFontTTFBase(const CStdString& strFileName)
   m_originX = m_originY = 0.0f;
   m_cellBaseLine = m_cellHeight = 0;
   m_numChars = 0;
-  m_posX = m_posY = 0;
-  m_textureHeight = m_textureWidth = 0;
   m_textureScaleX = m_textureScaleY = 0.0;
   m_ellipsesWidth = m_height = 0.0f;
   m_color = 0;
   m_vertex_count = 0;
-  m_nTexture = 0;
 }
 
 CGUIFontTTFBase::~CGUIFontTTFBase(void)
@@ -178,35 +173,17 @@ void CGUIFontTTFBase::RemoveReference()
 }
 
 
-void CGUIFontTTFBase::ClearCharacterCache()
-{
-  delete(m_texture);
-
-  DeleteHardwareTexture();
-
-  m_texture = NULL;
-  delete[] m_char;
-  m_char = new Character[CHAR_CHUNK];
-  memset(m_charquick, 0, sizeof(m_charquick));
-  m_numChars = 0;
-  m_maxChars = CHAR_CHUNK;
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
-  m_textureHeight = 0;
-}
-
 void CGUIFontTTFBase::Clear()
 {
-  delete(m_texture);
-  m_texture = NULL;
+  if (m_atlas)
+    m_atlas->Release(this);
+  m_atlas = NULL;
+
   delete[] m_char;
   memset(m_charquick, 0, sizeof(m_charquick));
   m_char = NULL;
   m_maxChars = 0;
   m_numChars = 0;
-  m_posX = 0;
-  m_posY = 0;
   m_nestedBeginCount = 0;
 
   if (m_face)
@@ -218,7 +195,13 @@ void CGUIFontTTFBase::Clear()
 
   free(m_vertex);
   m_vertex = NULL;
+  ClearVertices();
+}
+
+void CGUIFontTTFBase::ClearVertices()
+{
   m_vertex_count = 0;
+  m_pageRuns.clear();
 }
 
 bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float aspect, float lineSpacing, bool border)
@@ -279,8 +262,8 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   m_height = height;
 
-  delete(m_texture);
-  m_texture = NULL;
+  if (m_atlas)
+    m_atlas->Release(this);
   delete[] m_char;
   m_char = NULL;
 
@@ -289,18 +272,10 @@ bool CGUIFontTTFBase::Load(const CStdString& strFilename, float height, float as
 
   m_strFilename = strFilename;
 
-  m_textureHeight = 0;
-  m_textureWidth = ((m_cellHeight * CHARS_PER_TEXTURE_LINE) & ~63) + 64;
-
-  m_textureWidth = CBaseTexture::PadPow2(m_textureWidth);
-
-  if (m_textureWidth > g_Windowing.GetMaxTextureSize())
-    m_textureWidth = g_Windowing.GetMaxTextureSize();
-  m_textureScaleX = 1.0f / m_textureWidth;
-
-  // set the posX and posY so that our texture will be created on first character write.
-  m_posX = m_textureWidth;
-  m_posY = -(int)GetTextureLineHeight();
+  // our characters go to the pages shared by all fonts
+  m_atlas = &g_fontManager.GetGlyphAtlas();
+  m_textureScaleX = 1.0f / m_atlas->GetWidth();
+  m_textureScaleY = 1.0f / m_atlas->GetHeight();
 
   // cache the ellipses width
   Character *ellipse = GetCharacter(L'.');
@@ -478,7 +453,7 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   {
     character_t ch = (style << 8) | letter;
     if (m_charquick[ch])
-      return m_charquick[ch];
+      return ValidateCharacter(m_charquick[ch]);
   }
 
   // letters are stored based on style and letter
@@ -494,7 +469,7 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
     else if (ch < m_char[mid].letterAndStyle)
       high = mid - 1;
     else
-      return &m_char[mid];
+      return ValidateCharacter(&m_char[mid]);
   }
   // if we get to here, then low is where we should insert the new character
 
@@ -516,26 +491,19 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
   { // just move the data along as necessary
     memmove(m_char + low + 1, m_char + low, (m_numChars - low) * sizeof(Character));
   }
-  // render the character to our texture
-  // must End() as we can't render text to our texture during a Begin(), End() block
-  unsigned int nestedBeginCount = m_nestedBeginCount;
-  m_nestedBeginCount = 1;
-  if (nestedBeginCount) End();
-  if (!CacheCharacter(letter, style, m_char + low))
-  { // unable to cache character - try clearing them all out and starting over
-    CLog::Log(LOGDEBUG, "%s: Unable to cache character.  Clearing character cache of %i characters", __FUNCTION__, m_numChars);
-    ClearCharacterCache();
-    low = 0;
-    if (!CacheCharacter(letter, style, m_char + low))
-    {
-      CLog::Log(LOGERROR, "%s: Unable to cache character (out of memory?)", __FUNCTION__);
-      if (nestedBeginCount) Begin();
-      m_nestedBeginCount = nestedBeginCount;
-      return NULL;
-    }
+  // render the character to the atlas. The pages are only uploaded when
+  // drawing, so this is fine during a Begin(), End() block
+  m_atlas->AddMiss();
+  bool cached = CacheCharacter(letter, style, m_char + low);
+  if (cached)
+    m_numChars++;
+  else
+  {
+    // the atlas reuses its pages as needed, so there is no point in clearing
+    // our characters and trying again
+    CLog::Log(LOGERROR, "%s: Unable to cache character %x", __FUNCTION__, letter);
+    memmove(m_char + low, m_char + low + 1, (m_numChars - low) * sizeof(Character));
   }
-  if (nestedBeginCount) Begin();
-  m_nestedBeginCount = nestedBeginCount;
 
   // fixup quick access
   memset(m_charquick, 0, sizeof(m_charquick));
@@ -548,7 +516,22 @@ CGUIFontTTFBase::Character* CGUIFontTTFBase::GetCharacter(character_t chr)
     }
   }
 
-  return m_char + low;
+  return cached ? m_char + low : NULL;
+}
+
+CGUIFontTTFBase::Character* CGUIFontTTFBase::ValidateCharacter(Character *ch)
+{
+  if (ch->page == NoPage || m_atlas->IsValid(ch->page, ch->generation))
+  {
+    m_atlas->AddHit();
+    return ch;
+  }
+
+  // the page was handed to other glyphs, render it again in place
+  m_atlas->AddMiss();
+  if (!CacheCharacter((wchar_t)(ch->letterAndStyle & 0xffff), ch->letterAndStyle >> 16, ch))
+    return NULL;
+  return ch;
 }
 
 bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *ch)
@@ -585,73 +568,42 @@ bool CGUIFontTTFBase::CacheCharacter(wchar_t letter, uint32_t style, Character *
   FT_Bitmap bitmap = bitGlyph->bitmap;
   bool isEmptyGlyph = (bitmap.width == 0 || bitmap.rows == 0);
 
-  if (!isEmptyGlyph)
-  {
-    if (bitGlyph->left < 0)
-      m_posX += -bitGlyph->left;
-
-    // check we have enough room for the character
-    if (m_posX + bitGlyph->left + bitmap.width > (int)m_textureWidth)
-    { // no space - gotta drop to the next line (which means creating a new texture and copying it across)
-      m_posX = 0;
-      m_posY += GetTextureLineHeight();
-      if (bitGlyph->left < 0)
-        m_posX += -bitGlyph->left;
-
-      if(m_posY + GetTextureLineHeight() >= m_textureHeight)
-      {
-        // create the new larger texture
-        unsigned int newHeight = m_posY + GetTextureLineHeight();
-        // check for max height
-        if (newHeight > g_Windowing.GetMaxTextureSize())
-        {
-          CLog::Log(LOGDEBUG, "%s: New cache texture is too large (%u > %u pixels long)", __FUNCTION__, newHeight, g_Windowing.GetMaxTextureSize());
-          FT_Done_Glyph(glyph);
-          return false;
-        }
-
-        CBaseTexture* newTexture = NULL;
-        newTexture = ReallocTexture(newHeight);
-        if(newTexture == NULL)
-        {
-          FT_Done_Glyph(glyph);
-          CLog::Log(LOGDEBUG, "%s: Failed to allocate new texture of height %u", __FUNCTION__, newHeight);
-          return false;
-        }
-        m_texture = newTexture;
-      }
-    }
-
-    if(m_texture == NULL)
-    {
-      FT_Done_Glyph(glyph);
-      CLog::Log(LOGDEBUG, "%s: no texture to cache character to", __FUNCTION__);
-      return false;
-    }
-  }
   // set the character in our table
   ch->letterAndStyle = (style << 16) | letter;
   ch->offsetX = (short)bitGlyph->left;
   ch->offsetY = (short)m_cellBaseLine - bitGlyph->top;
-  ch->left = isEmptyGlyph ? 0 : ((float)m_posX + ch->offsetX);
-  ch->top = isEmptyGlyph ? 0 : ((float)m_posY + ch->offsetY);
-  ch->right = ch->left + bitmap.width;
-  ch->bottom = ch->top + bitmap.rows;
+  ch->left = ch->top = ch->right = ch->bottom = 0;
   ch->advance = (float)MathUtils::round_int( (float)m_face->glyph->advance.x / 64 );
+  ch->page = NoPage;
+  ch->generation = 0;
 
   // we need only render if we actually have some pixels
   if (!isEmptyGlyph)
   {
-    // ensure our rect will stay inside the texture (it *should* but we need to be certain)
-    unsigned int x1 = max(m_posX + ch->offsetX, 0);
-    unsigned int y1 = max(m_posY + ch->offsetY, 0);
-    unsigned int x2 = min(x1 + bitmap.width, m_textureWidth);
-    unsigned int y2 = min(y1 + bitmap.rows, m_textureHeight);
-    CopyCharToTexture(bitGlyph, x1, y1, x2, y2);
-  
-    m_posX += spacing_between_characters_in_texture + (unsigned short)max(ch->right - ch->left + ch->offsetX, ch->advance);
+    CGUIFontAtlas::Slot slot;
+    if (!m_atlas->Allocate(this, bitmap.width + spacing_between_characters_in_texture, GetTextureLineHeight(), slot))
+    {
+      CLog::Log(LOGDEBUG, "%s: no room in the glyph cache for a character of %ux%u pixels", __FUNCTION__, (unsigned int)bitmap.width, GetTextureLineHeight());
+      FT_Done_Glyph(glyph);
+      return false;
+    }
+
+    // ensure our rect will stay inside the line (it *should* but we need to be certain)
+    unsigned int skip = ch->offsetY < 0 ? -ch->offsetY : 0;
+    unsigned int rows = (unsigned int)bitmap.rows > skip ? bitmap.rows - skip : 0;
+    ch->offsetY += skip;
+    rows = min(rows, m_cellHeight - min<unsigned int>(ch->offsetY, m_cellHeight));
+
+    ch->page = slot.page;
+    ch->generation = slot.generation;
+    ch->left = (float)slot.x;
+    ch->top = (float)slot.y + ch->offsetY;
+    ch->right = ch->left + bitmap.width;
+    ch->bottom = ch->top + rows;
+
+    slot.y += ch->offsetY;
+    m_atlas->Write(slot, bitmap.buffer + skip * bitmap.pitch, bitmap.pitch, bitmap.width, rows);
   }
-  m_numChars++;
 
   // free the glyph
   FT_Done_Glyph(glyph);
@@ -742,6 +694,16 @@ void CGUIFontTTFBase::RenderCharacter(float posX, float posY, const Character *c
   m_color = color;
   SVertex* v = m_vertex + m_vertex_count;
 
+  // keep track of the pages the vertices use, each run is drawn with its page bound
+  if (m_pageRuns.empty() || m_pageRuns.back().page != ch->page)
+  {
+    PageRun run = { ch->page, m_vertex_count, 0 };
+    m_pageRuns.push_back(run);
+  }
+  m_pageRuns.back().count += 4;
+  m_atlas->Touch(ch->page);
+  m_atlas->AddVertices(4);
+
   unsigned char r = GET_R(color)
               , g = GET_G(color)
               , b = GET_B(color)
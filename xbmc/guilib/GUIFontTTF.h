@@ -28,7 +28,7 @@
  */
 
 // forward definition
-class CBaseTexture;
+class CGUIFontAtlas;
 
 struct FT_FaceRec_;
 struct FT_LibraryRec_;
@@ -89,6 +89,18 @@ protected:
     float left, top, right, bottom;
     float advance;
     character_t letterAndStyle;
+    unsigned int page;        // atlas page holding the glyph, NoPage for empty glyphs
+    unsigned int generation;  // generation of the page when the glyph was cached
+  };
+  static const unsigned int NoPage = ~0U;
+
+  /*! \brief consecutive vertices using the same atlas page
+   */
+  struct PageRun
+  {
+    unsigned int page;
+    int first;
+    int count;
   };
   void AddReference();
   void RemoveReference();
@@ -108,24 +120,16 @@ protected:
 
   // Stuff for pre-rendering for speed
   inline Character *GetCharacter(character_t letter);
+  Character *ValidateCharacter(Character *ch);
   bool CacheCharacter(wchar_t letter, uint32_t style, Character *ch);
   void RenderCharacter(float posX, float posY, const Character *ch, color_t color, bool roundX);
-  void ClearCharacterCache();
-
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight) = 0;
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2) = 0;
-  virtual void DeleteHardwareTexture() = 0;
+  void ClearVertices();
 
   // modifying glyphs
   void EmboldenGlyph(FT_GlyphSlot slot);
   static void ObliqueGlyph(FT_GlyphSlot slot);
 
-  CBaseTexture* m_texture;        // texture that holds our rendered characters (8bit alpha only)
-
-  unsigned int m_textureWidth;       // width of our texture
-  unsigned int m_textureHeight;      // heigth of our texture
-  int m_posX;                        // current position in the texture
-  int m_posY;
+  CGUIFontAtlas* m_atlas;          // shared texture pages that hold our rendered characters
 
   /*! \brief the height of each line in the texture.
    Accounts for spacing between lines to avoid characters overlapping.
@@ -154,12 +158,10 @@ protected:
   float m_originX;
   float m_originY;
 
-  bool m_bTextureLoaded;
-  unsigned int m_nTexture;
-
   SVertex* m_vertex;
   int      m_vertex_count;
   int      m_vertex_size;
+  std::vector<PageRun> m_pageRuns;
 
   float    m_textureScaleX;
   float    m_textureScaleY;
@@ -23,6 +23,7 @@
 #include "GUIFont.h"
 #include "GUIFontTTFDX.h"
 #include "GUIFontManager.h"
+#include "GUIFontAtlas.h"
 #include "Texture.h"
 #include "gui3d.h"
 #include "windowing/WindowingFactory.h"
@@ -37,17 +38,32 @@
 
 using namespace std;
 
+std::vector<CD3DTexture*> CGUIFontTTFDX::m_pageTextures;
+
+// set when the device was lost or recreated. The page textures register
+// resources of their own, so they are only dropped the next time they are
+// used rather than while the device walks its resources
+static volatile bool g_pageTexturesLost = false;
+
+class CGUIFontPageTexturesReset : public ID3DResource
+{
+public:
+  virtual void OnDestroyDevice() { g_pageTexturesLost = true; }
+  virtual void OnCreateDevice()  {}
+  virtual void OnLostDevice()    { g_pageTexturesLost = true; }
+};
+
+static CGUIFontPageTexturesReset g_pageTexturesReset;
+
 CGUIFontTTFDX::CGUIFontTTFDX(const CStdString& strFileName)
 : CGUIFontTTFBase(strFileName)
 {
-  m_speedupTexture = NULL;
   m_index      = NULL;
   m_index_size = 0;
 }
 
 CGUIFontTTFDX::~CGUIFontTTFDX(void)
 {
-  SAFE_DELETE(m_speedupTexture);
   free(m_index);
 }
 
@@ -58,11 +74,10 @@ void CGUIFontTTFDX::Begin()
   if (pD3DDevice == NULL)
     CLog::Log(LOGERROR, __FUNCTION__" - failed to get Direct3D device");
 
-  if (m_nestedBeginCount == 0 && pD3DDevice != NULL && m_texture != NULL)
+  if (m_nestedBeginCount == 0 && pD3DDevice != NULL)
   {
     int unit = 0;
-    // just have to blit from our texture.
-    m_texture->BindToUnit(unit);
+    // just have to blit from our textures, they are bound in End()
     pD3DDevice->SetTextureStageState( unit, D3DTSS_COLOROP, D3DTOP_SELECTARG1 ); // only use diffuse
     pD3DDevice->SetTextureStageState( unit, D3DTSS_COLORARG1, D3DTA_DIFFUSE);
     pD3DDevice->SetTextureStageState( unit, D3DTSS_ALPHAOP, D3DTOP_MODULATE );
@@ -93,7 +108,7 @@ void CGUIFontTTFDX::Begin()
     pD3DDevice->SetRenderState( D3DRS_LIGHTING, FALSE);
 
     pD3DDevice->SetFVF(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1);
-    m_vertex_count = 0;
+    ClearVertices();
   }
 
   // Keep track of the nested begin/end calls.
@@ -147,185 +162,97 @@ void CGUIFontTTFDX::End()
 
   pD3DDevice->SetTransform(D3DTS_WORLD, &world);
 
-  pD3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST
-                                    , 0
-                                    , m_vertex_count
-                                    , m_vertex_count / 2
-                                    , m_index
-                                    , D3DFMT_INDEX16
-                                    , m_vertex
-                                    , sizeof(SVertex));
+  // one draw per atlas page used
+  for (std::vector<PageRun>::const_iterator run = m_pageRuns.begin(); run != m_pageRuns.end(); ++run)
+  {
+    CD3DTexture *texture = UpdatePageTexture(run->page);
+    if (texture == NULL)
+      continue;
+
+    pD3DDevice->SetTexture(0, texture->Get());
+    pD3DDevice->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST
+                                      , 0
+                                      , run->count
+                                      , run->count / 2
+                                      , m_index
+                                      , D3DFMT_INDEX16
+                                      , m_vertex + run->first
+                                      , sizeof(SVertex));
+  }
   pD3DDevice->SetTransform(D3DTS_WORLD, &orig);
 
   pD3DDevice->SetTexture(0, NULL);
   pD3DDevice->SetTextureStageState( 0, D3DTSS_COLOROP, D3DTOP_MODULATE );
 }
 
-CBaseTexture* CGUIFontTTFDX::ReallocTexture(unsigned int& newHeight)
+void CGUIFontTTFDX::FreePageTextures()
 {
-  assert(newHeight != 0);
-  assert(m_textureWidth != 0);
-  if(m_textureHeight == 0)
-  {
-    delete m_texture;
-    m_texture = NULL;
-    delete m_speedupTexture;
-    m_speedupTexture = NULL;
-  }
+  if (m_pageTextures.empty())
+    return;
 
-  CDXTexture* pNewTexture = new CDXTexture(m_textureWidth, newHeight, XB_FMT_A8);
-  pNewTexture->CreateTextureObject();
-  LPDIRECT3DTEXTURE9 newTexture = pNewTexture->GetTextureObject();
+  for (unsigned int i = 0; i < m_pageTextures.size(); i++)
+    SAFE_DELETE(m_pageTextures[i]);
+  m_pageTextures.clear();
+  g_Windowing.Unregister(&g_pageTexturesReset);
+}
 
-  if (newTexture == NULL)
+CD3DTexture *CGUIFontTTFDX::UpdatePageTexture(unsigned int page)
+{
+  if (g_pageTexturesLost)
   {
-    CLog::Log(LOGERROR, __FUNCTION__" - failed to create the new texture h=%d w=%d", m_textureWidth, newHeight);
-    SAFE_DELETE(pNewTexture);
-    return NULL;
+    g_pageTexturesLost = false;
+    FreePageTextures();
   }
 
-  // Use a speedup texture in system memory when main texture in default pool+dynamic
-  // Otherwise the texture would have to be copied from vid mem to sys mem, which is too slow for subs while playing video.
-  CD3DTexture* newSpeedupTexture = NULL;
-  if (g_Windowing.DefaultD3DPool() == D3DPOOL_DEFAULT && g_Windowing.DefaultD3DUsage() == D3DUSAGE_DYNAMIC)
-  {
-    newSpeedupTexture = new CD3DTexture();
+  if (m_pageTextures.empty())
+    g_Windowing.Register(&g_pageTexturesReset);
+  if (page >= m_pageTextures.size())
+    m_pageTextures.resize(page + 1, NULL);
 
-    if (!newSpeedupTexture->Create(m_textureWidth, newHeight, 1, 0, D3DFMT_A8, D3DPOOL_SYSTEMMEM))
-    {
-      SAFE_DELETE(newSpeedupTexture);
-      SAFE_DELETE(pNewTexture);
-      return NULL;
-    }
-  }
-
-  LPDIRECT3DSURFACE9 pSource, pTarget;
-  // There might be data to copy from the previous texture
-  if ((newSpeedupTexture && m_speedupTexture) || (newTexture && m_texture))
+  // a new texture gets the whole page, not just the rows changed since the last upload
+  bool created = false;
+  CD3DTexture *&texture = m_pageTextures[page];
+  if (texture == NULL)
   {
-    if (m_speedupTexture && newSpeedupTexture)
-    {
-      m_speedupTexture->GetSurfaceLevel(0, &pSource);
-      newSpeedupTexture->GetSurfaceLevel(0, &pTarget);
-    }
-    else
-    {
-      ((CDXTexture *)m_texture)->GetTextureObject()->GetSurfaceLevel(0, &pSource);
-      newTexture->GetSurfaceLevel(0, &pTarget);
-    }
-
-    D3DLOCKED_RECT srclr, dstlr;
-    if(FAILED(pSource->LockRect( &srclr, NULL, 0 ))
-    || FAILED(pTarget->LockRect( &dstlr, NULL, 0 )))
+    texture = new CD3DTexture();
+    if (!texture->Create(m_atlas->GetWidth(), m_atlas->GetHeight(), 1, g_Windowing.DefaultD3DUsage(), D3DFMT_A8, g_Windowing.DefaultD3DPool()))
     {
-      CLog::Log(LOGERROR, __FUNCTION__" - failed to lock surfaces");
-      SAFE_DELETE(newSpeedupTexture);
-      SAFE_DELETE(pNewTexture);
-      pSource->Release();
-      pTarget->Release();
+      CLog::Log(LOGERROR, __FUNCTION__" - failed to create the texture for glyph page %u", page);
+      SAFE_DELETE(texture);
       return NULL;
     }
-
-    unsigned char *dst = (unsigned char *)dstlr.pBits;
-    unsigned char *src = (unsigned char *)srclr.pBits;
-    unsigned int dstPitch = dstlr.Pitch;
-    unsigned int srcPitch = srclr.Pitch;
-    unsigned int minPitch = std::min(srcPitch, dstPitch);
-
-    if (srcPitch == dstPitch)
-    {
-      memcpy(dst, src, srcPitch * m_textureHeight);
-    }
-    else
-    {
-      for (unsigned int y = 0; y < m_textureHeight; y++)
-      {
-        memcpy(dst, src, minPitch);
-        src += srcPitch;
-        dst += dstPitch;
-      }
-    }
-    pSource->UnlockRect();
-    pTarget->UnlockRect();
-
-    pSource->Release();
-    pTarget->Release();
+    created = true;
   }
 
-  // Upload from speedup texture to main texture
-  if (newSpeedupTexture && m_speedupTexture)
+  // only the rows with new glyphs are sent over
+  unsigned int firstRow, lastRow;
+  if (!m_atlas->TakeDirtyRows(page, firstRow, lastRow) && !created)
+    return texture;
+  if (created)
   {
-    LPDIRECT3DSURFACE9 pSource, pTarget;
-    newSpeedupTexture->GetSurfaceLevel(0, &pSource);
-    newTexture->GetSurfaceLevel(0, &pTarget);
-    const RECT rect = { 0, 0, m_textureWidth, m_textureHeight };
-    const POINT point = { 0, 0 };
-
-    HRESULT hr = g_Windowing.Get3DDevice()->UpdateSurface(pSource, &rect, pTarget, &point);
-    SAFE_RELEASE(pSource);
-    SAFE_RELEASE(pTarget);
-
-    if (FAILED(hr))
-    {
-      CLog::Log(LOGERROR, __FUNCTION__": Failed to upload from sysmem to vidmem (0x%08X)", hr);
-      SAFE_DELETE(newSpeedupTexture);
-      SAFE_DELETE(pNewTexture);
-      return NULL;
-    }
+    firstRow = 0;
+    lastRow  = m_atlas->GetHeight();
   }
 
-  SAFE_DELETE(m_texture);
-  SAFE_DELETE(m_speedupTexture);
-  m_textureHeight = newHeight;
-  m_textureScaleY = 1.0f / m_textureHeight;
-  m_speedupTexture = newSpeedupTexture;
-
-  return pNewTexture;
-}
-
-bool CGUIFontTTFDX::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
-{
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-
-  LPDIRECT3DTEXTURE9 texture = ((CDXTexture *)m_texture)->GetTextureObject();
-  LPDIRECT3DSURFACE9 target;
-  if (m_speedupTexture)
-    m_speedupTexture->GetSurfaceLevel(0, &target);
-  else
-    texture->GetSurfaceLevel(0, &target);
-
-  RECT sourcerect = { 0, 0, bitmap.width, bitmap.rows };
-  RECT targetrect = { x1, y1, x2, y2 };
-
-  HRESULT hr = D3DXLoadSurfaceFromMemory( target, NULL, &targetrect,
-                                          bitmap.buffer, D3DFMT_LIN_A8, bitmap.pitch, NULL, &sourcerect,
-                                          D3DX_FILTER_NONE, 0x00000000);
-
-  SAFE_RELEASE(target);
-
-  if (FAILED(hr))
+  const RECT rect = { 0, firstRow, m_atlas->GetWidth(), lastRow };
+  D3DLOCKED_RECT lr;
+  if (!texture->LockRect(0, &lr, &rect, 0))
   {
-    CLog::Log(LOGERROR, __FUNCTION__": Failed to copy the new character (0x%08X)", hr);
-    return false;
+    CLog::Log(LOGERROR, __FUNCTION__" - failed to lock the texture of glyph page %u", page);
+    return texture;
   }
 
-  if (m_speedupTexture)
+  const unsigned char *src = m_atlas->GetPixels(page) + firstRow * m_atlas->GetWidth();
+  unsigned char *dst = (unsigned char *)lr.pBits;
+  for (unsigned int y = firstRow; y < lastRow; y++)
   {
-    // Upload to GPU - the automatic dirty region tracking takes care of the rect.
-    HRESULT hr = g_Windowing.Get3DDevice()->UpdateTexture(m_speedupTexture->Get(), texture);
-    if (FAILED(hr))
-    {
-      CLog::Log(LOGERROR, __FUNCTION__": Failed to upload from sysmem to vidmem (0x%08X)", hr);
-      return false;
-    }
+    memcpy(dst, src, m_atlas->GetWidth());
+    src += m_atlas->GetWidth();
+    dst += lr.Pitch;
   }
-  return TRUE;
-}
-
+  texture->UnlockRect(0);
 
-void CGUIFontTTFDX::DeleteHardwareTexture()
-{
-  
+  return texture;
 }
 
 
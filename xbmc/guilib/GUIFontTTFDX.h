@@ -44,12 +44,20 @@ public:
   virtual void Begin();
   virtual void End();
 
+  /*!
+   \brief Frees the textures of the atlas pages, they are uploaded again when next drawn
+   */
+  static void FreePageTextures();
+
 protected:
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight);
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
-  virtual void DeleteHardwareTexture();
-  CD3DTexture *m_speedupTexture;  // extra texture to speed up reallocations when the main texture is in d3dpool_default.
-                                  // that's the typical situation of Windows Vista and above.
+  /*!
+   \brief Returns the texture of an atlas page, uploading whatever changed since the last call
+   */
+  CD3DTexture *UpdatePageTexture(unsigned int page);
+
+  // one texture per atlas page, shared by all fonts. Only touched from the
+  // render thread, freed when the fonts are cleared or the device is reset
+  static std::vector<CD3DTexture*> m_pageTextures;
   uint16_t* m_index;
   unsigned  m_index_size;
 };
@@ -22,6 +22,8 @@
 #include "GUIFont.h"
 #include "GUIFontTTFGL.h"
 #include "GUIFontManager.h"
+#include "GUIFontAtlas.h"
+#include "GUITexture.h"
 #include "Texture.h"
 #include "TextureManager.h"
 #include "GraphicContext.h"
@@ -29,6 +31,9 @@
 #include "utils/log.h"
 #include "utils/GLUtils.h"
 #include "windowing/WindowingFactory.h"
+#if defined(HAS_GLX) || defined(TARGET_DARWIN)
+#include "guilib/DispResource.h"
+#endif
 
 // stuff for freetype
 #include <ft2build.h>
@@ -41,6 +46,23 @@ using namespace std;
 #if defined(HAS_GL) || defined(HAS_GLES)
 
 
+std::vector<GLuint> CGUIFontTTFGL::m_pageTextures;
+
+// set when the display was reset, the render thread drops the page textures
+// before it next uses them
+static volatile bool g_pageTexturesLost = false;
+
+#if defined(HAS_GLX) || defined(TARGET_DARWIN)
+class CGUIFontPageTexturesReset : public IDispResource
+{
+public:
+  virtual void OnLostDevice()  { g_pageTexturesLost = true; }
+  virtual void OnResetDevice() { g_pageTexturesLost = true; }
+};
+
+static CGUIFontPageTexturesReset g_pageTexturesReset;
+#endif
+
 CGUIFontTTFGL::CGUIFontTTFGL(const CStdString& strFileName)
 : CGUIFontTTFBase(strFileName)
 {
@@ -52,75 +74,15 @@ CGUIFontTTFGL::~CGUIFontTTFGL(void)
 
 void CGUIFontTTFGL::Begin()
 {
-  if (m_nestedBeginCount == 0 && m_texture != NULL)
+  if (m_nestedBeginCount == 0)
   {
-    if (!m_bTextureLoaded)
-    {
-      // Have OpenGL generate a texture object handle for us
-      glGenTextures(1, (GLuint*) &m_nTexture);
-
-      // Bind the texture object
-      glBindTexture(GL_TEXTURE_2D, m_nTexture);
-#ifdef HAS_GL
-      glEnable(GL_TEXTURE_2D);
-#endif
-      // Set the texture's stretching properties
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-      // Set the texture image -- THIS WORKS, so the pixels must be wrong.
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_texture->GetWidth(), m_texture->GetHeight(), 0,
-                   GL_ALPHA, GL_UNSIGNED_BYTE, m_texture->GetPixels());
-
-      VerifyGLState();
-      m_bTextureLoaded = true;
-    }
-
+#ifndef HAS_GL
     // Turn Blending On
     glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
     glEnable(GL_BLEND);
-#ifdef HAS_GL
-    glEnable(GL_TEXTURE_2D);
-#endif
-    glBindTexture(GL_TEXTURE_2D, m_nTexture);
-
-#ifdef HAS_GL
-    glTexEnvi(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_COMBINE);
-    glTexEnvi(GL_TEXTURE_ENV,GL_COMBINE_RGB,GL_REPLACE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE0);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
-    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    VerifyGLState();
-
-    if(g_Windowing.UseLimitedColor())
-    {
-      glActiveTexture(GL_TEXTURE1);
-      glBindTexture(GL_TEXTURE_2D, m_nTexture); // dummy bind
-      glEnable(GL_TEXTURE_2D);
-
-      const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
-      glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
-      glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
-      glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_RGB      , GL_ADD);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_RGB      , GL_PREVIOUS);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE1_RGB      , GL_CONSTANT);
-      glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND0_RGB     , GL_SRC_COLOR);
-      glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND1_RGB     , GL_SRC_COLOR);
-      glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_ALPHA    , GL_REPLACE);
-      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_ALPHA    , GL_PREVIOUS);
-      VerifyGLState();
-    }
-
-#else
     g_Windowing.EnableGUIShader(SM_FONTS);
 #endif
-
-    m_vertex_count = 0;
+    ClearVertices();
   }
   // Keep track of the nested begin/end calls.
   m_nestedBeginCount++;
@@ -135,23 +97,36 @@ void CGUIFontTTFGL::End()
     return;
 
 #ifdef HAS_GL
-  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
-
-  glColorPointer   (4, GL_UNSIGNED_BYTE, sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, r));
-  glVertexPointer  (3, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, x));
-  glTexCoordPointer(2, GL_FLOAT        , sizeof(SVertex), (char*)m_vertex + offsetof(SVertex, u));
-  glEnableClientState(GL_COLOR_ARRAY);
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-  glDrawArrays(GL_QUADS, 0, m_vertex_count);
-  glPopClientAttrib();
-
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_TEXTURE_2D);
+  // the glyphs join the quads of the frame, text of all labels ends up in a
+  // few draws together with the textures
+  CGUIQuadBatch::State state;
+  state.diffuse = 0;
+  state.limitedColor = g_Windowing.UseLimitedColor();
+  state.font = true;
+
+  for (std::vector<PageRun>::const_iterator run = m_pageRuns.begin(); run != m_pageRuns.end(); ++run)
+  {
+    state.texture = UpdatePageTexture(run->page);
+    for (int i = run->first; i < run->first + run->count; i += 4)
+    {
+      CGUIQuadBatch::Vertex quad[4];
+      for (int j = 0; j < 4; j++)
+      {
+        const SVertex &vertex = m_vertex[i + j];
+        quad[j].x = vertex.x;
+        quad[j].y = vertex.y;
+        quad[j].z = vertex.z;
+        quad[j].r = vertex.r;
+        quad[j].g = vertex.g;
+        quad[j].b = vertex.b;
+        quad[j].a = vertex.a;
+        quad[j].u1 = vertex.u;
+        quad[j].v1 = vertex.v;
+        quad[j].u2 = quad[j].v2 = 0.0f;
+      }
+      CGUITextureGL::AddToBatch(state, quad);
+    }
+  }
 #else
   // GLES 2.0 version. Cannot draw quads. Convert to triangles.
   GLint posLoc  = g_Windowing.GUIShaderGetPos();
@@ -184,7 +159,12 @@ void CGUIFontTTFGL::End()
   glEnableVertexAttribArray(colLoc);
   glEnableVertexAttribArray(tex0Loc);
 
-  glDrawArrays(GL_TRIANGLES, 0, vecVertices.size());
+  // one draw per atlas page used
+  for (std::vector<PageRun>::const_iterator run = m_pageRuns.begin(); run != m_pageRuns.end(); ++run)
+  {
+    glBindTexture(GL_TEXTURE_2D, UpdatePageTexture(run->page));
+    glDrawArrays(GL_TRIANGLES, run->first / 4 * 6, run->count / 4 * 6);
+  }
 
   glDisableVertexAttribArray(posLoc);
   glDisableVertexAttribArray(colLoc);
@@ -194,79 +174,67 @@ void CGUIFontTTFGL::End()
 #endif
 }
 
-CBaseTexture* CGUIFontTTFGL::ReallocTexture(unsigned int& newHeight)
+void CGUIFontTTFGL::FreePageTextures()
 {
-  newHeight = CBaseTexture::PadPow2(newHeight);
-
-  CBaseTexture* newTexture = new CTexture(m_textureWidth, newHeight, XB_FMT_A8);
+  if (m_pageTextures.empty())
+    return;
 
-  if (!newTexture || newTexture->GetPixels() == NULL)
-  {
-    CLog::Log(LOGERROR, "GUIFontTTFGL::CacheCharacter: Error creating new cache texture for size %f", m_height);
-    delete newTexture;
-    return NULL;
-  }
-  m_textureHeight = newTexture->GetHeight();
-  m_textureScaleY = 1.0f / m_textureHeight;
-  m_textureWidth = newTexture->GetWidth();
-  m_textureScaleX = 1.0f / m_textureWidth;
-  if (m_textureHeight < newHeight)
-    CLog::Log(LOGWARNING, "%s: allocated new texture with height of %d, requested %d", __FUNCTION__, m_textureHeight, newHeight);
-
-  memset(newTexture->GetPixels(), 0, m_textureHeight * newTexture->GetPitch());
-  if (m_texture)
+  for (unsigned int i = 0; i < m_pageTextures.size(); i++)
   {
-    unsigned char* src = (unsigned char*) m_texture->GetPixels();
-    unsigned char* dst = (unsigned char*) newTexture->GetPixels();
-    for (unsigned int y = 0; y < m_texture->GetHeight(); y++)
-    {
-      memcpy(dst, src, m_texture->GetPitch());
-      src += m_texture->GetPitch();
-      dst += newTexture->GetPitch();
-    }
-    delete m_texture;
+    if (m_pageTextures[i])
+      glDeleteTextures(1, &m_pageTextures[i]);
   }
-
-  return newTexture;
+  m_pageTextures.clear();
+#if defined(HAS_GLX) || defined(TARGET_DARWIN)
+  g_Windowing.Unregister(&g_pageTexturesReset);
+#endif
 }
 
-bool CGUIFontTTFGL::CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2)
+GLuint CGUIFontTTFGL::UpdatePageTexture(unsigned int page)
 {
-  FT_Bitmap bitmap = bitGlyph->bitmap;
-
-  unsigned char* source = (unsigned char*) bitmap.buffer;
-  unsigned char* target = (unsigned char*) m_texture->GetPixels() + y1 * m_texture->GetPitch() + x1;
-
-  for (unsigned int y = y1; y < y2; y++)
+  if (g_pageTexturesLost)
   {
-    memcpy(target, source, x2-x1);
-    source += bitmap.width;
-    target += m_texture->GetPitch();
+    g_pageTexturesLost = false;
+    FreePageTextures();
   }
-  // THE SOURCE VALUES ARE THE SAME IN BOTH SITUATIONS.
 
-  // Since we have a new texture, we need to delete the old one
-  // the Begin(); End(); stuff is handled by whoever called us
-  if (m_bTextureLoaded)
+#if defined(HAS_GLX) || defined(TARGET_DARWIN)
+  if (m_pageTextures.empty())
+    g_Windowing.Register(&g_pageTexturesReset);
+#endif
+  if (page >= m_pageTextures.size())
+    m_pageTextures.resize(page + 1, 0);
+
+  GLuint &texture = m_pageTextures[page];
+  if (texture == 0)
   {
-    g_graphicsContext.BeginPaint();  //FIXME
-    DeleteHardwareTexture();
-    g_graphicsContext.EndPaint();
-    m_bTextureLoaded = false;
-  }
+    // Have OpenGL generate a texture object handle for us
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
 
-  return TRUE;
-}
+    // Set the texture's stretching properties
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, m_atlas->GetWidth(), m_atlas->GetHeight(), 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, m_atlas->GetPixels(page));
+    VerifyGLState();
 
-void CGUIFontTTFGL::DeleteHardwareTexture()
-{
-  if (m_bTextureLoaded)
+    unsigned int firstRow, lastRow;
+    m_atlas->TakeDirtyRows(page, firstRow, lastRow);
+    return texture;
+  }
+
+  // only the rows with new glyphs are sent over
+  unsigned int firstRow, lastRow;
+  if (m_atlas->TakeDirtyRows(page, firstRow, lastRow))
   {
-    if (glIsTexture(m_nTexture))
-      g_TextureManager.ReleaseHwTexture(m_nTexture);
-    m_bTextureLoaded = false;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, m_atlas->GetWidth(), lastRow - firstRow,
+                    GL_ALPHA, GL_UNSIGNED_BYTE, m_atlas->GetPixels(page) + firstRow * m_atlas->GetWidth());
+    VerifyGLState();
   }
+  return texture;
 }
 
 #endif
@@ -29,6 +29,7 @@
 
 
 #include "GUIFontTTF.h"
+#include "system_gl.h"
 
 
 /*!
@@ -44,11 +45,20 @@ public:
   virtual void Begin();
   virtual void End();
 
+  /*!
+   \brief Frees the textures of the atlas pages, they are uploaded again when next drawn
+   */
+  static void FreePageTextures();
+
 protected:
-  virtual CBaseTexture* ReallocTexture(unsigned int& newHeight);
-  virtual bool CopyCharToTexture(FT_BitmapGlyph bitGlyph, unsigned int x1, unsigned int y1, unsigned int x2, unsigned int y2);
-  virtual void DeleteHardwareTexture();
+  /*!
+   \brief Returns the texture of an atlas page, uploading whatever changed since the last call
+   */
+  GLuint UpdatePageTexture(unsigned int page);
 
+  // one texture per atlas page, shared by all fonts. Only touched from the
+  // render thread, freed when the fonts are cleared or the display is reset
+  static std::vector<GLuint> m_pageTextures;
 };
 
 #endif
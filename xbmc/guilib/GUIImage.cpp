@@ -293,6 +293,15 @@ CRect CGUIImage::CalcRenderRegion() const
   return CGUIControl::CalcRenderRegion().Intersect(region);
 }
 
+bool CGUIImage::IsOpaque() const
+{
+  // the render region is the bounding box of the transformed image, so the
+  // image only fills it if it isn't rotated, faded or crossfading
+  return IsVisible() && !m_hasCamera && m_fadingTextures.empty() &&
+         m_cachedTransform.alpha >= 1.0f && m_cachedTransform.IsAxisAligned() &&
+         m_texture.IsOpaque();
+}
+
 const CStdString &CGUIImage::GetFileName() const
 {
   return m_texture.GetFileName();
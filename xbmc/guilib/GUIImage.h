@@ -97,6 +97,7 @@ public:
   float GetTextureHeight() const;
 
   virtual CRect CalcRenderRegion() const;
+  virtual bool IsOpaque() const;
 
 #ifdef _DEBUG
   virtual void DumpTextureUse();
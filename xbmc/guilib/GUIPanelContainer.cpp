@@ -70,7 +70,7 @@ void CGUIPanelContainer::Process(unsigned int currentTime, CDirtyRegionList &dir
       break;
     if (current >= 0)
     {
-      CGUIListItemPtr item = m_items[current];
+      CGUIListItemPtr item = GetItemAt(current);
       bool focused = (current == GetOffset() * m_itemsPerRow + GetCursor()) && m_bHasFocus;
 
       if (m_orientation == VERTICAL)
@@ -128,7 +128,7 @@ void CGUIPanelContainer::Render()
         break;
       if (current >= 0)
       {
-        CGUIListItemPtr item = m_items[current];
+        CGUIListItemPtr item = GetItemAt(current);
         bool focused = (current == GetOffset() * m_itemsPerRow + GetCursor()) && m_bHasFocus;
         // render our item
         if (focused)
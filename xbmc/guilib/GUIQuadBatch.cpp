@@ -0,0 +1,120 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIQuadBatch.h"
+
+#include <string.h>
+
+// how many batches a quad may be moved back past
+#define BATCH_LOOKBACK 8
+
+using namespace std;
+
+static inline bool Overlaps(const CRect &a, const CRect &b)
+{
+  return a.x1 < b.x2 && b.x1 < a.x2 && a.y1 < b.y2 && b.y1 < a.y2;
+}
+
+CGUIQuadBatch::CGUIQuadBatch()
+{
+}
+
+void CGUIQuadBatch::Add(const State &state, const Vertex *quad)
+{
+  CRect bounds(quad[0].x, quad[0].y, quad[0].x, quad[0].y);
+  bool flat = quad[0].z == 0.0f;
+  for (int i = 1; i < 4; i++)
+  {
+    if (quad[i].x < bounds.x1) bounds.x1 = quad[i].x;
+    if (quad[i].x > bounds.x2) bounds.x2 = quad[i].x;
+    if (quad[i].y < bounds.y1) bounds.y1 = quad[i].y;
+    if (quad[i].y > bounds.y2) bounds.y2 = quad[i].y;
+    if (quad[i].z != 0.0f) flat = false;
+  }
+
+  unsigned int index = FindBatch(state, bounds, flat);
+  if (index == m_batches.size())
+  {
+    Batch batch;
+    batch.state = state;
+    batch.bounds = bounds;
+    batch.flat = flat;
+    batch.count = 0;
+    m_batches.push_back(batch);
+  }
+  else
+  {
+    Batch &batch = m_batches[index];
+    if (bounds.x1 < batch.bounds.x1) batch.bounds.x1 = bounds.x1;
+    if (bounds.x2 > batch.bounds.x2) batch.bounds.x2 = bounds.x2;
+    if (bounds.y1 < batch.bounds.y1) batch.bounds.y1 = bounds.y1;
+    if (bounds.y2 > batch.bounds.y2) batch.bounds.y2 = bounds.y2;
+    batch.flat &= flat;
+  }
+  m_batches[index].count++;
+
+  m_quads.resize(m_quads.size() + 1);
+  Quad &added = m_quads.back();
+  memcpy(added.vertices, quad, sizeof(added.vertices));
+  added.batch = index;
+}
+
+void CGUIQuadBatch::Take(vector<Vertex> &vertices, vector<Range> &ranges)
+{
+  ranges.resize(m_batches.size());
+  unsigned int first = 0;
+  for (unsigned int i = 0; i < m_batches.size(); i++)
+  {
+    ranges[i].state = m_batches[i].state;
+    ranges[i].first = first;
+    ranges[i].count = 0;
+    first += m_batches[i].count * 4;
+  }
+
+  // the quads of a batch keep their order, only batches are made contiguous
+  vertices.resize(m_quads.size() * 4);
+  for (vector<Quad>::const_iterator quad = m_quads.begin(); quad != m_quads.end(); ++quad)
+  {
+    Range &range = ranges[quad->batch];
+    memcpy(&vertices[range.first + range.count], quad->vertices, sizeof(quad->vertices));
+    range.count += 4;
+  }
+
+  m_batches.clear();
+  m_quads.clear();
+}
+
+unsigned int CGUIQuadBatch::FindBatch(const State &state, const CRect &bounds, bool flat) const
+{
+  // walk back from the last batch as long as the quad could be drawn before
+  // the batch without changing the result. Quads off the z == 0 plane may end
+  // up anywhere on screen, so they are never moved past other batches.
+  unsigned int lookback = 0;
+  for (unsigned int i = m_batches.size(); i > 0 && lookback < BATCH_LOOKBACK; i--, lookback++)
+  {
+    const Batch &batch = m_batches[i - 1];
+    if (batch.state == state)
+      return i - 1;
+    if (!flat || !batch.flat || Overlaps(batch.bounds, bounds))
+      break;
+  }
+
+  return m_batches.size();
+}
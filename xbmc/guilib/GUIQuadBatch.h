@@ -0,0 +1,116 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include "Geometry.h"
+
+/*!
+ \brief Collects the textured quads of a frame and groups them into as few draws as possible
+
+ Quads are added in painter's order. A quad joins the last batch if it shares
+ its render state, or an earlier batch with the same state if it doesn't
+ overlap anything drawn in between, so the result looks exactly as if every
+ quad had been drawn on its own. Only the lookback of the last few batches is
+ searched, which keeps adding a quad cheap.
+
+ The batch itself doesn't know anything about the renderer, the caller takes
+ the vertices and draws one range per batch.
+ */
+class CGUIQuadBatch
+{
+public:
+  /*!
+   \brief Everything that has to be the same for quads to be drawn together
+   */
+  struct State
+  {
+    unsigned int texture;  ///< texture object of the first unit
+    unsigned int diffuse;  ///< texture object of the diffuse unit or 0
+    bool limitedColor;     ///< whether the limited color range unit is used
+    bool font;             ///< alpha only glyphs colored by the vertices
+
+    bool operator==(const State &right) const
+    {
+      return texture == right.texture && diffuse == right.diffuse &&
+             limitedColor == right.limitedColor && font == right.font;
+    }
+    bool operator!=(const State &right) const { return !(*this == right); }
+  };
+
+  struct Vertex
+  {
+    float x, y, z;
+    unsigned char r, g, b, a;
+    float u1, v1;  ///< texture coordinates
+    float u2, v2;  ///< diffuse coordinates
+  };
+
+  /*!
+   \brief A range of vertices to be drawn with a single state
+   */
+  struct Range
+  {
+    State state;
+    unsigned int first;
+    unsigned int count;
+  };
+
+  CGUIQuadBatch();
+
+  /*!
+   \brief Queues a quad
+   \param state Render state of the quad
+   \param quad The 4 corners of the quad in drawing order
+   */
+  void Add(const State &state, const Vertex *quad);
+
+  bool IsEmpty() const { return m_quads.empty(); }
+  unsigned int GetQuadCount() const { return (unsigned int)m_quads.size(); }
+  unsigned int GetBatchCount() const { return (unsigned int)m_batches.size(); }
+
+  /*!
+   \brief Hands out the queued quads ordered by batch and empties the batch
+   \param vertices Vertices of all batches, one batch after the other
+   \param ranges One range per batch in drawing order
+   */
+  void Take(std::vector<Vertex> &vertices, std::vector<Range> &ranges);
+
+private:
+  struct Batch
+  {
+    State state;
+    CRect bounds;       ///< bounds of all quads of the batch
+    bool flat;          ///< whether all quads have z == 0
+    unsigned int count; ///< number of quads
+  };
+
+  struct Quad
+  {
+    Vertex vertices[4];
+    unsigned int batch;
+  };
+
+  unsigned int FindBatch(const State &state, const CRect &bounds, bool flat) const;
+
+  std::vector<Batch> m_batches;
+  std::vector<Quad> m_quads;
+};
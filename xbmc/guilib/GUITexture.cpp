@@ -22,6 +22,7 @@
 #include "GraphicContext.h"
 #include "TextureManager.h"
 #include "GUILargeTextureManager.h"
+#include "Texture.h"
 #include "utils/MathUtils.h"
 
 using namespace std;
@@ -556,6 +557,21 @@ bool CGUITextureBase::ReadyToRender() const
   return m_texture.size() > 0;
 }
 
+bool CGUITextureBase::IsOpaque() const
+{
+  if (!m_visible || m_texture.size() == 0 || m_diffuse.size() > 0 || m_vertex.IsEmpty())
+    return false;
+  if (m_alpha != 0xff || (m_diffuseColor & 0xff000000) != 0xff000000)
+    return false;
+
+  for (unsigned int i = 0; i < m_texture.m_textures.size(); i++)
+  {
+    if (!m_texture.m_textures[i] || m_texture.m_textures[i]->HasAlpha())
+      return false;
+  }
+  return true;
+}
+
 void CGUITextureBase::OrientateTexture(CRect &rect, float width, float height, int orientation)
 {
   switch (orientation & 3)
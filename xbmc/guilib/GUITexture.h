@@ -122,6 +122,9 @@ public:
   bool IsAllocated() const { return m_isAllocated != NO; };
   bool FailedToAlloc() const { return m_isAllocated == NORMAL_FAILED || m_isAllocated == LARGE_FAILED; };
   bool ReadyToRender() const;
+  /*! \brief Whether every pixel of the render rect is drawn fully opaque
+   */
+  bool IsOpaque() const;
 protected:
   bool CalculateSize();
   void LoadDiffuseImage();
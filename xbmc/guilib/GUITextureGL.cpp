@@ -30,15 +30,25 @@
 
 #if defined(HAS_GL)
 
+CGUIQuadBatch CGUITextureGL::m_batch;
+std::vector<CGUIQuadBatch::Vertex> CGUITextureGL::m_vertices;
+std::vector<CGUIQuadBatch::Range> CGUITextureGL::m_ranges;
+GLuint CGUITextureGL::m_vertexBuffer = 0;
+unsigned int CGUITextureGL::m_drawCalls = 0;
+unsigned int CGUITextureGL::m_quads = 0;
+unsigned int CGUITextureGL::m_lastDrawCalls = 0;
+unsigned int CGUITextureGL::m_lastQuads = 0;
+
 CGUITextureGL::CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo &texture)
 : CGUITextureBase(posX, posY, width, height, texture)
 {
   memset(m_col, 0, sizeof(m_col));
+  memset(&m_state, 0, sizeof(m_state));
 }
 
 void CGUITextureGL::Begin(color_t color)
 {
-  int range, unit = 0;
+  int range;
   if(g_Windowing.UseLimitedColor())
     range = 235 - 16;
   else
@@ -54,70 +64,114 @@ void CGUITextureGL::Begin(color_t color)
   if (m_diffuse.size())
     m_diffuse.m_textures[0]->LoadToGPU();
 
-  texture->BindToUnit(unit++);
+  // the quads are only queued here, binding and drawing happens in FlushBatch()
+  m_state.texture = static_cast<CTexture*>(texture)->GetTextureObject();
+  m_state.diffuse = m_diffuse.size() ? static_cast<CTexture*>(m_diffuse.m_textures[0])->GetTextureObject() : 0;
+  m_state.limitedColor = g_Windowing.UseLimitedColor();
+}
 
-  glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
-  glEnable(GL_BLEND);          // Turn Blending On
-  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+void CGUITextureGL::End()
+{
+}
 
-  // diffuse coloring
-  glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+void CGUITextureGL::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
+{
+  CGUIQuadBatch::Vertex quad[4];
+  for (int i = 0; i < 4; i++)
+  {
+    quad[i].x = x[i];
+    quad[i].y = y[i];
+    quad[i].z = z[i];
+    quad[i].r = m_col[0];
+    quad[i].g = m_col[1];
+    quad[i].b = m_col[2];
+    quad[i].a = m_col[3];
+    quad[i].u2 = quad[i].v2 = 0.0f;
+  }
 
-  glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
-  glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-  glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
-  VerifyGLState();
+  // Top-left vertex (corner)
+  quad[0].u1 = texture.x1; quad[0].v1 = texture.y1;
+  // Top-right vertex (corner)
+  if (orientation & 4)
+    quad[1].u1 = texture.x1, quad[1].v1 = texture.y2;
+  else
+    quad[1].u1 = texture.x2, quad[1].v1 = texture.y1;
+  // Bottom-right vertex (corner)
+  quad[2].u1 = texture.x2; quad[2].v1 = texture.y2;
+  // Bottom-left vertex (corner)
+  if (orientation & 4)
+    quad[3].u1 = texture.x2, quad[3].v1 = texture.y1;
+  else
+    quad[3].u1 = texture.x1, quad[3].v1 = texture.y2;
 
   if (m_diffuse.size())
   {
-    m_diffuse.m_textures[0]->BindToUnit(unit++);
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+    quad[0].u2 = diffuse.x1; quad[0].v2 = diffuse.y1;
+    if (m_info.orientation & 4)
+      quad[1].u2 = diffuse.x1, quad[1].v2 = diffuse.y2;
+    else
+      quad[1].u2 = diffuse.x2, quad[1].v2 = diffuse.y1;
+    quad[2].u2 = diffuse.x2; quad[2].v2 = diffuse.y2;
+    if (m_info.orientation & 4)
+      quad[3].u2 = diffuse.x2, quad[3].v2 = diffuse.y1;
+    else
+      quad[3].u2 = diffuse.x1, quad[3].v2 = diffuse.y2;
+  }
 
-    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
-    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PREVIOUS);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
-    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
-    VerifyGLState();
+  m_batch.Add(m_state, quad);
+}
+
+void CGUITextureGL::FlushBatch()
+{
+  if (m_batch.IsEmpty())
+    return;
+
+  m_quads += m_batch.GetQuadCount();
+  m_batch.Take(m_vertices, m_ranges);
+
+  // a single buffer object is reused for every flush. Respecifying its whole
+  // storage lets the driver hand out fresh memory instead of waiting for the
+  // draws of the previous flush to finish with it.
+  const char *base = (const char*)&m_vertices[0];
+  bool useBuffer = g_Windowing.IsExtSupported("GL_ARB_vertex_buffer_object");
+  if (useBuffer)
+  {
+    if (m_vertexBuffer == 0)
+      glGenBuffersARB(1, &m_vertexBuffer);
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, m_vertexBuffer);
+    glBufferDataARB(GL_ARRAY_BUFFER_ARB, m_vertices.size() * sizeof(CGUIQuadBatch::Vertex), base, GL_STREAM_DRAW_ARB);
+    base = NULL;
   }
 
-  if(g_Windowing.UseLimitedColor())
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+  glVertexPointer(3, GL_FLOAT, sizeof(CGUIQuadBatch::Vertex), base + offsetof(CGUIQuadBatch::Vertex, x));
+  glColorPointer (4, GL_UNSIGNED_BYTE, sizeof(CGUIQuadBatch::Vertex), base + offsetof(CGUIQuadBatch::Vertex, r));
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glClientActiveTexture(GL_TEXTURE1);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(CGUIQuadBatch::Vertex), base + offsetof(CGUIQuadBatch::Vertex, u2));
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glClientActiveTexture(GL_TEXTURE0);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(CGUIQuadBatch::Vertex), base + offsetof(CGUIQuadBatch::Vertex, u1));
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+  // the blend function is part of the state of each batch
+  glEnable(GL_BLEND);          // Turn Blending On
+  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+  //glDisable(GL_TEXTURE_2D); // uncomment this line and use GL_LINE_LOOP to switch to wireframe rendering
+  for (unsigned int i = 0; i < m_ranges.size(); i++)
   {
-    texture->BindToUnit(unit++); // dummy bind
-    const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
-    glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
-    glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
-    glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_RGB      , GL_ADD);
-    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_RGB      , GL_PREVIOUS);
-    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE1_RGB      , GL_CONSTANT);
-    glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND0_RGB     , GL_SRC_COLOR);
-    glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND1_RGB     , GL_SRC_COLOR);
-
-    glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_ALPHA    , GL_REPLACE);
-    glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_ALPHA    , GL_PREVIOUS);
-    VerifyGLState();
+    ApplyState(m_ranges[i].state, i ? &m_ranges[i - 1].state : NULL);
+    glDrawArrays(GL_QUADS, m_ranges[i].first, m_ranges[i].count);
   }
+  m_drawCalls += m_ranges.size();
 
-  //glDisable(GL_TEXTURE_2D); // uncomment these 2 lines to switch to wireframe rendering
-  //glBegin(GL_LINE_LOOP);
-  glBegin(GL_QUADS);
-}
+  glPopClientAttrib();
+  if (useBuffer)
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
 
-void CGUITextureGL::End()
-{
-  glEnd();
   glActiveTexture(GL_TEXTURE2_ARB);
   glBindTexture(GL_TEXTURE_2D, 0);
   glDisable(GL_TEXTURE_2D);
@@ -129,55 +183,131 @@ void CGUITextureGL::End()
   glDisable(GL_TEXTURE_2D);
 }
 
-void CGUITextureGL::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
+void CGUITextureGL::GetBatchStats(unsigned int &drawCalls, unsigned int &quads)
 {
-  // Top-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y1);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y1);
-  glVertex3f(x[0], y[0], z[0]);
+  drawCalls = m_lastDrawCalls;
+  quads = m_lastQuads;
+}
 
-  // Top-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  if (m_diffuse.size())
+void CGUITextureGL::EndFrame()
+{
+  FlushBatch();
+  m_lastDrawCalls = m_drawCalls;
+  m_lastQuads = m_quads;
+  m_drawCalls = 0;
+  m_quads = 0;
+}
+
+void CGUITextureGL::ApplyState(const CGUIQuadBatch::State &state, const CGUIQuadBatch::State *previous)
+{
+  // the texture environment only depends on which units are in use,
+  // going from one batch to the next mostly just rebinds the textures
+  bool setup = previous == NULL || (previous->diffuse != 0) != (state.diffuse != 0) ||
+               previous->limitedColor != state.limitedColor || previous->font != state.font;
+  unsigned int unit = 0;
+
+  glActiveTexture(GL_TEXTURE0 + unit++);
+  glBindTexture(GL_TEXTURE_2D, state.texture);
+  if (setup && state.font)
   {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
+    glEnable(GL_TEXTURE_2D);
+
+    // glyphs are alpha only, the color comes from the vertices. Text keeps
+    // the alpha of what it is drawn on, so its blending differs as well.
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_REPLACE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_PRIMARY_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+    glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+    glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+    VerifyGLState();
   }
-  glVertex3f(x[1], y[1], z[1]);
+  else if (setup)
+  {
+    glEnable(GL_TEXTURE_2D);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  // Bottom-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y2);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y2);
-  glVertex3f(x[2], y[2], z[2]);
+    // diffuse coloring
+    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PRIMARY_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
 
-  // Bottom-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  if (m_diffuse.size())
+    glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+    glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PRIMARY_COLOR);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+    glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+    VerifyGLState();
+  }
+
+  if (state.diffuse)
   {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
+    glActiveTexture(GL_TEXTURE0 + unit++);
+    glBindTexture(GL_TEXTURE_2D, state.diffuse);
+    if (setup)
+    {
+      glEnable(GL_TEXTURE_2D);
+      glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_RGB, GL_SRC_COLOR);
+      glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_PREVIOUS);
+      glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
+
+      glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_ALPHA, GL_TEXTURE);
+      glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE1_ALPHA, GL_PREVIOUS);
+      glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
+      glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_ALPHA, GL_SRC_ALPHA);
+      VerifyGLState();
+    }
+  }
+
+  if (state.limitedColor)
+  {
+    glActiveTexture(GL_TEXTURE0 + unit++);
+    glBindTexture(GL_TEXTURE_2D, state.texture); // dummy bind
+    if (setup)
+    {
+      glEnable(GL_TEXTURE_2D);
+      const GLfloat rgba[4] = {16.0f / 255.0f, 16.0f / 255.0f, 16.0f / 255.0f, 0.0f};
+      glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE , GL_COMBINE);
+      glTexEnvfv(GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, rgba);
+      glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_RGB      , GL_ADD);
+      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_RGB      , GL_PREVIOUS);
+      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE1_RGB      , GL_CONSTANT);
+      glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND0_RGB     , GL_SRC_COLOR);
+      glTexEnvi (GL_TEXTURE_ENV, GL_OPERAND1_RGB     , GL_SRC_COLOR);
+
+      glTexEnvi (GL_TEXTURE_ENV, GL_COMBINE_ALPHA    , GL_REPLACE);
+      glTexEnvi (GL_TEXTURE_ENV, GL_SOURCE0_ALPHA    , GL_PREVIOUS);
+      VerifyGLState();
+    }
+  }
+
+  // units a previous batch used but this one doesn't
+  if (setup)
+  {
+    for (; unit < 3; unit++)
+    {
+      glActiveTexture(GL_TEXTURE0 + unit);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      glDisable(GL_TEXTURE_2D);
+    }
   }
-  glVertex3f(x[3], y[3], z[3]);
 }
 
 void CGUITextureGL::DrawQuad(const CRect &rect, color_t color, CBaseTexture *texture, const CRect *texCoords)
 {
+  FlushBatch();
+
   if (texture)
   {
     texture->LoadToGPU();
@@ -29,6 +29,7 @@
  */
 
 #include "GUITexture.h"
+#include "GUIQuadBatch.h"
 
 #include "system_gl.h"
 
@@ -37,12 +38,47 @@ class CGUITextureGL : public CGUITextureBase
 public:
   CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo& texture);
   static void DrawQuad(const CRect &coords, color_t color, CBaseTexture *texture = NULL, const CRect *texCoords = NULL);
+
+  /*!
+   \brief Draws the quads queued by all textures since the last flush
+
+   Textures are not drawn right away but collected into as few draws as
+   possible. Anything else rendering with GL, or changing state the queued
+   quads depend on (viewport, scissors, transforms, ...), has to flush first.
+   */
+  static void FlushBatch();
+
+  /*!
+   \brief Queues a quad drawn by something other than a texture, e.g. text
+   */
+  static void AddToBatch(const CGUIQuadBatch::State &state, const CGUIQuadBatch::Vertex *quad) { m_batch.Add(state, quad); }
+
+  /*!
+   \brief Number of draw calls and quads of the last frame
+   */
+  static void GetBatchStats(unsigned int &drawCalls, unsigned int &quads);
+  /*!
+   \brief Marks the end of a frame for the stats
+   */
+  static void EndFrame();
 protected:
   void Begin(color_t color);
   void Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation);
   void End();
 private:
+  static void ApplyState(const CGUIQuadBatch::State &state, const CGUIQuadBatch::State *previous);
+
   GLubyte m_col[4];
+  CGUIQuadBatch::State m_state;
+
+  static CGUIQuadBatch m_batch;
+  static std::vector<CGUIQuadBatch::Vertex> m_vertices;
+  static std::vector<CGUIQuadBatch::Range> m_ranges;
+  static GLuint m_vertexBuffer;
+  static unsigned int m_drawCalls;
+  static unsigned int m_quads;
+  static unsigned int m_lastDrawCalls;
+  static unsigned int m_lastQuads;
 };
 
 #endif
@@ -31,6 +31,7 @@
 #include "settings/Settings.h"
 #include "addons/Skin.h"
 #include "GUITexture.h"
+#include "GUIControlProfiler.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/Variant.h"
 #include "Key.h"
@@ -215,6 +216,7 @@ void CGUIWindowManager::AddModeless(CGUIWindow* dialog)
   for (iDialog it = m_activeDialogs.begin(); it != m_activeDialogs.end(); ++it)
     if (*it == dialog) return;
   m_activeDialogs.push_back(dialog);
+  g_infoManager.InvalidateBools(INFO::SOURCE_WINDOW);
 }
 
 void CGUIWindowManager::Remove(int id)
@@ -233,6 +235,7 @@ void CGUIWindowManager::Remove(int id)
     }
 
     m_mapWindows.erase(it);
+    g_infoManager.InvalidateBools(INFO::SOURCE_WINDOW);
   }
   else
   {
@@ -529,20 +532,44 @@ void CGUIWindowManager::MarkDirty(const CRect& rect)
 
 void CGUIWindowManager::RenderPass() const
 {
+  // we render the dialogs based on their render order.
+  vector<CGUIWindow *> renderList = m_activeDialogs;
+  stable_sort(renderList.begin(), renderList.end(), RenderOrderSortFunction);
+
+  // when solving by tiles, whatever is below an opaque dialog covering the
+  // whole pass can't be seen
+  iDialog firstDialog = renderList.begin();
+  bool covered = false;
+  if (g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_TILES &&
+      GetActiveWindow() != WINDOW_FULLSCREEN_VIDEO && GetActiveWindow() != WINDOW_VISUALISATION)
+  {
+    CRect pass = g_graphicsContext.GetScissors();
+    for (iDialog it = renderList.end(); it != renderList.begin() && !covered;)
+    {
+      --it;
+      const CRect &region = (*it)->GetRenderRegion();
+      if ((*it)->IsDialogRunning() && (*it)->IsOpaque() &&
+          region.x1 <= pass.x1 && region.y1 <= pass.y1 && region.x2 >= pass.x2 && region.y2 >= pass.y2)
+      {
+        firstDialog = it;
+        covered = true;
+      }
+    }
+  }
+
+  // windows and dialogs holding video or addon rendering are rendered even
+  // when covered
   CGUIWindow* pWindow = GetWindow(GetActiveWindow());
   if (pWindow)
   {
     pWindow->ClearBackground();
-    pWindow->DoRender();
+    if (!covered || !pWindow->CanCull())
+      pWindow->DoRender();
   }
 
-  // we render the dialogs based on their render order.
-  vector<CGUIWindow *> renderList = m_activeDialogs;
-  stable_sort(renderList.begin(), renderList.end(), RenderOrderSortFunction);
-  
   for (iDialog it = renderList.begin(); it != renderList.end(); ++it)
   {
-    if ((*it)->IsDialogRunning())
+    if ((*it)->IsDialogRunning() && (it >= firstDialog || !(*it)->CanCull()))
       (*it)->DoRender();
   }
 }
@@ -554,12 +581,16 @@ bool CGUIWindowManager::Render()
 
   CDirtyRegionList dirtyRegions = m_tracker.GetDirtyRegions();
 
+  CRect view = g_graphicsContext.GetViewWindow();
+  float redrawn = 0.0f;
+
   bool hasRendered = false;
   // If we visualize the regions we will always render the entire viewport
   if (g_advancedSettings.m_guiVisualizeDirtyRegions || g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_FILL_VIEWPORT_ALWAYS)
   {
     RenderPass();
     hasRendered = true;
+    redrawn = view.Area();
   }
   else if (g_advancedSettings.m_guiAlgorithmDirtyRegions == DIRTYREGION_SOLVER_FILL_VIEWPORT_ON_CHANGE)
   {
@@ -567,6 +598,7 @@ bool CGUIWindowManager::Render()
     {
       RenderPass();
       hasRendered = true;
+      redrawn = view.Area();
     }
   }
   else
@@ -579,9 +611,13 @@ bool CGUIWindowManager::Render()
       g_graphicsContext.SetScissors(*i);
       RenderPass();
       hasRendered = true;
+
+      CRect pass = *i;
+      redrawn += pass.Intersect(view).Area();
     }
     g_graphicsContext.ResetScissors();
   }
+  GUIPROFILER_REDRAWN(view.Area(), redrawn);
 
   if (g_advancedSettings.m_guiVisualizeDirtyRegions)
   {
@@ -708,6 +744,7 @@ void CGUIWindowManager::DeInitialize()
   // clear our vectors of windows
   m_vecCustomWindows.clear();
   m_activeDialogs.clear();
+  g_infoManager.InvalidateBools(INFO::SOURCE_WINDOW);
 
   m_initialized = false;
 }
@@ -722,6 +759,7 @@ void CGUIWindowManager::RouteToWindow(CGUIWindow* dialog)
   RemoveDialog(dialog->GetID());
 
   m_activeDialogs.push_back(dialog);
+  g_infoManager.InvalidateBools(INFO::SOURCE_WINDOW);
 }
 
 /// \brief Unroute window
@@ -734,6 +772,7 @@ void CGUIWindowManager::RemoveDialog(int id)
     if ((*it)->GetID() == id)
     {
       m_activeDialogs.erase(it);
+      g_infoManager.InvalidateBools(INFO::SOURCE_WINDOW);
       return;
     }
   }
@@ -22,6 +22,7 @@
 #include "Texture.h"
 #include "AnimatedGif.h"
 #include "GraphicContext.h"
+#include "GUITexture.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
@@ -479,6 +480,11 @@ void CGUITextureManager::FreeUnusedTextures(unsigned int timeDelay)
       ++i;
   }
 
+#if defined(HAS_GL)
+  // queued quads may still use the textures
+  if (!m_unusedHwTextures.empty())
+    CGUITextureGL::FlushBatch();
+#endif
 #if defined(HAS_GL) || defined(HAS_GLES)
   for (unsigned int i = 0; i < m_unusedHwTextures.size(); ++i)
   {
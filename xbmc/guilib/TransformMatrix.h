@@ -241,6 +241,13 @@ public:
     return (color_t)(colour * alpha);
   }
 
+  /*! \brief Whether flat rectangles stay axis aligned rectangles, i.e. nothing is rotated or skewed
+   */
+  inline bool IsAxisAligned() const
+  {
+    return m[0][1] == 0.0f && m[1][0] == 0.0f && m[2][0] == 0.0f && m[2][1] == 0.0f;
+  }
+
   float m[3][4];
   float alpha;
   bool identity;
@@ -0,0 +1,157 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/DirtyRegionSolvers.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <stdlib.h>
+
+static const CRect viewport(0.0f, 0.0f, 1280.0f, 720.0f);
+
+static float Area(const CDirtyRegionList &regions)
+{
+  float area = 0.0f;
+  for (unsigned int i = 0; i < regions.size(); i++)
+    area += regions[i].Area();
+  return area;
+}
+
+static bool Covers(const CDirtyRegionList &regions, const CRect &rect)
+{
+  for (unsigned int i = 0; i < regions.size(); i++)
+  {
+    if (regions[i].x1 <= rect.x1 && regions[i].y1 <= rect.y1 && regions[i].x2 >= rect.x2 && regions[i].y2 >= rect.y2)
+      return true;
+  }
+  return false;
+}
+
+TEST(TestDirtyRegionSolvers, Tiles)
+{
+  CTileDirtyRegionSolver solver(64.0f, 4);
+  CDirtyRegionList input, output;
+
+  // nothing dirty, nothing to render
+  solver.Solve(input, viewport, output);
+  EXPECT_TRUE(output.empty());
+
+  // a region is snapped to the tiles it touches
+  input.push_back(CDirtyRegion(70.0f, 10.0f, 130.0f, 60.0f));
+  solver.Solve(input, viewport, output);
+  ASSERT_EQ(1U, output.size());
+  EXPECT_EQ(64.0f, output[0].x1);
+  EXPECT_EQ(0.0f, output[0].y1);
+  EXPECT_EQ(192.0f, output[0].x2);
+  EXPECT_EQ(64.0f, output[0].y2);
+
+  // regions sharing tiles become one, and tiles past the viewport are clipped
+  input.push_back(CDirtyRegion(100.0f, 40.0f, 180.0f, 100.0f));
+  input.push_back(CDirtyRegion(1250.0f, 700.0f, 1400.0f, 800.0f));
+  output.clear();
+  solver.Solve(input, viewport, output);
+  ASSERT_EQ(2U, output.size());
+  EXPECT_TRUE(Covers(output, CRect(64.0f, 0.0f, 192.0f, 128.0f)));
+  EXPECT_EQ(1280.0f, output[1].x2);
+  EXPECT_EQ(720.0f, output[1].y2);
+  EXPECT_EQ(128.0f * 128.0f + 64.0f * 80.0f, Area(output));
+}
+
+TEST(TestDirtyRegionSolvers, TilesMaxRegions)
+{
+  // a row of separate spinners, merged into as few rectangles as allowed
+  CTileDirtyRegionSolver solver(64.0f, 3);
+  CDirtyRegionList input, output;
+  for (int i = 0; i < 8; i++)
+    input.push_back(CDirtyRegion(i * 150.0f + 10.0f, 300.0f, i * 150.0f + 40.0f, 330.0f));
+  solver.Solve(input, viewport, output);
+  ASSERT_EQ(3U, output.size());
+  for (unsigned int i = 0; i < input.size(); i++)
+    EXPECT_TRUE(Covers(output, input[i]));
+  // still less than the union of all of them
+  EXPECT_LT(Area(output), 1152.0f * 128.0f);
+
+  // lots of scattered regions end up as their union
+  output.clear();
+  input.clear();
+  for (int row = 0; row < 12; row++)
+  {
+    for (int col = row % 2; col < 20; col += 2)
+      input.push_back(CDirtyRegion(col * 64.0f + 10.0f, row * 64.0f + 10.0f, col * 64.0f + 20.0f, row * 64.0f + 20.0f));
+  }
+  solver.Solve(input, viewport, output);
+  ASSERT_EQ(1U, output.size());
+  EXPECT_TRUE(Covers(output, viewport));
+}
+
+TEST(TestDirtyRegionSolvers, Benchmark)
+{
+  // a home screen with a few animated widgets and a moving focus
+  const int frames = 1000;
+  CTileDirtyRegionSolver tiles;
+  CGreedyDirtyRegionSolver greedy;
+  CDirtyRegionList input, output;
+  float tilesArea = 0.0f, greedyArea = 0.0f;
+  unsigned int tilesPasses = 0, greedyPasses = 0;
+
+  srand(1);
+  int64_t start = CurrentHostCounter();
+  for (int frame = 0; frame < frames; frame++)
+  {
+    input.clear();
+    for (int i = 0; i < 6; i++)
+    {
+      float x = (float)(rand() % 1200), y = (float)(rand() % 660);
+      input.push_back(CDirtyRegion(x, y, x + 20 + rand() % 60, y + 20 + rand() % 40));
+    }
+    output.clear();
+    tiles.Solve(input, viewport, output);
+    tilesArea += Area(output);
+    tilesPasses += output.size();
+  }
+  int64_t elapsed = CurrentHostCounter() - start;
+
+  srand(1);
+  for (int frame = 0; frame < frames; frame++)
+  {
+    input.clear();
+    for (int i = 0; i < 6; i++)
+    {
+      float x = (float)(rand() % 1200), y = (float)(rand() % 660);
+      input.push_back(CDirtyRegion(x, y, x + 20 + rand() % 60, y + 20 + rand() % 40));
+    }
+    output.clear();
+    greedy.Solve(input, output);
+    greedyArea += Area(output);
+    greedyPasses += output.size();
+  }
+
+  // the tiles trade some more redrawn area for fewer rendering passes
+  EXPECT_LE(tilesPasses, greedyPasses);
+  std::cout << "Tiles redraw " << testing::PrintToString((int)(100 * tilesArea / frames / viewport.Area()))
+            << "% of the screen in " << testing::PrintToString(tilesPasses / (float)frames)
+            << " passes per frame, cost reduction "
+            << testing::PrintToString((int)(100 * greedyArea / frames / viewport.Area())) << "% in "
+            << testing::PrintToString(greedyPasses / (float)frames) << " passes, solving took "
+            << testing::PrintToString(elapsed * 1000000 / CurrentHostFrequency() / frames) << " us per frame"
+            << std::endl;
+}
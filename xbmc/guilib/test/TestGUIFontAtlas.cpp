@@ -0,0 +1,211 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIFontAtlas.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int font1 = 1, font2 = 2, font3 = 3;
+
+TEST(TestGUIFontAtlas, Shelves)
+{
+  CGUIFontAtlas atlas(256, 256, 4);
+  CGUIFontAtlas::Slot slot;
+
+  // glyphs of a font fill a shelf from left to right
+  ASSERT_TRUE(atlas.Allocate(&font1, 100, 30, slot));
+  EXPECT_EQ(0U, slot.page);
+  EXPECT_EQ(0U, slot.x);
+  EXPECT_EQ(0U, slot.y);
+  ASSERT_TRUE(atlas.Allocate(&font1, 100, 30, slot));
+  EXPECT_EQ(100U, slot.x);
+  EXPECT_EQ(0U, slot.y);
+  ASSERT_TRUE(atlas.Allocate(&font1, 100, 30, slot));
+  EXPECT_EQ(0U, slot.x);
+  EXPECT_EQ(30U, slot.y);
+
+  // other fonts get their own shelves on the same page
+  ASSERT_TRUE(atlas.Allocate(&font2, 10, 12, slot));
+  EXPECT_EQ(0U, slot.page);
+  EXPECT_EQ(60U, slot.y);
+  EXPECT_EQ(1U, atlas.GetPageCount());
+
+  // too large for any page
+  EXPECT_FALSE(atlas.Allocate(&font1, 300, 30, slot));
+  EXPECT_FALSE(atlas.Allocate(&font1, 10, 300, slot));
+}
+
+TEST(TestGUIFontAtlas, Release)
+{
+  CGUIFontAtlas atlas(256, 256, 4);
+  CGUIFontAtlas::Slot slot, reused;
+  ASSERT_TRUE(atlas.Allocate(&font1, 50, 30, slot));
+  ASSERT_TRUE(atlas.Allocate(&font2, 50, 20, slot));
+
+  unsigned char glyph[4] = { 255, 255, 255, 255 };
+  atlas.Write(slot, glyph, 2, 2, 2);
+  atlas.Release(&font2);
+
+  // a font of about the same size takes over the shelf, cleared
+  ASSERT_TRUE(atlas.Allocate(&font3, 50, 18, reused));
+  EXPECT_EQ(slot.page, reused.page);
+  EXPECT_EQ(slot.y, reused.y);
+  EXPECT_EQ(0U, reused.x);
+  EXPECT_EQ(0, atlas.GetPixels(reused.page)[reused.y * atlas.GetWidth()]);
+
+  // while a much smaller one doesn't waste it
+  atlas.Release(&font3);
+  ASSERT_TRUE(atlas.Allocate(&font2, 50, 10, reused));
+  EXPECT_EQ(50U, reused.y);
+}
+
+TEST(TestGUIFontAtlas, Eviction)
+{
+  CGUIFontAtlas atlas(64, 64, 2);
+  CGUIFontAtlas::Slot first, second, slot;
+
+  // fill both pages, using the first one in the next frame only
+  ASSERT_TRUE(atlas.Allocate(&font1, 64, 64, first));
+  ASSERT_TRUE(atlas.Allocate(&font2, 64, 64, second));
+  EXPECT_EQ(2U, atlas.GetPageCount());
+  atlas.NextFrame();
+  atlas.Touch(first.page);
+  atlas.NextFrame();
+
+  // the least recently used page is taken, and its glyphs become invalid
+  ASSERT_TRUE(atlas.Allocate(&font3, 64, 64, slot));
+  EXPECT_EQ(second.page, slot.page);
+  EXPECT_FALSE(atlas.IsValid(second.page, second.generation));
+  EXPECT_TRUE(atlas.IsValid(slot.page, slot.generation));
+  EXPECT_TRUE(atlas.IsValid(first.page, first.generation));
+  EXPECT_EQ(1U, atlas.GetTotalStats().evictions);
+
+  // pages drawn in the current frame are kept, even past the limit, until the frame is done
+  atlas.Touch(first.page);
+  atlas.Touch(slot.page);
+  ASSERT_TRUE(atlas.Allocate(&font1, 64, 64, slot));
+  EXPECT_EQ(3U, atlas.GetPageCount());
+  EXPECT_TRUE(atlas.IsValid(first.page, first.generation));
+  EXPECT_TRUE(atlas.IsValid(slot.page, slot.generation));
+
+  atlas.Touch(slot.page);
+  atlas.NextFrame();
+  EXPECT_FALSE(atlas.IsValid(first.page, first.generation));
+  EXPECT_TRUE(atlas.IsValid(slot.page, slot.generation));
+  EXPECT_EQ(2U, atlas.GetTotalStats().evictions);
+}
+
+TEST(TestGUIFontAtlas, DirtyRows)
+{
+  CGUIFontAtlas atlas(64, 64, 2);
+  CGUIFontAtlas::Slot slot;
+  unsigned int firstRow, lastRow;
+
+  // a new page is uploaded completely
+  ASSERT_TRUE(atlas.Allocate(&font1, 10, 10, slot));
+  ASSERT_TRUE(atlas.TakeDirtyRows(0, firstRow, lastRow));
+  EXPECT_EQ(0U, firstRow);
+  EXPECT_EQ(64U, lastRow);
+  EXPECT_FALSE(atlas.TakeDirtyRows(0, firstRow, lastRow));
+
+  // later on only the rows written to
+  unsigned char glyph[8 * 8];
+  memset(glyph, 128, sizeof(glyph));
+  ASSERT_TRUE(atlas.Allocate(&font2, 8, 20, slot));
+  slot.y += 5;
+  atlas.Write(slot, glyph, 8, 8, 8);
+  ASSERT_TRUE(atlas.TakeDirtyRows(0, firstRow, lastRow));
+  EXPECT_EQ(15U, firstRow);
+  EXPECT_EQ(23U, lastRow);
+  EXPECT_EQ(128, atlas.GetPixels(0)[15 * 64 + slot.x + 7]);
+  EXPECT_EQ(0, atlas.GetPixels(0)[15 * 64 + slot.x + 8]);
+
+  // writes to invalidated slots are dropped
+  atlas.Reset();
+  EXPECT_TRUE(atlas.TakeDirtyRows(0, firstRow, lastRow));
+  atlas.Write(slot, glyph, 8, 8, 8);
+  EXPECT_FALSE(atlas.TakeDirtyRows(0, firstRow, lastRow));
+}
+
+TEST(TestGUIFontAtlas, Benchmark)
+{
+  // a few fonts drawing text with a skewed letter distribution, like labels
+  // of a library view. Every now and then another view with different rare
+  // glyphs is opened, while the common ones stay the same.
+  const int frames = 500, labels = 60, length = 24;
+  const unsigned int sizes[] = { 18, 24, 30, 42, 60 };
+  const int fonts = sizeof(sizes) / sizeof(sizes[0]);
+
+  CGUIFontAtlas atlas(1024, 1024, 8);
+  std::map<unsigned int, CGUIFontAtlas::Slot> cache[fonts];
+  unsigned char glyph[64 * 64] = { 0 };
+
+  srand(1);
+  int64_t start = CurrentHostCounter();
+  for (int frame = 0; frame < frames; frame++)
+  {
+    for (int label = 0; label < labels; label++)
+    {
+      int font = label % fonts;
+      unsigned int size = sizes[font];
+      for (int i = 0; i < length; i++)
+      {
+        // zipf like, a small alphabet used most of the time and a long tail
+        double r = (double)rand() / RAND_MAX;
+        unsigned int letter = (unsigned int)(pow(r, 4.0) * 500);
+        if (letter >= 64)
+          letter += frame / 100 * 500;
+
+        std::map<unsigned int, CGUIFontAtlas::Slot>::iterator it = cache[font].find(letter);
+        if (it != cache[font].end() && atlas.IsValid(it->second.page, it->second.generation))
+          atlas.AddHit();
+        else
+        {
+          atlas.AddMiss();
+          CGUIFontAtlas::Slot slot;
+          ASSERT_TRUE(atlas.Allocate(&sizes[font], size * 2 / 3 + 1, size + 1, slot));
+          atlas.Write(slot, glyph, 64, size * 2 / 3, size);
+          cache[font][letter] = slot;
+          it = cache[font].find(letter);
+        }
+        atlas.Touch(it->second.page);
+        atlas.AddVertices(4);
+      }
+    }
+    atlas.NextFrame();
+  }
+  int64_t elapsed = CurrentHostCounter() - start;
+
+  CGUIFontAtlas::Stats stats = atlas.GetTotalStats();
+  EXPECT_GT(stats.hits, stats.misses);
+  std::cout << "Glyph cache hit rate " << testing::PrintToString(100 * stats.hits / (stats.hits + stats.misses))
+            << "%, " << testing::PrintToString(stats.evictions) << " pages evicted, "
+            << testing::PrintToString(stats.vertices / frames) << " vertices per frame in "
+            << testing::PrintToString(atlas.GetPageCount()) << " pages, "
+            << testing::PrintToString(elapsed * 1000000 / CurrentHostFrequency() / frames) << " us per frame"
+            << std::endl;
+}
@@ -0,0 +1,219 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "guilib/GUIQuadBatch.h"
+#include "utils/TimeUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+static CGUIQuadBatch::State GetState(unsigned int texture, unsigned int diffuse = 0)
+{
+  CGUIQuadBatch::State state;
+  state.texture = texture;
+  state.diffuse = diffuse;
+  state.limitedColor = false;
+  state.font = false;
+  return state;
+}
+
+// the quad's id is kept in the red channel to check the order later on
+static void AddQuad(CGUIQuadBatch &batch, const CGUIQuadBatch::State &state, const CRect &rect, unsigned char id, float z = 0.0f)
+{
+  CGUIQuadBatch::Vertex quad[4];
+  memset(quad, 0, sizeof(quad));
+  quad[0].x = rect.x1; quad[0].y = rect.y1;
+  quad[1].x = rect.x2; quad[1].y = rect.y1;
+  quad[2].x = rect.x2; quad[2].y = rect.y2;
+  quad[3].x = rect.x1; quad[3].y = rect.y2;
+  for (int i = 0; i < 4; i++)
+  {
+    quad[i].z = z;
+    quad[i].r = id;
+  }
+  batch.Add(state, quad);
+}
+
+// a list with a background and an icon per item and a focus overlay on the middle one
+static void AddList(CGUIQuadBatch &batch, unsigned int items, unsigned int icons, float posX = 0.0f)
+{
+  for (unsigned int i = 0; i < items; i++)
+  {
+    CRect row(posX, i * 40.0f, posX + 400.0f, i * 40.0f + 40.0f);
+    AddQuad(batch, GetState(1), row, 0);
+    AddQuad(batch, GetState(2 + i % icons), CRect(row.x1 + 4, row.y1 + 4, row.x1 + 36, row.y2 - 4), 0);
+    if (i == items / 2)
+      AddQuad(batch, GetState(20, 21), row, 0);
+  }
+}
+
+TEST(TestGUIQuadBatch, SameState)
+{
+  CGUIQuadBatch batch;
+  for (int i = 0; i < 10; i++)
+    AddQuad(batch, GetState(1), CRect(0.0f, 0.0f, 100.0f, 100.0f), i);
+  EXPECT_EQ(10U, batch.GetQuadCount());
+  EXPECT_EQ(1U, batch.GetBatchCount());
+
+  std::vector<CGUIQuadBatch::Vertex> vertices;
+  std::vector<CGUIQuadBatch::Range> ranges;
+  batch.Take(vertices, ranges);
+  ASSERT_EQ(40U, vertices.size());
+  ASSERT_EQ(1U, ranges.size());
+  EXPECT_EQ(0U, ranges[0].first);
+  EXPECT_EQ(40U, ranges[0].count);
+  for (int i = 0; i < 10; i++)
+    EXPECT_EQ(i, vertices[i * 4].r);
+  EXPECT_TRUE(batch.IsEmpty());
+}
+
+TEST(TestGUIQuadBatch, Overlapping)
+{
+  // each quad covers the previous one, so nothing may be reordered
+  CGUIQuadBatch batch;
+  AddQuad(batch, GetState(1), CRect(0.0f, 0.0f, 100.0f, 100.0f), 0);
+  AddQuad(batch, GetState(2), CRect(50.0f, 50.0f, 150.0f, 150.0f), 1);
+  AddQuad(batch, GetState(1), CRect(100.0f, 100.0f, 200.0f, 200.0f), 2);
+  EXPECT_EQ(3U, batch.GetBatchCount());
+
+  // touching edges don't overlap
+  AddQuad(batch, GetState(2), CRect(200.0f, 0.0f, 300.0f, 100.0f), 3);
+  AddQuad(batch, GetState(1), CRect(300.0f, 0.0f, 400.0f, 100.0f), 4);
+  EXPECT_EQ(3U, batch.GetBatchCount());
+
+  std::vector<CGUIQuadBatch::Vertex> vertices;
+  std::vector<CGUIQuadBatch::Range> ranges;
+  batch.Take(vertices, ranges);
+  ASSERT_EQ(3U, ranges.size());
+  EXPECT_EQ(1U, ranges[0].state.texture);
+  EXPECT_EQ(2U, ranges[1].state.texture);
+  EXPECT_EQ(1U, ranges[2].state.texture);
+  EXPECT_EQ(8U, ranges[1].count);
+  EXPECT_EQ(3, vertices[ranges[1].first + 4].r);
+  EXPECT_EQ(4, vertices[ranges[2].first + 4].r);
+}
+
+TEST(TestGUIQuadBatch, NotFlat)
+{
+  // quads off the z == 0 plane are never moved
+  CGUIQuadBatch batch;
+  AddQuad(batch, GetState(1), CRect(0.0f, 0.0f, 100.0f, 100.0f), 0);
+  AddQuad(batch, GetState(2), CRect(200.0f, 0.0f, 300.0f, 100.0f), 1);
+  AddQuad(batch, GetState(1), CRect(400.0f, 0.0f, 500.0f, 100.0f), 2, 10.0f);
+  EXPECT_EQ(3U, batch.GetBatchCount());
+  AddQuad(batch, GetState(2), CRect(600.0f, 0.0f, 700.0f, 100.0f), 3);
+  EXPECT_EQ(4U, batch.GetBatchCount());
+}
+
+TEST(TestGUIQuadBatch, State)
+{
+  CGUIQuadBatch batch;
+  AddQuad(batch, GetState(1), CRect(0.0f, 0.0f, 100.0f, 100.0f), 0);
+  AddQuad(batch, GetState(1, 2), CRect(0.0f, 0.0f, 100.0f, 100.0f), 1);
+  CGUIQuadBatch::State limited = GetState(1, 2);
+  limited.limitedColor = true;
+  AddQuad(batch, limited, CRect(0.0f, 0.0f, 100.0f, 100.0f), 2);
+  EXPECT_EQ(3U, batch.GetBatchCount());
+}
+
+TEST(TestGUIQuadBatch, PaintersOrder)
+{
+  // whatever is merged, quads that overlap have to be drawn in the order they were added
+  srand(1);
+  for (int round = 0; round < 20; round++)
+  {
+    CGUIQuadBatch batch;
+    std::vector<CRect> rects;
+    for (int i = 0; i < 250; i++)
+    {
+      float x = (float)(rand() % 1800), y = (float)(rand() % 1000);
+      CRect rect(x, y, x + 20 + rand() % 200, y + 20 + rand() % 100);
+      rects.push_back(rect);
+      AddQuad(batch, GetState(rand() % 4), rect, (unsigned char)i);
+    }
+
+    std::vector<CGUIQuadBatch::Vertex> vertices;
+    std::vector<CGUIQuadBatch::Range> ranges;
+    unsigned int batches = batch.GetBatchCount();
+    batch.Take(vertices, ranges);
+    EXPECT_EQ(batches, ranges.size());
+    EXPECT_LT(ranges.size(), rects.size());
+
+    // where each quad ended up
+    std::vector<unsigned int> drawn(rects.size());
+    for (unsigned int j = 0; j < vertices.size(); j += 4)
+      drawn[vertices[j].r] = j / 4;
+
+    for (unsigned int i = 0; i < rects.size(); i++)
+    {
+      for (unsigned int j = i + 1; j < rects.size(); j++)
+      {
+        if (rects[i].x1 < rects[j].x2 && rects[j].x1 < rects[i].x2 &&
+            rects[i].y1 < rects[j].y2 && rects[j].y1 < rects[i].y2)
+          EXPECT_LT(drawn[i], drawn[j]);
+      }
+    }
+  }
+}
+
+TEST(TestGUIQuadBatch, List)
+{
+  CGUIQuadBatch batch;
+  std::vector<CGUIQuadBatch::Vertex> vertices;
+  std::vector<CGUIQuadBatch::Range> ranges;
+  AddList(batch, 20, 1);
+  EXPECT_EQ(41U, batch.GetQuadCount());
+  // all backgrounds, all icons and the focus
+  EXPECT_EQ(3U, batch.GetBatchCount());
+
+  batch.Take(vertices, ranges);
+  AddList(batch, 20, 8);
+  EXPECT_LT(batch.GetBatchCount(), 30U);
+}
+
+TEST(TestGUIQuadBatch, Benchmark)
+{
+  const int frames = 1000;
+  CGUIQuadBatch batch;
+  std::vector<CGUIQuadBatch::Vertex> vertices;
+  std::vector<CGUIQuadBatch::Range> ranges;
+
+  unsigned int quads = 0, drawCalls = 0;
+  int64_t start = CurrentHostCounter();
+  for (int frame = 0; frame < frames; frame++)
+  {
+    // a few lists side by side, like a home screen with widgets
+    AddList(batch, 25, 1, 0.0f);
+    AddList(batch, 25, 8, 450.0f);
+    AddList(batch, 25, 25, 900.0f);
+    quads = batch.GetQuadCount();
+    batch.Take(vertices, ranges);
+    drawCalls = ranges.size();
+  }
+  int64_t elapsed = CurrentHostCounter() - start;
+
+  std::cout << "Batching " << testing::PrintToString(quads) << " quads into "
+            << testing::PrintToString(drawCalls) << " draw calls took "
+            << testing::PrintToString(elapsed * 1000000 / CurrentHostFrequency() / frames) << " us per frame"
+            << std::endl;
+}
@@ -23,13 +23,27 @@
 
 namespace INFO
 {
+  volatile long InfoBool::m_evaluations = 0;
+
   InfoBool::InfoBool(const std::string &expression, int context)
     : m_value(false),
       m_context(context),
       m_listItemDependent(false),
+      m_sources(SOURCE_VOLATILE),
       m_expression(expression),
       m_dirty(true)
   {
     StringUtils::ToLower(m_expression);
   }
+
+  unsigned int InfoBool::TakeEvaluations()
+  {
+    // swap in zero without losing evaluations counted meanwhile
+    long evaluations;
+    do
+    {
+      evaluations = m_evaluations;
+    } while (cas(&m_evaluations, evaluations, 0) != evaluations);
+    return (unsigned int)evaluations;
+  }
 }
@@ -22,11 +22,28 @@
 
 #include <string>
 #include "boost/shared_ptr.hpp"
+#include "threads/Atomics.h"
 
 class CGUIListItem;
 
 namespace INFO
 {
+/*!
+ \brief State the value of an info bool depends on
+
+ Info bools are only re-evaluated after one of their sources changed.
+ Anything that can't be tracked is volatile and evaluated every frame.
+ */
+enum InfoSource
+{
+  SOURCE_NONE     = 0,      ///< constant, evaluated once
+  SOURCE_PLAYER   = 1 << 0, ///< playback started or stopped
+  SOURCE_WINDOW   = 1 << 1, ///< windows and dialogs opened or closed
+  SOURCE_SETTINGS = 1 << 2, ///< skin or system settings
+  SOURCE_LIBRARY  = 1 << 3, ///< library contents
+  SOURCE_VOLATILE = 1 << 4  ///< anything else
+};
+
 /*!
  \ingroup info
  \brief Base class, wrapping boolean conditions and expressions
@@ -51,9 +68,13 @@ public:
   inline bool Get(const CGUIListItem *item = NULL)
   {
     if (item && m_listItemDependent)
+    {
+      AtomicIncrement(&m_evaluations);
       Update(item);
+    }
     else if (m_dirty)
     {
+      AtomicIncrement(&m_evaluations);
       Update(NULL);
       m_dirty = false;
     }
@@ -73,15 +94,25 @@ public:
 
   const std::string &GetExpression() const { return m_expression; }
   bool ListItemDependent() const { return m_listItemDependent; }
+  /*! \brief The sources (INFO::InfoSource) that invalidate this info bool
+   */
+  unsigned int GetSources() const { return m_sources; }
+
+  /*! \brief Returns the number of evaluations since the last call
+   */
+  static unsigned int TakeEvaluations();
 protected:
 
   bool m_value;                ///< current value
   int m_context;               ///< contextual information to go with the condition
   bool m_listItemDependent;    ///< do not cache if a listitem pointer is given
+  unsigned int m_sources;      ///< state the value depends on
 
 private:
   std::string  m_expression;   ///< original expression
   bool         m_dirty;        ///< whether we need an update
+
+  static volatile long m_evaluations; ///< counted from every thread evaluating info bools
 };
 
 typedef boost::shared_ptr<InfoBool> InfoPtr;
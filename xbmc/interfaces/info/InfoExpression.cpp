@@ -30,6 +30,7 @@ InfoSingle::InfoSingle(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
   m_condition = g_infoManager.TranslateSingleString(expression, m_listItemDependent);
+  m_sources = m_listItemDependent ? SOURCE_VOLATILE : g_infoManager.GetBoolSources(m_condition);
 }
 
 void InfoSingle::Update(const CGUIListItem *item)
@@ -40,6 +41,7 @@ void InfoSingle::Update(const CGUIListItem *item)
 InfoExpression::InfoExpression(const std::string &expression, int context)
 : InfoBool(expression, context)
 {
+  m_sources = SOURCE_NONE;
   Parse(expression);
 }
 
@@ -85,6 +87,7 @@ void InfoExpression::Parse(const std::string &expression)
         if (info)
         {
           m_listItemDependent |= info->ListItemDependent();
+          m_sources |= info->GetSources();
           m_postfix.push_back(m_operands.size());
           m_operands.push_back(info);
         }
@@ -132,6 +135,7 @@ void InfoExpression::Parse(const std::string &expression)
     if (info)
     {
       m_listItemDependent |= info->ListItemDependent();
+      m_sources |= info->GetSources();
       m_postfix.push_back(m_operands.size());
       m_operands.push_back(info);
     }
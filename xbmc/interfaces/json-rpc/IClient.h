@@ -21,6 +21,15 @@
 
 namespace JSONRPC
 {
+  /*!
+   \brief Encodings responses and notifications can be sent in
+   */
+  enum ResponseEncoding
+  {
+    ResponseEncodingJSON = 0,
+    ResponseEncodingCBOR
+  };
+
   class IClient
   {
   public:
@@ -28,5 +37,7 @@ namespace JSONRPC
     virtual int GetPermissionFlags() = 0;
     virtual int GetAnnouncementFlags() = 0;
     virtual bool SetAnnouncementFlags(int flags) = 0;
+    virtual ResponseEncoding GetResponseEncoding() { return ResponseEncodingJSON; }
+    virtual bool SetResponseEncoding(ResponseEncoding encoding) { return encoding == ResponseEncodingJSON; }
   };
 }
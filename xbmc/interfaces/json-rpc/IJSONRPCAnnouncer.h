@@ -33,6 +33,13 @@ namespace JSONRPC
     static std::string AnnouncementToJSONRPC(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *method, const CVariant &data, bool compactOutput)
     {
       CVariant root;
+      AnnouncementToJSONRPC(flag, sender, method, data, root);
+
+      return CJSONVariantWriter::Write(root, compactOutput);
+    }
+
+    static void AnnouncementToJSONRPC(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *method, const CVariant &data, CVariant &root)
+    {
       root["jsonrpc"] = "2.0";
 
       std::string namespaceMethod = ANNOUNCEMENT::AnnouncementFlagToString(flag);
@@ -42,8 +49,6 @@ namespace JSONRPC
 
       root["params"]["data"] = data;
       root["params"]["sender"] = sender;
-
-      return CJSONVariantWriter::Write(root, compactOutput);
     }
   };
 }
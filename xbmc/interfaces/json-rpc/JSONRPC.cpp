@@ -27,6 +27,7 @@
 #include "interfaces/AnnouncementManager.h"
 #include "playlists/SmartPlayList.h"
 #include "settings/AdvancedSettings.h"
+#include "utils/CBORVariantWriter.h"
 #include "utils/log.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
@@ -166,6 +167,8 @@ JSONRPC_STATUS CJSONRPC::GetConfiguration(const CStdString &method, ITransportLa
   for (int i = 1; i <= ANNOUNCE_ALL; i *= 2)
     result["notifications"][AnnouncementFlagToString((AnnouncementFlag)i)] = (flags & i) == i;
 
+  result["encoding"] = client->GetResponseEncoding() == ResponseEncodingCBOR ? "cbor" : "json";
+
   return OK;
 }
 
@@ -209,6 +212,10 @@ JSONRPC_STATUS CJSONRPC::SetConfiguration(const CStdString &method, ITransportLa
   if (!client->SetAnnouncementFlags(flags))
     return BadPermission;
 
+  if (parameterObject["encoding"].isString() &&
+      !client->SetResponseEncoding(parameterObject["encoding"].asString() == "cbor" ? ResponseEncodingCBOR : ResponseEncodingJSON))
+    return BadPermission;
+
   return GetConfiguration(method, transport, client, parameterObject, result);
 }
 
@@ -229,7 +236,14 @@ JSONRPC_STATUS CJSONRPC::NotifyAll(const CStdString &method, ITransportLayer *tr
 
 CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client)
 {
-  CVariant inputroot, outputroot, result;
+  CVariant outputroot;
+  CStdString str = MethodCall(inputString, transport, client, outputroot) ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
+  return str;
+}
+
+bool CJSONRPC::MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client, CVariant &outputroot)
+{
+  CVariant inputroot, result;
   bool hasResponse = false;
 
   if(g_advancedSettings.CanLogComponent(LOGJSONRPC))
@@ -243,7 +257,7 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
       if (inputroot.size() <= 0)
       {
         CLog::Log(LOGERROR, "JSONRPC: Empty batch call\n");
-        BuildResponse(inputroot, InvalidRequest, CVariant(), outputroot);
+        BuildResponse(inputroot, InvalidRequest, result, outputroot);
         hasResponse = true;
       }
       else
@@ -253,7 +267,9 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
           CVariant response;
           if (HandleMethodCall(*itr, response, transport, client))
           {
-            outputroot.append(response);
+            // move the response into the batch instead of copying it
+            outputroot.append(CVariant());
+            outputroot[outputroot.size() - 1].swap(response);
             hasResponse = true;
           }
         }
@@ -265,12 +281,19 @@ CStdString CJSONRPC::MethodCall(const CStdString &inputString, ITransportLayer *
   else
   {
     CLog::Log(LOGERROR, "JSONRPC: Failed to parse '%s'\n", inputString.c_str());
-    BuildResponse(inputroot, ParseError, CVariant(), outputroot);
+    BuildResponse(inputroot, ParseError, result, outputroot);
     hasResponse = true;
   }
 
-  CStdString str = hasResponse ? CJSONVariantWriter::Write(outputroot, g_advancedSettings.m_jsonOutputCompact) : "";
-  return str;
+  return hasResponse;
+}
+
+IVariantEncoder* CJSONRPC::CreateEncoder(ResponseEncoding encoding)
+{
+  if (encoding == ResponseEncodingCBOR)
+    return new CCBORVariantEncoder();
+
+  return new CJSONVariantEncoder(g_advancedSettings.m_jsonOutputCompact);
 }
 
 bool CJSONRPC::HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client)
@@ -310,7 +333,7 @@ inline bool CJSONRPC::IsProperJSONRPC(const CVariant& inputroot)
   return inputroot.isObject() && inputroot.isMember("jsonrpc") && inputroot["jsonrpc"].isString() && inputroot["jsonrpc"] == CVariant("2.0") && inputroot.isMember("method") && inputroot["method"].isString() && (!inputroot.isMember("params") || inputroot["params"].isArray() || inputroot["params"].isObject());
 }
 
-inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response)
+inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant& result, CVariant& response)
 {
   response["jsonrpc"] = "2.0";
   response["id"] = request.isObject() && request.isMember("id") ? request["id"] : CVariant();
@@ -318,7 +341,8 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
   switch (code)
   {
     case OK:
-      response["result"] = result;
+      // results can be large, move them into the response instead of copying
+      response["result"].swap(result);
       break;
     case ACK:
       response["result"] = "OK";
@@ -331,7 +355,7 @@ inline void CJSONRPC::BuildResponse(const CVariant& request, JSONRPC_STATUS code
       response["error"]["code"] = InvalidParams;
       response["error"]["message"] = "Invalid params.";
       if (!result.isNull())
-        response["error"]["data"] = result;
+        response["error"]["data"].swap(result);
       break;
     case MethodNotFound:
       response["error"]["code"] = MethodNotFound;
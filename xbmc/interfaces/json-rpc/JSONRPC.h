@@ -28,6 +28,7 @@
 #include "JSONServiceDescription.h"
 #include "interfaces/IAnnouncer.h"
 #include "utils/StdString.h"
+#include "utils/VariantStreamWriter.h"
 
 namespace JSONRPC
 {
@@ -64,6 +65,24 @@ namespace JSONRPC
      */
     static CStdString MethodCall(const CStdString &inputString, ITransportLayer *transport, IClient *client);
 
+    /*
+     \brief Handles an incoming JSON-RPC request without serializing the response
+     \param inputString received JSON-RPC request
+     \param transport Transport protocol on which the request arrived
+     \param client Client which sent the request
+     \param response JSON-RPC response to be sent back to the client
+     \return True if there is a response to send back
+
+     Lets the transport serialize the response with a CVariantStreamWriter
+     in the encoding of the client straight into its own buffers.
+     */
+    static bool MethodCall(const std::string &inputString, ITransportLayer *transport, IClient *client, CVariant &response);
+
+    /*!
+     \brief Creates an encoder writing responses in the given encoding
+     */
+    static IVariantEncoder* CreateEncoder(ResponseEncoding encoding);
+
     static JSONRPC_STATUS Introspect(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Version(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
     static JSONRPC_STATUS Permission(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant& parameterObject, CVariant &result);
@@ -77,7 +96,7 @@ namespace JSONRPC
     static bool HandleMethodCall(const CVariant& request, CVariant& response, ITransportLayer *transport, IClient *client);
     static inline bool IsProperJSONRPC(const CVariant& inputroot);
 
-    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, const CVariant& result, CVariant& response);
+    inline static void BuildResponse(const CVariant& request, JSONRPC_STATUS code, CVariant& result, CVariant& response);
 
     static bool m_initialized;
   };
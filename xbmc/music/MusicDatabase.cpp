@@ -75,6 +75,7 @@ using ADDON::AddonPtr;
 
 #define RECENTLY_PLAYED_LIMIT 25
 #define MIN_FULL_SEARCH_LENGTH 3
+#define LAZY_SONGS_MIN_ITEMS 1000
 
 #ifdef HAS_DVD_DRIVE
 using namespace CDDB;
@@ -368,7 +369,10 @@ std::string GetArtistString(const VECARTISTCREDITS &credits)
 
 bool CMusicDatabase::AddAlbum(CAlbum& album)
 {
-  BeginTransaction();
+  // the scanner may be collecting several albums into one transaction
+  bool bTransaction = !InTransaction();
+  if (bTransaction)
+    BeginTransaction();
 
   album.idAlbum = AddAlbum(album.strAlbum,
                            album.strMusicBrainzAlbumID,
@@ -423,7 +427,8 @@ bool CMusicDatabase::AddAlbum(CAlbum& album)
                                                         ++albumArt)
     SetArtForItem(album.idAlbum, MediaTypeAlbum, albumArt->first, albumArt->second);
 
-  CommitTransaction();
+  if (bTransaction)
+    CommitTransaction();
   return true;
 }
 
@@ -614,11 +619,11 @@ bool CMusicDatabase::GetSong(int idSong, CSong& song)
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL=PrepareSQL("SELECT songview.*,songartistview.* FROM songview "
-                                 " LEFT JOIN songartistview ON songview.idSong = songartistview.idSong "
-                                 " WHERE songview.idSong = %i", idSong);
-
-    if (!m_pDS->query(strSQL.c_str())) return false;
+    dbiplus::BindList params;
+    params.push_back(idSong);
+    if (!m_pDS->query("SELECT songview.*,songartistview.* FROM songview "
+                      " LEFT JOIN songartistview ON songview.idSong = songartistview.idSong "
+                      " WHERE songview.idSong = ?", params)) return false;
     int iRowsFound = m_pDS->num_rows();
     if (iRowsFound == 0)
     {
@@ -1496,14 +1501,16 @@ int CMusicDatabase::AddPath(const CStdString& strPath1)
     if (it != m_pathCache.end())
       return it->second;
 
-    strSQL=PrepareSQL( "select * from path where strPath='%s'", strPath.c_str());
-    m_pDS->query(strSQL.c_str());
+    dbiplus::BindList params;
+    params.push_back(strPath.c_str());
+    strSQL = "select * from path where strPath=?";
+    m_pDS->query(strSQL, params);
     if (m_pDS->num_rows() == 0)
     {
       m_pDS->close();
       // doesnt exists, add it
-      strSQL=PrepareSQL("insert into path (idPath, strPath) values( NULL, '%s' )", strPath.c_str());
-      m_pDS->exec(strSQL.c_str());
+      strSQL = "insert into path (idPath, strPath) values( NULL, ? )";
+      m_pDS->exec(strSQL, params);
 
       int idPath = (int)m_pDS->lastinsertid();
       m_pathCache.insert(pair<CStdString, int>(strPath, idPath));
@@ -3422,6 +3429,129 @@ bool CMusicDatabase::GetAlbumsByWhere(const CStdString &baseDir, const Filter &f
   return false;
 }
 
+/*!
+ \brief Builds song items out of songview rows kept in a CFileItemColumns
+
+ The raw fields of the rows are stored under FieldMax + their songview index
+ and turned back into a record to fill the item like any other song item.
+ */
+class CSongItemFactory : public IFileItemFactory
+{
+public:
+  CSongItemFactory(const CMusicDbUrl &baseUrl)
+    : m_baseUrl(baseUrl)
+  { }
+
+  static int FieldKey(int field) { return FieldMax + field; }
+
+  void AddColumns(CFileItemColumns &columns, const dbiplus::sql_record &record)
+  {
+    for (unsigned int field = 0; field < record.size(); field++)
+    {
+      CFileItemColumns::ColumnType type;
+      switch (record[field].get_fType())
+      {
+        case dbiplus::ft_String:
+        case dbiplus::ft_WideString:
+        case dbiplus::ft_Char:
+        case dbiplus::ft_WChar:
+          type = CFileItemColumns::ColumnString;
+          break;
+        case dbiplus::ft_Float:
+        case dbiplus::ft_Double:
+        case dbiplus::ft_LongDouble:
+          type = CFileItemColumns::ColumnDouble;
+          break;
+        default:
+          type = CFileItemColumns::ColumnInteger;
+          break;
+      }
+      columns.AddColumn(FieldKey(field), type);
+      m_types.push_back(type);
+    }
+
+    // the fields the song views are sorted by
+    if (record.size() < CMusicDatabase::song_enumCount)
+      return;
+    columns.AddAlias(FieldId, FieldKey(CMusicDatabase::song_idSong));
+    columns.AddAlias(FieldTitle, FieldKey(CMusicDatabase::song_strTitle));
+    columns.AddAlias(FieldLabel, FieldKey(CMusicDatabase::song_strTitle));
+    columns.AddAlias(FieldArtist, FieldKey(CMusicDatabase::song_strArtists));
+    columns.AddAlias(FieldAlbumArtist, FieldKey(CMusicDatabase::song_strAlbumArtists));
+    columns.AddAlias(FieldGenre, FieldKey(CMusicDatabase::song_strGenres));
+    columns.AddAlias(FieldAlbum, FieldKey(CMusicDatabase::song_strAlbum));
+    columns.AddAlias(FieldTrackNumber, FieldKey(CMusicDatabase::song_iTrack));
+    columns.AddAlias(FieldTime, FieldKey(CMusicDatabase::song_iDuration));
+    columns.AddAlias(FieldYear, FieldKey(CMusicDatabase::song_iYear));
+    columns.AddAlias(FieldPlaycount, FieldKey(CMusicDatabase::song_iTimesPlayed));
+    columns.AddAlias(FieldLastPlayed, FieldKey(CMusicDatabase::song_lastplayed));
+    columns.AddAlias(FieldComment, FieldKey(CMusicDatabase::song_comment));
+    columns.AddAlias(FieldStartOffset, FieldKey(CMusicDatabase::song_iStartOffset));
+    columns.AddAlias(FieldEndOffset, FieldKey(CMusicDatabase::song_iEndOffset));
+    columns.AddColumn(FieldRating, CFileItemColumns::ColumnDouble);
+    columns.AddColumn(FieldPath, CFileItemColumns::ColumnString);
+    columns.AddColumn(FieldProgramCount, CFileItemColumns::ColumnInteger);
+    columns.AddConstant(FieldFolder, false);
+    columns.AddConstant(FieldSortSpecial, (int)SortSpecialNone);
+  }
+
+  void AddRow(CFileItemColumns &columns, const dbiplus::sql_record &record, int programCount)
+  {
+    columns.AddRow();
+    for (unsigned int field = 0; field < record.size() && field < m_types.size(); field++)
+    {
+      if (m_types[field] == CFileItemColumns::ColumnString)
+        columns.SetString(FieldKey(field), record[field].get_asString());
+      else if (m_types[field] == CFileItemColumns::ColumnDouble)
+        columns.SetDouble(FieldKey(field), record[field].get_asDouble());
+      else
+        columns.SetInteger(FieldKey(field), record[field].get_asInt64());
+    }
+
+    if (record.size() < CMusicDatabase::song_enumCount)
+      return;
+    columns.SetDouble(FieldRating, (double)(record[CMusicDatabase::song_rating].get_asChar() - '0'));
+    columns.SetInteger(FieldProgramCount, programCount);
+
+    // same path as GetFileItemFromDataset() gives the item
+    CStdString strFileName = record[CMusicDatabase::song_strFileName].get_asString();
+    if (!m_baseUrl.IsValid())
+      columns.SetString(FieldPath, URIUtils::AddFileToFolder(record[CMusicDatabase::song_strPath].get_asString(), strFileName));
+    else
+    {
+      CMusicDbUrl itemUrl = m_baseUrl;
+      CStdString strExt = URIUtils::GetExtension(strFileName);
+      itemUrl.AppendPath(StringUtils::Format("%ld%s", record[CMusicDatabase::song_idSong].get_asInt(), strExt.c_str()));
+      columns.SetString(FieldPath, itemUrl.ToString());
+    }
+  }
+
+  virtual CFileItemPtr CreateItem(const CFileItemColumns &columns, unsigned int row) const
+  {
+    dbiplus::sql_record record;
+    record.reserve(m_types.size());
+    for (unsigned int field = 0; field < m_types.size(); field++)
+    {
+      if (m_types[field] == CFileItemColumns::ColumnString)
+        record.push_back(dbiplus::field_value(columns.GetString(FieldKey(field), row).c_str()));
+      else if (m_types[field] == CFileItemColumns::ColumnDouble)
+        record.push_back(dbiplus::field_value(columns.GetDouble(FieldKey(field), row)));
+      else
+        record.push_back(dbiplus::field_value(columns.GetInteger(FieldKey(field), row)));
+    }
+
+    CFileItemPtr item(new CFileItem);
+    CMusicDatabase::GetFileItemFromDataset(&record, item.get(), m_baseUrl);
+    // HACK for sorting by database returned order
+    item->m_iprogramCount = (int)columns.GetInteger(FieldProgramCount, row);
+    return item;
+  }
+
+private:
+  CMusicDbUrl m_baseUrl;
+  std::vector<CFileItemColumns::ColumnType> m_types;
+};
+
 bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &filter, CFileItemList &items, const SortDescription &sortDescription /* = SortDescription() */)
 {
   if (m_pDB.get() == NULL || m_pDS.get() == NULL)
@@ -3486,9 +3616,29 @@ bool CMusicDatabase::GetSongsByWhere(const CStdString &baseDir, const Filter &fi
       return false;
 
     // get data from returned rows
-    items.Reserve(results.size());
     const dbiplus::query_data &data = m_pDS->get_result_set().records;
     int count = 0;
+    if (results.size() >= LAZY_SONGS_MIN_ITEMS)
+    {
+      // huge listings keep the rows and only create the items that are used
+      CSongItemFactory *factory = new CSongItemFactory(musicUrl);
+      boost::shared_ptr<CFileItemColumns> columns(new CFileItemColumns(factory));
+      for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
+      {
+        unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
+        const dbiplus::sql_record* const record = data.at(targetRow);
+        if (count == 0)
+          factory->AddColumns(*columns, *record);
+        factory->AddRow(*columns, *record, ++count);
+      }
+      items.AddRows(columns);
+
+      m_pDS->close();
+      CLog::Log(LOGDEBUG, "%s(%s) - took %d ms for %u lazy items", __FUNCTION__, filter.where.c_str(), XbmcThreads::SystemClockMillis() - time, columns->Size());
+      return true;
+    }
+
+    items.Reserve(results.size());
     for (DatabaseResults::const_iterator it = results.begin(); it != results.end(); it++)
     {
       unsigned int targetRow = (unsigned int)it->at(FieldRow).asInteger();
@@ -4306,8 +4456,9 @@ bool CMusicDatabase::GetPathHash(const CStdString &path, CStdString &hash)
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL=PrepareSQL("select strHash from path where strPath='%s'", path.c_str());
-    m_pDS->query(strSQL.c_str());
+    dbiplus::BindList params;
+    params.push_back(path.c_str());
+    m_pDS->query("select strHash from path where strPath=?", params);
     if (m_pDS->num_rows() == 0)
       return false;
     hash = m_pDS->fv("strHash").get_asString();
@@ -62,7 +62,10 @@ using namespace MUSICDATABASEDIRECTORY;
 using namespace MUSIC_GRABBER;
 using namespace ADDON;
 
-CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCountReader(this, "MusicFileCounter")
+// files whose tags are read at once
+#define TAG_LOAD_JOBS 4
+
+CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCountReader(this, "MusicFileCounter"), m_tagLoader(TAG_LOAD_JOBS)
 {
   m_bRunning = false;
   m_showDialog = false;
@@ -71,6 +74,7 @@ CMusicInfoScanner::CMusicInfoScanner() : CThread("MusicInfoScanner"), m_fileCoun
   m_currentItem=0;
   m_itemCount=0;
   m_flags = 0;
+  m_filesRead = 0;
 }
 
 CMusicInfoScanner::~CMusicInfoScanner()
@@ -105,6 +109,7 @@ void CMusicInfoScanner::Process()
       // Reset progress vars
       m_currentItem=0;
       m_itemCount=-1;
+      m_filesRead = 0;
 
       // Create the thread to count all files to be scanned
       SetPriority( GetMinPriority() );
@@ -137,6 +142,8 @@ void CMusicInfoScanner::Process()
           break;
         }
       }
+      // whatever was added before a cancel is kept, as it was without batches
+      CommitBatch();
 
       if (commit)
       {
@@ -165,6 +172,8 @@ void CMusicInfoScanner::Process()
       
       tick = XbmcThreads::SystemClockMillis() - tick;
       CLog::Log(LOGNOTICE, "My Music: Scanning for music info using worker thread, operation took %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
+      if (m_filesRead > 0)
+        CLog::Log(LOGNOTICE, "My Music: Read the tags of %u files, %.1f files/s", m_filesRead, m_filesRead * 1000.0f / std::max(tick, 1U));
     }
     if (m_scanType == 1) // load album info
     {
@@ -232,6 +241,7 @@ void CMusicInfoScanner::Process()
   {
     CLog::Log(LOGERROR, "MusicInfoScanner: Exception while scanning.");
   }
+  CommitBatch();
   m_musicDatabase.Close();
   CLog::Log(LOGDEBUG, "%s - Finished scan", __FUNCTION__);
   
@@ -443,6 +453,9 @@ bool CMusicInfoScanner::DoScan(const CStdString& strDirectory)
       OnDirectoryScanned(strDirectory);
     }
   }
+  // commit before moving on, the next folder is listed and its tags are read
+  // without holding the database
+  CommitBatch();
 
   // now scan the subfolders
   for (int i = 0; i < items.Size(); ++i)
@@ -469,10 +482,16 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
 {
   CStdStringArray regexps = g_advancedSettings.m_audioExcludeFromScanRegExps;
 
+  // the files read through TagLib are read a few at once on the job manager,
+  // the other loaders stay on this thread
+  vector<CFileItemPtr> tagged;
   for (int i = 0; i < items.Size(); ++i)
   {
     if (m_bStop)
+    {
+      m_tagLoader.Cancel();
       return INFO_CANCELLED;
+    }
 
     CFileItemPtr pItem = items[i];
 
@@ -483,24 +502,43 @@ INFO_RET CMusicInfoScanner::ScanTags(const CFileItemList& items, CFileItemList&
       continue;
 
     m_currentItem++;
+    tagged.push_back(pItem);
 
     CMusicInfoTag& tag = *pItem->GetMusicInfoTag();
     if (!tag.Loaded())
     {
-      auto_ptr<IMusicInfoTagLoader> pLoader (CMusicInfoTagLoaderFactory::CreateLoader(pItem->GetPath()));
-      if (NULL != pLoader.get())
+      IMusicInfoTagLoader *pLoader = CMusicInfoTagLoaderFactory::CreateLoader(pItem->GetPath());
+      if (CMusicTagLoadQueue::CanLoad(pLoader))
+        m_tagLoader.Add(pItem, pLoader);
+      else if (NULL != pLoader)
+      {
         pLoader->Load(pItem->GetPath(), tag);
+        delete pLoader;
+      }
+      m_filesRead++;
     }
+  }
 
-    if (m_handle && m_itemCount>0)
-      m_handle->SetPercentage(m_currentItem/(float)m_itemCount*100);
+  while (!m_tagLoader.Wait(100))
+  {
+    if (m_bStop)
+    {
+      m_tagLoader.Cancel();
+      return INFO_CANCELLED;
+    }
+  }
 
-    if (!tag.Loaded())
+  if (m_handle && m_itemCount>0)
+    m_handle->SetPercentage(m_currentItem/(float)m_itemCount*100);
+
+  for (vector<CFileItemPtr>::const_iterator it = tagged.begin(); it != tagged.end(); ++it)
+  {
+    if (!(*it)->GetMusicInfoTag()->Loaded())
     {
-      CLog::Log(LOGDEBUG, "%s - No tag found for: %s", __FUNCTION__, pItem->GetPath().c_str());
+      CLog::Log(LOGDEBUG, "%s - No tag found for: %s", __FUNCTION__, (*it)->GetPath().c_str());
       continue;
     }
-    scannedItems.Add(pItem);
+    scannedItems.Add(*it);
   }
   return INFO_ADDED;
 }
@@ -683,12 +721,17 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
 {
   MAPSONGS songsMap;
 
+  // read the tags before touching the database, so it isn't kept locked while waiting for the files
+  CFileItemList scannedItems;
+  INFO_RET tagsRet = ScanTags(items, scannedItems);
+
+  BeginBatch();
+
   // get all information for all files in current directory from database, and remove them
   if (m_musicDatabase.RemoveSongsFromPath(strDirectory, songsMap))
     m_needsCleanup = true;
 
-  CFileItemList scannedItems;
-  if (ScanTags(items, scannedItems) == INFO_CANCELLED || scannedItems.Size() == 0)
+  if (tagsRet == INFO_CANCELLED || scannedItems.Size() == 0)
     return 0;
 
   VECALBUMS albums;
@@ -791,6 +834,20 @@ int CMusicInfoScanner::RetrieveMusicInfo(const CStdString& strDirectory, CFileIt
   return numAdded;
 }
 
+void CMusicInfoScanner::BeginBatch()
+{
+  if ((m_flags & SCAN_ONLINE) || m_musicDatabase.InTransaction())
+    return;
+
+  m_musicDatabase.BeginTransaction();
+}
+
+void CMusicInfoScanner::CommitBatch()
+{
+  if (m_musicDatabase.InTransaction())
+    m_musicDatabase.CommitTransaction();
+}
+
 void CMusicInfoScanner::FindArtForAlbums(VECALBUMS &albums, const CStdString &path)
 {
   /*
@@ -22,6 +22,7 @@
 #include "music/MusicDatabase.h"
 #include "MusicAlbumInfo.h"
 #include "MusicInfoScraper.h"
+#include "MusicTagLoadQueue.h"
 
 class CAlbum;
 class CArtist;
@@ -187,6 +188,16 @@ protected:
 
   bool DoScan(const CStdString& strDirectory);
 
+  /*! \brief Start a transaction collecting the changes of a folder, unless one is running
+   Only started once the folder's tags are read, and not at all when scraping online,
+   so the database isn't kept locked while waiting for files or scrapers.
+   */
+  void BeginBatch();
+
+  /*! \brief Commit the running batch, if any
+   */
+  void CommitBatch();
+
   virtual void Run();
   int CountFiles(const CFileItemList& items, bool recursive);
   int CountFilesRecursively(const CStdString& strPath);
@@ -218,5 +229,8 @@ protected:
   std::set<std::string> m_pathsToScan;
   int m_flags;
   CThread m_fileCountReader;
+
+  CMusicTagLoadQueue m_tagLoader;
+  unsigned int m_filesRead;     ///< files whose tags were read during the scan
 };
 }
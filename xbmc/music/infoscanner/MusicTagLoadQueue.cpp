@@ -0,0 +1,103 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MusicTagLoadQueue.h"
+#include "music/tags/ImusicInfoTagLoader.h"
+#include "music/tags/MusicInfoTag.h"
+#include "music/tags/TagLoaderTagLib.h"
+#include "threads/SingleLock.h"
+
+using namespace MUSIC_INFO;
+
+class CMusicTagLoadJob : public CJob
+{
+public:
+  CMusicTagLoadJob(const CFileItemPtr &item, IMusicInfoTagLoader *loader)
+    : m_item(item), m_loader(loader)
+  {
+  }
+
+  virtual ~CMusicTagLoadJob()
+  {
+    delete m_loader;
+  }
+
+  virtual bool DoWork()
+  {
+    return m_loader->Load(m_item->GetPath(), *m_item->GetMusicInfoTag());
+  }
+
+private:
+  CFileItemPtr m_item;
+  IMusicInfoTagLoader *m_loader;
+};
+
+CMusicTagLoadQueue::CMusicTagLoadQueue(unsigned int jobsAtOnce)
+  : CJobQueue(false, jobsAtOnce, CJob::PRIORITY_LOW), m_pending(0)
+{
+}
+
+bool CMusicTagLoadQueue::CanLoad(const IMusicInfoTagLoader *loader)
+{
+  return dynamic_cast<const CTagLoaderTagLib *>(loader) != NULL;
+}
+
+void CMusicTagLoadQueue::Add(const CFileItemPtr &item, IMusicInfoTagLoader *loader)
+{
+  {
+    CSingleLock lock(m_pendingSection);
+    m_pending++;
+  }
+  AddJob(new CMusicTagLoadJob(item, loader));
+}
+
+bool CMusicTagLoadQueue::Wait(unsigned int milliSeconds)
+{
+  {
+    CSingleLock lock(m_pendingSection);
+    if (m_pending == 0)
+      return true;
+  }
+  m_loaded.WaitMSec(milliSeconds);
+
+  CSingleLock lock(m_pendingSection);
+  return m_pending == 0;
+}
+
+void CMusicTagLoadQueue::Cancel()
+{
+  CancelJobs();
+
+  CSingleLock lock(m_pendingSection);
+  m_pending = 0;
+}
+
+void CMusicTagLoadQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  // start the next job before counting this one as done
+  CJobQueue::OnJobComplete(jobID, success, job);
+
+  {
+    CSingleLock lock(m_pendingSection);
+    if (m_pending > 0)
+      m_pending--;
+  }
+  m_loaded.Set();
+}
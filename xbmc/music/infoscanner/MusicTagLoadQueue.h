@@ -0,0 +1,73 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+
+namespace MUSIC_INFO
+{
+class IMusicInfoTagLoader;
+
+/*! \brief Loads the tags of music files on the job manager
+
+ Reading a tag mostly means waiting for the file system, so a few files are
+ read at once while the scanner waits for all of them. The tags end up in
+ the items' music info tags, which have to be created before they are queued.
+ */
+class CMusicTagLoadQueue : public CJobQueue
+{
+public:
+  /*!
+   \param jobsAtOnce number of files read at once
+   */
+  CMusicTagLoadQueue(unsigned int jobsAtOnce);
+
+  /*! \brief Whether a loader may be run on the job manager
+   Only TagLib is known to be safe to use from several threads at once.
+   */
+  static bool CanLoad(const IMusicInfoTagLoader *loader);
+
+  /*! \brief Queue an item for loading its tag
+   \param item the file, its music info tag is filled in
+   \param loader loader to use, it's owned by the queue from now on
+   */
+  void Add(const CFileItemPtr &item, IMusicInfoTagLoader *loader);
+
+  /*! \brief Wait for the queued items to be loaded
+   \param milliSeconds time to wait at most
+   \return true if all of them are loaded
+   */
+  bool Wait(unsigned int milliSeconds);
+
+  /*! \brief Drop all items that are still queued
+   */
+  void Cancel();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+private:
+  CCriticalSection m_pendingSection;
+  unsigned int m_pending;
+  CEvent m_loaded;
+};
+}
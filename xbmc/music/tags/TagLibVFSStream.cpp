@@ -24,6 +24,8 @@
 #include "utils/log.h"
 #include <taglib/tiostream.h>
 
+#include <algorithm>
+
 using namespace XFILE;
 using namespace TagLib;
 using namespace MUSIC_INFO;
@@ -33,6 +35,10 @@ using namespace std;
 #pragma comment(lib, "tag.lib")
 #endif
 
+// tags are kept at the start and the end of files, those parts are read in one go
+#define HEAD_CACHE_SIZE (256 * 1024)
+#define TAIL_CACHE_SIZE (128 * 1024)
+
 /*!
  * Construct a File object and opens the \a file.  \a file should be a
  * be an XBMC Vfile.
@@ -52,6 +58,8 @@ TagLibVFSStream::TagLibVFSStream(const string& strFileName, bool readOnly)
   }
   m_strFileName = strFileName;
   m_bIsReadOnly = readOnly || !m_bIsOpen;
+  m_headLoaded = false;
+  m_tailLoaded = false;
 }
 
 /*!
@@ -75,11 +83,52 @@ FileName TagLibVFSStream::name() const
  */
 ByteVector TagLibVFSStream::readBlock(TagLib::ulong length)
 {
+  // TagLib reads the tags in lots of small pieces, each of them a round trip
+  // on network shares. Serve them from the start and end of the file instead.
+  if (m_bIsReadOnly && m_bIsOpen && length > 0)
+  {
+    ByteVector cached;
+    int64_t position = m_file.GetPosition();
+    int64_t fileLength = m_file.GetLength();
+    int64_t tailStart = fileLength > TAIL_CACHE_SIZE ? fileLength - TAIL_CACHE_SIZE : 0;
+    if (position >= 0 && fileLength > 0 &&
+        (ReadCached(m_head, m_headLoaded, 0, std::min<int64_t>(fileLength, HEAD_CACHE_SIZE), position, length, cached) ||
+         ReadCached(m_tail, m_tailLoaded, tailStart, fileLength - tailStart, position, length, cached)))
+      return cached;
+  }
+
   ByteVector byteVector(static_cast<TagLib::uint>(length));
   byteVector.resize(m_file.Read(byteVector.data(), length));
   return byteVector;
 }
 
+bool TagLibVFSStream::ReadCached(ByteVector &block, bool &loaded, int64_t start, int64_t size,
+                                 int64_t position, TagLib::ulong length, ByteVector &result)
+{
+  if (position < start || position + (int64_t)length > start + size)
+    return false;
+
+  if (!loaded)
+  {
+    loaded = true;
+    block.resize(static_cast<TagLib::uint>(size));
+    if (m_file.Seek(start, SEEK_SET) == start)
+      block.resize(m_file.Read(block.data(), size));
+    else
+      block.clear();
+  }
+
+  if (position + (int64_t)length > start + block.size())
+  { // short read, leave it to the file
+    m_file.Seek(position, SEEK_SET);
+    return false;
+  }
+
+  result = block.mid(static_cast<TagLib::uint>(position - start), static_cast<TagLib::uint>(length));
+  m_file.Seek(position + length, SEEK_SET);
+  return true;
+}
+
 /*!
  * Attempts to write the block \a data at the current get pointer.  If the
  * file is currently only opened read only -- i.e. readOnly() returns true --
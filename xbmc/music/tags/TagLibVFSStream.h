@@ -123,11 +123,23 @@ namespace MUSIC_INFO
     static TagLib::uint bufferSize() { return 1024; };
 
   private:
+    /*!
+     * Copies \a length bytes at \a position from a block of the file, which
+     * is read the first time it's needed.  Returns false if the block doesn't
+     * hold all of them.
+     */
+    bool ReadCached(TagLib::ByteVector &block, bool &loaded, int64_t start, int64_t size,
+                    int64_t position, TagLib::ulong length, TagLib::ByteVector &result);
+
     std::string   m_strFileName;
     XFILE::CFile  m_file;
     bool          m_bIsReadOnly;
     bool          m_bIsOpen;
     int           m_bufferSize;
+    TagLib::ByteVector m_head;  ///< start of a read only file
+    TagLib::ByteVector m_tail;  ///< end of a read only file
+    bool          m_headLoaded;
+    bool          m_tailLoaded;
   };
 }
 
@@ -308,83 +308,15 @@ void handleZeroconfAnnouncement()
 void CAirPlayServer::Process()
 {
   m_bStop = false;
-  static int sessionCounter = 0;
 
   while (!m_bStop)
   {
-    int             max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
-
-    FD_SET(m_ServerSocket, &rfds);
-    max_fd = m_ServerSocket;
-
-    for (unsigned int i = 0; i < m_connections.size(); i++)
-    {
-      FD_SET(m_connections[i].m_socket, &rfds);
-      if (m_connections[i].m_socket > max_fd)
-        max_fd = m_connections[i].m_socket;
-    }
-
-    int res = select(max_fd+1, &rfds, NULL, NULL, &to);
-    if (res < 0)
+    if (m_reactor.Dispatch(1000) < 0)
     {
-      CLog::Log(LOGERROR, "AIRPLAY Server: Select failed");
+      CLog::Log(LOGERROR, "AIRPLAY Server: Waiting for sockets failed");
       Sleep(1000);
       Initialize();
     }
-    else if (res > 0)
-    {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
-      {
-        int socket = m_connections[i].m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          if (nread > 0)
-          {
-            CStdString sessionId;
-            m_connections[i].PushBuffer(this, buffer, nread, sessionId, m_reverseSockets);
-          }
-          if (nread <= 0)
-          {
-            CSingleLock lock (m_connectionLock);
-            CLog::Log(LOGINFO, "AIRPLAY Server: Disconnection detected");
-            m_connections[i].Disconnect();
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
-      }
-
-      if (FD_ISSET(m_ServerSocket, &rfds))
-      {
-        CLog::Log(LOGDEBUG, "AIRPLAY Server: New connection detected");
-        CTCPClient newconnection;
-        newconnection.m_socket = accept(m_ServerSocket, (struct sockaddr*) &newconnection.m_cliaddr, &newconnection.m_addrlen);
-        sessionCounter++;
-        newconnection.m_sessionCounter = sessionCounter;
-
-        if (newconnection.m_socket == INVALID_SOCKET)
-        {
-          CLog::Log(LOGERROR, "AIRPLAY Server: Accept of new connection failed: %d", errno);
-          if (EBADF == errno)
-          {
-            Sleep(1000);
-            Initialize();
-            break;
-          }
-        }
-        else
-        {
-          CSingleLock lock (m_connectionLock);
-          CLog::Log(LOGINFO, "AIRPLAY Server: New connection added");
-          m_connections.push_back(newconnection);
-        }
-      }
-    }
     
     // by reannouncing the zeroconf service
     // we fix issues where xbmc is detected
@@ -396,12 +328,85 @@ void CAirPlayServer::Process()
   Deinitialize();
 }
 
+void CAirPlayServer::OnReadable(SOCKET socket)
+{
+  if (socket == m_ServerSocket)
+  {
+    Accept();
+    return;
+  }
+
+  for (int i = m_connections.size() - 1; i >= 0; i--)
+  {
+    if (m_connections[i].m_socket != socket)
+      continue;
+
+    // the connections are level triggered, responses are sent blocking
+    char buffer[RECEIVEBUFFER] = {};
+    int  nread = 0;
+    nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
+    if (nread > 0)
+    {
+      CStdString sessionId;
+      m_connections[i].PushBuffer(this, buffer, nread, sessionId, m_reverseSockets);
+    }
+    if (nread <= 0)
+    {
+      CSingleLock lock (m_connectionLock);
+      CLog::Log(LOGINFO, "AIRPLAY Server: Disconnection detected");
+      m_reactor.Remove(socket);
+      m_connections[i].Disconnect();
+      m_connections.erase(m_connections.begin() + i);
+    }
+    break;
+  }
+}
+
+void CAirPlayServer::Accept()
+{
+  static int sessionCounter = 0;
+
+  CLog::Log(LOGDEBUG, "AIRPLAY Server: New connection detected");
+  CTCPClient newconnection;
+  newconnection.m_socket = accept(m_ServerSocket, (struct sockaddr*) &newconnection.m_cliaddr, &newconnection.m_addrlen);
+  sessionCounter++;
+  newconnection.m_sessionCounter = sessionCounter;
+
+  if (newconnection.m_socket == INVALID_SOCKET)
+  {
+    CLog::Log(LOGERROR, "AIRPLAY Server: Accept of new connection failed: %d", errno);
+    if (EBADF == errno)
+    {
+      Sleep(1000);
+      Initialize();
+    }
+  }
+  else if (!m_reactor.Add(newconnection.m_socket, this, false))
+  {
+    CLog::Log(LOGERROR, "AIRPLAY Server: Failed to watch new connection");
+    newconnection.Disconnect();
+  }
+  else
+  {
+    CSingleLock lock (m_connectionLock);
+    CLog::Log(LOGINFO, "AIRPLAY Server: New connection added");
+    m_connections.push_back(newconnection);
+  }
+}
+
 bool CAirPlayServer::Initialize()
 {
   Deinitialize();
   
   if ((m_ServerSocket = CreateTCPServerSocket(m_port, !m_nonlocal, 10, "AIRPLAY")) == INVALID_SOCKET)
     return false;
+
+  if (!m_reactor.Add(m_ServerSocket, this, false))
+  {
+    close(m_ServerSocket);
+    m_ServerSocket = INVALID_SOCKET;
+    return false;
+  }
   
   CLog::Log(LOGINFO, "AIRPLAY Server: Successfully initialized");
   return true;
@@ -411,13 +416,17 @@ void CAirPlayServer::Deinitialize()
 {
   CSingleLock lock (m_connectionLock);
   for (unsigned int i = 0; i < m_connections.size(); i++)
+  {
+    m_reactor.Remove(m_connections[i].m_socket);
     m_connections[i].Disconnect();
+  }
 
   m_connections.clear();
   m_reverseSockets.clear();
 
   if (m_ServerSocket != INVALID_SOCKET)
   {
+    m_reactor.Remove(m_ServerSocket);
     shutdown(m_ServerSocket, SHUT_RDWR);
     close(m_ServerSocket);
     m_ServerSocket = INVALID_SOCKET;
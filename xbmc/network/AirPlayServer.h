@@ -32,17 +32,21 @@
 #include "utils/HttpParser.h"
 #include "utils/StdString.h"
 #include "interfaces/IAnnouncer.h"
+#include "network/SocketReactor.h"
 
 class DllLibPlist;
 
 #define AIRPLAY_SERVER_VERSION_STR "101.28"
 
-class CAirPlayServer : public CThread, public ANNOUNCEMENT::IAnnouncer
+class CAirPlayServer : public CThread, public ANNOUNCEMENT::IAnnouncer, public ISocketHandler
 {
 public:
   // IAnnouncer IF
   virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
 
+  // ISocketHandler IF
+  virtual void OnReadable(SOCKET socket);
+
   //AirPlayServer impl.
   static bool StartServer(int port, bool nonlocal);
   static void StopServer(bool bWait);
@@ -63,6 +67,7 @@ private:
   bool Initialize();
   void Deinitialize();
   void AnnounceToClients(int state);
+  void Accept();
 
   class CTCPClient
   {
@@ -102,6 +107,7 @@ private:
     CStdString m_authNonce;
   };
 
+  CSocketReactor m_reactor;
   CCriticalSection m_connectionLock;
   std::vector<CTCPClient> m_connections;
   std::map<CStdString, int> m_reverseSockets;
@@ -152,8 +152,7 @@ void CEventServer::Process()
 void CEventServer::Run()
 {
   CAddress any_addr;
-  CSocketListener listener;
-  int packetSize = 0;
+  CSocketReactor reactor;
 
   CLog::Log(LOGNOTICE, "ES: Starting UDP Event server on %s:%d", any_addr.Address(), m_iPort);
 
@@ -195,8 +194,13 @@ void CEventServer::Run()
                                m_iPort,
                                txt);
 
-  // add our socket to the 'select' listener
-  listener.AddSocket(m_pSocket);
+  // the socket is drained on every wakeup, so it doesn't have to block
+  if (!CSocketReactor::SetNonBlocking(m_pSocket->Socket()) ||
+      !reactor.Add(m_pSocket->Socket(), this))
+  {
+    CLog::Log(LOGERROR, "ES: Could not watch socket");
+    return;
+  }
 
   m_bRunning = true;
 
@@ -205,14 +209,8 @@ void CEventServer::Run()
     try
     {
       // start listening until we timeout
-      if (listener.Listen(m_iListenTimeout))
-      {
-        CAddress addr;
-        if ((packetSize = m_pSocket->Read(addr, PACKET_SIZE, (void *)m_pPacketBuffer)) > -1)
-        {
-          ProcessPacket(addr, packetSize);
-        }
-      }
+      if (reactor.Dispatch(m_iListenTimeout) < 0)
+        CLog::Log(LOGERROR, "ES: Waiting for socket failed");
     }
     catch (...)
     {
@@ -231,10 +229,26 @@ void CEventServer::Run()
   }
 
   CLog::Log(LOGNOTICE, "ES: UDP Event server stopped");
+  reactor.Remove(m_pSocket->Socket());
   m_bRunning = false;
   Cleanup();
 }
 
+void CEventServer::OnReadable(SOCKET socket)
+{
+  // read every packet that arrived since the last wakeup
+  while (true)
+  {
+    CAddress addr;
+    int packetSize = m_pSocket->Read(addr, PACKET_SIZE, (void *)m_pPacketBuffer);
+    if (packetSize < 0 && CSocketReactor::Interrupted())
+      continue;
+    if (packetSize < 0)
+      break;
+    ProcessPacket(addr, packetSize);
+  }
+}
+
 void CEventServer::ProcessPacket(CAddress& addr, int pSize)
 {
   // check packet validity
@@ -23,6 +23,7 @@
 
 #include "threads/Thread.h"
 #include "Socket.h"
+#include "SocketReactor.h"
 #include "EventClient.h"
 #include "threads/CriticalSection.h"
 #include "threads/SingleLock.h"
@@ -37,7 +38,7 @@ namespace EVENTSERVER
   /**********************************************************************/
   /* UDP Event Server Class                                             */
   /**********************************************************************/
-  class CEventServer : private CThread
+  class CEventServer : private CThread, private ISocketHandler
   {
   public:
     static void RemoveInstance();
@@ -75,6 +76,7 @@ namespace EVENTSERVER
     void ProcessPacket(SOCKETS::CAddress& addr, int packetSize);
     void ProcessEvents();
     void RefreshClients();
+    virtual void OnReadable(SOCKET socket);
 
     std::map<unsigned long, EVENTCLIENT::CEventClient*>  m_clients;
     static CEventServer* m_pInstance;
@@ -0,0 +1,294 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "SocketReactor.h"
+#include "threads/SingleLock.h"
+#include "utils/log.h"
+
+#include <errno.h>
+#include <vector>
+
+#if defined(TARGET_LINUX)
+#define HAS_EPOLL
+#include <sys/epoll.h>
+#endif
+
+#ifndef TARGET_WINDOWS
+#include <fcntl.h>
+#endif
+
+#define REACTOR_MAX_EVENTS 64
+/* a client that doesn't read its responses is dropped beyond this */
+#define WRITE_QUEUE_LIMIT  (32 * 1024 * 1024)
+/* queued chunks below this size are merged */
+#define WRITE_CHUNK_MERGE  (16 * 1024)
+
+CSocketReactor::CSocketReactor()
+{
+  m_epoll = -1;
+#ifdef HAS_EPOLL
+  m_epoll = epoll_create(REACTOR_MAX_EVENTS);
+  if (m_epoll < 0)
+    CLog::Log(LOGERROR, "CSocketReactor: epoll_create failed with %d, using select", errno);
+#endif
+}
+
+CSocketReactor::~CSocketReactor()
+{
+#ifdef HAS_EPOLL
+  if (m_epoll >= 0)
+    close(m_epoll);
+#endif
+}
+
+bool CSocketReactor::Add(SOCKET socket, ISocketHandler *handler, bool edgeTriggered)
+{
+  CSingleLock lock(m_section);
+  Entry entry;
+  entry.handler       = handler;
+  entry.edgeTriggered = edgeTriggered;
+  entry.watchWrite    = false;
+
+#ifdef HAS_EPOLL
+  if (m_epoll >= 0)
+  {
+    struct epoll_event event = {};
+    event.events  = EPOLLIN | (edgeTriggered ? EPOLLET : 0);
+    event.data.fd = socket;
+    if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) < 0)
+    {
+      CLog::Log(LOGERROR, "CSocketReactor: Failed to add socket %d, error %d", (int)socket, errno);
+      return false;
+    }
+  }
+#endif
+
+  m_sockets[socket] = entry;
+  return true;
+}
+
+void CSocketReactor::Remove(SOCKET socket)
+{
+  CSingleLock lock(m_section);
+  if (m_sockets.erase(socket) == 0)
+    return;
+
+#ifdef HAS_EPOLL
+  if (m_epoll >= 0)
+  {
+    struct epoll_event event = {};
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, &event);
+  }
+#endif
+}
+
+void CSocketReactor::WatchWrite(SOCKET socket, bool watch)
+{
+  CSingleLock lock(m_section);
+  std::map<SOCKET, Entry>::iterator it = m_sockets.find(socket);
+  if (it == m_sockets.end() || it->second.watchWrite == watch)
+    return;
+  it->second.watchWrite = watch;
+
+#ifdef HAS_EPOLL
+  if (m_epoll >= 0)
+  {
+    struct epoll_event event = {};
+    event.events  = EPOLLIN | (watch ? EPOLLOUT : 0) | (it->second.edgeTriggered ? EPOLLET : 0);
+    event.data.fd = socket;
+    epoll_ctl(m_epoll, EPOLL_CTL_MOD, socket, &event);
+  }
+#endif
+}
+
+bool CSocketReactor::Handler(SOCKET socket, ISocketHandler *&handler)
+{
+  // a handler may have removed sockets reported in the same batch
+  CSingleLock lock(m_section);
+  std::map<SOCKET, Entry>::iterator it = m_sockets.find(socket);
+  if (it == m_sockets.end())
+    return false;
+  handler = it->second.handler;
+  return true;
+}
+
+int CSocketReactor::Dispatch(int timeoutMs)
+{
+#ifdef HAS_EPOLL
+  if (m_epoll >= 0)
+  {
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    int count = epoll_wait(m_epoll, events, REACTOR_MAX_EVENTS, timeoutMs);
+    if (count < 0)
+      return errno == EINTR ? 0 : -1;
+
+    for (int i = 0; i < count; i++)
+    {
+      SOCKET socket = events[i].data.fd;
+      ISocketHandler *handler;
+      // errors and hangups are reported as readable, the read tells what happened
+      if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+      {
+        if (Handler(socket, handler))
+          handler->OnReadable(socket);
+      }
+      if (events[i].events & EPOLLOUT)
+      {
+        if (Handler(socket, handler))
+          handler->OnWritable(socket);
+      }
+    }
+    return count;
+  }
+#endif
+
+  fd_set rfds, wfds;
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+  SOCKET max_fd = 0;
+  std::vector<SOCKET> sockets;
+  {
+    CSingleLock lock(m_section);
+    for (std::map<SOCKET, Entry>::iterator it = m_sockets.begin(); it != m_sockets.end(); ++it)
+    {
+      FD_SET(it->first, &rfds);
+      if (it->second.watchWrite)
+        FD_SET(it->first, &wfds);
+      if ((intptr_t)it->first > (intptr_t)max_fd)
+        max_fd = it->first;
+      sockets.push_back(it->first);
+    }
+  }
+
+  struct timeval to = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+  int count = select((intptr_t)max_fd + 1, &rfds, &wfds, NULL, timeoutMs < 0 ? NULL : &to);
+  if (count < 0 && Interrupted())
+    return 0;
+  if (count <= 0)
+    return count;
+
+  for (std::vector<SOCKET>::iterator it = sockets.begin(); it != sockets.end(); ++it)
+  {
+    ISocketHandler *handler;
+    if (FD_ISSET(*it, &rfds) && Handler(*it, handler))
+      handler->OnReadable(*it);
+    if (FD_ISSET(*it, &wfds) && Handler(*it, handler))
+      handler->OnWritable(*it);
+  }
+  return count;
+}
+
+bool CSocketReactor::SetNonBlocking(SOCKET socket)
+{
+#ifdef TARGET_WINDOWS
+  u_long nonblocking = 1;
+  return ioctlsocket(socket, FIONBIO, &nonblocking) == 0;
+#else
+  return fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) == 0;
+#endif
+}
+
+bool CSocketReactor::WouldBlock()
+{
+#ifdef TARGET_WINDOWS
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+bool CSocketReactor::Interrupted()
+{
+#ifdef TARGET_WINDOWS
+  return WSAGetLastError() == WSAEINTR;
+#else
+  return errno == EINTR;
+#endif
+}
+
+CSocketWriteQueue::CSocketWriteQueue()
+{
+  m_offset = 0;
+  m_queued = 0;
+}
+
+bool CSocketWriteQueue::Send(SOCKET socket, const char *data, size_t size)
+{
+  // nothing may overtake queued data
+  if (m_chunks.empty())
+  {
+    while (size > 0)
+    {
+      int sent = send(socket, data, (int)size, 0);
+      if (sent < 0 && CSocketReactor::Interrupted())
+        continue;
+      if (sent < 0)
+      {
+        if (!CSocketReactor::WouldBlock())
+          return false;
+        break;
+      }
+      data += sent;
+      size -= sent;
+    }
+  }
+
+  if (size == 0)
+    return true;
+
+  if (m_queued + size > WRITE_QUEUE_LIMIT)
+    return false;
+
+  if (!m_chunks.empty() && m_chunks.back().size() + size <= WRITE_CHUNK_MERGE)
+    m_chunks.back().append(data, size);
+  else
+    m_chunks.push_back(std::string(data, size));
+  m_queued += size;
+  return true;
+}
+
+bool CSocketWriteQueue::Flush(SOCKET socket)
+{
+  while (!m_chunks.empty())
+  {
+    const std::string &chunk = m_chunks.front();
+    int sent = send(socket, chunk.c_str() + m_offset, (int)(chunk.size() - m_offset), 0);
+    if (sent < 0 && CSocketReactor::Interrupted())
+      continue;
+    if (sent < 0)
+      return CSocketReactor::WouldBlock();
+
+    m_offset += sent;
+    m_queued -= sent;
+    if (m_offset == chunk.size())
+    {
+      m_chunks.pop_front();
+      m_offset = 0;
+    }
+  }
+  return true;
+}
+
+void CSocketWriteQueue::Clear()
+{
+  m_chunks.clear();
+  m_offset = 0;
+  m_queued = 0;
+}
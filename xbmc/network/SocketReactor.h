@@ -0,0 +1,140 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "system.h"
+#include "threads/CriticalSection.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <sys/socket.h>
+
+/*!
+ \brief Receives the events of the sockets registered with a CSocketReactor
+ */
+class ISocketHandler
+{
+public:
+  virtual ~ISocketHandler() {}
+
+  /*!
+   \brief The socket has data to read, a connection to accept or was closed
+   For edge triggered sockets this is only called again once new data arrived,
+   so the handler has to read until the socket would block.
+   */
+  virtual void OnReadable(SOCKET socket) = 0;
+  /*!
+   \brief The socket takes data again, only called while watched with WatchWrite()
+   */
+  virtual void OnWritable(SOCKET socket) {}
+};
+
+/*!
+ \brief Waits for events on many sockets at once
+
+ Uses epoll on Linux, so the cost of a wait doesn't grow with the number of idle
+ connections and there is no limit on the socket numbers. Other platforms fall
+ back to select(). The sockets are registered once instead of being collected
+ before every wait.
+
+ Dispatch() is meant to be called from a single thread, the one running the
+ server. Add(), Remove() and WatchWrite() may be called from any thread.
+ */
+class CSocketReactor
+{
+public:
+  CSocketReactor();
+  ~CSocketReactor();
+
+  /*!
+   \brief Registers a socket for read events
+   \param edgeTriggered Only report new data, the socket has to be non-blocking
+   */
+  bool Add(SOCKET socket, ISocketHandler *handler, bool edgeTriggered = true);
+  void Remove(SOCKET socket);
+  /*!
+   \brief Also reports when the socket takes data, used while a write queue isn't empty
+   */
+  void WatchWrite(SOCKET socket, bool watch);
+
+  /*!
+   \brief Waits for events and passes them to the handlers
+   \param timeoutMs Longest wait, -1 to wait forever
+   \return The number of events, -1 if waiting failed
+   */
+  int Dispatch(int timeoutMs);
+
+  static bool SetNonBlocking(SOCKET socket);
+  /*!
+   \brief Whether the last socket call failed only because it would have blocked
+   */
+  static bool WouldBlock();
+  /*!
+   \brief Whether the last socket call was interrupted by a signal and has to be repeated
+   An edge triggered socket isn't reported again, so the read can't wait for the next event.
+   */
+  static bool Interrupted();
+
+private:
+  struct Entry
+  {
+    ISocketHandler *handler;
+    bool edgeTriggered;
+    bool watchWrite;
+  };
+
+  bool Handler(SOCKET socket, ISocketHandler *&handler);
+
+  int m_epoll;
+  std::map<SOCKET, Entry> m_sockets;
+  CCriticalSection m_section;
+};
+
+/*!
+ \brief Data waiting to be sent on a non-blocking socket
+
+ Data is sent straight from the buffer of the caller, only what the socket
+ doesn't take right away is copied into the queue. The queue itself doesn't
+ lock, it belongs to the connection and is guarded by its lock.
+ */
+class CSocketWriteQueue
+{
+public:
+  CSocketWriteQueue();
+
+  /*!
+   \brief Sends what the socket takes, queues the rest behind already queued data
+   \return false if the socket failed or the queue outgrew its limit
+   */
+  bool Send(SOCKET socket, const char *data, size_t size);
+  /*!
+   \brief Sends as much of the queued data as the socket takes
+   \return false if the socket failed
+   */
+  bool Flush(SOCKET socket);
+  bool Empty() const { return m_chunks.empty(); }
+  void Clear();
+
+private:
+  std::deque<std::string> m_chunks;
+  size_t m_offset;  ///< bytes of the first chunk already sent
+  size_t m_queued;
+};
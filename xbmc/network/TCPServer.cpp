@@ -22,6 +22,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <memory>
+#include <algorithm>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
@@ -30,6 +32,7 @@
 #include "interfaces/AnnouncementManager.h"
 #include "utils/log.h"
 #include "utils/Variant.h"
+#include "utils/VariantStreamWriter.h"
 #include "threads/SingleLock.h"
 #include "websocket/WebSocketManager.h"
 #include "Network.h"
@@ -56,6 +59,8 @@ using namespace ANNOUNCEMENT;
 //using namespace std; On VS2010, bind conflicts with std::bind
 
 #define RECEIVEBUFFER 1024
+#define SENDBUFFER    16384
+#define ACCEPT_RETRY  500
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -99,6 +104,7 @@ CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer")
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+  m_acceptPaused = false;
 }
 
 void CTCPServer::Process()
@@ -107,110 +113,159 @@ void CTCPServer::Process()
 
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
+    int timeout = 1000;
+    if (m_acceptPaused)
+      timeout = std::min(timeout, (int)m_acceptRetry.MillisLeft());
 
-    for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+    // the sockets stay registered, every event goes to OnReadable or OnWritable
+    if (m_reactor.Dispatch(timeout) < 0)
     {
-      FD_SET(*it, &rfds);
-      if ((intptr_t)*it > (intptr_t)max_fd)
-        max_fd = *it;
+      CLog::Log(LOGERROR, "JSONRPC Server: Waiting for sockets failed");
+      Sleep(1000);
+      Initialize();
     }
 
-    for (unsigned int i = 0; i < m_connections.size(); i++)
+    if (m_acceptPaused && m_acceptRetry.IsTimePast())
     {
-      FD_SET(m_connections[i]->m_socket, &rfds);
-      if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i]->m_socket;
+      m_acceptPaused = false;
+      std::vector<SOCKET> servers(m_servers);
+      for (std::vector<SOCKET>::iterator it = servers.begin(); it != servers.end() && !m_acceptPaused; ++it)
+        Accept(*it);
     }
+  }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
-    if (res < 0)
-    {
-      CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
-      Sleep(1000);
-      Initialize();
-    }
-    else if (res > 0)
+  Deinitialize();
+}
+
+void CTCPServer::OnReadable(SOCKET socket)
+{
+  if (std::find(m_servers.begin(), m_servers.end(), socket) != m_servers.end())
+  {
+    Accept(socket);
+    return;
+  }
+
+  int index = FindConnection(socket);
+  if (index >= 0)
+    Receive(index);
+}
+
+void CTCPServer::OnWritable(SOCKET socket)
+{
+  int index = FindConnection(socket);
+  if (index >= 0)
+    m_connections[index]->Flush();
+}
+
+int CTCPServer::FindConnection(SOCKET socket) const
+{
+  for (unsigned int i = 0; i < m_connections.size(); i++)
+  {
+    if (m_connections[i]->m_socket == socket)
+      return i;
+  }
+  return -1;
+}
+
+void CTCPServer::Receive(int i)
+{
+  SOCKET socket = m_connections[i]->m_socket;
+  bool close = false;
+
+  // the socket is edge triggered, so read everything there is
+  while (!close)
+  {
+    char buffer[RECEIVEBUFFER] = {};
+    int  nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
+    if (nread < 0 && CSocketReactor::Interrupted())
+      continue;
+    if (nread < 0 && CSocketReactor::WouldBlock())
+      break;
+
+    if (nread > 0)
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
+      std::string response;
+      if (m_connections[i]->IsNew())
       {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
+        CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
+
+        if (response.size() > 0)
+          m_connections[i]->Send(response.c_str(), response.size());
+
+        if (websocket != NULL)
         {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (response.size() > 0)
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-            close = m_connections[i]->Closing();
-          }
-          else
-            close = true;
-
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
+          // Replace the CTCPClient with a CWebSocketClient
+          CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
+          delete m_connections[i];
+          m_connections[i] = websocketClient;
         }
       }
 
-      for (std::vector<SOCKET>::iterator it = m_servers.begin(); it != m_servers.end(); it++)
+      if (response.size() <= 0)
+        m_connections[i]->PushBuffer(this, buffer, nread);
+
+      close = m_connections[i]->Closing();
+    }
+    else
+      close = true;
+  }
+
+  if (close)
+  {
+    CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+    m_connections[i]->Disconnect();
+    delete m_connections[i];
+    m_connections.erase(m_connections.begin() + i);
+  }
+}
+
+void CTCPServer::Accept(SOCKET server)
+{
+  // take every pending connection, the listening socket is edge triggered too
+  while (true)
+  {
+    CTCPClient *newconnection = new CTCPClient();
+    newconnection->m_socket = accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+    if (newconnection->m_socket == INVALID_SOCKET)
+    {
+      delete newconnection;
+      if (CSocketReactor::Interrupted() || errno == ECONNABORTED)
+        continue;
+      if (CSocketReactor::WouldBlock())
+        break;
+
+      if (errno == EMFILE || errno == ENFILE)
       {
-        if (FD_ISSET(*it, &rfds))
-        {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket = accept(*it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-          {
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
-            if (EBADF == errno)
-            {
-              Sleep(1000);
-              Initialize();
-              break;
-            }
-          }
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
-        }
+        // the backlog stays pending without a new event, Process() accepts it once we have descriptors again
+        CLog::Log(LOGWARNING, "JSONRPC Server: Out of descriptors, retrying accept in %d ms", ACCEPT_RETRY);
+        m_acceptRetry.Set(ACCEPT_RETRY);
+        m_acceptPaused = true;
+        break;
+      }
+
+      CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
+      if (EBADF == errno)
+      {
+        Sleep(1000);
+        Initialize();
       }
+      break;
     }
-  }
 
-  Deinitialize();
+    CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+    if (!CSocketReactor::SetNonBlocking(newconnection->m_socket) || !m_reactor.Add(newconnection->m_socket, this))
+    {
+      CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch new connection");
+      newconnection->Disconnect();
+      delete newconnection;
+      continue;
+    }
+
+    CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+    newconnection->m_reactor = &m_reactor;
+    m_connections.push_back(newconnection);
+  }
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -230,17 +285,32 @@ int CTCPServer::GetCapabilities()
 
 void CTCPServer::Announce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
 {
-  std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, g_advancedSettings.m_jsonOutputCompact);
+  CVariant root;
+  IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, root);
 
+  // every encoding is only used once no matter how many clients asked for it
+  std::string encoded[ResponseEncodingCBOR + 1];
   for (unsigned int i = 0; i < m_connections.size(); i++)
   {
+    ResponseEncoding encoding;
     {
       CSingleLock lock (m_connections[i]->m_critSection);
       if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
         continue;
+      encoding = m_connections[i]->GetResponseEncoding();
+    }
+
+    if (encoded[encoding].empty())
+    {
+      std::auto_ptr<IVariantEncoder> encoder(CJSONRPC::CreateEncoder(encoding));
+      if (!CVariantStreamWriter::Write(root, *encoder, encoded[encoding]))
+      {
+        encoded[encoding].clear();
+        continue;
+      }
     }
 
-    m_connections[i]->Send(str.c_str(), str.size());
+    m_connections[i]->SendEncoded(encoded[encoding]);
   }
 }
 
@@ -305,7 +375,8 @@ bool CTCPServer::InitializeBlue()
     return false;
   }
 
-  m_servers.push_back(fd);
+  if (!AddServer(fd))
+    return false;
 
   CSADDR_INFO addrinfo;
   addrinfo.iProtocol   = BTHPROTO_RFCOMM;
@@ -436,9 +507,7 @@ bool CTCPServer::InitializeBlue()
   }
 
   m_sdpd = session;
-  m_servers.push_back(fd);
-
-  return true;
+  return AddServer(fd);
 #endif
   return false;
 }
@@ -452,6 +521,18 @@ bool CTCPServer::InitializeTCP()
   if ((fd = CreateTCPServerSocket(m_port, !m_nonlocal, 10, "JSONRPC")) == INVALID_SOCKET)
     return false;
 
+  return AddServer(fd);
+}
+
+bool CTCPServer::AddServer(SOCKET fd)
+{
+  if (!CSocketReactor::SetNonBlocking(fd) || !m_reactor.Add(fd, this))
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch server socket");
+    closesocket(fd);
+    return false;
+  }
+
   m_servers.push_back(fd);
   return true;
 }
@@ -467,7 +548,10 @@ void CTCPServer::Deinitialize()
   m_connections.clear();
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
+  {
+    m_reactor.Remove(m_servers[i]);
     closesocket(m_servers[i]);
+  }
 
   m_servers.clear();
 
@@ -484,7 +568,9 @@ CTCPServer::CTCPClient::CTCPClient()
 {
   m_new = true;
   m_announcementflags = ANNOUNCE_ALL;
+  m_encoding = ResponseEncodingJSON;
   m_socket = INVALID_SOCKET;
+  m_reactor = NULL;
   m_beginBrackets = 0;
   m_endBrackets = 0;
   m_beginChar = 0;
@@ -520,14 +606,69 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
   return true;
 }
 
+ResponseEncoding CTCPServer::CTCPClient::GetResponseEncoding()
+{
+  return m_encoding;
+}
+
+bool CTCPServer::CTCPClient::SetResponseEncoding(ResponseEncoding encoding)
+{
+  m_encoding = encoding;
+  return true;
+}
+
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  // whatever the socket doesn't take now is sent once it's writable again
+  if (!m_writeQueue.Send(m_socket, data, size))
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data + sent, size - sent, 0);
-  } while (sent < size);
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to send to client, closing the connection");
+    m_writeQueue.Clear();
+    shutdown(m_socket, SHUT_RDWR);
+    return;
+  }
+
+  if (!m_writeQueue.Empty() && m_reactor)
+    m_reactor->WatchWrite(m_socket, true);
+}
+
+void CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  if (!m_writeQueue.Flush(m_socket))
+  {
+    m_writeQueue.Clear();
+    shutdown(m_socket, SHUT_RDWR);
+  }
+
+  if (m_writeQueue.Empty() && m_reactor)
+    m_reactor->WatchWrite(m_socket, false);
+}
+
+void CTCPServer::CTCPClient::SendResponse(const CVariant &response)
+{
+  // serialize the response chunk by chunk into the socket instead of
+  // rendering the whole response into a string first
+  CVariantStreamWriter writer(response, CJSONRPC::CreateEncoder(m_encoding));
+  char buffer[SENDBUFFER];
+  int length;
+  while ((length = writer.Read(buffer, SENDBUFFER)) > 0)
+    Send(buffer, (unsigned int)length);
+
+  if (length < 0)
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to encode response");
+}
+
+void CTCPServer::CTCPClient::SendEncoded(const std::string &data)
+{
+  Send(data.c_str(), data.size());
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -558,8 +699,9 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
         m_endBrackets++;
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
-        Send(line.c_str(), line.size());
+        CVariant response;
+        if (CJSONRPC::MethodCall(m_buffer, host, this, response))
+          SendResponse(response);
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
@@ -572,6 +714,9 @@ void CTCPServer::CTCPClient::Disconnect()
   if (m_socket > 0)
   {
     CSingleLock lock (m_critSection);
+    if (m_reactor)
+      m_reactor->Remove(m_socket);
+    m_writeQueue.Clear();
     shutdown(m_socket, SHUT_RDWR);
     closesocket(m_socket);
     m_socket = INVALID_SOCKET;
@@ -582,14 +727,17 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
 {
   m_new               = client.m_new;
   m_socket            = client.m_socket;
+  m_reactor           = client.m_reactor;
   m_cliaddr           = client.m_cliaddr;
   m_addrlen           = client.m_addrlen;
   m_announcementflags = client.m_announcementflags;
+  m_encoding          = client.m_encoding;
   m_beginBrackets     = client.m_beginBrackets;
   m_endBrackets       = client.m_endBrackets;
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_writeQueue        = client.m_writeQueue;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -625,7 +773,31 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
 
 void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 {
-  const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
+  SendFrame(WebSocketTextFrame, data, size);
+}
+
+void CTCPServer::CWebSocketClient::SendResponse(const CVariant &response)
+{
+  // a websocket message has to be framed as a whole
+  std::string data;
+  std::auto_ptr<IVariantEncoder> encoder(CJSONRPC::CreateEncoder(GetResponseEncoding()));
+  if (!CVariantStreamWriter::Write(response, *encoder, data))
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to encode response");
+    return;
+  }
+
+  SendEncoded(data);
+}
+
+void CTCPServer::CWebSocketClient::SendEncoded(const std::string &data)
+{
+  SendFrame(GetResponseEncoding() == ResponseEncodingCBOR ? WebSocketBinaryFrame : WebSocketTextFrame, data.c_str(), data.size());
+}
+
+void CTCPServer::CWebSocketClient::SendFrame(WebSocketFrameOpcode opcode, const char *data, unsigned int size)
+{
+  const CWebSocketMessage *msg = m_websocket->Send(opcode, data, size);
   if (msg == NULL || !msg->IsComplete())
     return;
 
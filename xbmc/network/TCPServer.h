@@ -26,12 +26,14 @@
 #include "interfaces/json-rpc/IJSONRPCAnnouncer.h"
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
+#include "threads/SystemClock.h"
 #include "threads/Thread.h"
 #include "websocket/WebSocket.h"
+#include "SocketReactor.h"
 
 namespace JSONRPC
 {
-  class CTCPServer : public ITransportLayer, public JSONRPC::IJSONRPCAnnouncer, public CThread
+  class CTCPServer : public ITransportLayer, public JSONRPC::IJSONRPCAnnouncer, public CThread, public ISocketHandler
   {
   public:
     static bool StartServer(int port, bool nonlocal);
@@ -43,6 +45,9 @@ namespace JSONRPC
     virtual int GetCapabilities();
 
     virtual void Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data);
+
+    virtual void OnReadable(SOCKET socket);
+    virtual void OnWritable(SOCKET socket);
   protected:
     void Process();
   private:
@@ -51,6 +56,10 @@ namespace JSONRPC
     bool InitializeBlue();
     bool InitializeTCP();
     void Deinitialize();
+    bool AddServer(SOCKET fd);
+    void Accept(SOCKET server);
+    int FindConnection(SOCKET socket) const;
+    void Receive(int index);
 
     class CTCPClient : public IClient
     {
@@ -65,10 +74,24 @@ namespace JSONRPC
       virtual int  GetPermissionFlags();
       virtual int  GetAnnouncementFlags();
       virtual bool SetAnnouncementFlags(int flags);
+      virtual ResponseEncoding GetResponseEncoding();
+      virtual bool SetResponseEncoding(ResponseEncoding encoding);
 
       virtual void Send(const char *data, unsigned int size);
+      /*!
+       \brief Encodes the response in the encoding of the client and sends it
+       */
+      virtual void SendResponse(const CVariant &response);
+      /*!
+       \brief Sends a message which has already been encoded in the encoding of the client
+       */
+      virtual void SendEncoded(const std::string &data);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
+      /*!
+       \brief Sends the data the socket didn't take before, once it's writable again
+       */
+      void Flush();
 
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
@@ -77,15 +100,18 @@ namespace JSONRPC
       sockaddr_storage m_cliaddr;
       socklen_t        m_addrlen;
       CCriticalSection m_critSection;
+      CSocketReactor  *m_reactor;
 
     protected:
       void Copy(const CTCPClient& client);
     private:
       bool m_new;
       int m_announcementflags;
+      ResponseEncoding m_encoding;
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      CSocketWriteQueue m_writeQueue;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -98,6 +124,8 @@ namespace JSONRPC
       ~CWebSocketClient();
 
       virtual void Send(const char *data, unsigned int size);
+      virtual void SendResponse(const CVariant &response);
+      virtual void SendEncoded(const std::string &data);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
 
@@ -105,11 +133,16 @@ namespace JSONRPC
       virtual bool Closing() const { return m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed; }
 
     private:
+      void SendFrame(WebSocketFrameOpcode opcode, const char *data, unsigned int size);
+
       CWebSocket *m_websocket;
     };
 
+    CSocketReactor m_reactor;
     std::vector<CTCPClient*> m_connections;
     std::vector<SOCKET> m_servers;
+    bool m_acceptPaused;                 ///< accept ran out of descriptors, retried at m_acceptRetry
+    XbmcThreads::EndTime m_acceptRetry;
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
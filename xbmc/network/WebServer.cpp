@@ -33,6 +33,7 @@
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 #include <boost/make_shared.hpp>
+#include "filesystem/SpecialProtocol.h"
 
 //#define WEBSERVER_DEBUG
 
@@ -41,12 +42,25 @@
 #endif
 
 #define MAX_POST_BUFFER_SIZE 2048
+#define STREAM_BLOCK_SIZE    32 * 1024
+
+#ifndef MHD_SIZE_UNKNOWN
+#define MHD_SIZE_UNKNOWN     -1
+#endif
 
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
 
 #define CONTENT_RANGE_FORMAT  "bytes %" PRId64 "-%" PRId64 "/%" PRId64
 
+// mhd sends file descriptor responses with sendfile() where it can
+#if defined(TARGET_POSIX) && (MHD_VERSION >= 0x00090500)
+#define HAS_FD_RESPONSE
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
 using namespace XFILE;
 using namespace std;
 using namespace JSONRPC;
@@ -61,6 +75,7 @@ typedef struct {
   bool boundaryWritten;
   string contentType;
   int64_t writePosition;
+  int fd;
 } HttpFileDownloadContext;
 
 vector<IHTTPRequestHandler *> CWebServer::m_requestHandlers;
@@ -333,6 +348,10 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
       ret = CreateMemoryDownloadResponse(request.connection, handler->GetHTTPResponseData(), handler->GetHTTPResonseDataLength(), true, true, response);
       break;
 
+    case HTTPStreamDownload:
+      ret = CreateStreamDownloadResponse(request.connection, handler->GetHTTPResponseReader(), response);
+      break;
+
     case HTTPError:
       ret = CreateErrorResponse(request.connection, handler->GetHTTPResonseCode(), request.method, response);
       break;
@@ -423,6 +442,7 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
       context->contentType = mimeType;
       context->boundaryWritten = false;
       context->writePosition = 0;
+      context->fd = -1;
 
       if (methodType == GET)
       {
@@ -524,15 +544,50 @@ int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, co
         // set the initial write position
         context->writePosition = context->ranges.begin()->first;
 
-        // create the response object
-        response = MHD_create_response_from_callback(totalLength,
-                                                     2048,
-                                                     &CWebServer::ContentReaderCallback, context.get(),
-                                                     &CWebServer::ContentReaderFreeCallback);
-        if (response == NULL)
-          return MHD_NO;
-        
-        context.release(); // ownership was passed to mhd
+        int fd = OpenLocalFile(strURL);
+#ifdef HAS_FD_RESPONSE
+        bool fdResponse = fd >= 0 && context->rangeCount == 1;
+#if (MHD_VERSION < 0x00094400)
+        // older mhd takes a size_t length and an off_t offset, mhd itself may have been
+        // built with a 32 bit off_t, so larger ranges go through the callback
+        fdResponse = fdResponse && (uint64_t)context->rangesLength <= (size_t)-1 &&
+                     context->writePosition + context->rangesLength <= LONG_MAX;
+#endif
+        if (fdResponse)
+        {
+          // a single range of a local file is sent by the kernel straight from
+          // the page cache, mhd closes the descriptor with the response
+#if (MHD_VERSION >= 0x00094400)
+          response = MHD_create_response_from_fd_at_offset64(context->rangesLength, fd, context->writePosition);
+#else
+          response = MHD_create_response_from_fd_at_offset((size_t)context->rangesLength, fd, (off_t)context->writePosition);
+#endif
+          if (response == NULL)
+          {
+            CloseLocalFile(fd);
+            return MHD_NO;
+          }
+        }
+        else
+#endif
+        {
+          // multiple ranges need the boundaries in between, so they are read
+          // into mhd's buffer, from the descriptor if there is one
+          context->fd = fd;
+
+          // create the response object
+          response = MHD_create_response_from_callback(totalLength,
+                                                       2048,
+                                                       &CWebServer::ContentReaderCallback, context.get(),
+                                                       &CWebServer::ContentReaderFreeCallback);
+          if (response == NULL)
+          {
+            CloseLocalFile(fd);
+            return MHD_NO;
+          }
+
+          context.release(); // ownership was passed to mhd
+        }
       }
 
       // add Content-Range header
@@ -616,6 +671,23 @@ int CWebServer::CreateMemoryDownloadResponse(struct MHD_Connection *connection,
   return MHD_NO;
 }
 
+int CWebServer::CreateStreamDownloadResponse(struct MHD_Connection *connection, IHTTPResponseReader *reader, struct MHD_Response *&response)
+{
+  if (reader == NULL)
+    return MHD_NO;
+
+  // the body is produced while mhd sends it, so its length isn't known upfront
+  response = MHD_create_response_from_callback(MHD_SIZE_UNKNOWN,
+                                               STREAM_BLOCK_SIZE,
+                                               &CWebServer::StreamReaderCallback, reader,
+                                               &CWebServer::StreamReaderFreeCallback);
+  if (response)
+    return MHD_YES;
+
+  delete reader;
+  return MHD_NO;
+}
+
 int CWebServer::SendErrorResponse(struct MHD_Connection *connection, int errorType, HTTPMethod method)
 {
   struct MHD_Response *response = NULL;
@@ -696,12 +768,25 @@ int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
   // adjust the maximum number of read bytes
   maximum = std::min(maximum, end - context->writePosition + 1);
 
-  // seek to the position if necessary
-  if(context->writePosition != context->file->GetPosition())
-    context->file->Seek(context->writePosition);
+  unsigned int res = 0;
+#ifdef HAS_FD_RESPONSE
+  if (context->fd >= 0)
+  {
+    // positioned read, no need to go through the vfs and seek
+    ssize_t read = pread(context->fd, buf, (size_t)maximum, context->writePosition);
+    if (read > 0)
+      res = (unsigned int)read;
+  }
+  else
+#endif
+  {
+    // seek to the position if necessary
+    if(context->writePosition != context->file->GetPosition())
+      context->file->Seek(context->writePosition);
 
-  // read data from the file
-  unsigned int res = context->file->Read(buf, maximum);
+    // read data from the file
+    res = context->file->Read(buf, maximum);
+  }
   if (res == 0)
     return -1;
 
@@ -727,6 +812,8 @@ int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
 void CWebServer::ContentReaderFreeCallback(void *cls)
 {
   HttpFileDownloadContext *context = (HttpFileDownloadContext *)cls;
+  if (context != NULL)
+    CloseLocalFile(context->fd);
   delete context;
 
 #ifdef WEBSERVER_DEBUG
@@ -734,6 +821,36 @@ void CWebServer::ContentReaderFreeCallback(void *cls)
 #endif
 }
 
+#if (MHD_VERSION >= 0x00090200)
+ssize_t CWebServer::StreamReaderCallback(void *cls, uint64_t pos, char *buf, size_t max)
+#elif (MHD_VERSION >= 0x00040001)
+int CWebServer::StreamReaderCallback(void *cls, uint64_t pos, char *buf, int max)
+#else   //libmicrohttpd < 0.4.0
+int CWebServer::StreamReaderCallback(void *cls, size_t pos, char *buf, int max)
+#endif
+{
+  IHTTPResponseReader *reader = (IHTTPResponseReader *)cls;
+  if (reader == NULL)
+    return -1;
+
+  // returning 0 would make mhd ask again, the end of the body is signaled with -1
+  int read = reader->Read(buf, (size_t)max);
+#ifdef MHD_CONTENT_READER_END_WITH_ERROR
+  if (read < 0)
+    return MHD_CONTENT_READER_END_WITH_ERROR;
+#endif
+  if (read <= 0)
+    return -1;
+
+  return read;
+}
+
+void CWebServer::StreamReaderFreeCallback(void *cls)
+{
+  IHTTPResponseReader *reader = (IHTTPResponseReader *)cls;
+  delete reader;
+}
+
 struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 {
   unsigned int timeout = 60 * 60 * 24;
@@ -1039,6 +1156,39 @@ std::string CWebServer::GenerateMultipartBoundary()
   return boundary;
 }
 
+int CWebServer::OpenLocalFile(const std::string &strURL)
+{
+#ifdef HAS_FD_RESPONSE
+  // only files on a local filesystem have a descriptor the kernel can send from,
+  // everything else (network shares, archives, ...) goes through the vfs
+  std::string path = CSpecialProtocol::TranslatePath(strURL);
+  if (!CURL(path).GetProtocol().empty())
+    return -1;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return -1;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+  {
+    close(fd);
+    return -1;
+  }
+  return fd;
+#else
+  return -1;
+#endif
+}
+
+void CWebServer::CloseLocalFile(int fd)
+{
+#ifdef HAS_FD_RESPONSE
+  if (fd >= 0)
+    close(fd);
+#endif
+}
+
 bool CWebServer::GetLastModifiedDateTime(XFILE::CFile *file, CDateTime &lastModified)
 {
   if (file == NULL)
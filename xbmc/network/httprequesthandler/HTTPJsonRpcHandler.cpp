@@ -23,6 +23,7 @@
 #include "interfaces/json-rpc/JSONServiceDescription.h"
 #include "interfaces/json-rpc/JSONUtils.h"
 #include "network/WebServer.h"
+#include "utils/CBORVariantWriter.h"
 #include "utils/JSONVariantWriter.h"
 #include "utils/log.h"
 
@@ -31,6 +32,11 @@
 using namespace std;
 using namespace JSONRPC;
 
+CHTTPJsonRpcHandler::~CHTTPJsonRpcHandler()
+{
+  delete m_reader;
+}
+
 bool CHTTPJsonRpcHandler::CheckHTTPRequest(const HTTPRequest &request)
 {
   return (request.url.compare("/jsonrpc") == 0);
@@ -38,7 +44,9 @@ bool CHTTPJsonRpcHandler::CheckHTTPRequest(const HTTPRequest &request)
 
 int CHTTPJsonRpcHandler::HandleHTTPRequest(const HTTPRequest &request)
 {
-  CHTTPClient client;
+  // responses are only sent as CBOR to clients explicitly asking for it
+  string accept = CWebServer::GetRequestHeaderValue(request.connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT);
+  CHTTPClient client(accept.find("application/cbor") != string::npos ? ResponseEncodingCBOR : ResponseEncodingJSON);
   bool isRequest = false;
   if (request.method == POST)
   {
@@ -69,21 +77,42 @@ int CHTTPJsonRpcHandler::HandleHTTPRequest(const HTTPRequest &request)
     }
   }
 
+  CVariant response;
+  IVariantEncoder *encoder = NULL;
+  bool hasResponse = true;
   if (isRequest)
-    m_response = CJSONRPC::MethodCall(m_request, request.webserver, &client);
+  {
+    hasResponse = CJSONRPC::MethodCall(m_request, request.webserver, &client, response);
+    encoder = CJSONRPC::CreateEncoder(client.GetResponseEncoding());
+  }
   else
   {
     // get the whole output of JSONRPC.Introspect
-    CVariant result;
-    CJSONServiceDescription::Print(result, request.webserver, &client);
-    m_response = CJSONVariantWriter::Write(result, false);
+    CJSONServiceDescription::Print(response, request.webserver, &client);
+    if (client.GetResponseEncoding() == ResponseEncodingCBOR)
+      encoder = new CCBORVariantEncoder();
+    else
+      encoder = new CJSONVariantEncoder(false);
   }
 
-  m_responseHeaderFields.insert(pair<string, string>("Content-Type", "application/json"));
+  m_responseHeaderFields.insert(pair<string, string>("Content-Type", client.GetResponseEncoding() == ResponseEncodingCBOR ? "application/cbor" : "application/json"));
 
   m_request.clear();
-  
-  m_responseType = HTTPMemoryDownloadNoFreeCopy;
+
+  if (hasResponse)
+  {
+    // the response is serialized straight into the buffer of the webserver
+    // instead of being rendered into a string first
+    delete m_reader;
+    m_reader = new CResponseReader(response, encoder);
+    m_responseType = HTTPStreamDownload;
+  }
+  else
+  {
+    // notifications don't get a response
+    delete encoder;
+    m_responseType = HTTPMemoryDownloadNoFreeNoCopy;
+  }
   m_responseCode = MHD_HTTP_OK;
 
   return MHD_YES;
@@ -106,6 +135,24 @@ bool CHTTPJsonRpcHandler::appendPostData(const char *data, unsigned int size)
   return true;
 }
 
+IHTTPResponseReader* CHTTPJsonRpcHandler::GetHTTPResponseReader()
+{
+  IHTTPResponseReader *reader = m_reader;
+  m_reader = NULL;
+  return reader;
+}
+
+CHTTPJsonRpcHandler::CResponseReader::CResponseReader(CVariant &response, IVariantEncoder *encoder)
+  : m_writer(m_response, encoder)
+{
+  m_response.swap(response);
+}
+
+int CHTTPJsonRpcHandler::CResponseReader::Read(char *buffer, size_t size)
+{
+  return m_writer.Read(buffer, (unsigned int)size);
+}
+
 int CHTTPJsonRpcHandler::CHTTPClient::GetPermissionFlags()
 {
   return OPERATION_PERMISSION_ALL;
@@ -121,3 +168,9 @@ bool CHTTPJsonRpcHandler::CHTTPClient::SetAnnouncementFlags(int flags)
 {
   return false;
 }
+
+bool CHTTPJsonRpcHandler::CHTTPClient::SetResponseEncoding(ResponseEncoding encoding)
+{
+  // the encoding is negotiated per request through the Accept header
+  return encoding == m_encoding;
+}
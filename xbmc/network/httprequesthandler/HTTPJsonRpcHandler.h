@@ -21,18 +21,20 @@
 
 #include "IHTTPRequestHandler.h"
 #include "interfaces/json-rpc/IClient.h"
+#include "utils/Variant.h"
+#include "utils/VariantStreamWriter.h"
 
 class CHTTPJsonRpcHandler : public IHTTPRequestHandler
 {
 public:
-  CHTTPJsonRpcHandler() { };
+  CHTTPJsonRpcHandler() : m_reader(NULL) { };
+  virtual ~CHTTPJsonRpcHandler();
   
   virtual IHTTPRequestHandler* GetInstance() { return new CHTTPJsonRpcHandler(); }
   virtual bool CheckHTTPRequest(const HTTPRequest &request);
   virtual int HandleHTTPRequest(const HTTPRequest &request);
 
-  virtual void* GetHTTPResponseData() const { return (void *)m_response.c_str(); };
-  virtual size_t GetHTTPResonseDataLength() const { return m_response.size(); }
+  virtual IHTTPResponseReader* GetHTTPResponseReader();
 
   virtual int GetPriority() const { return 2; }
 
@@ -45,13 +47,35 @@ protected:
 
 private:
   std::string m_request;
-  std::string m_response;
+
+  /*!
+   \brief Serializes the response while the webserver sends it
+   */
+  class CResponseReader : public IHTTPResponseReader
+  {
+  public:
+    CResponseReader(CVariant &response, IVariantEncoder *encoder);
+
+    virtual int Read(char *buffer, size_t size);
+
+  private:
+    CVariant m_response;
+    CVariantStreamWriter m_writer;
+  };
+  CResponseReader *m_reader;
 
   class CHTTPClient : public JSONRPC::IClient
   {
   public:
+    CHTTPClient(JSONRPC::ResponseEncoding encoding) : m_encoding(encoding) { }
+
     virtual int  GetPermissionFlags();
     virtual int  GetAnnouncementFlags();
     virtual bool SetAnnouncementFlags(int flags);
+    virtual JSONRPC::ResponseEncoding GetResponseEncoding() { return m_encoding; }
+    virtual bool SetResponseEncoding(JSONRPC::ResponseEncoding encoding);
+
+  private:
+    JSONRPC::ResponseEncoding m_encoding;
   };
 };
@@ -50,7 +50,8 @@ enum HTTPResponseType
   HTTPMemoryDownloadNoFreeNoCopy,
   HTTPMemoryDownloadNoFreeCopy,
   HTTPMemoryDownloadFreeNoCopy,
-  HTTPMemoryDownloadFreeCopy
+  HTTPMemoryDownloadFreeCopy,
+  HTTPStreamDownload
 };
 
 typedef struct HTTPRequest
@@ -62,6 +63,21 @@ typedef struct HTTPRequest
   CWebServer *webserver;
 } HTTPRequest;
 
+/*!
+ \brief Produces the body of a response of unknown length while it is sent
+ */
+class IHTTPResponseReader
+{
+public:
+  virtual ~IHTTPResponseReader() { }
+
+  /*!
+   \brief Copies the next part of the response body into buffer
+   \return Number of bytes copied, 0 at the end of the body and -1 on error
+   */
+  virtual int Read(char *buffer, size_t size) = 0;
+};
+
 class IHTTPRequestHandler
 {
 public:
@@ -75,6 +91,10 @@ public:
   virtual size_t GetHTTPResonseDataLength() const { return 0; }
   virtual std::string GetHTTPRedirectUrl() const { return ""; }
   virtual std::string GetHTTPResponseFile() const { return ""; }
+  /*!
+   \brief Returns the reader for a HTTPStreamDownload response, ownership is passed to the webserver
+   */
+  virtual IHTTPResponseReader* GetHTTPResponseReader() { return NULL; }
 
   // The higher the more important
   virtual int GetPriority() const { return 0; }
@@ -0,0 +1,263 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <vector>
+
+#include "ImageScaler.h"
+#include "cores/FFmpeg.h"
+#include "threads/Atomics.h"
+#include "threads/SingleLock.h"
+#include "threads/Thread.h"
+#include "utils/CPUInfo.h"
+
+extern "C" {
+#include "libswscale/swscale.h"
+}
+
+// images smaller than this are scaled in one go
+#define STRIPE_MIN_PIXELS   (1024 * 1024)
+#define MAX_STRIPES         8
+#define MAX_CACHED_CONTEXTS 8
+
+using namespace std;
+
+list<CImageScaler::Context> CImageScaler::m_contexts;
+CCriticalSection CImageScaler::m_section;
+volatile long CImageScaler::m_helpers = 0;
+
+static unsigned int GreatestCommonDivisor(unsigned int a, unsigned int b)
+{
+  while (b != 0)
+  {
+    unsigned int r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+/*!
+ \brief Scales one stripe of an image
+
+ The stripe is extended by a margin of source rows on either side, so the
+ filter sees the same rows it would see when scaling the whole image. The
+ rows scaled out of the margin are dropped.
+ */
+class CImageScalerStripe : public IRunnable
+{
+public:
+  CImageScalerStripe(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                     uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch,
+                     unsigned int skip_rows, unsigned int rows)
+    : m_inPixels(in_pixels), m_inWidth(in_width), m_inHeight(in_height), m_inPitch(in_pitch),
+      m_outPixels(out_pixels), m_outWidth(out_width), m_outHeight(out_height), m_outPitch(out_pitch),
+      m_skipRows(skip_rows), m_rows(rows), m_success(false)
+  { }
+
+  virtual void Run()
+  {
+    if (m_skipRows == 0 && m_rows == m_outHeight)
+    {
+      m_success = CImageScaler::ScaleStripe(m_inPixels, m_inWidth, m_inHeight, m_inPitch,
+                                            m_outPixels, m_outWidth, m_outHeight, m_outPitch);
+      return;
+    }
+
+    vector<uint8_t> buffer(m_outHeight * m_outPitch);
+    m_success = CImageScaler::ScaleStripe(m_inPixels, m_inWidth, m_inHeight, m_inPitch,
+                                          &buffer[0], m_outWidth, m_outHeight, m_outPitch);
+    if (m_success)
+      memcpy(m_outPixels, &buffer[m_skipRows * m_outPitch], m_rows * m_outPitch);
+  }
+
+  bool Succeeded() const { return m_success; }
+
+private:
+  const uint8_t *m_inPixels;
+  unsigned int m_inWidth;
+  unsigned int m_inHeight;
+  unsigned int m_inPitch;
+  uint8_t *m_outPixels;       ///< where the rows of the stripe go
+  unsigned int m_outWidth;
+  unsigned int m_outHeight;   ///< rows scaled, including the margins
+  unsigned int m_outPitch;
+  unsigned int m_skipRows;    ///< rows of the top margin
+  unsigned int m_rows;        ///< rows of the stripe
+  bool m_success;
+};
+
+bool CImageScaler::Scale(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                         uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch,
+                         unsigned int stripes /* = 0 */)
+{
+  if (in_pixels == NULL || out_pixels == NULL ||
+      in_width == 0 || in_height == 0 || out_width == 0 || out_height == 0)
+    return false;
+
+  if (stripes == 0)
+    stripes = g_cpuInfo.getCPUCount();
+  if (stripes > MAX_STRIPES)
+    stripes = MAX_STRIPES;
+
+  if (stripes < 2 || in_width * in_height < STRIPE_MIN_PIXELS)
+    return ScaleStripe(in_pixels, in_width, in_height, in_pitch, out_pixels, out_width, out_height, out_pitch);
+
+  // stripes have to start at rows where the source and destination line up
+  // exactly, otherwise the scaled stripes would sample at other positions
+  // than the whole image does. The image is made up of units of unit_in
+  // source rows that scale to unit_out destination rows.
+  unsigned int units = GreatestCommonDivisor(in_height, out_height);
+  unsigned int unit_in = in_height / units;
+  unsigned int unit_out = out_height / units;
+
+  // units of the neighbouring stripes within reach of the filter
+  unsigned int margin = (in_height / out_height + 2 + unit_in - 1) / unit_in;
+  unsigned int stripe_units = (units + stripes - 1) / stripes;
+  if (stripe_units < 2 * margin)
+    return ScaleStripe(in_pixels, in_width, in_height, in_pitch, out_pixels, out_width, out_height, out_pitch);
+
+  vector<CImageScalerStripe> jobs;
+  jobs.reserve(stripes);
+  for (unsigned int start = 0; start < units; start += stripe_units)
+  {
+    unsigned int end = std::min(start + stripe_units, units);
+    unsigned int first = start > margin ? start - margin : 0;
+    unsigned int last = std::min(end + margin, units);
+
+    jobs.push_back(CImageScalerStripe(in_pixels + first * unit_in * in_pitch, in_width, (last - first) * unit_in, in_pitch,
+                                      out_pixels + start * unit_out * out_pitch, out_width, (last - first) * unit_out, out_pitch,
+                                      (start - first) * unit_out, (end - start) * unit_out));
+  }
+
+  // the stripes are laid out the same whatever the load, so the result
+  // doesn't depend on how many helpers are free. The calling thread scales
+  // the first stripe and those no helper was left for
+  unsigned int helpers = ReserveHelpers(jobs.size() - 1);
+  vector<CThread*> threads;
+  for (unsigned int i = 1; i <= helpers; i++)
+  {
+    CThread *thread = new CThread(&jobs[i], "ImageScaler");
+    thread->Create();
+    threads.push_back(thread);
+  }
+  jobs[0].Run();
+  for (unsigned int i = helpers + 1; i < jobs.size(); i++)
+    jobs[i].Run();
+
+  for (unsigned int i = 0; i < threads.size(); i++)
+  {
+    threads[i]->StopThread();
+    delete threads[i];
+  }
+  ReleaseHelpers(helpers);
+
+  bool success = true;
+  for (unsigned int i = 0; i < jobs.size(); i++)
+    success &= jobs[i].Succeeded();
+
+  return success;
+}
+
+unsigned int CImageScaler::ReserveHelpers(unsigned int wanted)
+{
+  long limit = g_cpuInfo.getCPUCount() - 1;
+  long helpers = AtomicAdd(&m_helpers, 0);
+  for (;;)
+  {
+    long available = std::min((long)wanted, limit - helpers);
+    if (available <= 0)
+      return 0;
+    long prev = cas(&m_helpers, helpers, helpers + available);
+    if (prev == helpers)
+      return (unsigned int)available;
+    helpers = prev;
+  }
+}
+
+void CImageScaler::ReleaseHelpers(unsigned int helpers)
+{
+  if (helpers)
+    AtomicAdd(&m_helpers, -(long)helpers);
+}
+
+void CImageScaler::FlushContexts()
+{
+  CSingleLock lock(m_section);
+  for (list<Context>::iterator it = m_contexts.begin(); it != m_contexts.end(); ++it)
+    sws_freeContext(it->context);
+  m_contexts.clear();
+}
+
+bool CImageScaler::ScaleStripe(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                               uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
+{
+  Context context;
+  context.in_width = in_width;
+  context.in_height = in_height;
+  context.out_width = out_width;
+  context.out_height = out_height;
+  if (!AcquireContext(context))
+    return false;
+
+  uint8_t *src[] = { (uint8_t *)in_pixels, 0, 0, 0 };
+  int     srcStride[] = { (int)in_pitch, 0, 0, 0 };
+  uint8_t *dst[] = { out_pixels , 0, 0, 0 };
+  int     dstStride[] = { (int)out_pitch, 0, 0, 0 };
+
+  sws_scale(context.context, src, srcStride, 0, in_height, dst, dstStride);
+
+  ReleaseContext(context);
+  return true;
+}
+
+bool CImageScaler::AcquireContext(Context &context)
+{
+  {
+    CSingleLock lock(m_section);
+    for (list<Context>::iterator it = m_contexts.begin(); it != m_contexts.end(); ++it)
+    {
+      if (it->in_width == context.in_width && it->in_height == context.in_height &&
+          it->out_width == context.out_width && it->out_height == context.out_height)
+      {
+        // a context is only used by one thread at a time
+        context.context = it->context;
+        m_contexts.erase(it);
+        return true;
+      }
+    }
+  }
+
+  context.context = sws_getContext(context.in_width, context.in_height, PIX_FMT_BGRA,
+                                   context.out_width, context.out_height, PIX_FMT_BGRA,
+                                   SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+  return context.context != NULL;
+}
+
+void CImageScaler::ReleaseContext(const Context &context)
+{
+  CSingleLock lock(m_section);
+  m_contexts.push_front(context);
+  if (m_contexts.size() > MAX_CACHED_CONTEXTS)
+  {
+    sws_freeContext(m_contexts.back().context);
+    m_contexts.pop_back();
+  }
+}
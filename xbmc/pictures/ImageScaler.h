@@ -0,0 +1,85 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <list>
+#include <stdint.h>
+
+#include "threads/CriticalSection.h"
+
+struct SwsContext;
+
+/*!
+ \brief Scales 32 bit BGRA images through swscale
+
+ Scaling contexts are expensive to set up, so they are kept in a small cache
+ keyed by their dimensions and reused by the next image of the same size
+ (fanart and posters mostly come in a handful of sizes). Large images are
+ split into horizontal stripes that are scaled on all cores. Scaling mostly
+ runs in texture cache jobs, several at a time, so the helper threads are
+ shared by all callers and capped at one per additional core. Stripes that
+ don't get a helper are scaled by the calling thread.
+ */
+class CImageScaler
+{
+public:
+  /*! \brief Scale an image
+   \param in_pixels the source image
+   \param in_width the width of the source image
+   \param in_height the height of the source image
+   \param in_pitch the pitch of the source image in bytes
+   \param out_pixels the destination buffer
+   \param out_width the width of the scaled image
+   \param out_height the height of the scaled image
+   \param out_pitch the pitch of the destination buffer in bytes
+   \param stripes the maximum number of stripes to scale in parallel, 0 for one per core
+   \return true if the image was scaled, false otherwise
+   */
+  static bool Scale(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                    uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch,
+                    unsigned int stripes = 0);
+
+  /*! \brief Free all cached scaling contexts
+   */
+  static void FlushContexts();
+
+private:
+  struct Context
+  {
+    unsigned int in_width;
+    unsigned int in_height;
+    unsigned int out_width;
+    unsigned int out_height;
+    SwsContext *context;
+  };
+
+  static bool ScaleStripe(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                          uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch);
+  static unsigned int ReserveHelpers(unsigned int wanted);
+  static void ReleaseHelpers(unsigned int helpers);
+  static bool AcquireContext(Context &context);
+  static void ReleaseContext(const Context &context);
+
+  friend class CImageScalerStripe;
+
+  static std::list<Context> m_contexts;
+  static CCriticalSection m_section;
+  static volatile long m_helpers;   ///< helper threads running for all callers
+};
@@ -18,12 +18,15 @@
  *
  */
 
+#include <math.h>
+
 #include "system.h"
 #if (defined HAVE_CONFIG_H) && (!defined TARGET_WINDOWS)
   #include "config.h"
 #endif
 
 #include "Picture.h"
+#include "ImageScaler.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "FileItem.h"
@@ -32,15 +35,10 @@
 #include "utils/URIUtils.h"
 #include "guilib/Texture.h"
 #include "guilib/imagefactory.h"
-#include "cores/FFmpeg.h"
 #if defined(HAS_OMXPLAYER)
 #include "cores/omxplayer/OMXImage.h"
 #endif
 
-extern "C" {
-#include "libswscale/swscale.h"
-}
-
 using namespace XFILE;
 
 bool CPicture::CreateThumbnailFromSurface(const unsigned char *buffer, int width, int height, int stride, const CStdString &thumbFile)
@@ -108,6 +106,16 @@ bool CThumbnailWriter::DoWork()
   return success;
 }
 
+void CPicture::GetMaxCacheSize(uint32_t &width, uint32_t &height)
+{
+  // CacheTexture() keeps 16x9 images at the fanart res, all others at the image res
+  uint32_t max_height = std::max(g_advancedSettings.m_imageRes, g_advancedSettings.m_fanartRes);
+  uint32_t max_width = max_height * 16/9;
+
+  width = width ? std::min(width, max_width) : max_width;
+  height = height ? std::min(height, max_height) : max_height;
+}
+
 bool CPicture::CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest)
 {
   return CacheTexture(texture->GetPixels(), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(),
@@ -240,22 +248,7 @@ void CPicture::GetScale(unsigned int width, unsigned int height, unsigned int &o
 bool CPicture::ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
                           uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
 {
-  struct SwsContext *context = sws_getContext(in_width, in_height, PIX_FMT_BGRA,
-                                                         out_width, out_height, PIX_FMT_BGRA,
-                                                         SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-
-  uint8_t *src[] = { in_pixels, 0, 0, 0 };
-  int     srcStride[] = { (int)in_pitch, 0, 0, 0 };
-  uint8_t *dst[] = { out_pixels , 0, 0, 0 };
-  int     dstStride[] = { (int)out_pitch, 0, 0, 0 };
-
-  if (context)
-  {
-    sws_scale(context, src, srcStride, 0, in_height, dst, dstStride);
-    sws_freeContext(context);
-    return true;
-  }
-  return false;
+  return CImageScaler::Scale(in_pixels, in_width, in_height, in_pitch, out_pixels, out_width, out_height, out_pitch);
 }
 
 bool CPicture::OrientateImage(uint32_t *&pixels, unsigned int &width, unsigned int &height, int orientation)
@@ -44,6 +44,12 @@ public:
   static bool CacheTexture(CBaseTexture *texture, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest);
   static bool CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pitch, int orientation, uint32_t &dest_width, uint32_t &dest_height, const std::string &dest);
 
+  /*! \brief Get the largest size CacheTexture could keep an image of unknown dimensions at
+   \param width [in/out] maximum width in pixels requested, 0 for any - replaced with the largest width cached
+   \param height [in/out] maximum height in pixels requested, 0 for any - replaced with the largest height cached
+   */
+  static void GetMaxCacheSize(uint32_t &width, uint32_t &height);
+
 private:
   static void GetScale(unsigned int width, unsigned int height, unsigned int &out_width, unsigned int &out_height);
   static bool ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
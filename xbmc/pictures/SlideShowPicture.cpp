@@ -22,6 +22,7 @@
 #include "system.h"
 #include "guilib/GraphicContext.h"
 #include "guilib/Texture.h"
+#include "guilib/GUITexture.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "windowing/WindowingFactory.h"
@@ -806,6 +807,7 @@ void CSlideShowPic::Render(float *x, float *y, CBaseTexture* pTexture, color_t c
 
 #elif defined(HAS_GL)
   g_graphicsContext.BeginPaint();
+  CGUITextureGL::FlushBatch();
   if (pTexture)
   {
     pTexture->LoadToGPU();
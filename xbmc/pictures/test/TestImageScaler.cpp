@@ -0,0 +1,176 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "pictures/ImageScaler.h"
+#include "threads/SystemClock.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+static std::vector<uint8_t> CreateImage(unsigned int width, unsigned int height)
+{
+  // a gradient with some noise, so seams between stripes would show
+  std::vector<uint8_t> pixels(width * height * 4);
+  srand(width * height);
+  for (unsigned int y = 0; y < height; y++)
+  {
+    for (unsigned int x = 0; x < width; x++)
+    {
+      uint8_t *pixel = &pixels[(y * width + x) * 4];
+      pixel[0] = (uint8_t)(x * 255 / width);
+      pixel[1] = (uint8_t)(y * 255 / height);
+      pixel[2] = (uint8_t)(rand() & 0x3f);
+      pixel[3] = 0xff;
+    }
+  }
+  return pixels;
+}
+
+TEST(TestImageScaler, Solid)
+{
+  std::vector<uint8_t> in(64 * 48 * 4, 0x80);
+  std::vector<uint8_t> out(32 * 24 * 4, 0);
+
+  EXPECT_TRUE(CImageScaler::Scale(&in[0], 64, 48, 64 * 4, &out[0], 32, 24, 32 * 4));
+  for (unsigned int i = 0; i < out.size(); i++)
+    EXPECT_EQ(0x80, out[i]);
+}
+
+TEST(TestImageScaler, Invalid)
+{
+  std::vector<uint8_t> in(16 * 16 * 4);
+  std::vector<uint8_t> out(16 * 16 * 4);
+
+  EXPECT_FALSE(CImageScaler::Scale(NULL, 16, 16, 16 * 4, &out[0], 16, 16, 16 * 4));
+  EXPECT_FALSE(CImageScaler::Scale(&in[0], 0, 16, 16 * 4, &out[0], 16, 16, 16 * 4));
+  EXPECT_FALSE(CImageScaler::Scale(&in[0], 16, 16, 16 * 4, &out[0], 16, 0, 16 * 4));
+}
+
+TEST(TestImageScaler, StripesMatchWholeImage)
+{
+  const unsigned int in_width = 2000, in_height = 1500;
+  const unsigned int out_width = 1280, out_height = 960;
+  std::vector<uint8_t> in = CreateImage(in_width, in_height);
+  std::vector<uint8_t> whole(out_width * out_height * 4);
+  std::vector<uint8_t> striped(out_width * out_height * 4);
+
+  ASSERT_TRUE(CImageScaler::Scale(&in[0], in_width, in_height, in_width * 4,
+                                  &whole[0], out_width, out_height, out_width * 4, 1));
+  ASSERT_TRUE(CImageScaler::Scale(&in[0], in_width, in_height, in_width * 4,
+                                  &striped[0], out_width, out_height, out_width * 4, 4));
+
+  int maxDiff = 0;
+  for (unsigned int i = 0; i < whole.size(); i++)
+    maxDiff = std::max(maxDiff, abs((int)whole[i] - (int)striped[i]));
+  EXPECT_LE(maxDiff, 2);
+}
+
+TEST(TestImageScaler, StripesMatchWholeImageOddUnits)
+{
+  // 1500 -> 1125 rows gives units of 4 source rows scaling to 3 destination
+  // rows, so the stripes start at rows the filter doesn't sample evenly
+  const unsigned int in_width = 2000, in_height = 1500;
+  const unsigned int out_width = 1500, out_height = 1125;
+  std::vector<uint8_t> in = CreateImage(in_width, in_height);
+  std::vector<uint8_t> whole(out_width * out_height * 4);
+  std::vector<uint8_t> striped(out_width * out_height * 4);
+
+  ASSERT_TRUE(CImageScaler::Scale(&in[0], in_width, in_height, in_width * 4,
+                                  &whole[0], out_width, out_height, out_width * 4, 1));
+  ASSERT_TRUE(CImageScaler::Scale(&in[0], in_width, in_height, in_width * 4,
+                                  &striped[0], out_width, out_height, out_width * 4, 3));
+
+  // a misplaced stripe shows as whole rows that differ, so check every row
+  // and that no more than a few pixels are off by rounding
+  unsigned int differing = 0;
+  int maxDiff = 0;
+  for (unsigned int y = 0; y < out_height; y++)
+  {
+    int rowDiff = 0;
+    for (unsigned int i = y * out_width * 4; i < (y + 1) * out_width * 4; i++)
+    {
+      int diff = abs((int)whole[i] - (int)striped[i]);
+      if (diff)
+        differing++;
+      rowDiff = std::max(rowDiff, diff);
+    }
+    EXPECT_LE(rowDiff, 2) << "row " << y;
+    maxDiff = std::max(maxDiff, rowDiff);
+  }
+  EXPECT_LE(maxDiff, 2);
+  EXPECT_LE(differing, whole.size() / 100);
+}
+
+struct ImageSize
+{
+  const char *name;
+  unsigned int in_width;
+  unsigned int in_height;
+  unsigned int out_width;
+  unsigned int out_height;
+};
+
+TEST(TestImageScaler, Benchmark)
+{
+  // the sizes artwork is typically cached at
+  const ImageSize sizes[] = { { "poster", 1000, 1500, 480, 720 },
+                              { "fanart", 1920, 1080, 1280, 720 },
+                              { "4k fanart", 3840, 2160, 1920, 1080 },
+                              { "photo", 4000, 3000, 960, 720 } };
+  const unsigned int images = 10;
+
+  for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    const ImageSize &size = sizes[i];
+    std::vector<uint8_t> in = CreateImage(size.in_width, size.in_height);
+    std::vector<uint8_t> out(size.out_width * size.out_height * 4);
+
+    unsigned int start = XbmcThreads::SystemClockMillis();
+    for (unsigned int image = 0; image < images; image++)
+    {
+      CImageScaler::FlushContexts();
+      CImageScaler::Scale(&in[0], size.in_width, size.in_height, size.in_width * 4,
+                          &out[0], size.out_width, size.out_height, size.out_width * 4, 1);
+    }
+    unsigned int uncached = std::max(XbmcThreads::SystemClockMillis() - start, 1U);
+
+    start = XbmcThreads::SystemClockMillis();
+    for (unsigned int image = 0; image < images; image++)
+      CImageScaler::Scale(&in[0], size.in_width, size.in_height, size.in_width * 4,
+                          &out[0], size.out_width, size.out_height, size.out_width * 4, 1);
+    unsigned int cached = std::max(XbmcThreads::SystemClockMillis() - start, 1U);
+
+    start = XbmcThreads::SystemClockMillis();
+    for (unsigned int image = 0; image < images; image++)
+      CImageScaler::Scale(&in[0], size.in_width, size.in_height, size.in_width * 4,
+                          &out[0], size.out_width, size.out_height, size.out_width * 4);
+    unsigned int striped = std::max(XbmcThreads::SystemClockMillis() - start, 1U);
+
+    std::cout << size.name << " images/sec: "
+              << "new context " << testing::PrintToString(images * 1000 / uncached)
+              << ", cached context " << testing::PrintToString(images * 1000 / cached)
+              << ", striped " << testing::PrintToString(images * 1000 / striped) << std::endl;
+  }
+  CImageScaler::FlushContexts();
+}
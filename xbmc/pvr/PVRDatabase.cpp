@@ -36,6 +36,85 @@ using namespace dbiplus;
 using namespace PVR;
 using namespace ADDON;
 
+namespace PVR
+{
+  /* streams changed channels that already have a database ID into a batch */
+  class CPVRChannelRows : public bind_source
+  {
+  public:
+    CPVRChannelRows(const vector<CPVRChannelPtr> &channels) :
+      m_it(channels.begin()),
+      m_end(channels.end()) {}
+
+    virtual bool next(BindList &params)
+    {
+      if (m_it == m_end)
+        return false;
+
+      const CPVRChannel &channel = **m_it++;
+      params.push_back(channel.UniqueID());
+      params.push_back(channel.IsRadio() ? 1 : 0);
+      params.push_back(channel.IsHidden() ? 1 : 0);
+      params.push_back(channel.IsUserSetIcon() ? 1 : 0);
+      params.push_back(channel.IsUserSetName() ? 1 : 0);
+      params.push_back(channel.IsLocked() ? 1 : 0);
+      params.push_back(channel.IconPath().c_str());
+      params.push_back(channel.ChannelName().c_str());
+      params.push_back(channel.IsVirtual() ? 1 : 0);
+      params.push_back(channel.EPGEnabled() ? 1 : 0);
+      params.push_back(channel.EPGScraper().c_str());
+      params.push_back((int64_t)channel.LastWatched());
+      params.push_back(channel.ClientID());
+      params.push_back(channel.ClientChannelNumber());
+      params.push_back(channel.InputFormat().c_str());
+      params.push_back(channel.StreamURL().c_str());
+      params.push_back(channel.EncryptionSystem());
+      params.push_back(channel.ChannelID());
+      params.push_back(channel.EpgID());
+      return true;
+    }
+
+  private:
+    vector<CPVRChannelPtr>::const_iterator m_it;
+    vector<CPVRChannelPtr>::const_iterator m_end;
+  };
+
+  /* streams the members of a group that aren't stored with their current number yet into a batch */
+  class CPVRGroupMemberRows : public bind_source
+  {
+  public:
+    CPVRGroupMemberRows(const CPVRChannelGroup &group, const vector<PVRChannelGroupMember> &members, const set<pair<int, unsigned int> > &stored) :
+      m_iGroupId(group.GroupID()),
+      m_it(members.begin()),
+      m_end(members.end()),
+      m_stored(stored) {}
+
+    virtual bool next(BindList &params)
+    {
+      for (; m_it != m_end; m_it++)
+      {
+        int iChannelId = m_it->channel->ChannelID();
+        if (m_stored.find(make_pair(iChannelId, m_it->iChannelNumber)) != m_stored.end())
+          continue;
+
+        params.push_back(m_iGroupId);
+        params.push_back(iChannelId);
+        params.push_back(m_it->iChannelNumber);
+        m_it++;
+        return true;
+      }
+
+      return false;
+    }
+
+  private:
+    int m_iGroupId;
+    vector<PVRChannelGroupMember>::const_iterator m_it;
+    vector<PVRChannelGroupMember>::const_iterator m_end;
+    const set<pair<int, unsigned int> > &m_stored;
+  };
+}
+
 #define PVRDB_DEBUGGING 0
 
 bool CPVRDatabase::Open()
@@ -743,18 +822,40 @@ bool CPVRDatabase::PersistChannels(CPVRChannelGroup &group)
   if (m_sqlite)
     iLastChannel = GetLastChannelId();
 
+  vector<CPVRChannelPtr> channels;
   for (unsigned int iChannelPtr = 0; iChannelPtr < group.m_members.size(); iChannelPtr++)
   {
     PVRChannelGroupMember member = group.m_members.at(iChannelPtr);
     if (member.channel->IsChanged() || member.channel->IsNew())
     {
+      /* invalid channel, Persist() refuses these as well */
+      if (member.channel->UniqueID() <= 0)
+      {
+        CLog::Log(LOGERROR, "PVR - %s - invalid channel uid: %d", __FUNCTION__, member.channel->UniqueID());
+        bReturn = false;
+        continue;
+      }
+
       if (m_sqlite && member.channel->IsNew())
         member.channel->SetChannelID(++iLastChannel);
-      bReturn &= Persist(*member.channel, m_sqlite || !member.channel->IsNew());
+
+      /* channels without an ID have to be inserted one by one to get it */
+      if (member.channel->IsNew())
+        bReturn &= Persist(*member.channel, false);
+      else
+        channels.push_back(member.channel);
     }
   }
 
-  bReturn &= CommitInsertQueries();
+  if (!channels.empty())
+  {
+    CPVRChannelRows rows(channels);
+    bReturn &= ExecuteBatch("REPLACE INTO channels ("
+        "iUniqueId, bIsRadio, bIsHidden, bIsUserSetIcon, bIsUserSetName, bIsLocked, "
+        "sIconPath, sChannelName, bIsVirtual, bEPGEnabled, sEPGScraper, iLastWatched, iClientId, "
+        "iClientChannelNumber, sInputFormat, sStreamURL, iEncryptionSystem, idChannel, idEpg) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", rows) >= 0;
+  }
 
   return bReturn;
 }
@@ -763,31 +864,36 @@ bool CPVRDatabase::PersistGroupMembers(CPVRChannelGroup &group)
 {
   bool bReturn = true;
   bool bRemoveChannels = true;
-  CStdString strQuery;
   CSingleLock lock(group.m_critSection);
 
   if (group.m_members.size() > 0)
   {
-    for (unsigned int iChannelPtr = 0; iChannelPtr < group.m_members.size(); iChannelPtr++)
+    /* load what's stored at once, instead of looking up every member */
+    set<pair<int, unsigned int> > stored;
+    CStdString strQuery = PrepareSQL("SELECT idChannel, iChannelNumber FROM map_channelgroups_channels WHERE idGroup = %u", group.GroupID());
+    if (ResultQuery(strQuery))
     {
-      PVRChannelGroupMember member = group.m_members.at(iChannelPtr);
-
-      CStdString strWhereClause = PrepareSQL("idChannel = %u AND idGroup = %u AND iChannelNumber = %u",
-          member.channel->ChannelID(), group.GroupID(), member.iChannelNumber);
-
-      CStdString strValue = GetSingleValue("map_channelgroups_channels", "idChannel", strWhereClause);
-      if (strValue.empty())
+      try
+      {
+        while (!m_pDS->eof())
+        {
+          stored.insert(make_pair(m_pDS->fv("idChannel").get_asInt(), (unsigned int)m_pDS->fv("iChannelNumber").get_asInt()));
+          m_pDS->next();
+        }
+        m_pDS->close();
+      }
+      catch (...)
       {
-        strQuery = PrepareSQL("REPLACE INTO map_channelgroups_channels ("
-            "idGroup, idChannel, iChannelNumber) "
-            "VALUES (%i, %i, %i);",
-            group.GroupID(), member.channel->ChannelID(), member.iChannelNumber);
-        QueueInsertQuery(strQuery);
+        CLog::Log(LOGERROR, "PVR - %s - couldn't load the members of group '%s'", __FUNCTION__, group.GroupName().c_str());
       }
     }
+
+    CPVRGroupMemberRows rows(group, group.m_members, stored);
+    bReturn = ExecuteBatch("REPLACE INTO map_channelgroups_channels ("
+        "idGroup, idChannel, iChannelNumber) "
+        "VALUES (?, ?, ?)", rows) >= 0;
     lock.Leave();
 
-    bReturn = CommitInsertQueries();
     bRemoveChannels = RemoveStaleChannelsFromGroup(group);
   }
 
@@ -845,6 +951,11 @@ bool CPVRDatabase::Persist(CPVRChannelGroup &group)
     return bReturn;
   }
 
+  /* write the group, its channels and its members in a single transaction */
+  bool bTransaction = !InTransaction();
+  if (bTransaction)
+    BeginTransaction();
+
   CStdString strQuery;
   bReturn = true;
   {
@@ -873,6 +984,9 @@ bool CPVRDatabase::Persist(CPVRChannelGroup &group)
   if (bReturn)
     bReturn = PersistGroupMembers(group);
 
+  if (bTransaction)
+    bReturn &= CommitTransaction();
+
   return bReturn;
 }
 
@@ -25,6 +25,7 @@
 
 #include "RenderSystemGL.h"
 #include "guilib/GraphicContext.h"
+#include "guilib/GUITextureGL.h"
 #include "settings/AdvancedSettings.h"
 #include "settings/DisplaySettings.h"
 #include "utils/log.h"
@@ -257,6 +258,8 @@ bool CRenderSystemGL::EndRender()
   if (!m_bRenderCreated)
     return false;
 
+  CGUITextureGL::FlushBatch();
+
   return true;
 }
 
@@ -265,6 +268,8 @@ bool CRenderSystemGL::ClearBuffers(color_t color)
   if (!m_bRenderCreated)
     return false;
 
+  CGUITextureGL::FlushBatch();
+
   /* clear is not affected by stipple pattern, so we can only clear on first frame */
   if(m_stereoMode == RENDER_STEREO_MODE_INTERLACED && m_stereoView == RENDER_STEREO_VIEW_RIGHT)
     return true;
@@ -297,6 +302,8 @@ bool CRenderSystemGL::PresentRender(const CDirtyRegionList& dirty)
   if (!m_bRenderCreated)
     return false;
 
+  CGUITextureGL::EndFrame();
+
   if (m_iVSyncMode != 0 && m_iSwapRate != 0)
   {
     int64_t curr, diff, freq;
@@ -392,6 +399,8 @@ void CRenderSystemGL::CaptureStateBlock()
 {
   if (!m_bRenderCreated)
     return;
+
+  CGUITextureGL::FlushBatch();
   
   glGetIntegerv(GL_VIEWPORT, m_viewPort);
 
@@ -414,6 +423,8 @@ void CRenderSystemGL::ApplyStateBlock()
   if (!m_bRenderCreated)
     return;
 
+  CGUITextureGL::FlushBatch();
+
   glViewport(m_viewPort[0], m_viewPort[1], m_viewPort[2], m_viewPort[3]);
   glMatrixMode(GL_PROJECTION);
   glPopMatrix();
@@ -434,6 +445,8 @@ void CRenderSystemGL::SetCameraPosition(const CPoint &camera, int screenWidth, i
   if (!m_bRenderCreated)
     return;
 
+  CGUITextureGL::FlushBatch();
+
   g_graphicsContext.BeginPaint();
 
   CPoint offset = camera - CPoint(screenWidth*0.5f, screenHeight*0.5f);
@@ -494,6 +507,8 @@ void CRenderSystemGL::ApplyHardwareTransform(const TransformMatrix &finalMatrix)
   if (!m_bRenderCreated)
     return;
 
+  CGUITextureGL::FlushBatch();
+
   glMatrixMode(GL_MODELVIEW);
   glPushMatrix();
   GLfloat matrix[4][4];
@@ -515,6 +530,8 @@ void CRenderSystemGL::RestoreHardwareTransform()
   if (!m_bRenderCreated)
     return;
 
+  CGUITextureGL::FlushBatch();
+
   glMatrixMode(GL_MODELVIEW);
   glPopMatrix();
 }
@@ -584,6 +601,8 @@ void CRenderSystemGL::SetViewPort(CRect& viewPort)
   if (!m_bRenderCreated)
     return;
 
+  CGUITextureGL::FlushBatch();
+
   glScissor((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
   glViewport((GLint) viewPort.x1, (GLint) (m_height - viewPort.y1 - viewPort.Height()), (GLsizei) viewPort.Width(), (GLsizei) viewPort.Height());
 }
@@ -592,6 +611,9 @@ void CRenderSystemGL::SetScissors(const CRect &rect)
 {
   if (!m_bRenderCreated)
     return;
+
+  CGUITextureGL::FlushBatch();
+
   GLint x1 = MathUtils::round_int(rect.x1);
   GLint y1 = MathUtils::round_int(rect.y1);
   GLint x2 = MathUtils::round_int(rect.x2);
@@ -661,6 +683,7 @@ static const GLubyte stipple_3d[] = {
 
 void CRenderSystemGL::SetStereoMode(RENDER_STEREO_MODE mode, RENDER_STEREO_VIEW view)
 {
+  CGUITextureGL::FlushBatch();
   CRenderSystemBase::SetStereoMode(mode, view);
 
   glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
@@ -156,6 +156,7 @@ void CAdvancedSettings::Initialize()
   m_videoEnableHighQualityHwScalers = false;
   m_videoAutoScaleMaxFps = 30.0f;
   m_videoDisableBackgroundDeinterlace = false;
+  m_videoRenderBuffers = 4;
   m_videoCaptureUseOcclusionQuery = -1; //-1 is auto detect
   m_videoVDPAUtelecine = false;
   m_videoVDPAUdeintSkipChromaHD = false;
@@ -321,6 +322,8 @@ void CAdvancedSettings::Initialize()
   m_curlretries = 2;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
+  m_curlConnections = 4;
+  m_multiPathTimeout = 5000;
 
   m_startFullScreen = false;
   m_showExitButton = true;
@@ -366,7 +369,9 @@ void CAdvancedSettings::Initialize()
   m_measureRefreshrate = false;
 
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  m_cacheMemBufferMapped = true;
   m_networkBufferMode = 0; // Default (buffer all internet streams/filesystems)
+  m_dirCacheDiskSize = 0; // Disabled
   // the following setting determines the readRate of a player data
   // as multiply of the default data read rate
   m_readBufferFactor = 1.0f;
@@ -404,6 +409,7 @@ void CAdvancedSettings::Initialize()
   m_logLevelHint = m_logLevel = LOG_LEVEL_NORMAL;
   m_extraLogEnabled = false;
   m_extraLogLevels = 0;
+  m_asyncLogging = false;
 
   #if defined(TARGET_DARWIN)
     CStdString logDir = getenv("HOME");
@@ -596,6 +602,7 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetFloat(pElement,"autoscalemaxfps",m_videoAutoScaleMaxFps, 0.0f, 1000.0f);
     XMLUtils::GetBoolean(pElement,"disableswmultithreading",m_videoDisableSWMultithreading);
     XMLUtils::GetBoolean(pElement, "disablebackgrounddeinterlace", m_videoDisableBackgroundDeinterlace);
+    XMLUtils::GetInt(pElement, "renderbuffers", m_videoRenderBuffers, 2, 6);
     XMLUtils::GetInt(pElement, "useocclusionquery", m_videoCaptureUseOcclusionQuery, -1, 1);
     XMLUtils::GetBoolean(pElement,"vdpauInvTelecine",m_videoVDPAUtelecine);
     XMLUtils::GetBoolean(pElement,"vdpauHDdeintSkipChroma",m_videoVDPAUdeintSkipChromaHD);
@@ -800,8 +807,12 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
+    XMLUtils::GetInt(pElement, "curlconnections", m_curlConnections, 1, 16);
+    XMLUtils::GetInt(pElement, "multipathtimeout", m_multiPathTimeout, 100, 120000);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    XMLUtils::GetBoolean(pElement, "cachemembuffermapped", m_cacheMemBufferMapped);
     XMLUtils::GetUInt(pElement, "buffermode", m_networkBufferMode, 0, 3);
+    XMLUtils::GetUInt(pElement, "dircachesize", m_dirCacheDiskSize);
     XMLUtils::GetFloat(pElement, "readbufferfactor", m_readBufferFactor);
   }
 
@@ -849,6 +860,10 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     CLog::SetLogLevel(g_advancedSettings.m_logLevel);
   }
 
+  // write the log from a background thread, so debug logging doesn't stall the render and audio threads
+  XMLUtils::GetBoolean(pRootElement, "asynclogging", m_asyncLogging);
+  CLog::SetAsync(m_asyncLogging);
+
   XMLUtils::GetString(pRootElement, "cddbaddress", m_cddbAddress);
 
   //airtunes + airplay
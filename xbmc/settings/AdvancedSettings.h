@@ -188,6 +188,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     std::vector<RefreshVideoLatency> m_videoRefreshLatency;
     float m_videoDefaultLatency;
     bool m_videoDisableBackgroundDeinterlace;
+    int  m_videoRenderBuffers; ///< \brief render buffers including the one on screen, the player queues the others ahead
     int  m_videoCaptureUseOcclusionQuery;
     bool m_DXVACheckCompatibility;
     bool m_DXVACheckCompatibilityPresent;
@@ -212,6 +213,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_logLevelHint;
     bool m_extraLogEnabled;
     int m_extraLogLevels;
+    bool m_asyncLogging;
     CStdString m_cddbAddress;
 
     //airtunes + airplay
@@ -324,6 +326,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_curllowspeedtime;
     int m_curlretries;
     bool m_curlDisableIPV6;
+    int m_curlConnections; ///< \brief parallel range requests for cached http streams, 1 to disable
+    int m_multiPathTimeout; ///< \brief ms to wait for the sources of a multipath listing before showing what arrived
 
     bool m_fullScreen;
     bool m_startFullScreen;
@@ -381,7 +385,9 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemBufferSize;
+    bool m_cacheMemBufferMapped; ///< \brief back the memory cache by a mapped ring file (CMappedCircularCache)
     unsigned int m_networkBufferMode;
+    unsigned int m_dirCacheDiskSize; ///< \brief byte budget of the on-disk directory cache for network sources, 0 to disable
     float m_readBufferFactor;
 
     bool m_jsonOutputCompact;
@@ -23,6 +23,7 @@
 #include "Settings.h"
 #include "Application.h"
 #include "Autorun.h"
+#include "GUIInfoManager.h"
 #include "LangInfo.h"
 #include "Util.h"
 #include "addons/Skin.h"
@@ -308,6 +309,7 @@ void CSettings::Uninitialize()
 #if defined(TARGET_LINUX) && !defined(TARGET_ANDROID) && !defined(__UCLIBC__)
   m_settingsManager->UnregisterSettingsHandler(&g_timezone);
 #endif
+  m_settingsManager->UnregisterSettingsHandler(&g_infoManager);
 
   m_initialized = false;
 }
@@ -637,6 +639,7 @@ void CSettings::InitializeISettingsHandlers()
   m_settingsManager->RegisterSettingsHandler(&g_timezone);
 #endif
   m_settingsManager->RegisterSettingsHandler(&CMediaSettings::Get());
+  m_settingsManager->RegisterSettingsHandler(&g_infoManager);
 }
 
 void CSettings::InitializeISubSettings()
@@ -87,6 +87,8 @@ void CSkinSettings::SetString(int setting, const string &label)
   if (it != m_strings.end())
   {
     it->second.value = label;
+    lock.Leave();
+    g_infoManager.InvalidateBools(INFO::SOURCE_SETTINGS);
     return;
   }
 
@@ -134,6 +136,8 @@ void CSkinSettings::SetBool(int setting, bool set)
   if (it != m_bools.end())
   {
     it->second.value = set;
+    lock.Leave();
+    g_infoManager.InvalidateBools(INFO::SOURCE_SETTINGS);
     return;
   }
 
@@ -152,6 +156,8 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value.clear();
+      lock.Leave();
+      g_infoManager.InvalidateBools(INFO::SOURCE_SETTINGS);
       return;
     }
   }
@@ -162,6 +168,8 @@ void CSkinSettings::Reset(const string &setting)
     if (StringUtils::EqualsNoCase(settingName, it->second.name))
     {
       it->second.value = false;
+      lock.Leave();
+      g_infoManager.InvalidateBools(INFO::SOURCE_SETTINGS);
       return;
     }
   }
@@ -185,7 +193,7 @@ void CSkinSettings::Reset()
       it->second.value.clear();
   }
 
-  g_infoManager.ResetCache();
+  g_infoManager.InvalidateBools(INFO::SOURCE_SETTINGS);
 }
 
 bool CSkinSettings::Load(const TiXmlNode *settings)
@@ -226,6 +234,7 @@ bool CSkinSettings::Load(const TiXmlNode *settings)
     pChild = pChild->NextSiblingElement(XML_SETTING);
   }
 
+  g_infoManager.InvalidateBools(INFO::SOURCE_SETTINGS);
   return true;
 }
 
@@ -273,6 +282,8 @@ void CSkinSettings::Clear()
   CSingleLock lock(m_critical);
   m_strings.clear();
   m_bools.clear();
+
+  g_infoManager.InvalidateBools(INFO::SOURCE_SETTINGS);
 }
 
 std::string CSkinSettings::GetCurrentSkin() const
@@ -19,6 +19,8 @@
  *
  */
 
+class CSetting;
+
 /*!
  \ingroup settings
  \brief Interface defining methods being called by the settings system if an
@@ -66,4 +68,13 @@ public:
    This callback can be used to trigger clearing any state variables.
    */
   virtual void OnSettingsCleared() { }
+  /*!
+   \brief The value of any of the settings has changed.
+
+   This callback can be used to track changes without registering an
+   ISettingCallback for every single setting.
+
+   \param setting The setting whose value has changed
+   */
+  virtual void OnSettingValueChanged(const CSetting *setting) { }
 };
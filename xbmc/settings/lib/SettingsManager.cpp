@@ -755,6 +755,8 @@ void CSettingsManager::OnSettingChanged(const CSetting *setting)
         ++callback)
     (*callback)->OnSettingChanged(setting);
 
+  OnSettingValueChanged(setting);
+
   // now handle any settings which depend on the changed setting
   const SettingDependencyMap& deps = GetDependencies(setting);
   for (SettingDependencyMap::const_iterator depsIt = deps.begin(); depsIt != deps.end(); ++depsIt)
@@ -936,6 +938,13 @@ void CSettingsManager::OnSettingsCleared()
     (*it)->OnSettingsCleared();
 }
 
+void CSettingsManager::OnSettingValueChanged(const CSetting *setting)
+{
+  CSharedLock lock(m_critical);
+  for (SettingsHandlers::const_iterator it = m_settingsHandlers.begin(); it != m_settingsHandlers.end(); ++it)
+    (*it)->OnSettingValueChanged(setting);
+}
+
 bool CSettingsManager::Load(const TiXmlNode *settings)
 {
   bool ok = true;
@@ -398,6 +398,7 @@ private:
   virtual bool OnSettingsSaving() const;
   virtual void OnSettingsSaved() const;
   virtual void OnSettingsCleared();
+  virtual void OnSettingValueChanged(const CSetting *setting);
 
   // implementation of ISubSettings
   virtual bool Load(const TiXmlNode *settings);
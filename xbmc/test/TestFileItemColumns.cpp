@@ -0,0 +1,217 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "FileItemColumns.h"
+#include "threads/SystemClock.h"
+#include "utils/StringUtils.h"
+
+#include "gtest/gtest.h"
+
+#include <iostream>
+
+#define COLUMN_TRACK (FieldMax + 1)
+
+class CTestItemFactory : public IFileItemFactory
+{
+public:
+  CTestItemFactory(unsigned int *created) : m_created(created) { }
+
+  virtual CFileItemPtr CreateItem(const CFileItemColumns &columns, unsigned int row) const
+  {
+    (*m_created)++;
+    CFileItemPtr item(new CFileItem(columns.GetString(FieldLabel, row)));
+    item->SetPath(columns.GetString(FieldPath, row));
+    item->m_iprogramCount = (int)columns.GetInteger(COLUMN_TRACK, row);
+    return item;
+  }
+
+private:
+  unsigned int *m_created;
+};
+
+class CTestLabelPreparer : public IFileItemPreparer
+{
+public:
+  virtual void Prepare(const CFileItemPtr &item)
+  {
+    item->SetLabel2("prepared");
+  }
+};
+
+static FileItemColumnsPtr CreateColumns(unsigned int rows, unsigned int *created)
+{
+  CFileItemColumns *columns = new CFileItemColumns(new CTestItemFactory(created));
+  columns->AddColumn(FieldLabel, CFileItemColumns::ColumnString);
+  columns->AddColumn(FieldPath, CFileItemColumns::ColumnString);
+  columns->AddColumn(COLUMN_TRACK, CFileItemColumns::ColumnInteger);
+  columns->AddAlias(FieldTrackNumber, COLUMN_TRACK);
+  columns->AddConstant(FieldFolder, false);
+  columns->AddConstant(FieldSortSpecial, (int)SortSpecialNone);
+
+  for (unsigned int i = 0; i < rows; i++)
+  {
+    columns->AddRow();
+    columns->SetString(FieldLabel, StringUtils::Format("song %06u", i));
+    columns->SetString(FieldPath, StringUtils::Format("musicdb://songs/%u.mp3", i));
+    columns->SetInteger(COLUMN_TRACK, rows - i);
+  }
+
+  return FileItemColumnsPtr(columns);
+}
+
+TEST(TestFileItemColumns, Columns)
+{
+  unsigned int created = 0;
+  FileItemColumnsPtr columns = CreateColumns(3, &created);
+
+  EXPECT_EQ(3U, columns->Size());
+  EXPECT_STREQ("song 000001", columns->GetString(FieldLabel, 1).c_str());
+  EXPECT_EQ(2, columns->GetInteger(FieldTrackNumber, 1));
+  EXPECT_FALSE(columns->GetBoolean(FieldFolder, 2));
+  EXPECT_FALSE(columns->HasColumn(FieldTitle));
+
+  Fields fields;
+  fields.insert(FieldTrackNumber);
+  SortItem sortable;
+  EXPECT_TRUE(columns->ToSortable(2, fields, sortable));
+  EXPECT_EQ(1, sortable[FieldTrackNumber].asInteger());
+  EXPECT_STREQ("song 000002", sortable[FieldLabel].asString().c_str());
+
+  fields.insert(FieldTitle);
+  EXPECT_FALSE(columns->ToSortable(2, fields, sortable));
+  EXPECT_EQ(0U, created);
+}
+
+TEST(TestFileItemColumns, Materialize)
+{
+  unsigned int created = 0;
+  CFileItemList items;
+  items.AddRows(CreateColumns(100, &created));
+
+  EXPECT_TRUE(items.IsLazy());
+  EXPECT_EQ(100, items.Size());
+  EXPECT_FALSE(items.IsFolder(5));
+  EXPECT_FALSE(items.IsMaterialized(5));
+  EXPECT_EQ(0U, created);
+
+  CFileItemPtr item = items.Get(5);
+  ASSERT_TRUE(item != NULL);
+  EXPECT_STREQ("song 000005", item->GetLabel().c_str());
+  EXPECT_TRUE(items.IsMaterialized(5));
+  EXPECT_TRUE(items.Get(5) == item);
+  EXPECT_EQ(1U, created);
+
+  items.Materialize();
+  EXPECT_FALSE(items.IsLazy());
+  EXPECT_EQ(100U, created);
+  EXPECT_TRUE(items.Get(5) == item);
+}
+
+TEST(TestFileItemColumns, Sort)
+{
+  unsigned int created = 0;
+  CFileItemList items;
+  items.AddRows(CreateColumns(100, &created));
+
+  items.Sort(SortByTrackNumber, SortOrderAscending);
+  EXPECT_EQ(0U, created);
+  EXPECT_STREQ("song 000099", items.Get(0)->GetLabel().c_str());
+  EXPECT_STREQ("song 000000", items.Get(99)->GetLabel().c_str());
+
+  items.Sort(SortByLabel, SortOrderDescending);
+  EXPECT_EQ(2U, created);
+  EXPECT_STREQ("song 000099", items.Get(0)->GetLabel().c_str());
+  EXPECT_STREQ("song 000098", items.Get(1)->GetLabel().c_str());
+  EXPECT_EQ(3U, created);
+}
+
+TEST(TestFileItemColumns, AppendAndCopy)
+{
+  unsigned int created = 0;
+  CFileItemList items;
+  items.AddRows(CreateColumns(10, &created));
+
+  CFileItemList appended;
+  appended.Append(items);
+  EXPECT_EQ(10, appended.Size());
+  EXPECT_TRUE(appended.Get(3) == items.Get(3));
+
+  CFileItemList copied;
+  copied.Copy(items);
+  EXPECT_EQ(10, copied.Size());
+  CFileItemPtr item = copied.Get(3);
+  EXPECT_TRUE(item != items.Get(3));
+  EXPECT_STREQ(items.Get(3)->GetLabel().c_str(), item->GetLabel().c_str());
+
+  copied.Remove(0);
+  EXPECT_EQ(9, copied.Size());
+  EXPECT_TRUE(copied.Get(2) == item);
+  EXPECT_EQ(10, items.Size());
+}
+
+TEST(TestFileItemColumns, PrepareItems)
+{
+  unsigned int created = 0;
+  CFileItemList items;
+  items.AddRows(CreateColumns(10, &created));
+  CFileItemPtr before = items.Get(0);
+
+  items.PrepareItems("labels", FileItemPreparerPtr(new CTestLabelPreparer()));
+  EXPECT_STREQ("prepared", before->GetLabel2().c_str());
+  EXPECT_STREQ("prepared", items.Get(9)->GetLabel2().c_str());
+  EXPECT_EQ(2U, created);
+}
+
+TEST(TestFileItemColumns, Benchmark)
+{
+  const unsigned int rows = 150000;
+  unsigned int created = 0;
+
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  CFileItemList eager;
+  eager.Reserve(rows);
+  for (unsigned int i = 0; i < rows; i++)
+  {
+    CFileItemPtr item(new CFileItem(StringUtils::Format("song %06u", i)));
+    item->SetPath(StringUtils::Format("musicdb://songs/%u.mp3", i));
+    item->m_iprogramCount = rows - i;
+    eager.Add(item);
+  }
+  eager.Sort(SortByTrackNumber, SortOrderAscending);
+  unsigned int eagerTime = XbmcThreads::SystemClockMillis() - start;
+
+  start = XbmcThreads::SystemClockMillis();
+  FileItemColumnsPtr columns = CreateColumns(rows, &created);
+  CFileItemList lazy;
+  lazy.AddRows(columns);
+  lazy.Sort(SortByTrackNumber, SortOrderAscending);
+  for (int i = 0; i < 50; i++)
+    lazy.Get(i);
+  unsigned int lazyTime = XbmcThreads::SystemClockMillis() - start;
+
+  EXPECT_EQ(50U, created);
+  std::cout << "Eager list of " << testing::PrintToString(rows) << " items: "
+            << testing::PrintToString(eagerTime) << " ms, "
+            << testing::PrintToString(rows * sizeof(CFileItem)) << " bytes of items" << std::endl;
+  std::cout << "Lazy list of " << testing::PrintToString(rows) << " items: "
+            << testing::PrintToString(lazyTime) << " ms, "
+            << testing::PrintToString(columns->GetMemoryUsage()) << " bytes of columns" << std::endl;
+}
@@ -0,0 +1,69 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "GUIInfoManager.h"
+#include "settings/Settings.h"
+#include "settings/SkinSettings.h"
+#include "utils/StringUtils.h"
+#include "utils/XBMCTinyXML.h"
+
+#include "gtest/gtest.h"
+
+static void LoadSkinSetting(const std::string &name, bool value)
+{
+  std::string xml = StringUtils::Format("<settings><skinsettings>"
+                                        "<setting type=\"bool\" name=\"%s.%s\">%s</setting>"
+                                        "</skinsettings></settings>",
+                                        CSettings::Get().GetString("lookandfeel.skin").c_str(),
+                                        name.c_str(), value ? "true" : "false");
+  CXBMCTinyXML doc;
+  doc.Parse(xml);
+  EXPECT_TRUE(CSkinSettings::Get().Load(doc.RootElement()));
+}
+
+TEST(TestGUIInfoManager, SkinSettingsInvalidateBools)
+{
+  LoadSkinSetting("infotest", true);
+  INFO::InfoPtr info = g_infoManager.Register("skin.hassetting(infotest)");
+  ASSERT_TRUE(info);
+
+  g_infoManager.NextFrame();
+  EXPECT_TRUE(info->Get());
+
+  // unchanged settings don't evaluate the bool again
+  g_infoManager.NextFrame();
+  EXPECT_TRUE(info->Get());
+  g_infoManager.NextFrame();
+  EXPECT_EQ(0u, g_infoManager.GetBoolEvaluations());
+
+  CSkinSettings::Get().Reset();
+  g_infoManager.NextFrame();
+  EXPECT_FALSE(info->Get());
+
+  CSkinSettings::Get().SetBool(CSkinSettings::Get().TranslateBool("infotest"), true);
+  g_infoManager.NextFrame();
+  EXPECT_TRUE(info->Get());
+
+  LoadSkinSetting("infotest", false);
+  g_infoManager.NextFrame();
+  EXPECT_FALSE(info->Get());
+
+  CSkinSettings::Get().Clear();
+}
@@ -0,0 +1,81 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "threads/Atomics.h"
+#include "threads/Helpers.h"
+
+namespace XbmcThreads
+{
+  /**
+   * A fixed size ring handing values from one thread to another without
+   *  locking. Push() may only be called from the producing thread, Front(),
+   *  Peek() and Pop() only from the consuming one. Size() and Empty() may be
+   *  called from either, the producer may see a value that is already stale.
+   *
+   * The indices only ever grow and are changed with atomic increments, which
+   *  are full barriers on every platform we support, so an item is written
+   *  before it becomes visible and read before its slot is given back.
+   *
+   * N has to be a power of two.
+   */
+  template <class T, unsigned int N> class SPSCRing : public NonCopyable
+  {
+    typedef char ring_size_must_be_a_power_of_two[(N & (N - 1)) == 0 ? 1 : -1];
+
+    T m_items[N];
+    volatile long m_read;
+    volatile long m_write;
+
+    static inline long load(const volatile long& index) { return AtomicAdd(const_cast<volatile long*>(&index), 0); }
+
+  public:
+    inline SPSCRing() : m_read(0), m_write(0) {}
+
+    /**
+     * Called from the producer. Returns false if the ring is full.
+     */
+    inline bool Push(const T& value)
+    {
+      long write = m_write; // only we change it
+      if ((unsigned long)(write - load(m_read)) >= N)
+        return false;
+      m_items[write & (N - 1)] = value;
+      AtomicIncrement(&m_write);
+      return true;
+    }
+
+    inline unsigned int Size() const { return (unsigned int)(unsigned long)(load(m_write) - load(m_read)); }
+    inline bool Empty() const { return Size() == 0; }
+
+    /**
+     * Called from the consumer, i has to be below Size().
+     */
+    inline const T& Peek(unsigned int i) const { return m_items[(m_read + i) & (N - 1)]; }
+    inline const T& Front() const { return Peek(0); }
+    inline void Pop() { AtomicIncrement(&m_read); }
+
+    /**
+     * Only safe while neither side uses the ring.
+     */
+    inline void Clear() { m_read = m_write = 0; }
+  };
+}
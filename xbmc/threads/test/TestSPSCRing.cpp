@@ -0,0 +1,104 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TestHelpers.h"
+#include "threads/SPSCRing.h"
+
+#define TESTNUM 100000l
+
+using namespace XbmcThreads;
+
+typedef SPSCRing<long, 8> TestRing;
+
+class Producer : public IRunnable
+{
+  TestRing& ring;
+public:
+  inline Producer(TestRing& r) : ring(r) {}
+
+  virtual void Run()
+  {
+    for (long i = 0; i < TESTNUM; )
+    {
+      if (ring.Push(i))
+        i++;
+      else
+        SleepMillis(0); // let the consumer run on single core machines
+    }
+  }
+};
+
+TEST(TestSPSCRing, General)
+{
+  TestRing ring;
+  EXPECT_TRUE(ring.Empty());
+
+  for (long i = 0; i < 8; i++)
+    EXPECT_TRUE(ring.Push(i));
+  EXPECT_FALSE(ring.Push(8));
+  EXPECT_EQ(8u, ring.Size());
+
+  EXPECT_EQ(0, ring.Front());
+  EXPECT_EQ(5, ring.Peek(5));
+  ring.Pop();
+  ring.Pop();
+  EXPECT_EQ(6u, ring.Size());
+  EXPECT_EQ(2, ring.Front());
+
+  // wraps around the end of the slots
+  EXPECT_TRUE(ring.Push(8));
+  EXPECT_TRUE(ring.Push(9));
+  EXPECT_FALSE(ring.Push(10));
+  for (long i = 2; i < 10; i++)
+  {
+    EXPECT_EQ(i, ring.Front());
+    ring.Pop();
+  }
+  EXPECT_TRUE(ring.Empty());
+
+  ring.Push(1);
+  ring.Clear();
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(TestSPSCRing, Threads)
+{
+  TestRing ring;
+  Producer producer(ring);
+  thread t(producer);
+
+  bool ordered = true;
+  for (long i = 0; i < TESTNUM; )
+  {
+    if (ring.Empty())
+    {
+      SleepMillis(0);
+      continue;
+    }
+    if (ring.Front() != i)
+      ordered = false;
+    ring.Pop();
+    i++;
+  }
+  t.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_TRUE(ring.Empty());
+}
@@ -0,0 +1,179 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "CBORVariantWriter.h"
+
+#define CBOR_UNSIGNED     0
+#define CBOR_NEGATIVE     1
+#define CBOR_TEXT_STRING  3
+#define CBOR_ARRAY        4
+#define CBOR_MAP          5
+#define CBOR_SIMPLE       7
+
+#define CBOR_FALSE        20
+#define CBOR_TRUE         21
+#define CBOR_NULL         22
+#define CBOR_FLOAT        26
+#define CBOR_DOUBLE       27
+
+using namespace std;
+
+string CCBORVariantWriter::Write(const CVariant &value)
+{
+  string output;
+  CCBORVariantEncoder encoder;
+
+  if (!CVariantStreamWriter::Write(value, encoder, output))
+    output.clear();
+
+  return output;
+}
+
+bool CCBORVariantEncoder::WriteNull()
+{
+  m_output.push_back((char)(CBOR_SIMPLE << 5 | CBOR_NULL));
+  return true;
+}
+
+bool CCBORVariantEncoder::WriteBoolean(bool value)
+{
+  m_output.push_back((char)(CBOR_SIMPLE << 5 | (value ? CBOR_TRUE : CBOR_FALSE)));
+  return true;
+}
+
+bool CCBORVariantEncoder::WriteInteger(int64_t value)
+{
+  if (value < 0)
+    WriteHead(CBOR_NEGATIVE, (uint64_t)(-1 - value));
+  else
+    WriteHead(CBOR_UNSIGNED, (uint64_t)value);
+  return true;
+}
+
+bool CCBORVariantEncoder::WriteUnsignedInteger(uint64_t value)
+{
+  WriteHead(CBOR_UNSIGNED, value);
+  return true;
+}
+
+bool CCBORVariantEncoder::WriteDouble(double value)
+{
+  float single = (float)value;
+  if ((double)single == value || value != value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &single, sizeof(bits));
+    m_output.push_back((char)(CBOR_SIMPLE << 5 | CBOR_FLOAT));
+    for (int shift = 24; shift >= 0; shift -= 8)
+      m_output.push_back((char)(bits >> shift));
+  }
+  else
+  {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    m_output.push_back((char)(CBOR_SIMPLE << 5 | CBOR_DOUBLE));
+    for (int shift = 56; shift >= 0; shift -= 8)
+      m_output.push_back((char)(bits >> shift));
+  }
+  return true;
+}
+
+bool CCBORVariantEncoder::WriteString(const char *value, size_t length)
+{
+  WriteHead(CBOR_TEXT_STRING, length);
+  m_output.append(value, length);
+  return true;
+}
+
+bool CCBORVariantEncoder::BeginArray(unsigned int size)
+{
+  WriteHead(CBOR_ARRAY, size);
+  return true;
+}
+
+bool CCBORVariantEncoder::EndArray()
+{
+  return true;
+}
+
+bool CCBORVariantEncoder::BeginObject(unsigned int size)
+{
+  WriteHead(CBOR_MAP, size);
+  return true;
+}
+
+bool CCBORVariantEncoder::WriteKey(const char *key, size_t length)
+{
+  return WriteString(key, length);
+}
+
+bool CCBORVariantEncoder::EndObject()
+{
+  return true;
+}
+
+void CCBORVariantEncoder::TakeOutput(string &buffer)
+{
+  if (buffer.empty())
+    buffer.swap(m_output);
+  else
+  {
+    buffer.append(m_output);
+    m_output.clear();
+  }
+}
+
+void CCBORVariantEncoder::WriteHead(uint8_t majorType, uint64_t value)
+{
+  // the major type lives in the upper 3 bits, the lower 5 bits either hold
+  // the value itself or how many bytes of it follow in network byte order
+  uint8_t type = majorType << 5;
+  int bytes;
+  if (value < 24)
+  {
+    m_output.push_back((char)(type | value));
+    return;
+  }
+  else if (value <= 0xFF)
+  {
+    m_output.push_back((char)(type | 24));
+    bytes = 1;
+  }
+  else if (value <= 0xFFFF)
+  {
+    m_output.push_back((char)(type | 25));
+    bytes = 2;
+  }
+  else if (value <= 0xFFFFFFFFULL)
+  {
+    m_output.push_back((char)(type | 26));
+    bytes = 4;
+  }
+  else
+  {
+    m_output.push_back((char)(type | 27));
+    bytes = 8;
+  }
+
+  for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+    m_output.push_back((char)(value >> shift));
+}
@@ -0,0 +1,63 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Variant.h"
+#include "VariantStreamWriter.h"
+
+/*!
+ \brief Writes a CVariant as CBOR (RFC 7049), a compact binary encoding of the JSON data model
+ */
+class CCBORVariantWriter
+{
+public:
+  static std::string Write(const CVariant &value);
+};
+
+/*!
+ \brief Encodes values as CBOR, for use with CVariantStreamWriter
+
+ Arrays and objects are written with their length, doubles are written as
+ single precision floats when that doesn't lose precision.
+ */
+class CCBORVariantEncoder : public IVariantEncoder
+{
+public:
+  virtual ~CCBORVariantEncoder() { }
+
+  virtual bool WriteNull();
+  virtual bool WriteBoolean(bool value);
+  virtual bool WriteInteger(int64_t value);
+  virtual bool WriteUnsignedInteger(uint64_t value);
+  virtual bool WriteDouble(double value);
+  virtual bool WriteString(const char *value, size_t length);
+  virtual bool BeginArray(unsigned int size);
+  virtual bool EndArray();
+  virtual bool BeginObject(unsigned int size);
+  virtual bool WriteKey(const char *key, size_t length);
+  virtual bool EndObject();
+
+  virtual void TakeOutput(std::string &buffer);
+
+private:
+  void WriteHead(uint8_t majorType, uint64_t value);
+
+  std::string m_output;
+};
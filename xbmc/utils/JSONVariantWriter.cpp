@@ -18,7 +18,8 @@
  *
  */
 
-#include <locale>
+#include <stdio.h>
+#include <string.h>
 
 #include "JSONVariantWriter.h"
 
@@ -27,112 +28,143 @@ using namespace std;
 string CJSONVariantWriter::Write(const CVariant &value, bool compact)
 {
   string output;
+  CJSONVariantEncoder encoder(compact);
 
+  if (!CVariantStreamWriter::Write(value, encoder, output))
+    output.clear();
+
+  return output;
+}
+
+CJSONVariantEncoder::CJSONVariantEncoder(bool compact)
+{
 #if YAJL_MAJOR == 2
-  yajl_gen g = yajl_gen_alloc(NULL);
-  yajl_gen_config(g, yajl_gen_beautify, compact ? 0 : 1);
-  yajl_gen_config(g, yajl_gen_indent_string, "\t");
+  m_generator = yajl_gen_alloc(NULL);
+  yajl_gen_config(m_generator, yajl_gen_beautify, compact ? 0 : 1);
+  yajl_gen_config(m_generator, yajl_gen_indent_string, "\t");
 #else
   yajl_gen_config conf = { compact ? 0 : 1, "\t" };
-  yajl_gen g = yajl_gen_alloc(&conf, NULL);
+  m_generator = yajl_gen_alloc(&conf, NULL);
 #endif
+}
 
-  // Set locale to classic ("C") to ensure valid JSON numbers
-  const char *currentLocale = setlocale(LC_NUMERIC, NULL);
-  if (currentLocale != NULL)
-    setlocale(LC_NUMERIC, "C");
+CJSONVariantEncoder::~CJSONVariantEncoder()
+{
+  yajl_gen_clear(m_generator);
+  yajl_gen_free(m_generator);
+}
 
-  if (InternalWrite(g, value))
-  {
-    const unsigned char * buffer;
+bool CJSONVariantEncoder::WriteNull()
+{
+  return yajl_gen_status_ok == yajl_gen_null(m_generator);
+}
+
+bool CJSONVariantEncoder::WriteBoolean(bool value)
+{
+  return yajl_gen_status_ok == yajl_gen_bool(m_generator, value ? 1 : 0);
+}
 
+bool CJSONVariantEncoder::WriteInteger(int64_t value)
+{
 #if YAJL_MAJOR == 2
-    size_t length;
-    yajl_gen_get_buf(g, &buffer, &length);
+  return yajl_gen_status_ok == yajl_gen_integer(m_generator, (long long int)value);
 #else
-    unsigned int length;
-    yajl_gen_get_buf(g, &buffer, &length);
+  return yajl_gen_status_ok == yajl_gen_integer(m_generator, (long int)value);
 #endif
-    output = string((const char *)buffer, length);
-  }
-
-  // Re-set locale to what it was before using yajl
-  if (currentLocale != NULL)
-    setlocale(LC_NUMERIC, currentLocale);
-
-  yajl_gen_clear(g);
-  yajl_gen_free(g);
-
-  return output;
 }
 
-bool CJSONVariantWriter::InternalWrite(yajl_gen g, const CVariant &value)
+bool CJSONVariantEncoder::WriteUnsignedInteger(uint64_t value)
 {
-  bool success = false;
-
-  switch (value.type())
-  {
-  case CVariant::VariantTypeInteger:
 #if YAJL_MAJOR == 2
-    success = yajl_gen_status_ok == yajl_gen_integer(g, (long long int)value.asInteger());
+  return yajl_gen_status_ok == yajl_gen_integer(m_generator, (long long int)value);
 #else
-    success = yajl_gen_status_ok == yajl_gen_integer(g, (long int)value.asInteger());
+  return yajl_gen_status_ok == yajl_gen_integer(m_generator, (long int)value);
 #endif
-    break;
-  case CVariant::VariantTypeUnsignedInteger:
+}
+
+bool CJSONVariantEncoder::WriteDouble(double value)
+{
+  // JSON has no numbers for these, yajl refuses them as well
+  if (value != value || value - value != 0.0)
+    return false;
+
+  // Formatted like yajl_gen_double() does, but without relying on the process wide
+  // locale, which may be changed by other threads: the decimal separator is the
+  // only locale dependent part of the number and is replaced by a point
+  char buffer[64];
+  int length = snprintf(buffer, sizeof(buffer), "%.20g", value);
+  if (length <= 0 || length >= (int)sizeof(buffer))
+    return false;
+
+  char number[64];
+  size_t size = 0;
+  bool separator = false;
+  for (int i = 0; i < length; i++)
+  {
+    char c = buffer[i];
+    if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == 'e' || c == 'E')
+      number[size++] = c;
+    else if (!separator)
+    {
+      number[size++] = '.';
+      separator = true;
+    }
+  }
+
 #if YAJL_MAJOR == 2
-    success = yajl_gen_status_ok == yajl_gen_integer(g, (long long int)value.asUnsignedInteger());
+  return yajl_gen_status_ok == yajl_gen_number(m_generator, number, size);
 #else
-    success = yajl_gen_status_ok == yajl_gen_integer(g, (long int)value.asUnsignedInteger());
+  return yajl_gen_status_ok == yajl_gen_number(m_generator, number, (unsigned int)size);
 #endif
-    break;
-  case CVariant::VariantTypeDouble:
-    success = yajl_gen_status_ok == yajl_gen_double(g, value.asDouble());
-    break;
-  case CVariant::VariantTypeBoolean:
-    success = yajl_gen_status_ok == yajl_gen_bool(g, value.asBoolean() ? 1 : 0);
-    break;
-  case CVariant::VariantTypeString:
+}
+
+bool CJSONVariantEncoder::WriteString(const char *value, size_t length)
+{
 #if YAJL_MAJOR == 2
-    success = yajl_gen_status_ok == yajl_gen_string(g, (const unsigned char*)value.c_str(), (size_t)value.size());
+  return yajl_gen_status_ok == yajl_gen_string(m_generator, (const unsigned char*)value, length);
 #else
-    success = yajl_gen_status_ok == yajl_gen_string(g, (const unsigned char*)value.c_str(), value.size());
+  return yajl_gen_status_ok == yajl_gen_string(m_generator, (const unsigned char*)value, (unsigned int)length);
 #endif
-    break;
-  case CVariant::VariantTypeArray:
-    success = yajl_gen_status_ok == yajl_gen_array_open(g);
+}
+
+bool CJSONVariantEncoder::BeginArray(unsigned int size)
+{
+  return yajl_gen_status_ok == yajl_gen_array_open(m_generator);
+}
+
+bool CJSONVariantEncoder::EndArray()
+{
+  return yajl_gen_status_ok == yajl_gen_array_close(m_generator);
+}
 
-    for (CVariant::const_iterator_array itr = value.begin_array(); itr != value.end_array() && success; ++itr)
-      success &= InternalWrite(g, *itr);
+bool CJSONVariantEncoder::BeginObject(unsigned int size)
+{
+  return yajl_gen_status_ok == yajl_gen_map_open(m_generator);
+}
 
-    if (success)
-      success = yajl_gen_status_ok == yajl_gen_array_close(g);
+bool CJSONVariantEncoder::WriteKey(const char *key, size_t length)
+{
+  return WriteString(key, length);
+}
 
-    break;
-  case CVariant::VariantTypeObject:
-    success = yajl_gen_status_ok == yajl_gen_map_open(g);
+bool CJSONVariantEncoder::EndObject()
+{
+  return yajl_gen_status_ok == yajl_gen_map_close(m_generator);
+}
 
-    for (CVariant::const_iterator_map itr = value.begin_map(); itr != value.end_map() && success; ++itr)
-    {
+void CJSONVariantEncoder::TakeOutput(string &buffer)
+{
+  const unsigned char * output;
 #if YAJL_MAJOR == 2
-      success &= yajl_gen_status_ok == yajl_gen_string(g, (const unsigned char*)itr->first.c_str(), (size_t)itr->first.length());
+  size_t length;
 #else
-      success &= yajl_gen_status_ok == yajl_gen_string(g, (const unsigned char*)itr->first.c_str(), itr->first.length());
+  unsigned int length;
 #endif
-      if (success)
-        success &= InternalWrite(g, itr->second);
-    }
+  yajl_gen_get_buf(m_generator, &output, &length);
 
-    if (success)
-      success &= yajl_gen_status_ok == yajl_gen_map_close(g);
-
-    break;
-  case CVariant::VariantTypeConstNull:
-  case CVariant::VariantTypeNull:
-  default:
-    success = yajl_gen_status_ok == yajl_gen_null(g);
-    break;
+  if (length > 0)
+  {
+    buffer.append((const char *)output, length);
+    yajl_gen_clear(m_generator);
   }
-
-  return success;
 }
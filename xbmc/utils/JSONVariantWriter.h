@@ -21,6 +21,7 @@
 
 #include "system.h"
 #include "Variant.h"
+#include "VariantStreamWriter.h"
 #include <yajl/yajl_gen.h>
 #ifdef HAVE_YAJL_YAJL_VERSION_H
 #include <yajl/yajl_version.h>
@@ -30,6 +31,31 @@ class CJSONVariantWriter
 {
 public:
   static std::string Write(const CVariant &value, bool compact);
+};
+
+/*!
+ \brief Encodes values as JSON, for use with CVariantStreamWriter
+ */
+class CJSONVariantEncoder : public IVariantEncoder
+{
+public:
+  CJSONVariantEncoder(bool compact);
+  virtual ~CJSONVariantEncoder();
+
+  virtual bool WriteNull();
+  virtual bool WriteBoolean(bool value);
+  virtual bool WriteInteger(int64_t value);
+  virtual bool WriteUnsignedInteger(uint64_t value);
+  virtual bool WriteDouble(double value);
+  virtual bool WriteString(const char *value, size_t length);
+  virtual bool BeginArray(unsigned int size);
+  virtual bool EndArray();
+  virtual bool BeginObject(unsigned int size);
+  virtual bool WriteKey(const char *key, size_t length);
+  virtual bool EndObject();
+
+  virtual void TakeOutput(std::string &buffer);
+
 private:
-  static bool InternalWrite(yajl_gen g, const CVariant &value);
+  yajl_gen m_generator;
 };
@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
 #include "utils/log.h"
 
 #include "system.h"
@@ -71,10 +72,18 @@ void CJobWorker::Process()
     {
       CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, job->GetType());
     }
-    m_jobManager->OnJobComplete(success, job);
+    m_jobManager->OnJobComplete(this, success, job);
   }
 }
 
+size_t CJobWorker::QueueSize() const
+{
+  size_t size = 0;
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    size += m_jobQueue[priority].size();
+  return size;
+}
+
 void CJobQueue::CJobPointer::CancelJob()
 {
   CJobManager::GetInstance().CancelJob(m_id);
@@ -175,13 +184,15 @@ CJobManager &CJobManager::GetInstance()
 CJobManager::CJobManager()
 {
   m_jobCounter = 0;
+  m_nextWorker = 0;
+  m_processing = 0;
   m_running = true;
   m_pauseJobs = false;
 }
 
 void CJobManager::Restart()
 {
-  CSingleLock lock(m_section);
+  CExclusiveLock lock(m_section);
 
   if (m_running)
     throw std::logic_error("CJobManager already running");
@@ -190,18 +201,24 @@ void CJobManager::Restart()
 
 void CJobManager::CancelJobs()
 {
-  CSingleLock lock(m_section);
+  CExclusiveLock lock(m_section);
   m_running = false;
 
-  // clear any pending jobs
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  for (Workers::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
   {
-    for_each(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
-    m_jobQueue[priority].clear();
-  }
+    CJobWorker *worker = *it;
+    CSingleLock workerLock(worker->m_section);
 
-  // cancel any callbacks on jobs still processing
-  for_each(m_processing.begin(), m_processing.end(), mem_fun_ref(&CWorkItem::Cancel));
+    // clear any pending jobs
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+    {
+      for_each(worker->m_jobQueue[priority].begin(), worker->m_jobQueue[priority].end(), mem_fun_ref(&CWorkItem::FreeJob));
+      worker->m_jobQueue[priority].clear();
+    }
+
+    // cancel any callbacks on jobs still processing
+    worker->m_current.Cancel();
+  }
 
   // tell our workers to finish
   while (m_workers.size())
@@ -219,83 +236,172 @@ CJobManager::~CJobManager()
 
 unsigned int CJobManager::AddJob(CJob *job, IJobCallback *callback, CJob::PRIORITY priority)
 {
-  CSingleLock lock(m_section);
-
-  if (!m_running)
-    return 0;
-
   // increment the job counter, ensuring 0 (invalid job) is never hit
-  m_jobCounter++;
-  if (m_jobCounter == 0)
-    m_jobCounter++;
+  unsigned int id = (unsigned int)AtomicIncrement(&m_jobCounter);
+  if (id == 0)
+    id = (unsigned int)AtomicIncrement(&m_jobCounter);
 
   // create a work item for this job
-  CWorkItem work(job, m_jobCounter, priority, callback);
-  m_jobQueue[priority].push_back(work);
+  CWorkItem work(job, id, priority, callback);
+
+  {
+    // common case: a worker is available (or we're at the limit for this
+    // priority), so we only need to read the worker list
+    CSharedLock lock(m_section);
+    if (!m_running)
+      return 0;
+
+    if (!NeedWorker(priority))
+    {
+      QueueJob(work);
+      lock.Leave();
+      m_jobEvent.Set();
+      return id;
+    }
+  }
 
-  StartWorkers(priority);
-  return work.m_id;
+  // everyone is busy - we need more workers
+  CExclusiveLock lock(m_section);
+  if (!m_running)
+    return 0;
+
+  if (NeedWorker(priority))
+    m_workers.push_back(new CJobWorker(this));
+  QueueJob(work);
+  lock.Leave();
+  m_jobEvent.Set();
+  return id;
 }
 
 void CJobManager::CancelJob(unsigned int jobID)
 {
-  CSingleLock lock(m_section);
+  CSharedLock lock(m_section);
 
-  // check whether we have this job in the queue
-  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  for (Workers::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
   {
-    JobQueue::iterator i = find(m_jobQueue[priority].begin(), m_jobQueue[priority].end(), jobID);
-    if (i != m_jobQueue[priority].end())
+    CJobWorker *worker = *it;
+    CSingleLock workerLock(worker->m_section);
+
+    // check whether we have this job in the queue
+    for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
     {
-      delete i->m_job;
-      m_jobQueue[priority].erase(i);
+      JobQueue::iterator i = find(worker->m_jobQueue[priority].begin(), worker->m_jobQueue[priority].end(), jobID);
+      if (i != worker->m_jobQueue[priority].end())
+      {
+        delete i->m_job;
+        worker->m_jobQueue[priority].erase(i);
+        return;
+      }
+    }
+    // or if we're processing it
+    if (worker->m_current.m_job && worker->m_current == jobID)
+    {
+      worker->m_current.m_callback = NULL; // job is in progress, so only thing to do is to remove callback
       return;
     }
   }
-  // or if we're processing it
-  Processing::iterator it = find(m_processing.begin(), m_processing.end(), jobID);
-  if (it != m_processing.end())
-    it->m_callback = NULL; // job is in progress, so only thing to do is to remove callback
 }
 
-void CJobManager::StartWorkers(CJob::PRIORITY priority)
+bool CJobManager::NeedWorker(CJob::PRIORITY priority) const
 {
-  CSingleLock lock(m_section);
+  unsigned int processing = (unsigned int)m_processing;
 
   // check how many free threads we have
-  if (m_processing.size() >= GetMaxWorkers(priority))
-    return;
+  if (processing >= GetMaxWorkers(priority))
+    return false;
 
   // do we have any sleeping threads?
-  if (m_processing.size() < m_workers.size())
+  return processing >= m_workers.size();
+}
+
+void CJobManager::QueueJob(const CWorkItem &work)
+{
+  // jobs queued from one of our workers (eg by a job or a job callback) stay local
+  CJobWorker *worker = NULL;
+  CThread *thread = CThread::GetCurrentThread();
+  for (Workers::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
   {
-    m_jobEvent.Set();
-    return;
+    if (*it == thread)
+    {
+      worker = *it;
+      break;
+    }
   }
+  if (!worker)
+    worker = m_workers[(unsigned long)AtomicIncrement(&m_nextWorker) % m_workers.size()];
 
-  // everyone is busy - we need more workers
-  m_workers.push_back(new CJobWorker(this));
+  CSingleLock lock(worker->m_section);
+  worker->m_jobQueue[work.m_priority].push_back(work);
 }
 
-CJob *CJobManager::PopJob()
+bool CJobManager::ReserveSlot(CJob::PRIORITY priority)
+{
+  long max = (long)GetMaxWorkers(priority);
+  long processing;
+  do
+  {
+    processing = m_processing;
+    if (processing >= max)
+      return false;
+  } while (cas(&m_processing, processing, processing + 1) != processing);
+  return true;
+}
+
+CJob *CJobManager::PopJob(CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
   for (int priority = CJob::PRIORITY_HIGH; priority >= CJob::PRIORITY_LOW_PAUSABLE; --priority)
   {
     // Check whether we're pausing pausable jobs
     if (priority == CJob::PRIORITY_LOW_PAUSABLE && m_pauseJobs)
       continue;
 
-    if (m_jobQueue[priority].size() && m_processing.size() < GetMaxWorkers(CJob::PRIORITY(priority)))
+    if (!ReserveSlot(CJob::PRIORITY(priority)))
+      continue;
+
+    {
+      CSingleLock lock(worker->m_section);
+      JobQueue &queue = worker->m_jobQueue[priority];
+      if (queue.size())
+      {
+        // pop the oldest job off our own queue and mark it as processing
+        worker->m_current = queue.front();
+        queue.pop_front();
+        worker->m_current.m_job->m_callback = this;
+        return worker->m_current.m_job;
+      }
+    }
+
+    CJob *job = StealJob(worker, CJob::PRIORITY(priority));
+    if (job)
+      return job;
+
+    AtomicDecrement(&m_processing);
+  }
+  return NULL;
+}
+
+CJob *CJobManager::StealJob(CJobWorker *thief, CJob::PRIORITY priority)
+{
+  for (Workers::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
+  {
+    CJobWorker *victim = *it;
+    if (victim == thief)
+      continue;
+
+    // hold both workers while moving the job across, so that CancelJob() always
+    // finds it in one of them. Lock in address order to avoid deadlocking with
+    // a worker stealing from us at the same time.
+    CSingleLock first(thief < victim ? thief->m_section : victim->m_section);
+    CSingleLock second(thief < victim ? victim->m_section : thief->m_section);
+
+    JobQueue &queue = victim->m_jobQueue[priority];
+    if (queue.size())
     {
-      // pop the job off the queue
-      CWorkItem job = m_jobQueue[priority].front();
-      m_jobQueue[priority].pop_front();
-
-      // add to the processing vector
-      m_processing.push_back(job);
-      job.m_job->m_callback = this;
-      return job.m_job;
+      // steal from the back, away from where the victim pops its own jobs
+      thief->m_current = queue.back();
+      queue.pop_back();
+      thief->m_current.m_job->m_callback = this;
+      return thief->m_current.m_job;
     }
   }
   return NULL;
@@ -303,26 +409,27 @@ CJob *CJobManager::PopJob()
 
 void CJobManager::PauseJobs()
 {
-  CSingleLock lock(m_section);
+  CExclusiveLock lock(m_section);
   m_pauseJobs = true;
 }
 
 void CJobManager::UnPauseJobs()
 {
-  CSingleLock lock(m_section);
+  CExclusiveLock lock(m_section);
   m_pauseJobs = false;
 }
 
 bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 {
-  CSingleLock lock(m_section);
+  CSharedLock lock(m_section);
 
   if (m_pauseJobs)
     return false;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (Workers::const_iterator it = m_workers.begin(); it != m_workers.end(); ++it)
   {
-    if (priority == it->m_priority)
+    CSingleLock workerLock((*it)->m_section);
+    if ((*it)->m_current.m_job && priority == (*it)->m_current.m_priority)
       return true;
   }
   return false;
@@ -331,94 +438,141 @@ bool CJobManager::IsProcessing(const CJob::PRIORITY &priority) const
 int CJobManager::IsProcessing(const std::string &type) const
 {
   int jobsMatched = 0;
-  CSingleLock lock(m_section);
+  CSharedLock lock(m_section);
 
   if (m_pauseJobs)
     return 0;
 
-  for(Processing::const_iterator it = m_processing.begin(); it < m_processing.end(); ++it)
+  for (Workers::const_iterator it = m_workers.begin(); it != m_workers.end(); ++it)
   {
-    if (type == std::string(it->m_job->GetType()))
+    CSingleLock workerLock((*it)->m_section);
+    if ((*it)->m_current.m_job && type == std::string((*it)->m_current.m_job->GetType()))
       jobsMatched++;
   }
   return jobsMatched;
 }
 
-CJob *CJobManager::GetNextJob(const CJobWorker *worker)
+CJob *CJobManager::GetNextJob(CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
-  while (m_running)
+  CSharedLock lock(m_section);
+  while (true)
   {
-    // grab a job off the queue if we have one
-    CJob *job = PopJob();
+    while (m_running)
+    {
+      // grab a job off our queue or another worker's if we have one
+      CJob *job = PopJob(worker);
+      if (job)
+        return job;
+      // no jobs are left - sleep for 30 seconds to allow new jobs to come in
+      lock.Leave();
+      bool newJob = m_jobEvent.WaitMSec(30000);
+      lock.Enter();
+      if (!newJob)
+        break;
+    }
+    lock.Leave();
+
+    // ensure no jobs have come in during the period after timeout and
+    // before we held the lock. Nobody can queue a job while we hold the
+    // section exclusively.
+    CExclusiveLock exclusive(m_section);
+    CJob *job = PopJob(worker);
     if (job)
       return job;
-    // no jobs are left - sleep for 30 seconds to allow new jobs to come in
-    lock.Leave();
-    bool newJob = m_jobEvent.WaitMSec(30000);
-    lock.Enter();
-    if (!newJob)
-      break;
+
+    // paused jobs and jobs waiting for a free slot are still queued on us,
+    // they have to go to another worker or we have to stay around for them
+    if (m_running && worker->QueueSize() > 0 && !MoveJobs(worker))
+    {
+      exclusive.Leave();
+      lock.Enter();
+      continue;
+    }
+
+    // have no jobs
+    Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
+    if (i != m_workers.end())
+      m_workers.erase(i); // workers auto-delete
+    return NULL;
   }
-  // ensure no jobs have come in during the period after
-  // timeout and before we held the lock
-  CJob *job = PopJob();
-  if (job)
-    return job;
-  // have no jobs
-  RemoveWorker(worker);
-  return NULL;
 }
 
-bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
+bool CJobManager::MoveJobs(CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
-  // find the job in the processing queue, and check whether it's cancelled (no callback)
-  Processing::const_iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  CJobWorker *heir = NULL;
+  for (Workers::iterator it = m_workers.begin(); it != m_workers.end(); ++it)
   {
-    CWorkItem item(*i);
-    lock.Leave(); // leave section prior to call
-    if (item.m_callback)
+    if (*it != worker)
     {
-      item.m_callback->OnJobProgress(item.m_id, progress, total, job);
-      return false;
+      heir = *it;
+      break;
     }
   }
-  return true; // couldn't find the job, or it's been cancelled
+  if (!heir)
+    return false;
+
+  CSingleLock first(worker < heir ? worker->m_section : heir->m_section);
+  CSingleLock second(worker < heir ? heir->m_section : worker->m_section);
+  for (unsigned int priority = CJob::PRIORITY_LOW_PAUSABLE; priority <= CJob::PRIORITY_HIGH; ++priority)
+  {
+    JobQueue &queue = worker->m_jobQueue[priority];
+    heir->m_jobQueue[priority].insert(heir->m_jobQueue[priority].end(), queue.begin(), queue.end());
+    queue.clear();
+  }
+  return true;
 }
 
-void CJobManager::OnJobComplete(bool success, CJob *job)
+bool CJobManager::OnJobProgress(unsigned int progress, unsigned int total, const CJob *job) const
 {
-  CSingleLock lock(m_section);
-  // remove the job from the processing queue
-  Processing::iterator i = find(m_processing.begin(), m_processing.end(), job);
-  if (i != m_processing.end())
+  CSharedLock lock(m_section);
+  // find the job amongst the workers, and check whether it's cancelled (no callback)
+  for (Workers::const_iterator it = m_workers.begin(); it != m_workers.end(); ++it)
   {
-    // tell any listeners we're done with the job, then delete it
-    CWorkItem item(*i);
-    lock.Leave();
-    try
+    CSingleLock workerLock((*it)->m_section);
+    if ((*it)->m_current == job)
     {
+      CWorkItem item((*it)->m_current);
+      workerLock.Leave();
+      lock.Leave(); // leave section prior to call
       if (item.m_callback)
-        item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
-    }
-    catch (...)
-    {
-      CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
+      {
+        item.m_callback->OnJobProgress(item.m_id, progress, total, job);
+        return false;
+      }
+      break;
     }
-    lock.Enter();
-    Processing::iterator j = find(m_processing.begin(), m_processing.end(), job);
-    if (j != m_processing.end())
-      m_processing.erase(j);
-    lock.Leave();
-    item.FreeJob();
   }
+  return true; // couldn't find the job, or it's been cancelled
+}
+
+void CJobManager::OnJobComplete(CJobWorker *worker, bool success, CJob *job)
+{
+  CSingleLock lock(worker->m_section);
+  if (!(worker->m_current == job))
+    return;
+
+  // tell any listeners we're done with the job, then delete it
+  CWorkItem item(worker->m_current);
+  lock.Leave();
+  try
+  {
+    if (item.m_callback)
+      item.m_callback->OnJobComplete(item.m_id, success, item.m_job);
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s error processing job %s", __FUNCTION__, item.m_job->GetType());
+  }
+  lock.Enter();
+  worker->m_current = CWorkItem();
+  lock.Leave();
+  AtomicDecrement(&m_processing);
+  item.FreeJob();
 }
 
 void CJobManager::RemoveWorker(const CJobWorker *worker)
 {
-  CSingleLock lock(m_section);
+  CExclusiveLock lock(m_section);
   // remove our worker
   Workers::iterator i = find(m_workers.begin(), m_workers.end(), worker);
   if (i != m_workers.end())
@@ -23,21 +23,12 @@
 #include <vector>
 #include <string>
 #include "threads/CriticalSection.h"
+#include "threads/SharedSection.h"
 #include "threads/Thread.h"
 #include "Job.h"
 
 class CJobManager;
-
-class CJobWorker : public CThread
-{
-public:
-  CJobWorker(CJobManager *manager);
-  virtual ~CJobWorker();
-
-  void Process();
-private:
-  CJobManager  *m_jobManager;
-};
+class CJobWorker;
 
 /*!
  \ingroup jobs
@@ -165,6 +156,14 @@ private:
  priority levels.  Lower priority jobs are executed only if there are sufficient
  spare worker threads free to allow for higher priority jobs that may arise.
 
+ Each CJobWorker owns its own set of per-priority job queues.  New jobs are
+ distributed over the workers (or kept on the calling worker when a job adds
+ another job), and an idle worker steals from the back of the other workers'
+ queues before going to sleep.  Workers always take the highest priority job
+ available, whether from their own queue or stolen, so priorities are respected
+ across the whole pool.  The worker list itself is guarded by a shared section,
+ so adding and fetching jobs only contend on the queue of the worker involved.
+
  \sa CJob and IJobCallback
  */
 class CJobManager
@@ -172,6 +171,13 @@ class CJobManager
   class CWorkItem
   {
   public:
+    CWorkItem()
+    {
+      m_job = NULL;
+      m_id = 0;
+      m_callback = NULL;
+      m_priority = CJob::PRIORITY_LOW;
+    }
     CWorkItem(CJob *job, unsigned int id, CJob::PRIORITY priority, IJobCallback *callback)
     {
       m_job = job;
@@ -275,19 +281,21 @@ protected:
 
   /*!
    \brief Get a new job to process. Blocks until a new job is available, or a timeout has occurred.
+   Takes from the worker's own queues first, and steals from the other workers otherwise.
    \param worker a pointer to the current CJobWorker instance requesting a job.
    \sa CJob
    */
-  CJob *GetNextJob(const CJobWorker *worker);
+  CJob *GetNextJob(CJobWorker *worker);
 
   /*!
    \brief Callback from CJobWorker after a job has completed.
    Calls IJobCallback::OnJobComplete(), and then destroys job.
-   \param job a pointer to the calling subclassed CJob instance.
+   \param worker a pointer to the CJobWorker instance that processed the job.
    \param success the result from the DoWork call
+   \param job a pointer to the calling subclassed CJob instance.
    \sa IJobCallback, CJob
    */
-  void  OnJobComplete(bool success, CJob *job);
+  void  OnJobComplete(CJobWorker *worker, bool success, CJob *job);
 
   /*!
    \brief Callback from CJob to report progress and check for cancellation.
@@ -307,27 +315,88 @@ private:
   CJobManager const& operator=(CJobManager const&);
   virtual ~CJobManager();
 
-  /*! \brief Pop a job off the job queue and add to the processing queue ready to process
+  /*! \brief Pop a job off the worker's queues (or steal one from another worker) and mark it as processing.
+   Must be called with m_section held (shared or exclusive).
+   \param worker the worker that is going to process the job.
    \return the job to process, NULL if no jobs are available
    */
-  CJob *PopJob();
+  CJob *PopJob(CJobWorker *worker);
+
+  /*! \brief Steal the newest job of the given priority from another worker and mark it as processing on the thief.
+   Must be called with m_section held (shared or exclusive).
+   \param thief the worker that is going to process the job.
+   \param priority the priority of the queues to steal from.
+   \return the stolen job, NULL if no other worker has a job of this priority
+   */
+  CJob *StealJob(CJobWorker *thief, CJob::PRIORITY priority);
+
+  /*! \brief Hand the jobs still queued on a retiring worker to another worker.
+   Must be called with m_section held exclusively.
+   \param worker the worker about to retire.
+   \return true if the jobs were moved, false if there is no other worker to take them
+   */
+  bool MoveJobs(CJobWorker *worker);
+
+  /*! \brief Hand a work item to a worker's queue.
+   Jobs added from a worker thread stay with that worker, others are distributed round robin.
+   Must be called with m_section held (shared or exclusive) and at least one worker available.
+   */
+  void QueueJob(const CWorkItem &work);
+
+  /*! \brief Whether a new worker is needed to run a job of the given priority.
+   Must be called with m_section held (shared or exclusive).
+   */
+  bool NeedWorker(CJob::PRIORITY priority) const;
+
+  /*! \brief Reserve a processing slot for a job of the given priority
+   \return true if fewer than GetMaxWorkers(priority) jobs were processing, false otherwise.
+   */
+  bool ReserveSlot(CJob::PRIORITY priority);
 
-  void StartWorkers(CJob::PRIORITY priority);
   void RemoveWorker(const CJobWorker *worker);
   static unsigned int GetMaxWorkers(CJob::PRIORITY priority);
 
-  unsigned int m_jobCounter;
+  volatile long m_jobCounter;
+  volatile long m_nextWorker;
+  volatile long m_processing;   ///< number of jobs currently being processed
 
   typedef std::deque<CWorkItem>    JobQueue;
-  typedef std::vector<CWorkItem>   Processing;
   typedef std::vector<CJobWorker*> Workers;
 
-  JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
   bool       m_pauseJobs;
-  Processing m_processing;
   Workers    m_workers;
 
-  CCriticalSection m_section;
+  CSharedSection   m_section;   ///< guards m_workers, m_running and m_pauseJobs
   CEvent           m_jobEvent;
   bool             m_running;
 };
+
+/*!
+ \ingroup jobs
+ \brief Worker thread of the CJobManager.
+
+ Each worker holds its own queues of pending jobs (one per priority) and the job it is
+ currently processing, guarded by its own lock.  Other workers steal from these queues
+ when they run out of work.
+
+ \sa CJobManager
+ */
+class CJobWorker : public CThread
+{
+public:
+  CJobWorker(CJobManager *manager);
+  virtual ~CJobWorker();
+
+  void Process();
+private:
+  friend class CJobManager;
+
+  /*! \brief Number of jobs waiting in this worker's queues. Must be called with m_section held. */
+  size_t QueueSize() const;
+
+  CJobManager  *m_jobManager;
+
+  CCriticalSection        m_section;   ///< guards m_jobQueue and m_current
+  CJobManager::JobQueue   m_jobQueue[CJob::PRIORITY_HIGH+1];
+  CJobManager::CWorkItem  m_current;   ///< the job being processed, m_current.m_job is NULL when idle
+};
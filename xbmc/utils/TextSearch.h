@@ -38,6 +38,11 @@ public:
   bool Search(const CStdString &strHaystack) const;
   bool IsValid(void) const;
 
+  /*! \brief The terms that all have to be found, lower case unless the search is case sensitive */
+  const std::vector<CStdString> &GetAndTerms(void) const { return m_AND; }
+  /*! \brief The terms of which at least one has to be found, lower case unless the search is case sensitive */
+  const std::vector<CStdString> &GetOrTerms(void) const { return m_OR; }
+
 private:
   static void GetAndCutNextTerm(CStdString &strSearchTerm, CStdString &strNextTerm);
   void ExtractSearchTerms(const CStdString &strSearchTerm, TextSearchDefault defaultSearchMode);
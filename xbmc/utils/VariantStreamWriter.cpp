@@ -0,0 +1,199 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include "VariantStreamWriter.h"
+
+using namespace std;
+
+CVariantStreamWriter::CVariantStreamWriter(const CVariant &value, IVariantEncoder *encoder)
+  : m_value(value),
+    m_encoder(encoder),
+    m_started(false),
+    m_done(false),
+    m_failed(false),
+    m_offset(0)
+{ }
+
+CVariantStreamWriter::~CVariantStreamWriter()
+{
+  delete m_encoder;
+}
+
+int CVariantStreamWriter::Read(char *buffer, unsigned int size)
+{
+  if (m_failed)
+    return -1;
+
+  // drop what has already been read once it makes up most of the buffer
+  if (m_offset > 0 && m_offset >= m_output.size() / 2)
+  {
+    m_output.erase(0, m_offset);
+    m_offset = 0;
+  }
+
+  while (!m_done && m_output.size() - m_offset < size)
+  {
+    if (!Step())
+    {
+      m_failed = true;
+      return -1;
+    }
+    m_encoder->TakeOutput(m_output);
+  }
+
+  size_t length = m_output.size() - m_offset;
+  if (length > size)
+    length = size;
+
+  memcpy(buffer, m_output.c_str() + m_offset, length);
+  m_offset += length;
+
+  return (int)length;
+}
+
+bool CVariantStreamWriter::ReadAll(string &output)
+{
+  if (m_failed)
+    return false;
+
+  output.append(m_output, m_offset, string::npos);
+  m_output.clear();
+  m_offset = 0;
+
+  while (!m_done)
+  {
+    if (!Step())
+    {
+      m_failed = true;
+      return false;
+    }
+    m_encoder->TakeOutput(output);
+  }
+
+  return true;
+}
+
+bool CVariantStreamWriter::Write(const CVariant &value, IVariantEncoder &encoder, string &output)
+{
+  CVariantStreamWriter writer(value, NULL);
+  writer.m_encoder = &encoder;
+
+  bool success = writer.ReadAll(output);
+
+  writer.m_encoder = NULL;
+  return success;
+}
+
+bool CVariantStreamWriter::Step()
+{
+  if (!m_started)
+  {
+    m_started = true;
+    bool success = WriteValue(m_value);
+    m_done = success && m_stack.empty();
+    return success;
+  }
+
+  if (m_stack.empty())
+  {
+    m_done = true;
+    return true;
+  }
+
+  Frame &frame = m_stack.back();
+  bool success;
+  if (frame.value->isArray())
+  {
+    if (frame.arrayItr == frame.value->end_array())
+    {
+      m_stack.pop_back();
+      success = m_encoder->EndArray();
+    }
+    else
+    {
+      // advance before descending, the frame may move when the stack grows
+      const CVariant &item = *frame.arrayItr++;
+      success = WriteValue(item);
+    }
+  }
+  else
+  {
+    if (frame.mapItr == frame.value->end_map())
+    {
+      m_stack.pop_back();
+      success = m_encoder->EndObject();
+    }
+    else
+    {
+      const CVariant::const_iterator_map itr = frame.mapItr++;
+      success = m_encoder->WriteKey(itr->first.c_str(), itr->first.size()) && WriteValue(itr->second);
+    }
+  }
+
+  if (success && m_stack.empty())
+    m_done = true;
+
+  return success;
+}
+
+bool CVariantStreamWriter::WriteValue(const CVariant &value)
+{
+  switch (value.type())
+  {
+  case CVariant::VariantTypeInteger:
+    return m_encoder->WriteInteger(value.asInteger());
+  case CVariant::VariantTypeUnsignedInteger:
+    return m_encoder->WriteUnsignedInteger(value.asUnsignedInteger());
+  case CVariant::VariantTypeDouble:
+    return m_encoder->WriteDouble(value.asDouble());
+  case CVariant::VariantTypeBoolean:
+    return m_encoder->WriteBoolean(value.asBoolean());
+  case CVariant::VariantTypeString:
+    return m_encoder->WriteString(value.c_str(), value.size());
+  case CVariant::VariantTypeArray:
+  {
+    if (!m_encoder->BeginArray(value.size()))
+      return false;
+
+    Frame frame;
+    frame.value = &value;
+    frame.arrayItr = value.begin_array();
+    m_stack.push_back(frame);
+    return true;
+  }
+  case CVariant::VariantTypeObject:
+  {
+    if (!m_encoder->BeginObject(value.size()))
+      return false;
+
+    Frame frame;
+    frame.value = &value;
+    frame.mapItr = value.begin_map();
+    m_stack.push_back(frame);
+    return true;
+  }
+  case CVariant::VariantTypeConstNull:
+  case CVariant::VariantTypeNull:
+  default:
+    return m_encoder->WriteNull();
+  }
+}
@@ -0,0 +1,113 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Variant.h"
+
+/*!
+ \brief Serializes the values handed to it into some output format
+ */
+class IVariantEncoder
+{
+public:
+  virtual ~IVariantEncoder() { }
+
+  virtual bool WriteNull() = 0;
+  virtual bool WriteBoolean(bool value) = 0;
+  virtual bool WriteInteger(int64_t value) = 0;
+  virtual bool WriteUnsignedInteger(uint64_t value) = 0;
+  virtual bool WriteDouble(double value) = 0;
+  virtual bool WriteString(const char *value, size_t length) = 0;
+  virtual bool BeginArray(unsigned int size) = 0;
+  virtual bool EndArray() = 0;
+  virtual bool BeginObject(unsigned int size) = 0;
+  virtual bool WriteKey(const char *key, size_t length) = 0;
+  virtual bool EndObject() = 0;
+
+  /*!
+   \brief Moves the output encoded so far to the end of the given buffer
+   */
+  virtual void TakeOutput(std::string &buffer) = 0;
+};
+
+/*!
+ \brief Incrementally serializes a CVariant with a given encoder
+
+ Instead of rendering the whole value into one string, the value is walked
+ as the output is read, so a transport can pull the serialized value in
+ chunks of its own buffer size while only a chunk is held in memory.
+ */
+class CVariantStreamWriter
+{
+public:
+  /*!
+   \brief Creates a writer for the given value
+   \param value Value to serialize, has to stay valid and unchanged while reading
+   \param encoder Encoder producing the output, owned by the writer
+   */
+  CVariantStreamWriter(const CVariant &value, IVariantEncoder *encoder);
+  ~CVariantStreamWriter();
+
+  /*!
+   \brief Copies the next chunk of the serialized value into buffer
+   \return Number of bytes copied, 0 once everything has been read and -1 if the value could not be encoded
+   */
+  int Read(char *buffer, unsigned int size);
+
+  /*!
+   \brief Serializes the rest of the value into a string
+   \return False if the value could not be encoded
+   */
+  bool ReadAll(std::string &output);
+
+  bool IsDone() const { return m_done && m_offset >= m_output.size(); }
+
+  /*!
+   \brief Serializes a whole value into output
+   */
+  static bool Write(const CVariant &value, IVariantEncoder &encoder, std::string &output);
+
+private:
+  CVariantStreamWriter(const CVariantStreamWriter&);
+  CVariantStreamWriter& operator=(const CVariantStreamWriter&);
+
+  bool Step();
+  bool WriteValue(const CVariant &value);
+
+  struct Frame
+  {
+    const CVariant *value;
+    CVariant::const_iterator_array arrayItr;
+    CVariant::const_iterator_map mapItr;
+  };
+
+  const CVariant &m_value;
+  IVariantEncoder *m_encoder;
+  std::vector<Frame> m_stack;
+  bool m_started;
+  bool m_done;
+  bool m_failed;
+  std::string m_output;
+  size_t m_offset;
+};
@@ -22,7 +22,9 @@
 #include "log.h"
 #include "stdio_utf8.h"
 #include "stat_utf8.h"
+#include "threads/Atomics.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
 #include "utils/StdString.h"
@@ -32,6 +34,10 @@
 #elif defined(TARGET_WINDOWS)
 #include "win32/WIN32Util.h"
 #endif
+#if defined(TARGET_POSIX)
+#include <signal.h>
+#include <unistd.h>
+#endif
 
 #define critSec XBMC_GLOBAL_USE(CLog::CLogGlobals).critSec
 #define m_file XBMC_GLOBAL_USE(CLog::CLogGlobals).m_file
@@ -40,10 +46,378 @@
 #define m_repeatLine XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLine
 #define m_logLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_logLevel
 #define m_extraLogLevels XBMC_GLOBAL_USE(CLog::CLogGlobals).m_extraLogLevels
+#define m_writer XBMC_GLOBAL_USE(CLog::CLogGlobals).m_writer
+#define m_async XBMC_GLOBAL_USE(CLog::CLogGlobals).m_async
 
 static char levelNames[][8] =
 {"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
 
+#define LOG_RING_SIZE      2048 /* records queued by asynchronous logging, power of two */
+#define LOG_RECORD_SIZE    512  /* characters of a line that fit in a record */
+#define LOG_FLUSH_INTERVAL 100  /* ms the writer collects lines before writing them out */
+
+struct LogRecord
+{
+  volatile long sequence;
+  int           level;
+  uint64_t      threadId;
+  SYSTEMTIME    time;
+  std::string  *longText;
+  char          text[LOG_RECORD_SIZE];
+};
+
+/*
+ * Background writer of asynchronous logging. Callers claim a record of a
+ * bounded multi producer ring, format into it and publish it through its
+ * sequence number. The writer thread wakes up periodically, on errors and
+ * when the ring fills up, and writes out everything published in one batch
+ * with a single flush.
+ */
+class CLogWriter : public CThread
+{
+public:
+  CLogWriter() : CThread("LogWriter"), m_wake(false)
+  {
+    m_records = new LogRecord[LOG_RING_SIZE];
+    for (long i = 0; i < LOG_RING_SIZE; i++)
+    {
+      m_records[i].sequence = i;
+      m_records[i].longText = NULL;
+    }
+    m_enqueuePos  = 0;
+    m_dequeuePos  = 0;
+    m_producers   = 0;
+    m_dropped     = 0;
+    m_overflowed  = 0;
+    m_reported    = 0;
+  }
+
+  void Start()
+  {
+    m_bStop = false;
+    Create();
+  }
+
+  void Stop()
+  {
+    m_bStop = true;
+    m_wake.Set();
+    StopThread(true);
+  }
+
+  bool Push(int loglevel, const SYSTEMTIME &time, const char *format, va_list va);
+  void Drain();
+#if defined(TARGET_POSIX)
+  void WriteUnflushed(int fd) const;
+#endif
+  static void WriteLine(int loglevel, const SYSTEMTIME &time, uint64_t threadId, std::string &strData);
+
+  volatile long m_producers;
+  volatile long m_dropped;
+  volatile long m_overflowed;
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      m_wake.WaitMSec(LOG_FLUSH_INTERVAL);
+      Drain();
+    }
+  }
+
+private:
+  LogRecord    *m_records;
+  volatile long m_enqueuePos;
+  long          m_dequeuePos;
+  long          m_reported;
+  CEvent        m_wake;
+};
+
+/* queues a line, returns false if the ring is full */
+bool CLogWriter::Push(int loglevel, const SYSTEMTIME &time, const char *format, va_list va)
+{
+  LogRecord *record;
+  long pos = AtomicAdd(&m_enqueuePos, 0);
+  for (;;)
+  {
+    record = &m_records[pos & (LOG_RING_SIZE - 1)];
+    long diff = (long)((unsigned long)AtomicAdd(&record->sequence, 0) - (unsigned long)pos);
+    if (diff == 0)
+    {
+      long prev = cas(&m_enqueuePos, pos, pos + 1);
+      if (prev == pos)
+        break;
+      pos = prev;
+    }
+    else if (diff < 0)
+    {
+      m_wake.Set();
+      return false;
+    }
+    else
+      pos = AtomicAdd(&m_enqueuePos, 0);
+  }
+
+  record->level    = loglevel;
+  record->threadId = (uint64_t)CThread::GetCurrentThreadId();
+  record->time     = time;
+
+  va_list copy;
+  va_copy(copy, va);
+  int length = vsnprintf(record->text, LOG_RECORD_SIZE, format, copy);
+  va_end(copy);
+  if (length < 0 || length >= LOG_RECORD_SIZE)
+  {
+    record->longText = new std::string(StringUtils::FormatV(format, va));
+    AtomicIncrement(&m_overflowed);
+  }
+
+  // publish the record to the writer
+  AtomicIncrement(&record->sequence);
+
+  if (loglevel >= LOGERROR || ((pos + 1) & (LOG_RING_SIZE / 4 - 1)) == 0)
+    m_wake.Set();
+
+  return true;
+}
+
+void CLogWriter::Drain()
+{
+  CSingleLock waitLock(critSec);
+  for (;;)
+  {
+    LogRecord &record = m_records[m_dequeuePos & (LOG_RING_SIZE - 1)];
+    if ((long)((unsigned long)AtomicAdd(&record.sequence, 0) - (unsigned long)(m_dequeuePos + 1)) < 0)
+      break;
+
+    std::string strData;
+    if (record.longText)
+    {
+      strData.swap(*record.longText);
+      delete record.longText;
+      record.longText = NULL;
+    }
+    else
+      strData = record.text;
+
+    int level = record.level;
+    uint64_t threadId = record.threadId;
+    SYSTEMTIME time = record.time;
+
+    // hand the record back to the producers
+    AtomicAdd(&record.sequence, LOG_RING_SIZE - 1);
+    m_dequeuePos++;
+
+    if (m_file)
+      WriteLine(level, time, threadId, strData);
+  }
+
+  long dropped = AtomicAdd(&m_dropped, 0);
+  if (dropped != m_reported && m_file)
+  {
+    SYSTEMTIME time;
+    GetLocalTime(&time);
+    std::string strData = StringUtils::Format("CLog: %ld lines dropped, log buffer full", dropped - m_reported);
+    WriteLine(LOGWARNING, time, (uint64_t)CThread::GetCurrentThreadId(), strData);
+    m_reported = dropped;
+  }
+
+  if (m_file)
+    fflush(m_file);
+}
+
+/* writes a line, compressing repeats. critSec has to be held */
+void CLogWriter::WriteLine(int loglevel, const SYSTEMTIME &time, uint64_t threadId, std::string &strData)
+{
+  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
+
+  CStdString strPrefix;
+
+  if (m_repeatLogLevel == loglevel && m_repeatLine == strData)
+  {
+    m_repeatCount++;
+    return;
+  }
+  else if (m_repeatCount)
+  {
+    strPrefix = StringUtils::Format(prefixFormat,
+                                    time.wHour,
+                                    time.wMinute,
+                                    time.wSecond,
+                                    threadId,
+                                    levelNames[m_repeatLogLevel]);
+
+    CStdString strData2 = StringUtils::Format("Previous line repeats %d times."
+                                              LINE_ENDING,
+                                              m_repeatCount);
+    fputs(strPrefix.c_str(), m_file);
+    fputs(strData2.c_str(), m_file);
+    CLog::OutputDebugString(strData2);
+    m_repeatCount = 0;
+  }
+
+  m_repeatLine      = strData;
+  m_repeatLogLevel  = loglevel;
+
+  StringUtils::TrimRight(strData);
+  if (strData.empty())
+    return;
+
+  CLog::OutputDebugString(strData);
+
+  /* fixup newline alignment, number of spaces should equal prefix length */
+  StringUtils::Replace(strData, "\n", LINE_ENDING"                                            ");
+  strData += LINE_ENDING;
+
+  strPrefix = StringUtils::Format(prefixFormat,
+                                  time.wHour,
+                                  time.wMinute,
+                                  time.wSecond,
+                                  threadId,
+                                  levelNames[loglevel]);
+
+//print to adb
+#if defined(TARGET_ANDROID) && defined(_DEBUG)
+  CXBMCApp::android_printf("%s%s",strPrefix.c_str(), strData.c_str());
+#endif
+
+  fputs(strPrefix.c_str(), m_file);
+  fputs(strData.c_str(), m_file);
+}
+
+#if defined(TARGET_POSIX)
+static const int crashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+static struct sigaction crashActions[sizeof(crashSignals) / sizeof(crashSignals[0])];
+static CLogWriter * volatile crashWriter = NULL;
+static volatile int crashFd = -1;
+
+static void WriteRaw(int fd, const char *data, size_t length)
+{
+  while (length > 0)
+  {
+    ssize_t written = write(fd, data, length);
+    if (written <= 0)
+      return;
+    data   += written;
+    length -= written;
+  }
+}
+
+/* formats value right aligned into the buffer ending at end, returns its start */
+static char *FormatDecimal(char *end, uint64_t value, int digits)
+{
+  do
+  {
+    *--end = '0' + (char)(value % 10);
+    value /= 10;
+  } while (value || --digits > 0);
+  return end;
+}
+
+/*
+ * Writes the lines queued but not written yet straight to the file
+ * descriptor. Only called from the crash handler, so it doesn't lock,
+ * allocate or use stdio and leaves the ring untouched.
+ */
+void CLogWriter::WriteUnflushed(int fd) const
+{
+  for (long pos = m_dequeuePos; pos != m_dequeuePos + LOG_RING_SIZE; pos++)
+  {
+    const LogRecord &record = m_records[pos & (LOG_RING_SIZE - 1)];
+    if (record.sequence != pos + 1)
+      break;
+
+    char prefix[64];
+    char *end = prefix + sizeof(prefix);
+    char *start = end;
+    *--start = ' ';
+    *--start = ':';
+    const char *level = levelNames[record.level];
+    size_t length = strlen(level);
+    start -= length;
+    memcpy(start, level, length);
+    *--start = ' ';
+    start = FormatDecimal(start, record.threadId, 1);
+    *--start = ':';
+    *--start = 'T';
+    *--start = ' ';
+    start = FormatDecimal(start, record.time.wSecond, 2);
+    *--start = ':';
+    start = FormatDecimal(start, record.time.wMinute, 2);
+    *--start = ':';
+    start = FormatDecimal(start, record.time.wHour, 2);
+
+    WriteRaw(fd, start, end - start);
+    WriteRaw(fd, record.text, strnlen(record.text, LOG_RECORD_SIZE));
+    WriteRaw(fd, LINE_ENDING, strlen(LINE_ENDING));
+  }
+}
+
+/* writes out the queued lines, then hands the signal to the previous handler */
+static void CrashHandler(int sig, siginfo_t *info, void *context)
+{
+  // a previous handler that returns from a fault gets us called again
+  static volatile sig_atomic_t written = 0;
+  CLogWriter *writer = crashWriter;
+  int fd = crashFd;
+  if (writer && fd >= 0 && !written)
+  {
+    written = 1;
+    writer->WriteUnflushed(fd);
+  }
+
+  for (unsigned int i = 0; i < sizeof(crashSignals) / sizeof(crashSignals[0]); i++)
+  {
+    if (crashSignals[i] != sig)
+      continue;
+
+    struct sigaction &previous = crashActions[i];
+    if (previous.sa_flags & SA_SIGINFO)
+    {
+      if (previous.sa_sigaction)
+      {
+        previous.sa_sigaction(sig, info, context);
+        return;
+      }
+    }
+    else if (previous.sa_handler == SIG_IGN)
+    {
+      // only a sent signal can be ignored, returning from a fault would just fault again
+      if (!info || info->si_code <= 0)
+        return;
+    }
+    else if (previous.sa_handler != SIG_DFL)
+    {
+      previous.sa_handler(sig);
+      return;
+    }
+    break;
+  }
+
+  // let the default action end the process
+  signal(sig, SIG_DFL);
+  raise(sig);
+}
+
+static void InstallCrashHandler()
+{
+  static bool installed = false;
+  crashWriter = m_writer;
+  if (installed)
+    return;
+  installed = true;
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = CrashHandler;
+  action.sa_flags = SA_SIGINFO;
+  sigemptyset(&action.sa_mask);
+  for (unsigned int i = 0; i < sizeof(crashSignals) / sizeof(crashSignals[0]); i++)
+    sigaction(crashSignals[i], &action, &crashActions[i]);
+}
+#endif
+
 CLog::CLog()
 {}
 
@@ -52,10 +426,14 @@ CLog::~CLog()
 
 void CLog::Close()
 {
-  
+  SetAsync(false);
+
   CSingleLock waitLock(critSec);
   if (m_file)
   {
+#if defined(TARGET_POSIX)
+    crashFd = -1;
+#endif
     fclose(m_file);
     m_file = NULL;
   }
@@ -64,8 +442,6 @@ void CLog::Close()
 
 void CLog::Log(int loglevel, const char *format, ... )
 {
-  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
-  CSingleLock waitLock(critSec);
   int extras = (loglevel >> LOGMASKBIT) << LOGMASKBIT;
   loglevel = loglevel & LOGMASK;
 #if !(defined(_DEBUG) || defined(PROFILE))
@@ -82,65 +458,43 @@ void CLog::Log(int loglevel, const char *format, ... )
     SYSTEMTIME time;
     GetLocalTime(&time);
 
-    CStdString strPrefix, strData;
-
-    strData.reserve(16384);
     va_list va;
     va_start(va, format);
-    strData = StringUtils::FormatV(format,va);
-    va_end(va);
 
-    if (m_repeatLogLevel == loglevel && m_repeatLine == strData)
+    bool queued = false;
+    if (m_async)
     {
-      m_repeatCount++;
-      return;
+      CLogWriter *writer = m_writer;
+      AtomicIncrement(&writer->m_producers);
+      if (m_async)
+      {
+        // the writer is behind, drop the line rather than stall the caller.
+        // errors are written directly after everything queued
+        if (writer->Push(loglevel, time, format, va))
+          queued = true;
+        else if (loglevel < LOGERROR)
+        {
+          AtomicIncrement(&writer->m_dropped);
+          queued = true;
+        }
+      }
+      AtomicDecrement(&writer->m_producers);
     }
-    else if (m_repeatCount)
+
+    if (!queued)
     {
-      strPrefix = StringUtils::Format(prefixFormat,
-                                      time.wHour,
-                                      time.wMinute,
-                                      time.wSecond,
-                                      (uint64_t)CThread::GetCurrentThreadId(),
-                                      levelNames[m_repeatLogLevel]);
-
-      CStdString strData2 = StringUtils::Format("Previous line repeats %d times."
-                                                LINE_ENDING,
-                                                m_repeatCount);
-      fputs(strPrefix.c_str(), m_file);
-      fputs(strData2.c_str(), m_file);
-      OutputDebugString(strData2);
-      m_repeatCount = 0;
+      std::string strData = StringUtils::FormatV(format, va);
+      CSingleLock waitLock(critSec);
+      if (m_async)
+        m_writer->Drain();
+      if (m_file)
+      {
+        CLogWriter::WriteLine(loglevel, time, (uint64_t)CThread::GetCurrentThreadId(), strData);
+        fflush(m_file);
+      }
     }
-    
-    m_repeatLine      = strData;
-    m_repeatLogLevel  = loglevel;
-
-    StringUtils::TrimRight(strData);
-    if (strData.empty())
-      return;
-    
-    OutputDebugString(strData);
-
-    /* fixup newline alignment, number of spaces should equal prefix length */
-    StringUtils::Replace(strData, "\n", LINE_ENDING"                                            ");
-    strData += LINE_ENDING;
-
-    strPrefix = StringUtils::Format(prefixFormat,
-                                    time.wHour,
-                                    time.wMinute,
-                                    time.wSecond,
-                                    (uint64_t)CThread::GetCurrentThreadId(),
-                                    levelNames[loglevel]);
-
-//print to adb
-#if defined(TARGET_ANDROID) && defined(_DEBUG)
-  CXBMCApp::android_printf("%s%s",strPrefix.c_str(), strData.c_str());
-#endif
 
-    fputs(strPrefix.c_str(), m_file);
-    fputs(strData.c_str(), m_file);
-    fflush(m_file);
+    va_end(va);
   }
 }
 
@@ -176,6 +530,10 @@ bool CLog::Init(const char* path)
   {
     unsigned char BOM[3] = {0xEF, 0xBB, 0xBF};
     fwrite(BOM, sizeof(BOM), 1, m_file);
+#if defined(TARGET_POSIX)
+    // the crash handler can't use stdio, it writes to the descriptor
+    crashFd = fileno(m_file);
+#endif
   }
 
   return m_file != NULL;
@@ -248,3 +606,61 @@ void CLog::OutputDebugString(const std::string& line)
   ::OutputDebugString("\n");
 #endif
 }
+
+void CLog::SetAsync(bool async)
+{
+  static CCriticalSection asyncSection;
+  CSingleLock asyncLock(asyncSection);
+  if (async == m_async)
+    return;
+
+  if (async)
+  {
+    // the writer is kept for the lifetime of the process, a caller racing
+    // with disabling must never see it freed
+    if (!m_writer)
+      m_writer = new CLogWriter();
+#if defined(TARGET_POSIX)
+    InstallCrashHandler();
+#endif
+    m_writer->Start();
+    m_async = true;
+  }
+  else
+  {
+    {
+      // hold the file so lines queued before disabling are written before
+      // any line that is written directly
+      CSingleLock waitLock(critSec);
+      m_async = false;
+      while (AtomicAdd(&m_writer->m_producers, 0))
+        Sleep(1);
+      m_writer->Drain();
+    }
+    m_writer->Stop();
+    m_writer->Drain();
+  }
+}
+
+bool CLog::IsAsync()
+{
+  return m_async;
+}
+
+void CLog::Flush()
+{
+  if (m_writer)
+    m_writer->Drain();
+  else
+  {
+    CSingleLock waitLock(critSec);
+    if (m_file)
+      fflush(m_file);
+  }
+}
+
+void CLog::GetAsyncStats(unsigned int &dropped, unsigned int &overflowed)
+{
+  dropped    = m_writer ? (unsigned int)AtomicAdd(&m_writer->m_dropped, 0) : 0;
+  overflowed = m_writer ? (unsigned int)AtomicAdd(&m_writer->m_overflowed, 0) : 0;
+}
@@ -33,6 +33,8 @@
 #define ATTRIB_LOG_FORMAT
 #endif
 
+class CLogWriter;
+
 class CLog
 {
 public:
@@ -40,13 +42,15 @@ public:
   class CLogGlobals
   {
   public:
-    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0) {}
+    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_extraLogLevels(0), m_writer(NULL), m_async(false) {}
     FILE*       m_file;
     int         m_repeatCount;
     int         m_repeatLogLevel;
     std::string m_repeatLine;
     int         m_logLevel;
     int         m_extraLogLevels;
+    CLogWriter* m_writer;
+    volatile bool m_async;
     CCriticalSection critSec;
   };
 
@@ -59,7 +63,24 @@ public:
   static void SetLogLevel(int level);
   static int  GetLogLevel();
   static void SetExtraLogLevels(int level);
+
+  /*!
+   \brief Queue log lines for a background writer instead of writing them on the calling thread.
+   Lines are formatted into a ring of preallocated records and written out in batches,
+   lines are dropped when the ring is full. Disabling writes out everything queued.
+   */
+  static void SetAsync(bool async);
+  static bool IsAsync();
+  /*! \brief Synchronously write out all queued lines, used on shutdown and crash */
+  static void Flush();
+  /*!
+   \brief Counters of the asynchronous writer
+   \param dropped lines lost because the ring was full
+   \param overflowed lines too long for a record that had to be allocated
+   */
+  static void GetAsyncStats(unsigned int &dropped, unsigned int &overflowed);
 private:
+  friend class CLogWriter;
   static void OutputDebugString(const std::string& line);
 };
 
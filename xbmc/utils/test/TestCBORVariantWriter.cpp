@@ -0,0 +1,96 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/CBORVariantWriter.h"
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>
+
+namespace
+{
+std::string ToHex(const std::string &data)
+{
+  std::string hex;
+  char byte[3];
+  for (size_t i = 0; i < data.size(); i++)
+  {
+    sprintf(byte, "%02x", (unsigned char)data[i]);
+    hex += byte;
+  }
+  return hex;
+}
+}
+
+// expected values are taken from appendix A of RFC 7049
+TEST(TestCBORVariantWriter, WriteInteger)
+{
+  EXPECT_STREQ("00", ToHex(CCBORVariantWriter::Write(CVariant(0))).c_str());
+  EXPECT_STREQ("17", ToHex(CCBORVariantWriter::Write(CVariant(23))).c_str());
+  EXPECT_STREQ("1818", ToHex(CCBORVariantWriter::Write(CVariant(24))).c_str());
+  EXPECT_STREQ("1903e8", ToHex(CCBORVariantWriter::Write(CVariant(1000))).c_str());
+  EXPECT_STREQ("1a000f4240", ToHex(CCBORVariantWriter::Write(CVariant(1000000))).c_str());
+  EXPECT_STREQ("1b000000e8d4a51000", ToHex(CCBORVariantWriter::Write(CVariant((int64_t)1000000000000LL))).c_str());
+  EXPECT_STREQ("1bffffffffffffffff", ToHex(CCBORVariantWriter::Write(CVariant((uint64_t)18446744073709551615ULL))).c_str());
+  EXPECT_STREQ("20", ToHex(CCBORVariantWriter::Write(CVariant(-1))).c_str());
+  EXPECT_STREQ("3863", ToHex(CCBORVariantWriter::Write(CVariant(-100))).c_str());
+  EXPECT_STREQ("3903e7", ToHex(CCBORVariantWriter::Write(CVariant(-1000))).c_str());
+}
+
+TEST(TestCBORVariantWriter, WriteDouble)
+{
+  // exactly representable values are written as single precision
+  EXPECT_STREQ("fa3fc00000", ToHex(CCBORVariantWriter::Write(CVariant(1.5))).c_str());
+  EXPECT_STREQ("fa47c35000", ToHex(CCBORVariantWriter::Write(CVariant(100000.0))).c_str());
+  EXPECT_STREQ("fb3ff199999999999a", ToHex(CCBORVariantWriter::Write(CVariant(1.1))).c_str());
+}
+
+TEST(TestCBORVariantWriter, WriteSimple)
+{
+  EXPECT_STREQ("f4", ToHex(CCBORVariantWriter::Write(CVariant(false))).c_str());
+  EXPECT_STREQ("f5", ToHex(CCBORVariantWriter::Write(CVariant(true))).c_str());
+  EXPECT_STREQ("f6", ToHex(CCBORVariantWriter::Write(CVariant())).c_str());
+}
+
+TEST(TestCBORVariantWriter, WriteString)
+{
+  EXPECT_STREQ("60", ToHex(CCBORVariantWriter::Write(CVariant(""))).c_str());
+  EXPECT_STREQ("6449455446", ToHex(CCBORVariantWriter::Write(CVariant("IETF"))).c_str());
+  EXPECT_STREQ("62c3bc", ToHex(CCBORVariantWriter::Write(CVariant("\xc3\xbc"))).c_str());
+}
+
+TEST(TestCBORVariantWriter, WriteContainers)
+{
+  CVariant array(CVariant::VariantTypeArray);
+  EXPECT_STREQ("80", ToHex(CCBORVariantWriter::Write(array)).c_str());
+
+  array.push_back(1);
+  array.push_back(2);
+  array.push_back(3);
+  EXPECT_STREQ("83010203", ToHex(CCBORVariantWriter::Write(array)).c_str());
+
+  CVariant object(CVariant::VariantTypeObject);
+  EXPECT_STREQ("a0", ToHex(CCBORVariantWriter::Write(object)).c_str());
+
+  object["a"] = 1;
+  object["b"].push_back(2);
+  object["b"].push_back(3);
+  EXPECT_STREQ("a26161016162820203", ToHex(CCBORVariantWriter::Write(object)).c_str());
+}
@@ -22,6 +22,9 @@
 
 #include "gtest/gtest.h"
 
+#include <locale.h>
+#include <math.h>
+
 TEST(TestJSONVariantWriter, Write)
 {
   CVariant variant;
@@ -30,3 +33,23 @@ TEST(TestJSONVariantWriter, Write)
   str = CJSONVariantWriter::Write(variant, false);
   EXPECT_STREQ("null\n", str.c_str());
 }
+
+TEST(TestJSONVariantWriter, Doubles)
+{
+  EXPECT_STREQ("1.5", CJSONVariantWriter::Write(CVariant(1.5), true).c_str());
+  EXPECT_STREQ("-0.25", CJSONVariantWriter::Write(CVariant(-0.25), true).c_str());
+  EXPECT_STREQ("1.0000000000000000525e+300", CJSONVariantWriter::Write(CVariant(1e300), true).c_str());
+
+  // not representable in JSON
+  EXPECT_TRUE(CJSONVariantWriter::Write(CVariant(sqrt(-1.0)), true).empty());
+  EXPECT_TRUE(CJSONVariantWriter::Write(CVariant(HUGE_VAL), true).empty());
+
+  // a decimal comma doesn't end up in the output, if the locale is available
+  const char *locale = setlocale(LC_NUMERIC, NULL);
+  std::string oldLocale = locale ? locale : "C";
+  if (setlocale(LC_NUMERIC, "de_DE.UTF-8"))
+  {
+    EXPECT_STREQ("1.5", CJSONVariantWriter::Write(CVariant(1.5), true).c_str());
+    setlocale(LC_NUMERIC, oldLocale.c_str());
+  }
+}
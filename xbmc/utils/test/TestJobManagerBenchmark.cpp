@@ -0,0 +1,139 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/JobManager.h"
+#include "utils/TimeUtils.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+class TinyJob : public CJob
+{
+public:
+  TinyJob(unsigned int index) :
+    m_index(index),
+    m_queued(CurrentHostCounter())
+  {
+  }
+
+  const char *GetType() const
+  {
+    return "TinyJob";
+  }
+
+  bool DoWork()
+  {
+    return true;
+  }
+
+  unsigned int m_index;
+  int64_t m_queued;
+};
+
+class TinyJobCallback : public IJobCallback
+{
+public:
+  TinyJobCallback(unsigned int jobs) :
+    m_latency(jobs),
+    m_jobs(jobs),
+    m_completed(0)
+  {
+  }
+
+  void OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    TinyJob *tiny = static_cast<TinyJob *>(job);
+    m_latency[tiny->m_index] = CurrentHostCounter() - tiny->m_queued;
+    if (AtomicIncrement(&m_completed) == (long)m_jobs)
+      m_done.Set();
+  }
+
+  std::vector<int64_t> m_latency;
+  unsigned int m_jobs;
+  volatile long m_completed;
+  CEvent m_done;
+};
+
+double ToMicroSeconds(int64_t counter)
+{
+  return (double)counter * 1000000.0 / (double)CurrentHostFrequency();
+}
+
+void RunTinyJobs(unsigned int jobs)
+{
+  TinyJobCallback callback(jobs);
+
+  int64_t start = CurrentHostCounter();
+  for (unsigned int i = 0; i < jobs; i++)
+    CJobManager::GetInstance().AddJob(new TinyJob(i), &callback, CJob::PRIORITY(i % (CJob::PRIORITY_HIGH + 1)));
+  bool done = callback.m_done.WaitMSec(60000);
+  EXPECT_TRUE(done);
+  if (!done)
+  {
+    // the queued jobs complete into callback, which is gone once we return
+    CJobManager::GetInstance().CancelJobs();
+    return;
+  }
+  int64_t elapsed = CurrentHostCounter() - start;
+
+  std::vector<int64_t> &latency = callback.m_latency;
+  std::sort(latency.begin(), latency.end());
+
+  std::cout << "Jobs: " << testing::PrintToString(jobs) << std::endl;
+  std::cout << "  Jobs/sec: " << testing::PrintToString((double)jobs * 1000000.0 / ToMicroSeconds(elapsed)) << std::endl;
+  std::cout << "  Latency p50 (us): " << testing::PrintToString(ToMicroSeconds(latency[jobs / 2])) << std::endl;
+  std::cout << "  Latency p99 (us): " << testing::PrintToString(ToMicroSeconds(latency[jobs * 99 / 100])) << std::endl;
+  std::cout << "  Latency max (us): " << testing::PrintToString(ToMicroSeconds(latency[jobs - 1])) << std::endl;
+}
+}
+
+/* Microbenchmark of the CJobManager scheduler: enqueue many jobs that do no
+ * work, spread over all priorities, and measure throughput and the queued to
+ * completed latency of each job. */
+class TestJobManagerBenchmark : public testing::Test
+{
+protected:
+  ~TestJobManagerBenchmark()
+  {
+    CJobManager::GetInstance().CancelJobs();
+    CJobManager::GetInstance().Restart();
+  }
+};
+
+TEST_F(TestJobManagerBenchmark, TinyJobs1k)
+{
+  RunTinyJobs(1000);
+}
+
+TEST_F(TestJobManagerBenchmark, TinyJobs10k)
+{
+  RunTinyJobs(10000);
+}
+
+TEST_F(TestJobManagerBenchmark, TinyJobs100k)
+{
+  RunTinyJobs(100000);
+}
@@ -0,0 +1,164 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/CBORVariantWriter.h"
+#include "utils/JSONVariantWriter.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
+#include "utils/VariantStreamWriter.h"
+
+#include "gtest/gtest.h"
+
+namespace
+{
+CVariant CreateLibrary(unsigned int movies)
+{
+  CVariant result;
+  result["limits"]["start"] = 0;
+  result["limits"]["end"] = movies;
+  result["limits"]["total"] = movies;
+  result["movies"] = CVariant(CVariant::VariantTypeArray);
+
+  for (unsigned int i = 0; i < movies; i++)
+  {
+    CVariant movie;
+    movie["movieid"] = i;
+    movie["label"] = StringUtils::Format("Movie %u", i);
+    movie["year"] = 1950 + (int)(i % 60);
+    movie["rating"] = 5.0 + (i % 50) / 10.0;
+    movie["playcount"] = (int)(i % 3);
+    movie["file"] = StringUtils::Format("smb://server/movies/Movie %u (%u)/Movie %u.mkv", i, 1950 + i % 60, i);
+    movie["genre"].push_back("Drama");
+    movie["genre"].push_back("Thriller");
+    movie["plot"] = "A long enough plot outline to make up a realistic share of the response.";
+    movie["art"]["poster"] = StringUtils::Format("image://smb%%3a%%2f%%2fserver%%2fmovies%%2fMovie%%20%u%%2fposter.jpg/", i);
+    movie["art"]["fanart"] = StringUtils::Format("image://smb%%3a%%2f%%2fserver%%2fmovies%%2fMovie%%20%u%%2ffanart.jpg/", i);
+    movie["resume"]["position"] = 0.0;
+    movie["resume"]["total"] = 0.0;
+    movie["trailer"] = CVariant();
+    movie["set"] = i % 10 == 0;
+
+    result["movies"].push_back(movie);
+  }
+
+  return result;
+}
+
+std::string ReadChunked(const CVariant &value, IVariantEncoder *encoder, unsigned int chunkSize)
+{
+  CVariantStreamWriter writer(value, encoder);
+  std::string output;
+  std::vector<char> buffer(chunkSize);
+  int read;
+  while ((read = writer.Read(&buffer[0], chunkSize)) > 0)
+  {
+    EXPECT_LE((unsigned int)read, chunkSize);
+    output.append(&buffer[0], read);
+  }
+
+  EXPECT_EQ(0, read);
+  EXPECT_TRUE(writer.IsDone());
+  return output;
+}
+
+double ToMicroSeconds(int64_t counter)
+{
+  return (double)counter * 1000000.0 / (double)CurrentHostFrequency();
+}
+}
+
+TEST(TestVariantStreamWriter, ChunkedJSON)
+{
+  CVariant library = CreateLibrary(50);
+  std::string compact = CJSONVariantWriter::Write(library, true);
+  std::string beautified = CJSONVariantWriter::Write(library, false);
+
+  unsigned int chunkSizes[] = { 1, 7, 64, 4096, 1024 * 1024 };
+  for (unsigned int i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); i++)
+  {
+    EXPECT_EQ(compact, ReadChunked(library, new CJSONVariantEncoder(true), chunkSizes[i]));
+    EXPECT_EQ(beautified, ReadChunked(library, new CJSONVariantEncoder(false), chunkSizes[i]));
+  }
+}
+
+TEST(TestVariantStreamWriter, ChunkedCBOR)
+{
+  CVariant library = CreateLibrary(50);
+  std::string whole = CCBORVariantWriter::Write(library);
+
+  unsigned int chunkSizes[] = { 1, 7, 64, 4096, 1024 * 1024 };
+  for (unsigned int i = 0; i < sizeof(chunkSizes) / sizeof(chunkSizes[0]); i++)
+    EXPECT_EQ(whole, ReadChunked(library, new CCBORVariantEncoder(), chunkSizes[i]));
+}
+
+TEST(TestVariantStreamWriter, DeepNesting)
+{
+  // the value is walked without recursion so nesting depth isn't bound by the stack
+  CVariant root(CVariant::VariantTypeArray);
+  CVariant *current = &root;
+  for (unsigned int i = 0; i < 100000; i++)
+  {
+    current->push_back(CVariant(CVariant::VariantTypeArray));
+    current = &(*current)[0];
+  }
+
+  std::string output = CCBORVariantWriter::Write(root);
+  ASSERT_EQ(100001U, output.size());
+  EXPECT_EQ(std::string(100000, '\x81') + '\x80', output);
+}
+
+TEST(TestVariantStreamWriter, Benchmark)
+{
+  const unsigned int movies = 20000;
+  const unsigned int chunkSize = 16 * 1024;
+  CVariant library = CreateLibrary(movies);
+
+  int64_t start = CurrentHostCounter();
+  std::string json = CJSONVariantWriter::Write(library, true);
+  int64_t jsonTime = CurrentHostCounter() - start;
+
+  start = CurrentHostCounter();
+  std::string cbor = CCBORVariantWriter::Write(library);
+  int64_t cborTime = CurrentHostCounter() - start;
+
+  CVariantStreamWriter writer(library, new CJSONVariantEncoder(true));
+  std::vector<char> buffer(chunkSize);
+  size_t streamed = 0;
+  int64_t firstChunkTime = 0;
+  int read;
+  start = CurrentHostCounter();
+  while ((read = writer.Read(&buffer[0], chunkSize)) > 0)
+  {
+    if (streamed == 0)
+      firstChunkTime = CurrentHostCounter() - start;
+    streamed += read;
+  }
+  int64_t streamTime = CurrentHostCounter() - start;
+
+  EXPECT_EQ(json.size(), streamed);
+
+  std::cout << "Movies: " << testing::PrintToString(movies) << std::endl;
+  std::cout << "  JSON string (us): " << testing::PrintToString(ToMicroSeconds(jsonTime)) << std::endl;
+  std::cout << "  JSON string bytes: " << testing::PrintToString(json.size()) << std::endl;
+  std::cout << "  CBOR string (us): " << testing::PrintToString(ToMicroSeconds(cborTime)) << std::endl;
+  std::cout << "  CBOR string bytes: " << testing::PrintToString(cbor.size()) << std::endl;
+  std::cout << "  JSON streamed (us): " << testing::PrintToString(ToMicroSeconds(streamTime)) << std::endl;
+  std::cout << "  JSON streamed first chunk (us): " << testing::PrintToString(ToMicroSeconds(firstChunkTime)) << std::endl;
+}
@@ -24,6 +24,7 @@
 #include "filesystem/SpecialProtocol.h"
 
 #include "test/TestUtils.h"
+#include "utils/TimeUtils.h"
 
 #include "gtest/gtest.h"
 
@@ -146,3 +147,84 @@ TEST_F(Testlog, SetLogLevel)
   CLog::Close();
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
+
+TEST_F(Testlog, Async)
+{
+  CStdString logfile, logstring;
+  char buf[100];
+  unsigned int bytesread;
+  XFILE::CFile file;
+  CRegExp regex;
+
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+  EXPECT_TRUE(XFILE::CFile::Exists(logfile));
+
+  CLog::SetAsync(true);
+  EXPECT_TRUE(CLog::IsAsync());
+
+  CLog::Log(LOGDEBUG, "async debug log message");
+  CLog::Log(LOGERROR, "async error log message");
+  CLog::Log(LOGNOTICE, "async long log message %s", std::string(2000, 'x').c_str());
+  CLog::Log(LOGNOTICE, "async repeated log message");
+  CLog::Log(LOGNOTICE, "async repeated log message");
+  CLog::Log(LOGNOTICE, "async last log message");
+  CLog::Flush();
+
+  unsigned int dropped, overflowed;
+  CLog::GetAsyncStats(dropped, overflowed);
+  EXPECT_EQ(0U, dropped);
+  EXPECT_EQ(1U, overflowed);
+
+  CLog::Close();
+  EXPECT_FALSE(CLog::IsAsync());
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+
+  EXPECT_TRUE(regex.RegComp(".*DEBUG: async debug log message.*"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+  EXPECT_TRUE(regex.RegComp(".*ERROR: async error log message.*"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+  EXPECT_TRUE(regex.RegComp(".*NOTICE: async long log message x{2000}.*"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+  EXPECT_TRUE(regex.RegComp(".*Previous line repeats 1 times.*"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+  EXPECT_TRUE(regex.RegComp(".*NOTICE: async last log message.*"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
+/* Time spent in CLog::Log by the calling thread, writing directly and
+ * through the asynchronous writer. */
+TEST_F(Testlog, Benchmark)
+{
+  static const int lines = 20000;
+  CStdString logfile = CSpecialProtocol::TranslatePath("special://temp/") + "xbmc.log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/")));
+
+  for (int async = 0; async < 2; async++)
+  {
+    CLog::SetAsync(async != 0);
+    int64_t start = CurrentHostCounter();
+    for (int i = 0; i < lines; i++)
+      CLog::Log(LOGDEBUG, "benchmark line %d of a debug log with some payload", i);
+    double seconds = (double)(CurrentHostCounter() - start) / (double)CurrentHostFrequency();
+    CLog::Flush();
+
+    unsigned int dropped, overflowed;
+    CLog::GetAsyncStats(dropped, overflowed);
+    std::cout << (async ? "Asynchronous" : "Synchronous") << std::endl;
+    std::cout << "  Time per line (ns): " << testing::PrintToString(seconds * 1000000000.0 / lines) << std::endl;
+    std::cout << "  Dropped: " << testing::PrintToString(dropped) << std::endl;
+  }
+
+  CLog::Close();
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
@@ -492,8 +492,10 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL.c_str());
+    strSQL = "select idPath from path where strPath=?";
+    dbiplus::BindList params;
+    params.push_back(strPath1.c_str());
+    m_pDS->query(strSQL, params);
     if (!m_pDS->eof())
       idPath = m_pDS->fv("path.idPath").get_asInt();
 
@@ -660,12 +662,17 @@ int CVideoDatabase::AddPath(const CStdString& strPath, const CStdString &strDate
 
     URIUtils::AddSlashAtEnd(strPath1);
 
+    dbiplus::BindList params;
+    params.push_back(strPath1.c_str());
     // only set dateadded if we got one
     if (!strDateAdded.empty())
-      strSQL=PrepareSQL("insert into path (idPath, strPath, strContent, strScraper, dateAdded) values (NULL,'%s','','', '%s')", strPath1.c_str(), strDateAdded.c_str());
+    {
+      strSQL = "insert into path (idPath, strPath, strContent, strScraper, dateAdded) values (NULL,?,'','',?)";
+      params.push_back(strDateAdded.c_str());
+    }
     else
-      strSQL=PrepareSQL("insert into path (idPath, strPath, strContent, strScraper) values (NULL,'%s','','')", strPath1.c_str());
-    m_pDS->exec(strSQL.c_str());
+      strSQL = "insert into path (idPath, strPath, strContent, strScraper) values (NULL,?,'','')";
+    m_pDS->exec(strSQL, params);
     idPath = (int)m_pDS->lastinsertid();
     return idPath;
   }
@@ -683,8 +690,9 @@ bool CVideoDatabase::GetPathHash(const CStdString &path, CStdString &hash)
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString strSQL=PrepareSQL("select strHash from path where strPath='%s'", path.c_str());
-    m_pDS->query(strSQL.c_str());
+    dbiplus::BindList params;
+    params.push_back(path.c_str());
+    m_pDS->query("select strHash from path where strPath=?", params);
     if (m_pDS->num_rows() == 0)
       return false;
     hash = m_pDS->fv("strHash").get_asString();
@@ -1010,9 +1018,10 @@ int CVideoDatabase::GetFileId(const CStdString& strFilenameAndPath)
     int idPath = GetPathId(strPath);
     if (idPath >= 0)
     {
-      CStdString strSQL;
-      strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
-      m_pDS->query(strSQL.c_str());
+      dbiplus::BindList params;
+      params.push_back(strFileName.c_str());
+      params.push_back(idPath);
+      m_pDS->query("select idFile from files where strFileName=? and idPath=?", params);
       if (m_pDS->num_rows() > 0)
       {
         int idFile = m_pDS->fv("files.idFile").get_asInt();
@@ -1841,8 +1850,9 @@ bool CVideoDatabase::GetMovieInfo(const CStdString& strFilenameAndPath, CVideoIn
       idMovie = GetMovieId(strFilenameAndPath);
     if (idMovie < 0) return false;
 
-    CStdString sql = PrepareSQL("select * from movieview where idMovie=%i", idMovie);
-    if (!m_pDS->query(sql.c_str()))
+    dbiplus::BindList params;
+    params.push_back(idMovie);
+    if (!m_pDS->query("select * from movieview where idMovie=?", params))
       return false;
     details = GetDetailsForMovie(m_pDS, true);
     return !details.IsEmpty();
@@ -54,6 +54,9 @@ using namespace std;
 using namespace XFILE;
 using namespace ADDON;
 
+// sibling folders listed in the background ahead of the one being scanned
+#define PREFETCH_FOLDERS 16
+
 namespace VIDEO
 {
 
@@ -129,6 +132,9 @@ namespace VIDEO
           bCancelled = true;
       }
 
+      // drop whatever was listed ahead of a cancelled scan
+      m_prefetcher.Cancel();
+
       if (!bCancelled)
       {
         if (m_bClean)
@@ -211,6 +217,11 @@ namespace VIDEO
     m_bRunning = false;
   }
 
+  static bool IsScannedFolder(const CFileItem &item, const SScanSettings &settings, CONTENT_TYPE content)
+  {
+    return item.m_bIsFolder && !item.IsParentFolder() && !item.IsPlayList() && settings.recurse > 0 && content != CONTENT_TVSHOWS;
+  }
+
   static void OnDirectoryScanned(const CStdString& strDirectory)
   {
     CGUIMessage msg(GUI_MSG_DIRECTORY_SCANNED, 0, 0, 0);
@@ -263,19 +274,27 @@ namespace VIDEO
         m_handle->SetTitle(StringUtils::Format(g_localizeStrings.Get(str), info->Name().c_str()));
       }
 
-      CStdString fastHash = GetFastHash(strDirectory, regexps);
-      if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.empty() && fastHash == dbHash)
+      // use the listing fetched in the background while the previous folders were scanned, if any
+      CFolderListing listing;
+      m_database.GetPathHash(strDirectory, dbHash);
+      if (!m_prefetcher.Take(strDirectory, listing, &m_bStop))
+      {
+        if (m_bStop)
+          return false;
+        ListFolder(strDirectory, regexps, dbHash, listing);
+      }
+
+      CStdString fastHash = listing.fastHash;
+      if (!dbHash.empty() && !fastHash.empty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (fasthash)", CURL::GetRedacted(strDirectory).c_str());
         hash = fastHash;
         bSkip = true;
       }
       if (!bSkip)
-      { // need to fetch the folder
-        CDirectory::GetDirectory(strDirectory, items, g_advancedSettings.m_videoExtensions);
-        items.Stack();
-        // compute hash
-        GetPathHash(items, hash);
+      { // the folder has been fetched
+        items.Assign(listing.items);
+        hash = listing.hash;
         if (hash != dbHash && !hash.empty())
         {
           if (dbHash.empty())
@@ -355,6 +374,7 @@ namespace VIDEO
     if (m_handle)
       OnDirectoryScanned(strDirectory);
 
+    int prefetched = 0;
     for (int i = 0; i < items.Size(); ++i)
     {
       CFileItemPtr pItem = items[i];
@@ -364,8 +384,15 @@ namespace VIDEO
 
       // if we have a directory item (non-playlist) we then recurse into that folder
       // do not recurse for tv shows - we have already looked recursively for episodes
-      if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList() && settings.recurse > 0 && content != CONTENT_TVSHOWS)
+      if (IsScannedFolder(*pItem, settings, content))
       {
+        // keep the next few sibling folders being listed while this one is scanned
+        for (; prefetched < items.Size() && prefetched <= i + PREFETCH_FOLDERS; prefetched++)
+        {
+          if (IsScannedFolder(*items[prefetched], settings, content))
+            PrefetchFolder(items[prefetched]->GetPath());
+        }
+
         if (!DoScan(pItem->GetPath()))
         {
           m_bStop = true;
@@ -375,6 +402,38 @@ namespace VIDEO
     return !m_bStop;
   }
 
+  void CVideoInfoScanner::PrefetchFolder(const CStdString &directory)
+  {
+    if (m_prefetcher.IsPending(directory))
+      return;
+
+    SScanSettings settings;
+    bool foundDirectly = false;
+    ScraperPtr info = m_database.GetScraperForPath(directory, settings, foundDirectly);
+    CONTENT_TYPE content = info ? info->Content() : CONTENT_NONE;
+    if (content != CONTENT_MOVIES && content != CONTENT_MUSICVIDEOS)
+      return;
+
+    const CStdStringArray &regexps = g_advancedSettings.m_moviesExcludeFromScanRegExps;
+    if ((!m_scanAll && settings.noupdate) || CUtil::ExcludeFileOrFolder(directory, regexps))
+      return;
+
+    CStdString dbHash;
+    m_database.GetPathHash(directory, dbHash);
+    m_prefetcher.Prefetch(directory, regexps, dbHash);
+  }
+
+  void CVideoInfoScanner::ListFolder(const CStdString &directory, const CStdStringArray &excludes, const CStdString &dbHash, CFolderListing &listing)
+  {
+    listing.fastHash = GetFastHash(directory, excludes);
+    if (!dbHash.empty() && !listing.fastHash.empty() && listing.fastHash == dbHash)
+      return;
+
+    CDirectory::GetDirectory(directory, listing.items, g_advancedSettings.m_videoExtensions);
+    listing.items.Stack();
+    GetPathHash(listing.items, listing.hash);
+  }
+
   bool CVideoInfoScanner::RetrieveVideoInfo(CFileItemList& items, bool bDirNames, CONTENT_TYPE content, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress)
   {
     if (pDlgProgress)
@@ -1711,7 +1770,7 @@ namespace VIDEO
     return true;
   }
 
-  CStdString CVideoInfoScanner::GetFastHash(const CStdString &directory, const CStdStringArray &excludes) const
+  CStdString CVideoInfoScanner::GetFastHash(const CStdString &directory, const CStdStringArray &excludes)
   {
     XBMC::XBMC_MD5 md5state;
 
@@ -22,6 +22,7 @@
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
 #include "NfoFile.h"
+#include "VideoScanPrefetcher.h"
 
 class CRegExp;
 class CFileItem;
@@ -120,10 +121,26 @@ namespace VIDEO
     static std::string GetImage(CFileItem *pItem, bool useLocal, bool bApplyToDir, const std::string &type = "");
     static std::string GetFanart(CFileItem *pItem, bool useLocal);
 
+    /*! \brief List and hash a movie or music video folder
+     The folder is only listed if its fast hash doesn't match the one in the database.
+     Doesn't touch the database, so it may be run from any thread.
+     \param directory folder to list
+     \param excludes exclude from scan expressions for the folder's content
+     \param dbHash hash of the folder stored in the database, empty if none
+     \param listing [out] the fast hash, and the stacked listing and its hash if it was listed
+     */
+    static void ListFolder(const CStdString &directory, const CStdStringArray &excludes, const CStdString &dbHash, CFolderListing &listing);
+
   protected:
     virtual void Process();
     bool DoScan(const CStdString& strDirectory);
 
+    /*! \brief Have a folder the scanner is about to visit listed in the background
+     Only movie and music video folders that would be scanned are queued.
+     \param directory folder to list
+     */
+    void PrefetchFolder(const CStdString &directory);
+
     INFO_RET RetrieveInfoForTvShow(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMovie(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMusicVideo(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
@@ -191,7 +208,7 @@ namespace VIDEO
      \param excludes string array of exclude expressions
      \return the md5 hash of the folder"
      */
-    CStdString GetFastHash(const CStdString &directory, const CStdStringArray &excludes) const;
+    static CStdString GetFastHash(const CStdString &directory, const CStdStringArray &excludes);
 
     /*! \brief Retrieve a "fast" hash of the given directory recursively (if available)
      Performs a stat() on the directory, and uses modified time to create a "fast"
@@ -254,6 +271,7 @@ namespace VIDEO
     std::set<CStdString> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+    CVideoScanPrefetcher m_prefetcher;
   };
 }
 
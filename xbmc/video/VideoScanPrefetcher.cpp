@@ -0,0 +1,210 @@
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "VideoScanPrefetcher.h"
+#include "VideoInfoScanner.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "URL.h"
+
+#include <string.h>
+
+// a listing job that runs longer than this is assumed to be stuck
+#define LISTING_TIMEOUT 30000
+
+using namespace std;
+
+namespace VIDEO
+{
+  class CFolderListingJob : public CJob
+  {
+  public:
+    CFolderListingJob(const CStdString &directory, const CStdStringArray &excludes, const CStdString &dbHash)
+      : m_directory(directory), m_excludes(excludes), m_dbHash(dbHash), m_listing(new CFolderListing)
+    {
+    }
+
+    virtual ~CFolderListingJob()
+    {
+      delete m_listing;
+    }
+
+    virtual const char *GetType() const { return "videoscanlisting"; }
+
+    virtual bool operator==(const CJob* job) const
+    {
+      if (strcmp(job->GetType(), GetType()) == 0)
+        return m_directory == ((const CFolderListingJob *)job)->m_directory;
+      return false;
+    }
+
+    virtual bool DoWork()
+    {
+      // reports the start to the queue, a cancelled job has no queue to report to
+      if (ShouldCancel(0, 1))
+        return false;
+      CVideoInfoScanner::ListFolder(m_directory, m_excludes, m_dbHash, *m_listing);
+      return true;
+    }
+
+    CFolderListing *TakeListing()
+    {
+      CFolderListing *listing = m_listing;
+      m_listing = NULL;
+      return listing;
+    }
+
+    const CStdString &GetDirectory() const { return m_directory; }
+
+  private:
+    CStdString m_directory;
+    CStdStringArray m_excludes;
+    CStdString m_dbHash;
+    CFolderListing *m_listing;
+  };
+
+  CVideoScanPrefetcher::CHostQueue::CHostQueue(CVideoScanPrefetcher *prefetcher, unsigned int jobsAtOnce)
+    : CJobQueue(false, jobsAtOnce, CJob::PRIORITY_LOW), m_prefetcher(prefetcher)
+  {
+  }
+
+  void CVideoScanPrefetcher::CHostQueue::OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job)
+  {
+    m_prefetcher->OnStarted(((const CFolderListingJob *)job)->GetDirectory());
+  }
+
+  void CVideoScanPrefetcher::CHostQueue::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    CFolderListingJob *listingJob = (CFolderListingJob *)job;
+    m_prefetcher->OnListed(listingJob->GetDirectory(), listingJob->TakeListing());
+    CJobQueue::OnJobComplete(jobID, success, job);
+  }
+
+  CVideoScanPrefetcher::CVideoScanPrefetcher(unsigned int jobsPerHost)
+    : m_jobsPerHost(jobsPerHost)
+  {
+  }
+
+  CVideoScanPrefetcher::~CVideoScanPrefetcher()
+  {
+    Cancel();
+    for (map<CStdString, CHostQueue*>::iterator it = m_queues.begin(); it != m_queues.end(); ++it)
+      delete it->second;
+  }
+
+  void CVideoScanPrefetcher::Prefetch(const CStdString &directory, const CStdStringArray &excludes, const CStdString &dbHash)
+  {
+    CSingleLock lock(m_section);
+    if (m_listings.find(directory) != m_listings.end())
+      return;
+    m_listings.insert(make_pair(directory, (CFolderListing *)NULL));
+
+    CStdString host = CURL(directory).GetHostName();
+    map<CStdString, CHostQueue*>::iterator queue = m_queues.find(host);
+    if (queue == m_queues.end())
+      queue = m_queues.insert(make_pair(host, new CHostQueue(this, m_jobsPerHost))).first;
+    queue->second->AddJob(new CFolderListingJob(directory, excludes, dbHash));
+  }
+
+  bool CVideoScanPrefetcher::Take(const CStdString &directory, CFolderListing &listing, volatile bool *abort /* = NULL */)
+  {
+    XbmcThreads::EndTime timeout(LISTING_TIMEOUT);
+    while (true)
+    {
+      CSingleLock lock(m_section);
+      Listings::iterator it = m_listings.find(directory);
+      if (it == m_listings.end())
+        return false;
+      if (it->second)
+      {
+        listing.fastHash = it->second->fastHash;
+        listing.hash = it->second->hash;
+        listing.items.Assign(it->second->items);
+        delete it->second;
+        m_listings.erase(it);
+        return true;
+      }
+      // nothing is gained waiting for a job that didn't even start, or one
+      // that seems to be stuck, the caller lists the folder itself
+      if (m_started.find(directory) == m_started.end() || timeout.IsTimePast())
+      {
+        Drop(directory);
+        return false;
+      }
+      lock.Leave();
+
+      if (abort && *abort)
+        return false;
+      m_listed.WaitMSec(100);
+    }
+  }
+
+  bool CVideoScanPrefetcher::IsPending(const CStdString &directory) const
+  {
+    CSingleLock lock(m_section);
+    return m_listings.find(directory) != m_listings.end();
+  }
+
+  void CVideoScanPrefetcher::Cancel()
+  {
+    CSingleLock lock(m_section);
+    for (map<CStdString, CHostQueue*>::iterator it = m_queues.begin(); it != m_queues.end(); ++it)
+      it->second->CancelJobs();
+    for (Listings::iterator it = m_listings.begin(); it != m_listings.end(); ++it)
+      delete it->second;
+    m_listings.clear();
+    m_started.clear();
+  }
+
+  void CVideoScanPrefetcher::Drop(const CStdString &directory)
+  {
+    CSingleLock lock(m_section);
+    map<CStdString, CHostQueue*>::iterator queue = m_queues.find(CURL(directory).GetHostName());
+    if (queue != m_queues.end())
+    {
+      CFolderListingJob job(directory, CStdStringArray(), "");
+      queue->second->CancelJob(&job);
+    }
+    m_listings.erase(directory);
+    m_started.erase(directory);
+  }
+
+  void CVideoScanPrefetcher::OnStarted(const CStdString &directory)
+  {
+    CSingleLock lock(m_section);
+    if (m_listings.find(directory) != m_listings.end())
+      m_started.insert(directory);
+  }
+
+  void CVideoScanPrefetcher::OnListed(const CStdString &directory, CFolderListing *listing)
+  {
+    CSingleLock lock(m_section);
+    Listings::iterator it = m_listings.find(directory);
+    if (it == m_listings.end() || it->second)
+    { // cancelled in the meantime
+      delete listing;
+      return;
+    }
+    it->second = listing;
+    m_started.erase(directory);
+    lock.Leave();
+    m_listed.Set();
+  }
+}
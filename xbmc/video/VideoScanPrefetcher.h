@@ -0,0 +1,114 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2013 Team XBMC
+ *      http://xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "FileItem.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "utils/JobManager.h"
+#include "utils/StdString.h"
+
+#include <map>
+#include <set>
+
+namespace VIDEO
+{
+  /*! \brief What the scanner needs to know about a folder to decide whether it changed
+   */
+  class CFolderListing
+  {
+  public:
+    CStdString fastHash;  ///< hash of the folder's modification time, empty if not available
+    CStdString hash;      ///< hash of the listing, empty if the folder is empty or wasn't listed
+    CFileItemList items;  ///< stacked listing, only fetched if the fast hash doesn't match the database
+  };
+
+  /*! \brief Lists and hashes folders for the video scanner ahead of time
+
+   On network shares most of a scan without changes is spent waiting for one
+   listing after the other. The scanner hands the folders it is about to visit
+   to the prefetcher, which lists them on the job manager while the scanner is
+   busy with their siblings, and picks the results up once it gets to them.
+   Everything touching the database stays on the scanner's thread, so the
+   order of writes doesn't change.
+
+   Every host gets its own queue, so a single server is never asked for more
+   than a few listings at once.
+   */
+  class CVideoScanPrefetcher
+  {
+  public:
+    /*!
+     \param jobsPerHost listings requested from a single host at once
+     */
+    CVideoScanPrefetcher(unsigned int jobsPerHost = 4);
+    virtual ~CVideoScanPrefetcher();
+
+    /*! \brief Queue a folder for listing
+     \param directory the folder to list
+     \param excludes exclude from scan expressions for the folder's content
+     \param dbHash the hash stored in the database for the folder, the folder is only listed if its fast hash doesn't match
+     */
+    void Prefetch(const CStdString &directory, const CStdStringArray &excludes, const CStdString &dbHash);
+
+    /*! \brief Fetch the listing of a folder queued before, waiting for it if needed
+
+     A folder whose listing hasn't started yet is dropped rather than waited
+     for, as is one that takes longer than a listing should, so the caller
+     lists it itself.
+     \param directory the folder
+     \param listing [out] the listing
+     \param abort stop waiting once this is set, may be NULL
+     \return false if the folder wasn't queued, wasn't listed in time or waiting was aborted
+     */
+    bool Take(const CStdString &directory, CFolderListing &listing, volatile bool *abort = NULL);
+
+    /*! \brief Whether a folder is queued or listed and not taken yet
+     */
+    bool IsPending(const CStdString &directory) const;
+
+    /*! \brief Drop all queued folders and listings not taken
+     */
+    void Cancel();
+
+  private:
+    class CHostQueue : public CJobQueue
+    {
+    public:
+      CHostQueue(CVideoScanPrefetcher *prefetcher, unsigned int jobsAtOnce);
+      virtual void OnJobProgress(unsigned int jobID, unsigned int progress, unsigned int total, const CJob *job);
+      virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+    private:
+      CVideoScanPrefetcher *m_prefetcher;
+    };
+
+    void OnStarted(const CStdString &directory);
+    void OnListed(const CStdString &directory, CFolderListing *listing);
+    void Drop(const CStdString &directory);
+
+    typedef std::map<CStdString, CFolderListing*> Listings;
+    Listings m_listings;  ///< NULL while the folder is being listed
+    std::set<CStdString> m_started;  ///< folders whose listing job is running
+    std::map<CStdString, CHostQueue*> m_queues;
+    unsigned int m_jobsPerHost;
+    CCriticalSection m_section;
+    CEvent m_listed;
+  };
+}
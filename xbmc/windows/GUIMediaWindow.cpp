@@ -598,23 +598,35 @@ void CGUIMediaWindow::SortItems(CFileItemList &items)
 }
 
 // \brief Formats item labels based on the formatting provided by guiViewState
-void CGUIMediaWindow::FormatItemLabels(CFileItemList &items, const LABEL_MASKS &labelMasks)
+class CLabelFormatterPreparer : public IFileItemPreparer
 {
-  CLabelFormatter fileFormatter(labelMasks.m_strLabelFile, labelMasks.m_strLabel2File);
-  CLabelFormatter folderFormatter(labelMasks.m_strLabelFolder, labelMasks.m_strLabel2Folder);
-  for (int i=0; i<items.Size(); ++i)
-  {
-    CFileItemPtr pItem=items[i];
+public:
+  CLabelFormatterPreparer(const LABEL_MASKS &labelMasks)
+    : m_fileFormatter(labelMasks.m_strLabelFile, labelMasks.m_strLabel2File),
+      m_folderFormatter(labelMasks.m_strLabelFolder, labelMasks.m_strLabel2Folder)
+  { }
 
-    if (pItem->IsLabelPreformated())
-      continue;
+  virtual void Prepare(const CFileItemPtr &item)
+  {
+    if (item->IsLabelPreformated())
+      return;
 
-    if (pItem->m_bIsFolder)
-      folderFormatter.FormatLabels(pItem.get());
+    if (item->m_bIsFolder)
+      m_folderFormatter.FormatLabels(item.get());
     else
-      fileFormatter.FormatLabels(pItem.get());
+      m_fileFormatter.FormatLabels(item.get());
   }
 
+private:
+  CLabelFormatter m_fileFormatter;
+  CLabelFormatter m_folderFormatter;
+};
+
+void CGUIMediaWindow::FormatItemLabels(CFileItemList &items, const LABEL_MASKS &labelMasks)
+{
+  // items of lazy lists get their labels formatted once they are materialized
+  items.PrepareItems("labels", FileItemPreparerPtr(new CLabelFormatterPreparer(labelMasks)));
+
   if (items.GetSortMethod() == SortByLabel)
     items.ClearSortState();
 }
@@ -844,7 +856,7 @@ bool CGUIMediaWindow::Update(const CStdString &strDirectory, bool updateFilterPa
 
   bool bSelectedFound = false;
   //int iSongInDirectory = -1;
-  for (int i = 0; i < m_vecItems->Size(); ++i)
+  for (int i = 0; i < m_vecItems->Size() && !strSelectedItem.empty(); ++i)
   {
     CFileItemPtr pItem = m_vecItems->Get(i);
 
@@ -1755,11 +1767,11 @@ void CGUIMediaWindow::OnFilterItems(const CStdString &filter)
   // the filter can be passed down to the sub-directory
   for (int index = 0; index < m_vecItems->Size(); index++)
   {
-    CFileItemPtr pItem = m_vecItems->Get(index);
     // if the item is a folder we need to copy the path of
     // the filtered item to be able to keep the applied filters
-    if (pItem->m_bIsFolder)
+    if (m_vecItems->IsFolder(index))
     {
+      CFileItemPtr pItem = m_vecItems->Get(index);
       CURL itemUrl(pItem->GetPath());
       if (!filterOption.empty())
         itemUrl.SetOption("filter", filterOption);
@@ -27,9 +27,11 @@
 #include "input/ButtonTranslator.h"
 #include "guilib/GUIControlFactory.h"
 #include "guilib/GUIFontManager.h"
+#include "guilib/GUIFontAtlas.h"
 #include "guilib/GUITextLayout.h"
 #include "guilib/GUIWindowManager.h"
 #include "guilib/GUIControlProfiler.h"
+#include "guilib/GUITexture.h"
 #include "GUIInfoManager.h"
 #include "utils/Variant.h"
 #include "utils/StringUtils.h"
@@ -111,6 +113,17 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
     info = StringUtils::Format("LOG: %sxbmc.log\nMEM: %"PRIu64"/%"PRIu64" KB - FPS: %2.1f fps\nCPU: %s (CPU-XBMC %4.2f%%%s)", g_advancedSettings.m_logFolder.c_str(),
                                stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), strCores.c_str(), dCPU, profiling.c_str());
 #endif
+#if defined(HAS_GL)
+    unsigned int drawCalls, quads;
+    CGUITextureGL::GetBatchStats(drawCalls, quads);
+    info += StringUtils::Format("\nGUI: %u quads in %u draws", quads, drawCalls);
+#endif
+    const CGUIFontAtlas::Stats &glyphs = g_fontManager.GetGlyphAtlas().GetFrameStats();
+    uint64_t lookups = glyphs.hits + glyphs.misses;
+    info += StringUtils::Format("\nGlyphs: %.1f%% cached, %"PRIu64" vertices, %u pages",
+                                lookups ? 100.0 * glyphs.hits / lookups : 100.0, glyphs.vertices,
+                                g_fontManager.GetGlyphAtlas().GetPageCount());
+    info += StringUtils::Format("\nInfo: %u conditions evaluated", g_infoManager.GetBoolEvaluations());
   }
 
   // render the skin debug info